@@ -50,9 +50,6 @@ void AutoTuner::Initialize(const Config& config,
   schedule_measurer_ =
       std::make_unique<ScheduleMeasurer>(builder_.get(), runner_.get());
 
-  // initialize database
-  database_ = std::move(Database::Make(config.database_config));
-
   // create tasks
   TaskCreator task_creator;
   tasks_ = task_creator.CreateTuneTaskOpLevel(graph_);
@@ -76,6 +73,10 @@ void AutoTuner::Initialize(const Config& config,
             << task.serialized_key;
   }
 
+  // initialize database after the tasks are registered, which loads the
+  // records of these tasks only
+  database_ = std::move(Database::Make(config.database_config));
+
   // create task optimizers
   utils::LinearRandomEngine::StateType initial_seed =
       utils::LinearRandomEngine::GetDeviceRandomValue();
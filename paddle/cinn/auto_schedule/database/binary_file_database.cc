@@ -0,0 +1,329 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/auto_schedule/database/binary_file_database.h"
+
+#include <fcntl.h>
+#include <google/protobuf/util/json_util.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#include "paddle/cinn/auto_schedule/auto_schedule.pb.h"
+#include "paddle/cinn/auto_schedule/database/jsonfile_database.h"
+#include "paddle/cinn/auto_schedule/task/task_registry.h"
+
+namespace cinn {
+namespace auto_schedule {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'I', 'N', 'N', 'T', 'R', 'E', 'C'};
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+struct FrameHeader {
+  uint32_t key_size;
+  uint32_t record_size;
+  // checksum of the key and the record
+  uint64_t checksum;
+};
+
+// FNV-1a, only to detect damaged frames
+uint64_t Checksum(const std::string& key, const std::string& record) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (const std::string* data : {&key, &record}) {
+    for (unsigned char c : *data) {
+      hash = (hash ^ c) * 1099511628211ULL;
+    }
+  }
+  return hash;
+}
+
+std::string FileHeaderBytes() {
+  FileHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.reserved = 0;
+  return std::string(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+std::string FrameBytes(const std::string& key, const std::string& record) {
+  FrameHeader header;
+  header.key_size = key.size();
+  header.record_size = record.size();
+  header.checksum = Checksum(key, record);
+  std::string frame(reinterpret_cast<const char*>(&header), sizeof(header));
+  frame.append(key);
+  frame.append(record);
+  return frame;
+}
+
+// open the file for appending and take an exclusive lock on it, which is
+// released when the file is closed
+int OpenLocked(const std::string& file_path, bool create) {
+  int flags = O_WRONLY | O_APPEND | (create ? O_CREAT : 0);
+  int fd = ::open(file_path.c_str(), flags, 0644);
+  CHECK_GE(fd, 0) << "Cannot open the file to write: " << file_path;
+  int ret = 0;
+  do {
+    ret = ::flock(fd, LOCK_EX);
+  } while (ret != 0 && errno == EINTR);
+  CHECK_EQ(ret, 0) << "Failed to lock the file: " << file_path;
+  return fd;
+}
+
+void WriteAll(int fd, const std::string& file_path, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t ret = ::write(fd, data.data() + written, data.size() - written);
+    if (ret < 0 && errno == EINTR) continue;
+    CHECK_GT(ret, 0) << "Failed to write the file: " << file_path;
+    written += ret;
+  }
+}
+
+// append data to the file under the lock, so concurrent appends from other
+// processes do not interleave with it and a load never sees it half written
+void AppendToFile(const std::string& file_path, const std::string& data) {
+  int fd = OpenLocked(file_path, /*create=*/false);
+  WriteAll(fd, file_path, data);
+  ::close(fd);
+}
+
+// Under the lock, truncate the damaged tail of the file, and write the file
+// header if nothing valid is left. The records are read again under the
+// lock, since other processes may have appended or repaired the file since
+// it was loaded.
+void RepairFile(const std::string& file_path, bool create) {
+  int fd = OpenLocked(file_path, create);
+  struct stat sb;
+  CHECK_EQ(::fstat(fd, &sb), 0) << "Failed to stat the file: " << file_path;
+  uint64_t file_size = sb.st_size;
+  uint64_t valid_end = file_size == 0
+                           ? 0
+                           : ReadBinaryRecords(
+                                 file_path,
+                                 [](const std::string&, const std::string&) {});
+  if (valid_end < file_size) {
+    LOG(WARNING) << "Truncate the incomplete tuning records of " << file_path
+                 << " from " << file_size << " to " << valid_end << " bytes";
+    CHECK_EQ(::ftruncate(fd, valid_end), 0)
+        << "Failed to truncate " << file_path;
+  }
+  if (valid_end == 0) {
+    WriteAll(fd, file_path, FileHeaderBytes());
+  }
+  ::close(fd);
+}
+
+// The measured costs of the manual and external schedules of a task are
+// stored under the task key with a "@ManualMeasured:\n" or
+// "@ExternalMeasured:\n" prefix, which are loaded with the task too.
+bool IsRegisteredTaskKey(const std::string& key) {
+  InitialTaskRegistry* task_registry = InitialTaskRegistry::Global();
+  if (task_registry->Has(key)) {
+    return true;
+  }
+  size_t pos = key.find('\n');
+  return !key.empty() && key[0] == '@' && pos != std::string::npos &&
+         task_registry->Has(key.substr(pos + 1));
+}
+
+bool IsJSONFile(const std::string& file_path) {
+  static const std::string kSuffix = ".json";
+  return file_path.size() >= kSuffix.size() &&
+         file_path.compare(file_path.size() - kSuffix.size(),
+                           kSuffix.size(),
+                           kSuffix) == 0;
+}
+
+}  // namespace
+
+uint64_t ReadBinaryRecords(
+    const std::string& file_path,
+    const std::function<void(const std::string&, const std::string&)>& fn) {
+  std::ifstream is(file_path, std::ios::binary | std::ios::ate);
+  CHECK(is.good()) << "Cannot open the file to read: " << file_path;
+  uint64_t file_size = is.tellg();
+  is.seekg(0);
+  FileHeader file_header;
+  if (!is.read(reinterpret_cast<char*>(&file_header), sizeof(file_header))) {
+    return 0;
+  }
+  CHECK(std::memcmp(file_header.magic, kMagic, sizeof(kMagic)) == 0)
+      << file_path << " is not a CINN tuning record file";
+  CHECK_EQ(file_header.version, kVersion)
+      << "Unsupported version of the tuning record file: " << file_path;
+
+  uint64_t valid_end = sizeof(file_header);
+  std::string key, record;
+  FrameHeader header;
+  while (is.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    // sizes beyond the end of the file come from a damaged header, check
+    // them before allocating
+    uint64_t frame_size = sizeof(header) +
+                          static_cast<uint64_t>(header.key_size) +
+                          header.record_size;
+    if (frame_size > file_size - valid_end) {
+      break;
+    }
+    key.resize(header.key_size);
+    record.resize(header.record_size);
+    if (!is.read(&key[0], key.size()) || !is.read(&record[0], record.size())) {
+      break;
+    }
+    if (Checksum(key, record) != header.checksum) {
+      LOG(WARNING) << "Damaged tuning record at offset " << valid_end
+                   << " of " << file_path << ", ignore the rest of the file";
+      break;
+    }
+    fn(key, record);
+    valid_end += sizeof(header) + key.size() + record.size();
+  }
+  return valid_end;
+}
+
+BinaryFileDatabase::BinaryFileDatabase(int capacity_per_task,
+                                       const std::string& record_file_path,
+                                       bool allow_new_file)
+    : Database(capacity_per_task), record_file_path_(record_file_path) {
+  VLOG(3) << "Auto schedule will save/load tuning records on file:"
+          << record_file_path;
+  std::ifstream is(record_file_path_, std::ios::binary | std::ios::ate);
+  if (!is.good()) {
+    CHECK(allow_new_file) << "File doesn't exist: " << record_file_path_;
+    RepairFile(record_file_path_, /*create=*/true);
+    return;
+  }
+  uint64_t file_size = is.tellg();
+  is.close();
+  if (file_size == 0) {
+    RepairFile(record_file_path_, /*create=*/false);
+    return;
+  }
+
+  size_t total = 0;
+  auto load_fn = [&](const std::string& task_key, const std::string& bytes) {
+    ++total;
+    if (!IsRegisteredTaskKey(task_key)) {
+      return;
+    }
+    proto::TuningRecord record_proto;
+    CHECK(record_proto.ParseFromString(bytes))
+        << "Failed to parse the tuning record of task_key=" << task_key;
+    VLOG(4) << "Add a measured TuningRecord with task_key=" << task_key;
+    Insert(TuningRecord(record_proto));
+  };
+  uint64_t valid_end = ReadBinaryRecords(record_file_path_, load_fn);
+  VLOG(3) << "Loaded " << Size() << " of " << total
+          << " tuning records for the registered tasks";
+
+  if (valid_end < file_size) {
+    RepairFile(record_file_path_, /*create=*/false);
+  }
+}
+
+bool BinaryFileDatabase::Commit(const TuningRecord& record) {
+  std::string bytes;
+  CHECK(record.ToProto().SerializeToString(&bytes))
+      << "Failed to serialize record, task key = " << record.task_key;
+  AppendToFile(record_file_path_, FrameBytes(record.task_key, bytes));
+  return true;
+}
+
+/*static*/ size_t BinaryFileDatabase::Merge(
+    const std::vector<std::string>& input_paths,
+    const std::string& output_path,
+    int capacity_per_task) {
+  CHECK_GT(capacity_per_task, 0)
+      << "capacity_per_task should be greater than 0";
+  // task_key -> (execution_cost, serialized record)
+  std::map<std::string, std::vector<std::pair<double, std::string>>> records;
+  auto add_record = [&](const proto::TuningRecord& record_proto) {
+    std::string bytes;
+    CHECK(record_proto.SerializeToString(&bytes));
+    records[record_proto.task_key()].emplace_back(
+        record_proto.execution_cost(), std::move(bytes));
+  };
+  auto parse_fn = [&](const std::string& task_key, const std::string& bytes) {
+    proto::TuningRecord record_proto;
+    CHECK(record_proto.ParseFromString(bytes))
+        << "Failed to parse the tuning record of task_key=" << task_key;
+    add_record(record_proto);
+  };
+
+  for (const auto& input_path : input_paths) {
+    if (IsJSONFile(input_path)) {
+      for (const auto& line :
+           ReadLinesFromFile(input_path, /*allow_new_file=*/false)) {
+        proto::TuningRecord record_proto;
+        auto status =
+            google::protobuf::util::JsonStringToMessage(line, &record_proto);
+        CHECK(status.ok()) << "Failed to parse JSON: " << line;
+        add_record(record_proto);
+      }
+      continue;
+    }
+    ReadBinaryRecords(input_path, parse_fn);
+  }
+
+  // write to a temporary file and rename, so the output may be one of the
+  // inputs and readers never see a partial file
+  std::string tmp_path = output_path + ".tmp";
+  std::ofstream os(tmp_path, std::ios::binary | std::ios::trunc);
+  CHECK(os.good()) << "Cannot open the file to write: " << tmp_path;
+  os << FileHeaderBytes();
+  size_t num_written = 0;
+  for (auto& [task_key, task_records] : records) {
+    std::stable_sort(
+        task_records.begin(),
+        task_records.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    std::vector<const std::string*> kept;
+    for (const auto& [cost, bytes] : task_records) {
+      if (kept.size() == capacity_per_task) break;
+      if (std::any_of(kept.begin(), kept.end(), [&](const std::string* k) {
+            return *k == bytes;
+          })) {
+        continue;
+      }
+      kept.push_back(&bytes);
+      os << FrameBytes(task_key, bytes);
+    }
+    num_written += kept.size();
+  }
+  os.close();
+  CHECK(os.good()) << "Failed to write the file: " << tmp_path;
+  CHECK_EQ(std::rename(tmp_path.c_str(), output_path.c_str()), 0)
+      << "Failed to rename " << tmp_path << " to " << output_path;
+  VLOG(3) << "Merged " << num_written << " tuning records of "
+          << records.size() << " tasks into " << output_path;
+  return num_written;
+}
+
+}  // namespace auto_schedule
+}  // namespace cinn
@@ -0,0 +1,77 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "paddle/cinn/auto_schedule/database/database.h"
+
+namespace cinn {
+namespace auto_schedule {
+
+// BinaryFileDatabase is a database implemented by an append-only binary file
+// to save/load underlying data, which can be shared by the tuning jobs of
+// several processes and merged across machines.
+//
+// The file starts with a header, followed by one frame per record holding
+// the task key, the serialized proto::TuningRecord and a checksum of both.
+// The task key contains the target, so records of different targets never
+// mix. Loading reads the keys only and parses the records of the registered
+// tasks, including the measured costs of their manual and external
+// schedules. A record is appended under an exclusive flock, so processes
+// appending to the same file do not interleave, and a frame left incomplete
+// by a crashed writer is truncated under the same lock on the next load.
+class BinaryFileDatabase : public Database {
+ public:
+  /*!
+   * \brief Build a BinaryFileDatabase object from a binary record file.
+   * \param capacity_per_task The max number of candidates stored.
+   * \param record_file_path The path of the record file.
+   * \param allow_new_file Whether to create new file when the given path is not
+   * found.
+   */
+  BinaryFileDatabase(int capacity_per_task,
+                     const std::string& record_file_path,
+                     bool allow_new_file);
+  ~BinaryFileDatabase() = default;
+
+  /*!
+   * \brief Merge record files into one, keeping the best capacity_per_task
+   * records of each task and dropping duplicated ones. The inputs can be
+   * binary record files or JSON files of JSONFileDatabase.
+   * \return The number of records written to output_path.
+   */
+  static size_t Merge(const std::vector<std::string>& input_paths,
+                      const std::string& output_path,
+                      int capacity_per_task);
+
+ protected:
+  // commit the newly added record into the binary file
+  bool Commit(const TuningRecord& record) override;
+
+  // the name of the binary file to save tuning records.
+  std::string record_file_path_;
+};
+
+// Call fn(task_key, serialized_record) on each record of a binary record
+// file, and return the end offset of the last valid record.
+uint64_t ReadBinaryRecords(
+    const std::string& file_path,
+    const std::function<void(const std::string&, const std::string&)>& fn);
+
+}  // namespace auto_schedule
+}  // namespace cinn
@@ -0,0 +1,192 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/auto_schedule/database/binary_file_database.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "paddle/cinn/ast_gen_ius/tensor_group.h"
+#include "paddle/cinn/auto_schedule/database/jsonfile_database.h"
+#include "paddle/cinn/auto_schedule/search_space/search_state.h"
+#include "paddle/cinn/auto_schedule/task/task_registry.h"
+#include "paddle/cinn/cinn.h"
+#include "paddle/cinn/ir/schedule/ir_schedule.h"
+#include "paddle/cinn/ir/utils/ir_copy.h"
+
+namespace cinn {
+namespace auto_schedule {
+
+// Return lowered ir AST for example functions used in this test
+std::vector<ir::LoweredFunc> LowerCompute(const std::vector<int>& shape,
+                                          const Target& target) {
+  CHECK(shape.size() == 2) << "shape should be 2";
+  std::vector<Expr> domain;
+  for (auto i = 0; i < shape.size(); ++i) {
+    domain.emplace_back(shape[i]);
+  }
+
+  Placeholder<float> A("A", domain);
+  ir::Tensor B = Compute(
+      domain, [&A](Var i, Var j) { return A(i, j); }, "B");
+
+  ast_gen_ius::TensorGroup tensor_group({A, B});
+  return cinn::lang::LowerToAstVec("test_func", {A, B}, &tensor_group, target);
+}
+
+// Create a new IRSchedule with copied ir::LoweredFunc AST, and register it as
+// the initial ModuleExpr of task_key
+ir::IRSchedule MakeIRSchedule(const std::vector<ir::LoweredFunc>& lowered_funcs,
+                              const std::string& task_key) {
+  std::vector<Expr> exprs;
+  for (auto&& func : lowered_funcs) {
+    exprs.emplace_back(ir::ir_utils::IRCopy(func->body));
+  }
+  InitialTaskRegistry* task_registry = InitialTaskRegistry::Global();
+  task_registry->Regist(task_key, ir::ModuleExpr(exprs));
+
+  return ir::IRSchedule(ir::ModuleExpr(exprs));
+}
+
+class TestBinaryFileDatabase : public ::testing::Test {
+ public:
+  TestBinaryFileDatabase()
+      : record_file_path("/tmp/test_record.bin"),
+        merged_file_path("/tmp/test_record_merged.bin") {}
+
+  void SetUp() override {
+    lowered_funcs = LowerCompute({32, 32}, target);
+    std::remove(record_file_path.c_str());
+    std::remove(merged_file_path.c_str());
+  }
+
+  void TearDown() override {
+    std::remove(record_file_path.c_str());
+    std::remove(merged_file_path.c_str());
+  }
+
+  TuningRecord MakeRecord(const std::string& task_key, double cost) {
+    ir::IRSchedule ir_sch = MakeIRSchedule(lowered_funcs, task_key);
+    ir_sch.Fuse("B", {0, 1});
+    return TuningRecord(task_key, SearchState(std::move(ir_sch), 1.0), cost);
+  }
+
+  std::string record_file_path;
+  std::string merged_file_path;
+  std::vector<ir::LoweredFunc> lowered_funcs;
+  Target target = cinn::common::DefaultHostTarget();
+};
+
+TEST_F(TestBinaryFileDatabase, SaveLoad) {
+  {
+    BinaryFileDatabase test_db(2, record_file_path, true);
+    test_db.AddRecord(MakeRecord("k1", 1.0));
+    test_db.AddRecord(MakeRecord("k2", 3.0));
+    test_db.AddRecord(MakeRecord("k2", 2.0));
+    test_db.AddRecord(MakeRecord("k2", 4.0));
+  }
+  // every record is appended to the file, the capacity only limits the
+  // records kept in memory
+  size_t num_records = 0;
+  ReadBinaryRecords(record_file_path,
+                    [&](const std::string& task_key, const std::string& bytes) {
+                      ++num_records;
+                    });
+  EXPECT_EQ(num_records, 4);
+
+  BinaryFileDatabase test_db(2, record_file_path, false);
+  ASSERT_EQ(test_db.Count("k1"), 1);
+  auto records = test_db.LookUp("k2");
+  ASSERT_EQ(records.size(), 2);
+  EXPECT_EQ(records[0].execution_cost, 2.0);
+  EXPECT_EQ(records[1].execution_cost, 3.0);
+  EXPECT_EQ(records[0].trace.steps_size(), 1);
+  EXPECT_EQ(records[0].trace.steps(0).type(), "FuseWithName");
+}
+
+TEST_F(TestBinaryFileDatabase, TruncateIncompleteRecord) {
+  {
+    BinaryFileDatabase test_db(2, record_file_path, true);
+    test_db.AddRecord(MakeRecord("k1", 1.0));
+  }
+  {
+    // a record left incomplete by a crashed writer
+    std::ofstream os(record_file_path, std::ios::binary | std::ios::app);
+    os << "incomplete";
+  }
+  {
+    BinaryFileDatabase test_db(2, record_file_path, false);
+    EXPECT_EQ(test_db.Count("k1"), 1);
+    test_db.AddRecord(MakeRecord("k1", 0.5));
+  }
+  BinaryFileDatabase test_db(2, record_file_path, false);
+  auto records = test_db.LookUp("k1");
+  ASSERT_EQ(records.size(), 2);
+  EXPECT_EQ(records[0].execution_cost, 0.5);
+}
+
+TEST_F(TestBinaryFileDatabase, TruncateDamagedFrameSize) {
+  {
+    BinaryFileDatabase test_db(2, record_file_path, true);
+    test_db.AddRecord(MakeRecord("k1", 1.0));
+  }
+  {
+    // a frame header whose key size is beyond the end of the file
+    std::ofstream os(record_file_path, std::ios::binary | std::ios::app);
+    uint32_t sizes[2] = {0xffffffffu, 16};
+    uint64_t checksum = 0;
+    os.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    os.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+  }
+  {
+    BinaryFileDatabase test_db(2, record_file_path, false);
+    EXPECT_EQ(test_db.Count("k1"), 1);
+    test_db.AddRecord(MakeRecord("k1", 0.5));
+  }
+  BinaryFileDatabase test_db(2, record_file_path, false);
+  EXPECT_EQ(test_db.Count("k1"), 2);
+}
+
+TEST_F(TestBinaryFileDatabase, Merge) {
+  std::string json_file_path = "/tmp/test_record_merge.json";
+  std::remove(json_file_path.c_str());
+  {
+    BinaryFileDatabase binary_db(3, record_file_path, true);
+    binary_db.AddRecord(MakeRecord("k1", 3.0));
+    binary_db.AddRecord(MakeRecord("k1", 1.0));
+    binary_db.AddRecord(MakeRecord("k2", 2.0));
+    JSONFileDatabase json_db(3, json_file_path, true);
+    json_db.AddRecord(MakeRecord("k1", 2.0));
+    // the same record from another job
+    json_db.AddRecord(MakeRecord("k2", 2.0));
+  }
+
+  size_t num_written = BinaryFileDatabase::Merge(
+      {record_file_path, json_file_path}, merged_file_path, 2);
+  EXPECT_EQ(num_written, 3);
+  std::remove(json_file_path.c_str());
+
+  BinaryFileDatabase merged_db(2, merged_file_path, false);
+  auto records = merged_db.LookUp("k1");
+  ASSERT_EQ(records.size(), 2);
+  EXPECT_EQ(records[0].execution_cost, 1.0);
+  EXPECT_EQ(records[1].execution_cost, 2.0);
+  EXPECT_EQ(merged_db.Count("k2"), 1);
+}
+
+}  // namespace auto_schedule
+}  // namespace cinn
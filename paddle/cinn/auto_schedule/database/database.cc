@@ -18,6 +18,7 @@
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/json_util.h>
 
+#include "paddle/cinn/auto_schedule/database/binary_file_database.h"
 #include "paddle/cinn/auto_schedule/database/jsonfile_database.h"
 #include "paddle/cinn/auto_schedule/task/task_registry.h"
 #include "paddle/cinn/ir/schedule/ir_schedule.h"
@@ -52,6 +53,9 @@ std::unique_ptr<Database> Database::Make(const DatabaseConfig& config) {
   } else if (config.type == DatabaseType::kJSONFile) {
     return std::make_unique<JSONFileDatabase>(
         config.capacity_per_task, config.record_file_path, true);
+  } else if (config.type == DatabaseType::kBinaryFile) {
+    return std::make_unique<BinaryFileDatabase>(
+        config.capacity_per_task, config.record_file_path, true);
   }
 
   LOG(FATAL) << "Unimplemented database type.";
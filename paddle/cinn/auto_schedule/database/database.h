@@ -57,7 +57,7 @@ struct TuningRecord {
   };
 };
 
-enum class DatabaseType : int { kMemory, kJSONFile };
+enum class DatabaseType : int { kMemory, kJSONFile, kBinaryFile };
 
 struct DatabaseConfig {
   DatabaseType type = DatabaseType::kMemory;
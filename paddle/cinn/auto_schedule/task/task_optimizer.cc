@@ -23,6 +23,7 @@
 #include "paddle/cinn/auto_schedule/cost_model/expr_cost_model.h"
 #include "paddle/cinn/auto_schedule/measure/measure.h"
 #include "paddle/cinn/auto_schedule/search_strategy/evolutionary_search.h"
+#include "paddle/cinn/auto_schedule/task/task_registry.h"
 #include "paddle/cinn/common/target.h"
 #include "paddle/cinn/hlir/framework/op_lowering.h"
 #include "paddle/cinn/hlir/op/external_api_registry.h"
@@ -30,6 +31,7 @@
 #include "paddle/cinn/ir/ir.h"
 #include "paddle/cinn/ir/ir_base.h"
 #include "paddle/cinn/ir/schedule/ir_schedule.h"
+#include "paddle/cinn/ir/schedule/schedule_desc.h"
 #include "paddle/cinn/ir/utils/ir_copy.h"
 #include "paddle/cinn/optim/transform_gpu_forloop.h"
 #include "paddle/cinn/runtime/flags.h"
@@ -47,6 +49,11 @@ namespace auto_schedule {
 
 using cinn::hlir::op::ExternalApiRegistry;
 
+// the prefixes added in front of serialized_key to store/load the measured
+// records of the manual schedule and the external api
+static constexpr char kManualMeasuredKeyPrefix[] = "@ManualMeasured:\n";
+static constexpr char kExternalMeasuredKeyPrefix[] = "@ExternalMeasured:\n";
+
 // *** forward declarations of auxiliary functions to be used in this file only
 // *** update a scheduled function with several post-processors
 ir::LoweredFunc FuncWithUpdatedBody(const cinn::common::Target& target,
@@ -87,9 +94,25 @@ FunctionGroup TaskOptimizer::Optimize(const TuningOptions& options) {
   auto initial_output_names = task_->subgraph->output_names;
 
   std::vector<TaskOptimizer::Result> candidates;
-  candidates.emplace_back(OptimizeByEvolution(options));
-  candidates.emplace_back(OptimizeByManual(options.num_measure_trials > 0));
-  if (HasExternalApi(task_)) {
+  bool replayed = false;
+  if (options.num_measure_trials == 0 &&
+      database_->Count(task_->serialized_key) > 0) {
+    // reuse the best schedule measured by former tuning, such as the ones
+    // loaded from a record file, instead of searching without measurement
+    candidates.emplace_back(OptimizeByDatabase());
+    replayed = !candidates.back().functions.empty();
+  } else {
+    candidates.emplace_back(OptimizeByEvolution(options));
+  }
+  // without a measured record, the manual and external schedules get default
+  // costs lower than any measured one, so they compete with a replayed
+  // record only by their measured records
+  const std::string& key = task_->serialized_key;
+  if (!replayed || database_->Count(kManualMeasuredKeyPrefix + key) > 0) {
+    candidates.emplace_back(OptimizeByManual(options.num_measure_trials > 0));
+  }
+  if (HasExternalApi(task_) &&
+      (!replayed || database_->Count(kExternalMeasuredKeyPrefix + key) > 0)) {
     candidates.emplace_back(OptimizeByExternal(options.num_measure_trials > 0));
   }
   sort(candidates.begin(),
@@ -105,8 +128,45 @@ FunctionGroup TaskOptimizer::Optimize(const TuningOptions& options) {
   return best.functions;
 }
 
+TaskOptimizer::Result TaskOptimizer::OptimizeByDatabase() {
+  TaskOptimizer::Result result("Database");
+  auto records = database_->GetTopK(task_->serialized_key, 1);
+  if (records.empty()) {
+    return result;
+  }
+
+  // replay the trace of the best record on the initial ModuleExpr
+  InitialTaskRegistry* task_registry = InitialTaskRegistry::Global();
+  ir::IRSchedule ir_sch(
+      ir::ir_utils::IRCopy(
+          task_registry->Get(task_->serialized_key)->module_expr),
+      utils::ForkRandomState(&rand_seed_));
+  ir::ScheduleDesc::ReplayWithProto(records[0].trace, &ir_sch);
+  std::vector<ir::Expr> best_exprs = ir_sch.GetModule().GetExprs();
+  CHECK_EQ(best_exprs.size(), task_->lowered_funcs.size())
+      << "RuntimeError: Expr size is not equal to LoweredFunc size in "
+         "TaskOptimizer";
+
+  auto init_funcs = ir::ir_utils::IRCopy(task_->lowered_funcs);
+  FunctionGroup functions;
+  for (size_t i = 0; i < best_exprs.size(); ++i) {
+    auto updated_f =
+        UpdateFuncWithNewBody(task_->target, init_funcs[i], best_exprs[i]);
+    if (PruneInvalid(updated_f, task_->target)) {
+      LOG(WARNING) << "The schedule in database is invalid for task: "
+                   << task_->serialized_key;
+      return result;
+    }
+    functions.emplace_back(updated_f);
+  }
+  VLOG(4) << "Reuse the schedule in database with execution_cost="
+          << records[0].execution_cost;
+  result.functions = std::move(functions);
+  result.cost = records[0].execution_cost;
+  return result;
+}
+
 TaskOptimizer::Result TaskOptimizer::OptimizeByManual(bool need_measured) {
-  static constexpr char* kManualMeasuredKeyPrefix = "@ManualMeasured:\n";
   TaskOptimizer::Result result("Manual");
   result.functions = task_->op_lowerer->Lower(task_->subgraph);
 
@@ -143,7 +203,6 @@ TaskOptimizer::Result TaskOptimizer::OptimizeByManual(bool need_measured) {
 }
 
 TaskOptimizer::Result TaskOptimizer::OptimizeByExternal(bool need_measured) {
-  static constexpr char* kExternalMeasuredKeyPrefix = "@ExternalMeasured:\n";
   TaskOptimizer::Result result("External");
   auto nodes = task_->subgraph->CollectNodes();
   auto* first_node = nodes.front();
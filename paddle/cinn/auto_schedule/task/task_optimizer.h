@@ -52,6 +52,8 @@ class TaskOptimizer {
   Result OptimizeByManual(bool need_measure);
   Result OptimizeByExternal(bool need_measure);
   Result OptimizeByEvolution(const TuningOptions& options);
+  // replay the best measured record of the task in database
+  Result OptimizeByDatabase();
 
   // call search candidates once by EvolutionarySearch and prune invalid ones
   std::vector<SearchState> SearchOneRound(
@@ -0,0 +1,135 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/auto_schedule/task/task_optimizer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "paddle/cinn/auto_schedule/database/binary_file_database.h"
+#include "paddle/cinn/auto_schedule/search_space/search_state.h"
+#include "paddle/cinn/auto_schedule/task/task_creator.h"
+#include "paddle/cinn/auto_schedule/task/task_registry.h"
+#include "paddle/cinn/auto_schedule/task/tune_task.h"
+#include "paddle/cinn/auto_schedule/tuning.h"
+#include "paddle/cinn/common/context.h"
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/frontend/net_builder.h"
+#include "paddle/cinn/hlir/framework/graph.h"
+#include "paddle/cinn/hlir/framework/op_lowering.h"
+#include "paddle/cinn/ir/schedule/ir_schedule.h"
+#include "paddle/cinn/ir/utils/ir_copy.h"
+
+namespace cinn {
+namespace auto_schedule {
+
+using ::cinn::hlir::framework::GroupPtr;
+using ::cinn::hlir::framework::OpLowerer;
+using ::cinn::hlir::framework::OpLowererImpl;
+
+class TestTaskOptimizer : public ::testing::Test {
+ public:
+  TestTaskOptimizer()
+      : record_file_path("/tmp/test_task_optimizer_record.bin") {}
+
+  void SetUp() override {
+    Context::Global().ResetNameId();
+    std::remove(record_file_path.c_str());
+
+    frontend::NetBuilder builder("net_builder");
+    auto a = builder.CreateInput(Float(32), {32, 24}, "A");
+    auto b = builder.CreateInput(Float(32), {32, 24}, "B");
+    builder.Add(a, b);
+    auto program = builder.Build();
+    graph = std::make_shared<hlir::framework::Graph>(program, target);
+
+    TaskCreator task_creator;
+    tasks = task_creator.CreateTuneTaskOpLevel(graph.get());
+    ASSERT_EQ(tasks.size(), 1UL);
+    const auto& dtype_dict =
+        graph->GetAttrs<absl::flat_hash_map<std::string, cinn::common::Type>>(
+            "inferdtype");
+    const auto& shape_dict = graph->GetAttrs<
+        absl::flat_hash_map<std::string, hlir::framework::shape_t>>(
+        "infershape");
+    op_lowerer = std::make_unique<OpLowerer<GroupPtr>>(
+        new OpLowererImpl(dtype_dict, shape_dict, target));
+    tasks[0].Initialize(shape_dict, dtype_dict, op_lowerer.get());
+    InitialTaskRegistry::Global()->Regist(
+        tasks[0].serialized_key,
+        ir::ModuleExpr(tasks[0].GetLoweredFuncBodyExprs()));
+  }
+
+  void TearDown() override { std::remove(record_file_path.c_str()); }
+
+  // Save a record that fuses the loops of the task, and a measured record of
+  // its manual schedule if manual_cost is positive.
+  void SaveRecords(double record_cost, double manual_cost) {
+    const std::string& task_key = tasks[0].serialized_key;
+    ir::IRSchedule ir_sch(ir::ir_utils::IRCopy(
+        InitialTaskRegistry::Global()->Get(task_key)->module_expr));
+    ir_sch.Fuse(ir_sch.GetAllBlocks().back(), {0, 1});
+    BinaryFileDatabase database(2, record_file_path, true);
+    database.AddRecord(
+        TuningRecord(task_key, SearchState(std::move(ir_sch)), record_cost));
+    if (manual_cost > 0) {
+      database.AddRecord(TuningRecord("@ManualMeasured:\n" + task_key,
+                                      SearchState(ir::IRSchedule()),
+                                      manual_cost));
+    }
+  }
+
+  // Optimize the task without measurement on the records loaded from the
+  // file, and return the bodies of the optimized functions.
+  std::string OptimizeByRecords() {
+    BinaryFileDatabase database(2, record_file_path, false);
+    TaskOptimizer optimizer(&tasks[0], nullptr, &database);
+    TuningOptions options;
+    options.num_measure_trials = 0;
+    std::stringstream ss;
+    for (const auto& func : optimizer.Optimize(options)) {
+      ss << func->body << std::endl;
+    }
+    return ss.str();
+  }
+
+  std::string record_file_path;
+  Target target = cinn::common::DefaultHostTarget();
+  std::shared_ptr<hlir::framework::Graph> graph;
+  std::unique_ptr<OpLowerer<GroupPtr>> op_lowerer;
+  std::vector<TuneTask> tasks;
+};
+
+TEST_F(TestTaskOptimizer, ReplayRecord) {
+  SaveRecords(1.0, 0.0);
+  EXPECT_NE(OptimizeByRecords().find("fused"), std::string::npos);
+}
+
+TEST_F(TestTaskOptimizer, ReplayRecordFasterThanManual) {
+  SaveRecords(1.0, 2.0);
+  EXPECT_NE(OptimizeByRecords().find("fused"), std::string::npos);
+}
+
+TEST_F(TestTaskOptimizer, KeepManualFasterThanRecord) {
+  SaveRecords(2.0, 1.0);
+  EXPECT_EQ(OptimizeByRecords().find("fused"), std::string::npos);
+}
+
+}  // namespace auto_schedule
+}  // namespace cinn
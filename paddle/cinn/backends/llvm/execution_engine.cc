@@ -60,6 +60,7 @@
 #include "paddle/cinn/backends/llvm/codegen_x86.h"
 #include "paddle/cinn/backends/llvm/llvm_optimizer.h"
 #include "paddle/cinn/backends/llvm/llvm_util.h"
+#include "paddle/cinn/backends/llvm/persistent_object_cache.h"
 #include "paddle/cinn/backends/llvm/runtime_symbol_registry.h"
 #include "paddle/cinn/ir/ir_printer.h"
 #include "paddle/cinn/runtime/intrinsic.h"
@@ -92,6 +93,9 @@ void NaiveObjectCache::notifyObjectCompiled(const llvm::Module *m,
   cached_objects_[m->getModuleIdentifier()] =
       llvm::MemoryBuffer::getMemBufferCopy(obj_buffer.getBuffer(),
                                            obj_buffer.getBufferIdentifier());
+  if (auto *persistent_cache = PersistentObjectCache::Global()) {
+    persistent_cache->Store(m->getModuleIdentifier(), obj_buffer.getBuffer());
+  }
 }
 
 std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(
@@ -186,6 +190,22 @@ void ExecutionEngine::Link(const ir::Module &module) {
   auto machine = std::move(llvm::cantFail(
       llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost())
           .createTargetMachine()));
+  // Name the module by its content, so the object compiled by the JIT is
+  // saved to the persistent cache, and reloaded without optimizing and
+  // compiling it again in another process.
+  if (auto *persistent_cache = PersistentObjectCache::Global()) {
+    m->setModuleIdentifier(ObjectCacheKey(*m, *machine, /*opt_level=*/3));
+    auto object = persistent_cache->Load(m->getModuleIdentifier());
+    auto stats = persistent_cache->GetStats();
+    VLOG(1) << "Object cache " << (object ? "hit" : "miss") << " for "
+            << m->getModuleIdentifier() << ", hit rate " << stats.HitRate()
+            << " (" << stats.hits << "/" << stats.hits + stats.misses << ")";
+    if (object) {
+      buffer_.append(object->getBufferStart(), object->getBufferEnd());
+      llvm::cantFail(jit_->addObjectFile(std::move(object)));
+      return;
+    }
+  }
   LLVMModuleOptimizer optimize(machine.get(), 3, {}, true);
   optimize(m.get());
   CHECK(!llvm::verifyModule(*m, &llvm::errs()))
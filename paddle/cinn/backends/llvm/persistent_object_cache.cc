@@ -0,0 +1,266 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/backends/llvm/persistent_object_cache.h"
+
+#include <glog/logging.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+#include <utime.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/flags.h"
+
+PD_DECLARE_string(cinn_object_cache_dir);
+PD_DECLARE_int64(cinn_object_cache_max_size_mb);
+
+namespace cinn::backends {
+namespace {
+
+constexpr char kKeyPrefix[] = "cinn_obj_";
+constexpr char kObjectSuffix[] = ".o";
+// bump it when the layout of the file or the key changes
+constexpr uint32_t kFormatVersion = 1;
+constexpr char kMagic[8] = {'C', 'I', 'N', 'N', 'O', 'B', 'J', '\0'};
+
+struct ObjectFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t key_size;
+  uint64_t object_size;
+  uint64_t checksum;
+};
+
+// FNV-1a, only to detect files damaged on disk
+uint64_t Checksum(llvm::StringRef data) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : data) {
+    hash = (hash ^ c) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::string ToHex(llvm::ArrayRef<uint8_t> bytes) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(bytes.size() * 2);
+  for (uint8_t byte : bytes) {
+    hex.push_back(kDigits[byte >> 4]);
+    hex.push_back(kDigits[byte & 0xf]);
+  }
+  return hex;
+}
+
+}  // namespace
+
+std::string ObjectCacheKey(const llvm::Module &module,
+                           const llvm::TargetMachine &machine,
+                           int opt_level) {
+  std::string content;
+  llvm::raw_string_ostream os(content);
+  os << kFormatVersion << ';' << LLVM_VERSION_STRING << ';'
+     << machine.getTargetTriple().str() << ';' << machine.getTargetCPU()
+     << ';' << machine.getTargetFeatureString() << ';' << opt_level << ';';
+  module.print(os, nullptr);
+  os.flush();
+  auto digest = llvm::SHA1::hash(llvm::ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(content.data()), content.size()));
+  return kKeyPrefix + ToHex(digest);
+}
+
+PersistentObjectCache::PersistentObjectCache(const std::string &cache_dir,
+                                             uint64_t max_size_bytes)
+    : cache_dir_(cache_dir), max_size_bytes_(max_size_bytes) {
+  if (auto ec = llvm::sys::fs::create_directories(cache_dir_)) {
+    LOG(WARNING) << "Failed to create the object cache directory "
+                 << cache_dir_ << ": " << ec.message();
+  }
+  ScanSize();
+}
+
+/*static*/ PersistentObjectCache *PersistentObjectCache::Global() {
+  static std::unique_ptr<PersistentObjectCache> cache =
+      FLAGS_cinn_object_cache_dir.empty()
+          ? nullptr
+          : std::make_unique<PersistentObjectCache>(
+                FLAGS_cinn_object_cache_dir,
+                static_cast<uint64_t>(FLAGS_cinn_object_cache_max_size_mb)
+                    << 20);
+  return cache.get();
+}
+
+/*static*/ bool PersistentObjectCache::IsKey(llvm::StringRef key) {
+  return key.startswith(kKeyPrefix);
+}
+
+std::string PersistentObjectCache::ObjectPath(const std::string &key) const {
+  llvm::SmallString<256> path(cache_dir_);
+  llvm::sys::path::append(path, key + kObjectSuffix);
+  return path.str().str();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> PersistentObjectCache::Load(
+    const std::string &key) {
+  std::string path = ObjectPath(key);
+  auto file = llvm::MemoryBuffer::getFile(path);
+  if (!file) {
+    std::lock_guard<std::mutex> lock(mu_);
+    ++stats_.misses;
+    VLOG(3) << "No object for " << key << " in " << cache_dir_;
+    return nullptr;
+  }
+
+  llvm::StringRef content = (*file)->getBuffer();
+  ObjectFileHeader header;
+  bool valid = content.size() >= sizeof(header);
+  if (valid) {
+    std::memcpy(&header, content.data(), sizeof(header));
+    content = content.drop_front(sizeof(header));
+    valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+            header.version == kFormatVersion &&
+            content.size() == header.key_size + header.object_size &&
+            content.take_front(header.key_size) == key;
+  }
+  if (valid) {
+    content = content.drop_front(header.key_size);
+    valid = Checksum(content) == header.checksum;
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  if (!valid) {
+    LOG(WARNING) << "Remove the corrupted object cache file " << path;
+    llvm::sys::fs::remove(path);
+    ++stats_.corrupted;
+    ++stats_.misses;
+    return nullptr;
+  }
+  ++stats_.hits;
+  // mark as recently used for eviction
+  ::utime(path.c_str(), nullptr);
+  VLOG(3) << "Object for " << key << " loaded from " << path;
+  return llvm::MemoryBuffer::getMemBufferCopy(content, key);
+}
+
+void PersistentObjectCache::Store(const std::string &key,
+                                  llvm::StringRef object) {
+  if (!IsKey(key)) {
+    return;
+  }
+  ObjectFileHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kFormatVersion;
+  header.key_size = key.size();
+  header.object_size = object.size();
+  header.checksum = Checksum(object);
+
+  int fd = -1;
+  llvm::SmallString<256> tmp_path;
+  llvm::SmallString<256> model(cache_dir_);
+  llvm::sys::path::append(model, key + ".%%%%%%.tmp");
+  if (auto ec = llvm::sys::fs::createUniqueFile(model, fd, tmp_path)) {
+    LOG(WARNING) << "Failed to create the object cache file in " << cache_dir_
+                 << ": " << ec.message();
+    return;
+  }
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    os << key << object;
+    os.close();
+    if (os.has_error()) {
+      LOG(WARNING) << "Failed to write the object cache file " << tmp_path;
+      os.clear_error();
+      llvm::sys::fs::remove(tmp_path);
+      return;
+    }
+  }
+  std::string path = ObjectPath(key);
+  if (auto ec = llvm::sys::fs::rename(tmp_path, path)) {
+    LOG(WARNING) << "Failed to rename the object cache file to " << path
+                 << ": " << ec.message();
+    llvm::sys::fs::remove(tmp_path);
+    return;
+  }
+  VLOG(3) << "Object for " << key << " saved to " << path;
+
+  std::lock_guard<std::mutex> lock(mu_);
+  ++stats_.stored;
+  size_bytes_ += sizeof(header) + key.size() + object.size();
+  if (max_size_bytes_ > 0 && size_bytes_ > max_size_bytes_) {
+    Evict();
+  }
+}
+
+ObjectCacheStats PersistentObjectCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return stats_;
+}
+
+void PersistentObjectCache::ScanSize() {
+  size_bytes_ = 0;
+  std::error_code ec;
+  for (llvm::sys::fs::directory_iterator it(cache_dir_, ec), end;
+       it != end && !ec;
+       it.increment(ec)) {
+    auto status = it->status();
+    if (status && llvm::StringRef(it->path()).endswith(kObjectSuffix)) {
+      size_bytes_ += status->getSize();
+    }
+  }
+}
+
+void PersistentObjectCache::Evict() {
+  // Other processes may share the directory, so list it again, and remove
+  // down to a low watermark to not list it on every store.
+  std::vector<std::pair<llvm::sys::TimePoint<>, std::string>> files;
+  uint64_t total = 0;
+  std::error_code ec;
+  for (llvm::sys::fs::directory_iterator it(cache_dir_, ec), end;
+       it != end && !ec;
+       it.increment(ec)) {
+    auto status = it->status();
+    if (status && llvm::StringRef(it->path()).endswith(kObjectSuffix)) {
+      files.emplace_back(status->getLastModificationTime(), it->path());
+      total += status->getSize();
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  uint64_t low_watermark = max_size_bytes_ / 4 * 3;
+  for (const auto &[mtime, path] : files) {
+    if (total <= low_watermark) {
+      break;
+    }
+    uint64_t size = 0;
+    if (llvm::sys::fs::file_size(path, size) ||
+        llvm::sys::fs::remove(path)) {
+      continue;
+    }
+    total -= size;
+    ++stats_.evicted;
+    VLOG(3) << "Evict the object cache file " << path;
+  }
+  size_bytes_ = total;
+}
+
+}  // namespace cinn::backends
@@ -0,0 +1,92 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+
+namespace cinn::backends {
+
+struct ObjectCacheStats {
+  uint64_t hits{0};
+  uint64_t misses{0};
+  // objects dropped because the file is truncated or does not match its key
+  uint64_t corrupted{0};
+  uint64_t stored{0};
+  uint64_t evicted{0};
+
+  double HitRate() const {
+    uint64_t total = hits + misses;
+    return total == 0 ? 0. : static_cast<double>(hits) / total;
+  }
+};
+
+/**
+ * The key of the object compiled from \p module by \p machine, which is a hash
+ * of the IR, the target triple, cpu and features, the optimization level and
+ * the LLVM version.
+ */
+std::string ObjectCacheKey(const llvm::Module &module,
+                           const llvm::TargetMachine &machine,
+                           int opt_level);
+
+/**
+ * A directory of compiled objects shared by processes, so that a process does
+ * not compile again the modules compiled by a former one.
+ *
+ * Each object is a file named by its key, with a header holding the key, the
+ * size and a checksum of the object. Files which fail the check are removed
+ * and compiled again. Files are written to a temporary file first and renamed,
+ * so concurrent processes never read a partial object. When the directory
+ * grows larger than the limit, the least recently used objects are removed.
+ */
+class PersistentObjectCache {
+ public:
+  PersistentObjectCache(const std::string &cache_dir, uint64_t max_size_bytes);
+
+  //! The cache in FLAGS_cinn_object_cache_dir, or nullptr if it is not set.
+  static PersistentObjectCache *Global();
+
+  static bool IsKey(llvm::StringRef key);
+
+  //! Returns nullptr on miss.
+  std::unique_ptr<llvm::MemoryBuffer> Load(const std::string &key);
+
+  void Store(const std::string &key, llvm::StringRef object);
+
+  ObjectCacheStats GetStats() const;
+
+ private:
+  std::string ObjectPath(const std::string &key) const;
+  void ScanSize();
+  void Evict();
+
+  std::string cache_dir_;
+  uint64_t max_size_bytes_;
+
+  mutable std::mutex mu_;
+  // bytes in the directory, as last scanned plus the objects stored since
+  uint64_t size_bytes_{0};
+  ObjectCacheStats stats_;
+};
+
+}  // namespace cinn::backends
@@ -0,0 +1,117 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/backends/llvm/persistent_object_cache.h"
+
+#include <gtest/gtest.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <string>
+
+namespace cinn {
+namespace backends {
+
+namespace {
+std::string ObjectPath(const std::string &dir, const std::string &key) {
+  llvm::SmallString<256> path(dir);
+  llvm::sys::path::append(path, key + ".o");
+  return path.str().str();
+}
+}  // namespace
+
+TEST(PersistentObjectCache, store_and_load) {
+  llvm::SmallString<256> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("cinn_obj_cache", dir));
+  std::string key = "cinn_obj_0123456789abcdef";
+  std::string object(1000, 'x');
+  {
+    PersistentObjectCache cache(dir.str().str(), 0);
+    EXPECT_EQ(cache.Load(key), nullptr);
+    cache.Store(key, object);
+    // only the keys made by ObjectCacheKey are saved
+    cache.Store("<string>", object);
+    EXPECT_EQ(cache.GetStats().stored, 1UL);
+  }
+
+  // reloaded by another cache as if in another process
+  PersistentObjectCache cache(dir.str().str(), 0);
+  auto loaded = cache.Load(key);
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(loaded->getBuffer().str(), object);
+
+  // a truncated file is removed and counted as a miss
+  std::string path = ObjectPath(dir.str().str(), key);
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream os(path, ec);
+    ASSERT_FALSE(ec);
+    os << "CINNOBJ";
+  }
+  EXPECT_EQ(cache.Load(key), nullptr);
+  EXPECT_FALSE(llvm::sys::fs::exists(path));
+
+  // a file with extra bytes does not match its header
+  cache.Store(key, object);
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream os(path, ec, llvm::sys::fs::OF_Append);
+    ASSERT_FALSE(ec);
+    os << "y";
+  }
+  EXPECT_EQ(cache.Load(key), nullptr);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1UL);
+  EXPECT_EQ(stats.misses, 2UL);
+  EXPECT_EQ(stats.corrupted, 2UL);
+  EXPECT_DOUBLE_EQ(stats.HitRate(), 1. / 3);
+  llvm::sys::fs::remove_directories(dir);
+}
+
+TEST(PersistentObjectCache, evict) {
+  llvm::SmallString<256> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("cinn_obj_cache", dir));
+  std::string object(1000, 'x');
+  // room for about four objects, evicted down to three
+  PersistentObjectCache cache(dir.str().str(), 4500);
+  for (int i = 0; i < 8; ++i) {
+    cache.Store("cinn_obj_" + std::to_string(i), object);
+  }
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.stored, 8UL);
+  EXPECT_GT(stats.evicted, 0UL);
+
+  int remaining = 0;
+  uint64_t total = 0;
+  for (int i = 0; i < 8; ++i) {
+    uint64_t size = 0;
+    if (!llvm::sys::fs::file_size(
+            ObjectPath(dir.str().str(), "cinn_obj_" + std::to_string(i)),
+            size)) {
+      ++remaining;
+      total += size;
+    }
+  }
+  EXPECT_EQ(remaining, 8 - static_cast<int>(stats.evicted));
+  EXPECT_LE(total, 4500UL);
+  // the latest object is kept
+  EXPECT_NE(cache.Load("cinn_obj_7"), nullptr);
+  llvm::sys::fs::remove_directories(dir);
+}
+
+}  // namespace backends
+}  // namespace cinn
@@ -15,6 +15,7 @@
 #include "paddle/cinn/runtime/cpu/thread_backend.h"
 
 #include <algorithm>
+#include <cstring>
 #include <vector>
 
 #ifdef CINN_USE_OPENMP
@@ -24,6 +25,7 @@
 #include "paddle/cinn/backends/extern_func_jit_register.h"
 #include "paddle/cinn/backends/llvm/runtime_symbol_registry.h"
 #include "paddle/cinn/common/cas.h"
+#include "paddle/cinn/runtime/cpu/thread_pool.h"
 #include "paddle/cinn/runtime/intrinsic.h"
 
 int max_concurrency() {
@@ -43,20 +45,44 @@ int max_concurrency() {
   return std::max(max_concurrency, 1);
 }
 
+namespace {
+// CINN_PARALLEL_BACKEND selects "openmp" or "thread_pool", and defaults to
+// OpenMP when it is available.
+bool UseThreadPool() {
+  static bool use_thread_pool = []() {
+    const char* val = getenv("CINN_PARALLEL_BACKEND");
+#ifdef CINN_USE_OPENMP
+    return val != nullptr && std::strcmp(val, "thread_pool") == 0;
+#else
+    if (val != nullptr && std::strcmp(val, "openmp") == 0) {
+      LOG(WARNING) << "CINN is built without OpenMP, use the thread pool for "
+                      "host parallel launch.";
+    }
+    return true;
+#endif  // CINN_USE_OPENMP
+  }();
+  return use_thread_pool;
+}
+}  // namespace
+
 int cinn_backend_parallel_launch(FCINNParallelLambda flambda,
                                  void* datas,
                                  int num_task) {
+  if (UseThreadPool()) {
+    auto* pool = cinn::runtime::ThreadPool::Global();
+    if (num_task == 0) num_task = pool->num_threads();
+    pool->Launch(flambda, datas, num_task);
+    return 0;
+  }
+#ifdef CINN_USE_OPENMP
   int num_workers = max_concurrency();
   if (num_task == 0) num_task = num_workers;
-#ifdef CINN_USE_OPENMP
   omp_set_num_threads(num_task);
 #pragma omp parallel num_threads(num_task)
   {
     int thread_num = omp_get_thread_num();
     (*flambda)(thread_num, num_task, datas);
   }
-#else
-  LOG(FATAL) << "CINN host parallel launch need OpenMP! Please check.";
 #endif  // CINN_USE_OPENMP
   return 0;
 }
@@ -0,0 +1,233 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/runtime/cpu/thread_pool.h"
+
+#include <glog/logging.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+
+namespace cinn {
+namespace runtime {
+namespace {
+
+// whether the current thread is running a task of a pool
+thread_local bool in_pool_task = false;
+
+void RunInline(FCINNParallelLambda flambda, void* datas, int num_task) {
+  for (int i = 0; i < num_task; ++i) {
+    (*flambda)(i, num_task, datas);
+  }
+}
+
+void SetAffinity(std::thread* thread, int cpu) {
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu, &cpuset);
+  int ret = pthread_setaffinity_np(
+      thread->native_handle(), sizeof(cpu_set_t), &cpuset);
+  if (ret != 0) {
+    LOG(WARNING) << "Failed to pin the CINN pool thread to cpu " << cpu;
+  }
+#else
+  LOG(WARNING) << "CINN_THREAD_AFFINITY is only supported on Linux.";
+#endif
+}
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+  __builtin_ia32_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+}  // namespace
+
+std::vector<int> ParseCpuList(const std::string& cpu_list) {
+  std::vector<int> cpus;
+  std::stringstream ss(cpu_list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty()) continue;
+    auto dash = item.find('-');
+    int first = std::atoi(item.substr(0, dash).c_str());
+    int last = dash == std::string::npos
+                   ? first
+                   : std::atoi(item.substr(dash + 1).c_str());
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options)
+    : num_workers_(std::max(options.num_threads, 1) - 1),
+      spin_us_(options.spin_us),
+      slices_(new Slice[num_workers_ + 1]) {
+  workers_.reserve(num_workers_);
+  for (int i = 0; i < num_workers_; ++i) {
+    workers_.emplace_back([this, i]() { WorkerLoop(i); });
+    if (!options.cpus.empty()) {
+      SetAffinity(&workers_.back(), options.cpus[i % options.cpus.size()]);
+    }
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(park_mu_);
+    done_ = true;
+  }
+  park_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+/*static*/ ThreadPool* ThreadPool::Global() {
+  static ThreadPool* pool = []() {
+    ThreadPoolOptions options;
+    options.num_threads = max_concurrency();
+    if (const char* val = getenv("CINN_THREAD_SPIN_US")) {
+      options.spin_us = std::atoi(val);
+    }
+    if (const char* val = getenv("CINN_THREAD_AFFINITY")) {
+      options.cpus = ParseCpuList(val);
+    }
+    VLOG(3) << "Create CINN thread pool with " << options.num_threads
+            << " threads, spinning " << options.spin_us << " us";
+    // never destroyed, kernels may still launch during static destruction
+    return new ThreadPool(options);
+  }();
+  return pool;
+}
+
+void ThreadPool::Launch(FCINNParallelLambda flambda,
+                        void* datas,
+                        int num_task) {
+  if (num_task <= 0) return;
+  if (num_task == 1 || num_workers_ == 0 || in_pool_task) {
+    RunInline(flambda, datas, num_task);
+    return;
+  }
+  std::unique_lock<std::mutex> launch_lock(launch_mu_, std::try_to_lock);
+  if (!launch_lock.owns_lock()) {
+    // the workers are busy with the launch of another thread
+    RunInline(flambda, datas, num_task);
+    return;
+  }
+
+  int num_slots = num_workers_ + 1;
+  int per_slot = num_task / num_slots;
+  int rest = num_task % num_slots;
+  int begin = 0;
+  for (int slot = 0; slot < num_slots; ++slot) {
+    int end = begin + per_slot + (slot < rest ? 1 : 0);
+    slices_[slot].next.store(begin, std::memory_order_relaxed);
+    slices_[slot].end = end;
+    begin = end;
+  }
+  flambda_ = flambda;
+  datas_ = datas;
+  num_task_ = num_task;
+  remaining_.store(num_task, std::memory_order_relaxed);
+
+  uint64_t epoch = epoch_.load(std::memory_order_relaxed) + 1;
+  epoch_.store(epoch);
+  if (parked_.load() > 0) {
+    // lock to not notify between the check and the wait of a worker
+    { std::lock_guard<std::mutex> lock(park_mu_); }
+    park_cv_.notify_all();
+  }
+
+  // the launching thread runs the last slice
+  RunTasks(num_workers_);
+  while (remaining_.load(std::memory_order_acquire) > 0) {
+    CpuRelax();
+  }
+
+  // close the launch, and wait for the workers which have joined it to leave
+  // before the next launch overwrites the slices
+  epoch_.store(epoch + 1);
+  while (active_workers_.load() > 0) {
+    CpuRelax();
+  }
+}
+
+void ThreadPool::RunTasks(int slot) {
+  in_pool_task = true;
+  int num_slots = num_workers_ + 1;
+  // own slice first, then steal from the next ones
+  for (int k = 0; k < num_slots; ++k) {
+    Slice& slice = slices_[(slot + k) % num_slots];
+    while (true) {
+      int task_id = slice.next.fetch_add(1, std::memory_order_relaxed);
+      if (task_id >= slice.end) break;
+      (*flambda_)(task_id, num_task_, datas_);
+      remaining_.fetch_sub(1, std::memory_order_release);
+    }
+  }
+  in_pool_task = false;
+}
+
+bool ThreadPool::WaitForLaunch(uint64_t seen_epoch) {
+  auto is_new_launch = [&]() {
+    uint64_t epoch = epoch_.load();
+    return (epoch & 1) && epoch != seen_epoch;
+  };
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::microseconds(spin_us_);
+  for (int i = 0;; ++i) {
+    if (is_new_launch()) return true;
+    if (done_.load(std::memory_order_relaxed)) return false;
+    // check the clock once in a while
+    if ((i & 63) == 63 && std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+    CpuRelax();
+  }
+
+  std::unique_lock<std::mutex> lock(park_mu_);
+  parked_.fetch_add(1);
+  park_cv_.wait(lock, [&]() { return done_ || is_new_launch(); });
+  parked_.fetch_sub(1);
+  return !done_;
+}
+
+void ThreadPool::WorkerLoop(int worker_id) {
+  uint64_t seen_epoch = 0;
+  while (WaitForLaunch(seen_epoch)) {
+    active_workers_.fetch_add(1);
+    // the launch may have been closed since it was seen
+    uint64_t epoch = epoch_.load();
+    if ((epoch & 1) && epoch != seen_epoch) {
+      seen_epoch = epoch;
+      RunTasks(worker_id);
+    }
+    active_workers_.fetch_sub(1);
+  }
+}
+
+}  // namespace runtime
+}  // namespace cinn
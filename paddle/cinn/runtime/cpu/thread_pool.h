@@ -0,0 +1,110 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "paddle/cinn/runtime/cpu/thread_backend.h"
+
+namespace cinn {
+namespace runtime {
+
+struct ThreadPoolOptions {
+  //! The number of threads running the tasks, including the launching one.
+  int num_threads{1};
+  //! How long an idle worker spins for new tasks before it parks.
+  int spin_us{50};
+  //! The cpus to pin the workers to, round robin, not pinned if empty.
+  std::vector<int> cpus;
+};
+
+/**
+ * A persistent pool running the tasks of cinn_backend_parallel_launch, in
+ * place of an OpenMP parallel region for every parallel loop.
+ *
+ * The tasks of a launch are split into one contiguous slice per thread, and
+ * the launching thread runs a slice too. A thread claims the tasks of its own
+ * slice one by one, and steals from the other slices when its own is done, so
+ * that uneven tasks are balanced. Idle workers spin for a while to catch the
+ * next launch of a fused kernel sequence, then park on a condition variable
+ * so they do not compete with the executor threads.
+ *
+ * One launch runs at a time. A launch from a pool task, or while another
+ * thread is launching, runs its tasks inline on the calling thread.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(const ThreadPoolOptions& options);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * The pool configured by environment variables:
+   *   CINN_NUM_THREADS/OMP_NUM_THREADS for the number of threads,
+   *   CINN_THREAD_SPIN_US for the spinning time in microseconds,
+   *   CINN_THREAD_AFFINITY for the cpus, e.g. "0-3,8,10".
+   */
+  static ThreadPool* Global();
+
+  int num_threads() const { return num_workers_ + 1; }
+
+  //! Runs flambda(i, num_task, datas) for i in [0, num_task) and waits.
+  void Launch(FCINNParallelLambda flambda, void* datas, int num_task);
+
+ private:
+  struct alignas(64) Slice {
+    std::atomic<int> next{0};
+    int end{0};
+  };
+
+  void WorkerLoop(int worker_id);
+  // waits for a launch other than seen_epoch, returns false when done
+  bool WaitForLaunch(uint64_t seen_epoch);
+  void RunTasks(int slot);
+
+  const int num_workers_;
+  const int spin_us_;
+  std::vector<std::thread> workers_;
+
+  std::mutex launch_mu_;
+  // the current launch, written only when no worker is in active_workers_
+  std::unique_ptr<Slice[]> slices_;
+  FCINNParallelLambda flambda_{nullptr};
+  void* datas_{nullptr};
+  int num_task_{0};
+  std::atomic<int> remaining_{0};
+  // odd while a launch is open
+  std::atomic<uint64_t> epoch_{0};
+  std::atomic<int> active_workers_{0};
+
+  std::mutex park_mu_;
+  std::condition_variable park_cv_;
+  std::atomic<int> parked_{0};
+  std::atomic<bool> done_{false};
+};
+
+//! Parses a cpu list like "0-3,8,10".
+std::vector<int> ParseCpuList(const std::string& cpu_list);
+
+}  // namespace runtime
+}  // namespace cinn
@@ -0,0 +1,104 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/runtime/cpu/thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace cinn {
+namespace runtime {
+
+namespace {
+struct Closure {
+  std::vector<std::atomic<int>>* counts;
+  ThreadPool* pool;
+};
+
+int CountTask(int task_id, int num_task, void* datas) {
+  auto* closure = static_cast<Closure*>(datas);
+  (*closure->counts)[task_id].fetch_add(1);
+  return 0;
+}
+
+int NestedTask(int task_id, int num_task, void* datas) {
+  auto* closure = static_cast<Closure*>(datas);
+  // runs inline on the thread of the outer task
+  closure->pool->Launch(&CountTask, datas, 4);
+  return 0;
+}
+}  // namespace
+
+TEST(ThreadPool, launch) {
+  ThreadPoolOptions options;
+  options.num_threads = 4;
+  options.spin_us = 0;
+  ThreadPool pool(options);
+  EXPECT_EQ(pool.num_threads(), 4);
+
+  for (int num_task : {1, 3, 4, 7, 100}) {
+    for (int repeat = 0; repeat < 50; ++repeat) {
+      std::vector<std::atomic<int>> counts(num_task);
+      Closure closure{&counts, &pool};
+      pool.Launch(&CountTask, &closure, num_task);
+      for (int i = 0; i < num_task; ++i) {
+        ASSERT_EQ(counts[i].load(), 1) << "task " << i << " of " << num_task;
+      }
+    }
+  }
+
+  std::vector<std::atomic<int>> counts(4);
+  Closure closure{&counts, &pool};
+  pool.Launch(&NestedTask, &closure, 8);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(counts[i].load(), 8);
+  }
+}
+
+TEST(ThreadPool, concurrent_launch) {
+  ThreadPoolOptions options;
+  options.num_threads = 3;
+  ThreadPool pool(options);
+
+  std::vector<std::thread> threads;
+  std::atomic<int> failures{0};
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&]() {
+      for (int repeat = 0; repeat < 200; ++repeat) {
+        std::vector<std::atomic<int>> counts(16);
+        Closure closure{&counts, &pool};
+        pool.Launch(&CountTask, &closure, 16);
+        for (auto& count : counts) {
+          if (count.load() != 1) failures.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(failures.load(), 0);
+}
+
+TEST(ThreadPool, parse_cpu_list) {
+  EXPECT_EQ(ParseCpuList("0-3,8,10-11"),
+            (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_TRUE(ParseCpuList("").empty());
+}
+
+}  // namespace runtime
+}  // namespace cinn
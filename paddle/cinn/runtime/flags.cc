@@ -53,6 +53,18 @@ PD_DEFINE_int32(cinn_parallel_compile_thread,
                              (std::thread::hardware_concurrency() >> 1)),
                 "How much thread the parallel compile used.");
 
+PD_DEFINE_string(cinn_object_cache_dir,
+                 StringFromEnv("FLAGS_cinn_object_cache_dir", ""),
+                 "Specify the directory to save and reload the objects "
+                 "compiled by the x86 JIT across processes, disabled if "
+                 "empty.");
+
+PD_DEFINE_int64(cinn_object_cache_max_size_mb,
+                Int64FromEnv("FLAGS_cinn_object_cache_max_size_mb", 1024L),
+                "The size limit of FLAGS_cinn_object_cache_dir in MB, the "
+                "least recently used objects are removed beyond it, and 0 "
+                "means unlimited.");
+
 PD_DEFINE_bool(cinn_use_op_fusion,
                BoolFromEnv("FLAGS_cinn_use_op_fusion", true),
                "Whether to use op fusion pass.");
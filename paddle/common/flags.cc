@@ -709,6 +709,37 @@ PHI_DEFINE_EXPORTED_bool(sort_sum_gradient,
                          "Sum gradients by the reverse order of "
                          "the forward execution sequence.");
 
+/**
+ * Performance related FLAG
+ * Name: eager_backward_num_threads
+ * Since Version: 2.6.0
+ * Value Range: int32, default=0
+ * Example:
+ * Note: If greater than 1, the eager backward of CPU programs runs the
+ * grad nodes whose dependencies are met on a pool of this many threads.
+ * Otherwise grad nodes run one by one on the calling thread.
+ */
+PHI_DEFINE_EXPORTED_int32(
+    eager_backward_num_threads,
+    0,
+    "The number of threads to run eager backward on CPU. The backward is "
+    "sequential if it is not greater than 1.");
+
+/**
+ * Performance related FLAG
+ * Name: eager_backward_deterministic
+ * Since Version: 2.6.0
+ * Value Range: bool, default=true
+ * Example:
+ * Note: Only works when FLAGS_eager_backward_num_threads > 1. If True, the
+ * grads flowing into a grad node are summed in a fixed order that does not
+ * depend on thread scheduling, so results are reproducible.
+ */
+PHI_DEFINE_EXPORTED_bool(eager_backward_deterministic,
+                         true,
+                         "Sum grads in a fixed order in the multithreaded "
+                         "eager backward.");
+
 /**
  * Performance related FLAG
  * Name: max_inplace_grad_add
@@ -1062,6 +1093,20 @@ PHI_DEFINE_EXPORTED_bool(enable_cinn_auto_tune,
                          "It controls whether to use cinn with "
                          "its auto-tune feature enabled");
 
+/*
+ * CINN related FLAG
+ * Name: FLAGS_cinn_tuning_record_file
+ * Since Version: 2.6.0
+ * Value Range: string, default=""
+ * Example: FLAGS_cinn_tuning_record_file="./tuning_records.bin" would make
+ * the auto-tune of CINN save tuning records into the binary file, and compile
+ * the tasks recorded in it with their best schedules without searching.
+ */
+PHI_DEFINE_EXPORTED_string(cinn_tuning_record_file,
+                           "",
+                           "Specify the binary file of the tuning records "
+                           "shared by the auto-tune of CINN.");
+
 /*
  * CINN related FLAG
  * Name: FLAGS_cinn_subgraph_graphviz_dir
@@ -1117,6 +1162,11 @@ PD_DEFINE_bool(enable_slotrecord_reset_shrink,  // NOLINT
 PD_DEFINE_bool(enable_ins_parser_file,  // NOLINT
                false,
                "enable parser ins file, default false");
+PD_DEFINE_int32(dataset_channel_shard_num,  // NOLINT
+                0,
+                "Shard the channels of dataset instances into n queues with "
+                "their own locks to reduce contention between readers and "
+                "workers, 0 or 1 means not sharded, default 0");
 PHI_DEFINE_EXPORTED_bool(
     gpugraph_enable_hbm_table_collision_stat,
     false,
@@ -1382,6 +1432,36 @@ PHI_DEFINE_EXPORTED_bool(enable_pir_in_executor_trace_run,
                          false,
                          "Enable new IR in executor");
 
+/**
+ * Static memory plan of PirInterpreter FLAG
+ * Name: pir_interpreter_static_memory_plan
+ * Since Version: 2.6.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the intermediates of a program run by trace mode are placed
+ * into a preallocated arena by their liveness instead of being allocated and
+ * garbage collected in every run. The plan is rebuilt when the input shapes
+ * change.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_interpreter_static_memory_plan,
+                         false,
+                         "Plan the memory of intermediates statically in "
+                         "PirInterpreter trace run");
+
+/**
+ * Runtime metrics of executors FLAG
+ * Name: enable_executor_metrics
+ * Since Version: 2.6.0
+ * Value Range: bool, default=true
+ * Example:
+ * Note: If True, the interpreters count the dispatched ops and record their
+ * host latency into the runtime metrics registry, which can be exported in
+ * Prometheus text format without enabling the profiler.
+ */
+PHI_DEFINE_EXPORTED_bool(enable_executor_metrics,
+                         true,
+                         "Record op dispatch metrics in executors");
+
 /**
  * Apply inplace pass to new IR FLAG
  * Name: pir_apply_inplace_pass
@@ -1475,6 +1555,36 @@ PHI_DEFINE_EXPORTED_bool(
     false,
     "Whether to use the auto_growth CUDA pinned allocator.");
 
+/**
+ * Memory related FLAG
+ * Name: FLAGS_use_thread_cached_cpu_allocator
+ * Since Version: 2.6.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: Whether to cache freed CPU memory blocks by size class in each
+ *       thread when FLAGS_allocator_strategy is auto_growth.
+ */
+PHI_DEFINE_EXPORTED_bool(
+    use_thread_cached_cpu_allocator,
+    false,
+    "Whether to use the thread cached CPU allocator in auto_growth strategy.");
+
+PHI_DEFINE_EXPORTED_uint64(
+    thread_cached_cpu_allocator_max_block_size_in_kb,
+    1024ul,
+    "CPU blocks larger than this size bypass the thread cached allocator.");
+
+PHI_DEFINE_EXPORTED_uint64(
+    thread_cached_cpu_allocator_thread_cache_size_in_mb,
+    16ul,
+    "The maximum size of freed CPU blocks cached by one thread.");
+
+PHI_DEFINE_EXPORTED_uint64(
+    thread_cached_cpu_allocator_central_cache_size_in_mb,
+    256ul,
+    "The maximum size of freed CPU blocks shared by all threads, idle blocks "
+    "beyond it are returned to the system.");
+
 PHI_DEFINE_EXPORTED_bool(
     sync_after_alloc,
     false,
@@ -35,6 +35,8 @@
 namespace paddle {
 namespace distributed {
 
+using phi::distributed::CheckSizeOnEachRank;
+
 #ifdef _WIN32
 #define GENERATE_FUNC(type, func, ...)       \
   switch (type) {                            \
@@ -438,9 +440,18 @@ class AllgatherGlooTask : public ProcessGroupGloo::GlooTask {
 std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllGather(
     phi::DenseTensor* out_tensor,
     const phi::DenseTensor& in_tensor,
-    int64_t /*offset*/,
-    int64_t /*offset*/,
+    int64_t offset,
+    int64_t numel,
     bool sync_op) {
+  // numel > 0 indicates the tensor need to be sliced
+  if (numel > 0) {
+    auto tensor_tmp =
+        paddle::experimental::CheckAndTrans2NewContiguousTensor(in_tensor);
+    std::vector<phi::DenseTensor> in_wrapper{
+        GetPartialTensor(tensor_tmp, offset, numel)};
+    std::vector<phi::DenseTensor> out_wrapper{*out_tensor};
+    return AllGather(in_wrapper, out_wrapper, true);
+  }
   std::vector<phi::DenseTensor> in_wrapper{in_tensor};
   std::vector<phi::DenseTensor> out_wrapper{*out_tensor};
   return AllGather(in_wrapper, out_wrapper, true);
@@ -467,6 +478,124 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllGather(
   return task;
 }
 
+class AllToAllGlooTask : public ProcessGroupGloo::GlooTask {
+ public:
+  AllToAllGlooTask(int rank,
+                   phi::distributed::GlooCommContext* comm_context,
+                   const phi::DenseTensor& input,
+                   phi::DenseTensor* output,
+                   const std::vector<int64_t>& out_numel_each_rank,
+                   const std::vector<int64_t>& in_numel_each_rank,
+                   uint32_t tag)
+      : ProcessGroupGloo::GlooTask(rank, {input}, CommType::ALLTOALL),
+        _comm_context(comm_context),
+        _input(input),
+        _output(*output),
+        _out_numel_each_rank(out_numel_each_rank),
+        _in_numel_each_rank(in_numel_each_rank),
+        _tag(tag) {}
+
+  void Run() override { _do_alltoall(_input, _output); }
+
+ private:
+  phi::distributed::GlooCommContext* _comm_context;
+  phi::DenseTensor _input;
+  phi::DenseTensor _output;
+  std::vector<int64_t> _out_numel_each_rank;
+  std::vector<int64_t> _in_numel_each_rank;
+  uint32_t _tag;
+
+  void _do_alltoall(phi::DenseTensor& in,     // NOLINT
+                    phi::DenseTensor& out) {  // NOLINT
+    _comm_context->AllToAll(
+        &out, in, _out_numel_each_rank, _in_numel_each_rank, _tag);
+  }
+};
+
+std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllToAll(
+    phi::DenseTensor* out_tensor,
+    const phi::DenseTensor& in_tensor,
+    const std::vector<int64_t>& out_size_each_rank,
+    const std::vector<int64_t>& in_size_each_rank,
+    bool sync_op) {
+  auto tensor_tmp =
+      paddle::experimental::CheckAndTrans2NewContiguousTensor(in_tensor);
+  const phi::DDim& out_dim = out_tensor->dims();
+  const phi::DDim& in_dim = tensor_tmp.dims();
+  CheckSizeOnEachRank(out_dim, out_size_each_rank, size_);
+  CheckSizeOnEachRank(in_dim, in_size_each_rank, size_);
+
+  // The sizes are rows of dim 0, while gloo counts elements.
+  int64_t in_row_size = in_dim[0] == 0 ? 0 : tensor_tmp.numel() / in_dim[0];
+  int64_t out_row_size =
+      out_dim[0] == 0 ? 0 : out_tensor->numel() / out_dim[0];
+  std::vector<int64_t> in_numel_each_rank(size_);
+  std::vector<int64_t> out_numel_each_rank(size_);
+  for (int i = 0; i < size_; i++) {
+    in_numel_each_rank[i] = in_size_each_rank[i] * in_row_size;
+    out_numel_each_rank[i] = out_size_each_rank[i] * out_row_size;
+  }
+
+  std::shared_ptr<AllToAllGlooTask> task;
+  auto tag = next_tag();
+  auto comm_context = this->GetCommContext();
+  task = std::make_shared<AllToAllGlooTask>(rank_,
+                                            comm_context,
+                                            tensor_tmp,
+                                            out_tensor,
+                                            out_numel_each_rank,
+                                            in_numel_each_rank,
+                                            tag);
+  task->Run();
+  return task;
+}
+
+class ReduceScatterGlooTask : public ProcessGroupGloo::GlooTask {
+ public:
+  ReduceScatterGlooTask(int rank,
+                        phi::distributed::GlooCommContext* comm_context,
+                        const phi::DenseTensor& input,
+                        phi::DenseTensor* output,
+                        ReduceOp reduce_op,
+                        uint32_t tag)
+      : ProcessGroupGloo::GlooTask(rank, {input}, CommType::REDUCE_SCATTER),
+        _comm_context(comm_context),
+        _input(input),
+        _output(*output),
+        _reduce_op(reduce_op),
+        _tag(tag) {}
+
+  void Run() override { _do_reduce_scatter(_input, _output); }
+
+ private:
+  phi::distributed::GlooCommContext* _comm_context;
+  phi::DenseTensor _input;
+  phi::DenseTensor _output;
+  const ReduceOp _reduce_op;
+  uint32_t _tag;
+
+  void _do_reduce_scatter(phi::DenseTensor& in,     // NOLINT
+                          phi::DenseTensor& out) {  // NOLINT
+    _comm_context->ReduceScatter(&out, in, static_cast<int>(_reduce_op), _tag);
+  }
+};
+
+std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::ReduceScatter(
+    phi::DenseTensor* out_tensor,
+    const phi::DenseTensor& in_tensor,
+    const ReduceScatterOptions& opts,
+    bool sync_op) {
+  auto tensor_tmp =
+      paddle::experimental::CheckAndTrans2NewContiguousTensor(in_tensor);
+  std::shared_ptr<ReduceScatterGlooTask> task;
+  auto tag = next_tag();
+  auto comm_context = this->GetCommContext();
+  task = std::make_shared<ReduceScatterGlooTask>(
+      rank_, comm_context, tensor_tmp, out_tensor, opts.reduce_op, tag);
+  task->Run();
+  return task;
+}
+
 class ReduceGlooTask : public ProcessGroupGloo::GlooTask {
  public:
   ReduceGlooTask(int rank,
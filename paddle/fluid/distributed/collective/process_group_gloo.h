@@ -117,8 +117,8 @@ class ProcessGroupGloo : public ProcessGroupWithoutStream {
   std::shared_ptr<ProcessGroup::Task> AllGather(
       phi::DenseTensor* out_tensor,
       const phi::DenseTensor& in_tensor,
-      int64_t /*offset*/,  // for compatibility, no use now
-      int64_t /*numel*/,   // for compatibility, no use now
+      int64_t offset,
+      int64_t numel,
       bool sync_op) override;
 
   std::shared_ptr<ProcessGroup::Task> AllReduce(
@@ -127,6 +127,13 @@ class ProcessGroupGloo : public ProcessGroupWithoutStream {
       const AllreduceOptions& opts,
       bool sync_op) override;
 
+  std::shared_ptr<ProcessGroup::Task> AllToAll(
+      phi::DenseTensor* out_tensor,
+      const phi::DenseTensor& in_tensor,
+      const std::vector<int64_t>& out_size_each_rank,
+      const std::vector<int64_t>& in_size_each_rank,
+      bool sync_op) override;
+
   std::shared_ptr<ProcessGroup::Task> Broadcast(
       phi::DenseTensor* out_tensor,
       const phi::DenseTensor& in_tensor,
@@ -146,6 +153,12 @@ class ProcessGroupGloo : public ProcessGroupWithoutStream {
                                              const ReduceOptions& opts,
                                              bool sync_op) override;
 
+  std::shared_ptr<ProcessGroup::Task> ReduceScatter(
+      phi::DenseTensor* out_tensor,
+      const phi::DenseTensor& in_tensor,
+      const ReduceScatterOptions& opts,
+      bool sync_op) override;
+
   std::shared_ptr<ProcessGroup::Task> Scatter(phi::DenseTensor* out_tensor,
                                               const phi::DenseTensor& in_tensor,
                                               const ScatterOptions& opts,
@@ -346,6 +346,19 @@ int32_t BrpcPsClient::Initialize() {
           ::paddle::framework::MakeChannel<SparseAsyncTask *>();
       _push_sparse_merge_count_map[table_id] = 0;
     }
+    const auto &compress_param =
+        worker_param.downpour_table_param(i).push_compress();
+    if (compress_param.type() != PUSH_COMPRESS_NONE) {
+      size_t dim = 0;
+      size_t stat_dim = 0;
+      if (type == PS_SPARSE_TABLE) {
+        auto *accessor = GetTableAccessor(table_id);
+        dim = accessor->GetAccessorInfo().update_dim;
+        stat_dim = accessor->GetPushStatDim();
+      }
+      _push_compressors[table_id].reset(
+          new PushCompressor(compress_param, dim, stat_dim));
+    }
   }
 
   auto &profiler = CostProfiler::instance();
@@ -557,18 +570,73 @@ std::future<int32_t> BrpcPsClient::SendSaveCmd(
   return fut;
 }
 
+void BrpcPsClient::FillSparsePushRequest(size_t table_id,
+                                         const uint64_t *keys,
+                                         const float *const *values,
+                                         uint32_t num,
+                                         PsRequestMessage *request) {
+  request->add_params(reinterpret_cast<char *>(&num), sizeof(uint32_t));
+  auto *push_data = request->mutable_data();
+  auto itr = _push_compressors.find(table_id);
+  if (itr != _push_compressors.end()) {
+    // the second param marks the data as compressed
+    uint8_t type = itr->second->type();
+    request->add_params(reinterpret_cast<char *>(&type), sizeof(uint8_t));
+    itr->second->EncodeSparse(keys, values, num, push_data);
+    return;
+  }
+  /*
+  Push Content:
+  |---keysData---|---valuesData---|
+  |---8*{num}B---|----------------|
+  */
+  size_t value_size = GetTableAccessor(table_id)->GetAccessorInfo().update_size;
+  push_data->resize(num * (sizeof(uint64_t) + value_size));
+  char *push_data_ptr = const_cast<char *>(push_data->data());
+  memcpy(push_data_ptr, keys, num * sizeof(uint64_t));
+  push_data_ptr += num * sizeof(uint64_t);
+  for (uint32_t i = 0; i < num; ++i) {
+    memcpy(push_data_ptr, values[i], value_size);
+    push_data_ptr += value_size;
+  }
+}
+
+void BrpcPsClient::FillDensePushRequest(size_t table_id,
+                                        size_t shard_idx,
+                                        const float *values,
+                                        uint32_t num,
+                                        PsRequestMessage *request) {
+  auto *push_data = request->mutable_data();
+  auto itr = _push_compressors.find(table_id);
+  if (itr != _push_compressors.end()) {
+    // the param marks the data as compressed
+    uint8_t type = itr->second->type();
+    request->add_params(reinterpret_cast<char *>(&type), sizeof(uint8_t));
+    itr->second->EncodeDense(shard_idx, values, num, push_data);
+    return;
+  }
+  push_data->clear();
+  push_data->resize(sizeof(uint32_t) + num * sizeof(float));
+  char *push_data_ptr = const_cast<char *>(push_data->data());
+  memcpy(push_data_ptr, &num, sizeof(uint32_t));
+  memcpy(push_data_ptr + sizeof(uint32_t), values, num * sizeof(float));
+}
+
 std::future<int32_t> BrpcPsClient::Shrink(uint32_t table_id,
                                           const std::string threshold) {
+  ClearPullSparseCache(table_id);
   return SendCmd(table_id, PS_SHRINK_TABLE, {threshold});
 }
 
 std::future<int32_t> BrpcPsClient::Load(const std::string &epoch,
                                         const std::string &mode) {
+  ClearPullSparseCache(-1);
   return SendCmd(-1, PS_LOAD_ALL_TABLE, {epoch, mode});
 }
 std::future<int32_t> BrpcPsClient::Load(uint32_t table_id,
                                         const std::string &epoch,
                                         const std::string &mode) {
+  ClearPullSparseCache(table_id);
   return SendCmd(table_id, PS_LOAD_ONE_TABLE, {epoch, mode});
 }
 
@@ -666,13 +734,16 @@ std::future<int32_t> BrpcPsClient::GetCacheThreshold(uint32_t table_id,
 }
 
 std::future<int32_t> BrpcPsClient::Clear() {
+  ClearPullSparseCache(-1);
   return SendCmd(-1, PS_CLEAR_ALL_TABLE, {});
 }
 std::future<int32_t> BrpcPsClient::Clear(uint32_t table_id) {
+  ClearPullSparseCache(table_id);
   return SendCmd(table_id, PS_CLEAR_ONE_TABLE, {});
 }
 
 std::future<int32_t> BrpcPsClient::Revert() {
+  ClearPullSparseCache(-1);
   return SendCmd(-1, PS_REVERT, {});
 }
 
@@ -1009,7 +1080,6 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     const float **update_values,
     size_t num,
     void *done) {
-  auto *accessor = GetTableAccessor(table_id);
   // 发送RPC请求
   DownpourBrpcClosure *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
   auto promise = std::make_shared<std::promise<int32_t>>();
@@ -1039,28 +1109,16 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
   }
 
   for (size_t shard_idx = 0; shard_idx < request_call_num; ++shard_idx) {
-    auto kvs = ids[shard_idx];
-    auto value_ptr = value_ptrs[shard_idx];
-
-    size_t kv_size = kvs.size();
-    uint32_t value_size = accessor->GetAccessorInfo().update_size;
+    auto &kvs = ids[shard_idx];
+    auto &value_ptr = value_ptrs[shard_idx];
 
     // 发送RPC请求
     auto *push_request = closure->request(shard_idx);
     push_request->set_cmd_id(PS_PUSH_SPARSE_TABLE);
     push_request->set_table_id(table_id);
     push_request->set_client_id(_client_id);
-    push_request->add_params((char *)&kv_size, sizeof(uint32_t));  // NOLINT
-    auto *push_data = push_request->mutable_data();
-    push_data->resize(kv_size * (sizeof(uint64_t) + value_size));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
-    memcpy(push_data_ptr, kvs.data(), kv_size * sizeof(uint64_t));
-    push_data_ptr += kv_size * sizeof(uint64_t);
-
-    for (size_t i = 0; i < kv_size; ++i) {
-      memcpy(push_data_ptr, value_ptr[i], value_size);
-      push_data_ptr += value_size;
-    }
+    FillSparsePushRequest(
+        table_id, kvs.data(), value_ptr.data(), kvs.size(), push_request);
     PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
     closure->cntl(shard_idx)->set_request_compress_type(
         (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
@@ -1089,14 +1147,11 @@ std::future<int32_t> BrpcPsClient::PushDenseRawGradient(
     closure->request(i)->set_cmd_id(PS_PUSH_DENSE_TABLE);
     closure->request(i)->set_table_id(table_id);
     closure->request(i)->set_client_id(_client_id);
-    auto *push_data = closure->request(i)->mutable_data();
-    push_data->clear();
-    push_data->resize(sizeof(uint32_t) + num_per_shard * sizeof(float));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
-    memcpy(push_data_ptr, &num_per_shard, sizeof(uint32_t));
-    memcpy(push_data_ptr + sizeof(uint32_t),
-           total_send_data + i * num_per_shard,
-           num_per_shard * sizeof(float));
+    FillDensePushRequest(table_id,
+                         i,
+                         total_send_data + i * num_per_shard,
+                         num_per_shard,
+                         closure->request(i));
     // closure->cntl(i)->set_request_compress_type(
     //     (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
     PsService_Stub rpc_stub(GetDenseChannel(i));
@@ -1145,6 +1200,31 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
       std::make_shared<CostTimer>("pserver_client_pull_sparse_local");
   size_t request_call_num = _server_channels.size();
 
+  // serve the cached keys locally and only pull the misses
+  auto *cache = GetPullSparseCache(table_id);
+  uint64_t cache_version = 0;
+  auto miss_keys = std::make_shared<std::vector<uint64_t>>();
+  auto miss_values = std::make_shared<std::vector<float *>>();
+  if (cache != NULL) {
+    cache_version = cache->NextVersion();
+    std::vector<size_t> misses;
+    cache->Lookup(cache_version, keys, select_values, num, &misses);
+    if (misses.empty()) {
+      std::promise<int32_t> promise;
+      promise.set_value(0);
+      return promise.get_future();
+    }
+    miss_keys->reserve(misses.size());
+    miss_values->reserve(misses.size());
+    for (size_t i : misses) {
+      miss_keys->push_back(keys[i]);
+      miss_values->push_back(select_values[i]);
+    }
+    keys = miss_keys->data();
+    select_values = miss_values->data();
+    num = misses.size();
+  }
+
   auto shard_sorted_kvs = std::make_shared<
       std::vector<std::vector<std::pair<uint64_t, float *>>>>();
   shard_sorted_kvs->resize(request_call_num);
@@ -1169,7 +1249,13 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
   size_t value_size = accessor->GetAccessorInfo().select_size;
 
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
-      request_call_num, [shard_sorted_kvs, value_size](void *done) {
+      request_call_num,
+      [shard_sorted_kvs,
+       value_size,
+       cache,
+       cache_version,
+       miss_keys,
+       miss_values](void *done) {
         int ret = 0;
         auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
         for (size_t i = 0; i < shard_sorted_kvs->size(); ++i) {
@@ -1202,6 +1288,12 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
             }
           }
         }
+        if (ret == 0 && cache != NULL) {
+          cache->Update(cache_version,
+                        miss_keys->data(),
+                        miss_values->data(),
+                        miss_keys->size());
+        }
         closure->set_promise_value(ret);
       });
   closure->add_timer(timer);
@@ -1409,8 +1501,6 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradientPartial(
     uint32_t num,
     void *done,
     int pserver_idx) {
-  auto *accessor = GetTableAccessor(table_id);
-  size_t value_size = accessor->GetAccessorInfo().update_size;
   DownpourBrpcClosure *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
   auto promise = std::make_shared<std::promise<int32_t>>();
   closure->add_promise(promise);
@@ -1421,16 +1511,7 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradientPartial(
   push_request->set_cmd_id(PS_PUSH_SPARSE_TABLE);
   push_request->set_table_id(table_id);
   push_request->set_client_id(_client_id);
-  push_request->add_params((char *)&num, sizeof(uint32_t));  // NOLINT
-  auto *push_data = push_request->mutable_data();
-  push_data->resize(num * (sizeof(uint64_t) + value_size));
-  char *push_data_ptr = const_cast<char *>(push_data->data());
-  memcpy(push_data_ptr, keys, num * sizeof(uint64_t));
-  push_data_ptr += num * sizeof(uint64_t);
-  for (uint32_t i = 0; i < num; ++i) {
-    memcpy(push_data_ptr, update_values[i], value_size);
-    push_data_ptr += value_size;
-  }
+  FillSparsePushRequest(table_id, keys, update_values, num, push_request);
   PsService_Stub rpc_stub(GetSparseChannel(pserver_idx));
   closure->cntl(0)->set_request_compress_type(
       (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
@@ -1856,24 +1937,16 @@ int BrpcPsClient::PushSparseAsyncShardPush(
   push_request->set_cmd_id(PS_PUSH_SPARSE_TABLE);
   push_request->set_table_id(table_id);
   push_request->set_client_id(_client_id);
-  push_request->add_params(reinterpret_cast<char *>(&merged_kv_count),
-                           sizeof(uint32_t));  // NOLINT
-  auto *push_data = push_request->mutable_data();
-  int update_size = accessor->GetAccessorInfo().update_size;
-  push_data->resize(merged_kv_count * (sizeof(uint64_t) + update_size));
-  char *push_data_ptr = const_cast<char *>(push_data->data());
-  memcpy(push_data_ptr,
-         merged_key_list.data(),
-         merged_kv_count * sizeof(uint64_t));
-  push_data_ptr += merged_kv_count * sizeof(uint64_t);
+  std::vector<const float *> merged_value_ptrs(merged_kv_count);
   for (size_t i = 0; i < merged_kv_count; ++i) {
-    const char *task_data_ptr = merged_value_list[i].data();
-
-    memcpy(push_data_ptr,
-           (float *)(task_data_ptr),  // NOLINT
-           update_size);
-    push_data_ptr += update_size;
+    merged_value_ptrs[i] =
+        reinterpret_cast<const float *>(merged_value_list[i].data());
   }
+  FillSparsePushRequest(table_id,
+                        merged_key_list.data(),
+                        merged_value_ptrs.data(),
+                        merged_kv_count,
+                        push_request);
   PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
   closure->cntl(shard_idx)->set_request_compress_type(
       (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
@@ -2052,14 +2125,11 @@ void BrpcPsClient::PushDenseRawGradient(std::shared_ptr<DenseAsyncTask> &task,
     closure->request(i)->set_cmd_id(PS_PUSH_DENSE_TABLE);
     closure->request(i)->set_table_id(task->table_id());
     closure->request(i)->set_client_id(_client_id);
-    auto *push_data = closure->request(i)->mutable_data();
-    push_data->clear();
-    push_data->resize(sizeof(uint32_t) + num_per_shard * sizeof(float));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
-    memcpy(push_data_ptr, &num_per_shard, sizeof(uint32_t));
-    memcpy(push_data_ptr + sizeof(uint32_t),
-           total_send_data + i * num_per_shard,
-           num_per_shard * sizeof(float));
+    FillDensePushRequest(task->table_id(),
+                         i,
+                         total_send_data + i * num_per_shard,
+                         num_per_shard,
+                         closure->request(i));
     closure->cntl(i)->set_request_compress_type(
         (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
     PsService_Stub rpc_stub(GetDenseChannel(i));
@@ -26,6 +26,7 @@
 #include "paddle/common/macros.h"
 #include "paddle/fluid/distributed/ps/service/brpc_utils.h"
 #include "paddle/fluid/distributed/ps/service/ps_client.h"
+#include "paddle/fluid/distributed/ps/service/push_compressor.h"
 #include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
 #include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -345,6 +346,19 @@ class BrpcPsClient : public PSClient {
                                    int cmd_id,
                                    const std::vector<std::string> &param);
 
+  // Fill the num and the keys/values of a push, compressed if the table
+  // enables push_compress.
+  void FillSparsePushRequest(size_t table_id,
+                             const uint64_t *keys,
+                             const float *const *values,
+                             uint32_t num,
+                             PsRequestMessage *request);
+  void FillDensePushRequest(size_t table_id,
+                            size_t shard_idx,
+                            const float *values,
+                            uint32_t num,
+                            PsRequestMessage *request);
+
   bool _running = false;
   bool _flushing = false;
   std::atomic<uint32_t> _async_call_num;  // 异步请求计数
@@ -360,6 +374,9 @@ class BrpcPsClient : public PSClient {
   std::unordered_map<uint32_t, paddle::framework::Channel<SparseAsyncTask *>>
       _push_sparse_task_queue_map;
   std::unordered_map<uint32_t, uint32_t> _push_sparse_merge_count_map;
+  // tables with push_compress enabled
+  std::unordered_map<uint32_t, std::unique_ptr<PushCompressor>>
+      _push_compressors;
 
   std::thread _print_thread;
 
@@ -18,6 +18,7 @@
 
 #include "butil/object_pool.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
+#include "paddle/fluid/distributed/ps/service/push_compressor.h"
 #include "paddle/fluid/distributed/ps/table/depends/sparse_utils.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 #include "paddle/fluid/framework/archive.h"
@@ -383,12 +384,23 @@ int32_t BrpcPsService::PushDense(Table *table,
   |--num--|---valuesData---|
   |--4B---|----------------|
   */
-  uint32_t num = *(const uint32_t *)(request.data().data());
   TableContext table_context;
   table_context.value_type = Dense;
-  table_context.push_context.values =
-      (const float *)(request.data().data() + sizeof(uint32_t));
-  table_context.num = num;
+  std::vector<float> decoded_values;
+  if (request.params_size() > 0) {
+    // compressed by the client, see push_compressor.h
+    if (!PushCompressor::DecodeDense(request.data(), &decoded_values)) {
+      set_response_code(response, -1, "PushDense data is not in format");
+      return 0;
+    }
+    table_context.push_context.values = decoded_values.data();
+    table_context.num = decoded_values.size();
+  } else {
+    uint32_t num = *(const uint32_t *)(request.data().data());
+    table_context.push_context.values =
+        (const float *)(request.data().data() + sizeof(uint32_t));
+    table_context.num = num;
+  }
   // const float *values = (const float *)(request.data().data() +
   // sizeof(uint32_t));
   if (table->Push(table_context) != 0) {
@@ -578,9 +590,23 @@ int32_t BrpcPsService::PushSparse(Table *table,
   */
   TableContext table_context;
   table_context.value_type = Sparse;
-  table_context.push_context.keys = (const uint64_t *)push_data.data();
-  table_context.push_context.values =
-      (const float *)(push_data.data() + sizeof(uint64_t) * num);
+  std::vector<uint64_t> decoded_keys;
+  std::vector<float> decoded_values;
+  if (request.params_size() > 1) {
+    // compressed by the client, see push_compressor.h
+    size_t update_dim = table->ValueAccesor()->GetAccessorInfo().update_dim;
+    if (!PushCompressor::DecodeSparse(
+            push_data, num, update_dim, &decoded_keys, &decoded_values)) {
+      set_response_code(response, -1, "PushSparse data is not in format");
+      return 0;
+    }
+    table_context.push_context.keys = decoded_keys.data();
+    table_context.push_context.values = decoded_values.data();
+  } else {
+    table_context.push_context.keys = (const uint64_t *)push_data.data();
+    table_context.push_context.values =
+        (const float *)(push_data.data() + sizeof(uint64_t) * num);
+  }
   table_context.num = num;
   // const uint64_t *keys = (const uint64_t *)push_data.data();
   // const float *values = (const float *)(push_data.data() + sizeof(uint64_t) *
@@ -62,6 +62,15 @@ int32_t PSClient::Configure(  // called in FleetWrapper::InitWorker
     accessor->Initialize();
     _table_accessors[work_param.downpour_table_param(i).table_id()].reset(
         accessor);
+
+    const auto &table_param = work_param.downpour_table_param(i);
+    if (table_param.type() == PS_SPARSE_TABLE &&
+        table_param.pull_cache().capacity() > 0) {
+      _pull_sparse_caches[table_param.table_id()].reset(new SparsePullCache(
+          table_param.table_id(),
+          table_param.pull_cache(),
+          accessor->GetAccessorInfo().select_size / sizeof(float)));
+    }
   }
   return Initialize();
 }
@@ -24,6 +24,7 @@
 #include "paddle/fluid/distributed/common/cost_timer.h"
 #include "paddle/fluid/distributed/ps/service/env.h"
 #include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
+#include "paddle/fluid/distributed/ps/service/sparse_pull_cache.h"
 #include "paddle/fluid/distributed/ps/service/sparse_shard_value.h"
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
@@ -258,6 +259,23 @@ class PSClient {
     return itr->second.get();
   }
 
+  // NULL if the pull cache of the table is disabled
+  SparsePullCache *GetPullSparseCache(size_t table_id) {
+    auto itr = _pull_sparse_caches.find(table_id);
+    if (itr == _pull_sparse_caches.end()) {
+      return NULL;
+    }
+    return itr->second.get();
+  }
+  // table_id -1 for all the tables
+  void ClearPullSparseCache(int table_id) {
+    for (auto &itr : _pull_sparse_caches) {
+      if (table_id < 0 || static_cast<int>(itr.first) == table_id) {
+        itr.second->Clear();
+      }
+    }
+  }
+
   virtual size_t GetServerNums() = 0;
 
   virtual std::future<int32_t> PushDenseRawGradient(int table_id,
@@ -365,6 +383,8 @@ class PSClient {
   std::map<uint64_t, std::vector<paddle::distributed::Region>>
       _dense_pull_regions;
   std::unordered_map<uint32_t, std::shared_ptr<ValueAccessor>> _table_accessors;
+  std::unordered_map<uint32_t, std::unique_ptr<SparsePullCache>>
+      _pull_sparse_caches;
   std::unordered_map<int32_t, MsgHandlerFunc>
       _msg_handler_map;  // 处理client2client消息
 
@@ -34,6 +34,7 @@ int32_t PsLocalClient::Initialize() {
 ::std::future<int32_t> PsLocalClient::Shrink(uint32_t table_id,
                                              const std::string threshold) {
   // threshold not use
+  ClearPullSparseCache(table_id);
   auto* table_ptr = GetTable(table_id);
   table_ptr->Shrink("");
   return done();
@@ -49,6 +50,7 @@ int32_t PsLocalClient::Initialize() {
 ::std::future<int32_t> PsLocalClient::Load(uint32_t table_id,
                                            const std::string& epoch,
                                            const std::string& mode) {
+  ClearPullSparseCache(table_id);
   auto* table_ptr = GetTable(table_id);
   table_ptr->Load(epoch, mode);
   return done();
@@ -261,6 +263,56 @@ int32_t PsLocalClient::Initialize() {
   return done();
 }
 
+::std::future<int32_t> PsLocalClient::PullSparse(float** select_values,
+                                                 size_t table_id,
+                                                 const uint64_t* keys,
+                                                 size_t num,
+                                                 bool is_training) {
+  auto* accessor = GetTableAccessor(table_id);
+  size_t value_dim = accessor->GetAccessorInfo().select_size / sizeof(float);
+
+  std::vector<uint64_t> pull_keys(keys, keys + num);
+  std::vector<float*> pull_values(select_values, select_values + num);
+  auto* cache = GetPullSparseCache(table_id);
+  uint64_t cache_version = 0;
+  if (cache != nullptr) {
+    cache_version = cache->NextVersion();
+    std::vector<size_t> misses;
+    cache->Lookup(cache_version, keys, select_values, num, &misses);
+    pull_keys.clear();
+    pull_values.clear();
+    for (size_t i : misses) {
+      pull_keys.push_back(keys[i]);
+      pull_values.push_back(select_values[i]);
+    }
+    if (pull_keys.empty()) {
+      return done();
+    }
+  }
+
+  std::vector<uint32_t> frequencies(pull_keys.size(), 1);
+  std::vector<float> values(pull_keys.size() * value_dim);
+  PullSparseValue pull_value(pull_keys, frequencies, value_dim);
+  pull_value.is_training_ = is_training;
+
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = pull_value;
+  table_context.pull_context.values = values.data();
+  GetTable(table_id)->Pull(table_context);
+
+  for (size_t i = 0; i < pull_values.size(); ++i) {
+    memcpy(pull_values[i],
+           values.data() + i * value_dim,
+           value_dim * sizeof(float));
+  }
+  if (cache != nullptr) {
+    cache->Update(
+        cache_version, pull_keys.data(), pull_values.data(), pull_keys.size());
+  }
+  return done();
+}
+
 ::std::future<int32_t> PsLocalClient::PrintTableStat(uint32_t table_id) {
   auto* table_ptr = GetTable(table_id);
   std::pair<int64_t, int64_t> ret = table_ptr->PrintTableStat();
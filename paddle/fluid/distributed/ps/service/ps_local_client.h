@@ -65,17 +65,11 @@ class PsLocalClient : public PSClient {
                                                 size_t region_num,
                                                 size_t table_id);
 
-  virtual ::std::future<int32_t> PullSparse(float** select_values UNUSED,
-                                            size_t table_id UNUSED,
-                                            const uint64_t* keys UNUSED,
-                                            size_t num UNUSED,
-                                            bool is_training UNUSED) {
-    std::promise<int32_t> prom;
-    std::future<int32_t> fut = prom.get_future();
-    prom.set_value(0);
-
-    return fut;
-  }
+  virtual ::std::future<int32_t> PullSparse(float** select_values,
+                                            size_t table_id,
+                                            const uint64_t* keys,
+                                            size_t num,
+                                            bool is_training);
 
   virtual ::std::future<int32_t> PullSparsePtr(
       const int shard_id,
@@ -0,0 +1,317 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/push_compressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+template <typename T>
+void Append(const T& value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+const char* Read(const char* data, const char* end, T* value) {
+  if (data == NULL || end - data < static_cast<ptrdiff_t>(sizeof(T))) {
+    return NULL;
+  }
+  memcpy(value, data, sizeof(T));
+  return data + sizeof(T);
+}
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+const char* ReadVarint(const char* data, const char* end, uint64_t* value) {
+  uint64_t result = 0;
+  for (int shift = 0; data != NULL && data < end && shift < 64; shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(*data++);
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return data;
+    }
+  }
+  return NULL;
+}
+
+bool IsValidType(uint8_t type) {
+  return type == PUSH_COMPRESS_NONE || type == PUSH_COMPRESS_FP16 ||
+         type == PUSH_COMPRESS_BF16 || type == PUSH_COMPRESS_INT8;
+}
+
+}  // namespace
+
+PushCompressor::PushCompressor(const PushCompressParameter& param,
+                               size_t dim,
+                               size_t stat_dim)
+    : _type(param.type()),
+      _dim(dim),
+      _raw_dim(std::min<size_t>(std::max<size_t>(param.raw_dim(), stat_dim),
+                                dim)),
+      _error_feedback(param.error_feedback()),
+      _feedback_capacity(param.feedback_capacity()) {}
+
+void PushCompressor::EncodeRow(const float* row,
+                               size_t dim,
+                               float* residual,
+                               std::string* out) const {
+  auto value_at = [row, residual](size_t i) {
+    return residual != NULL ? row[i] + residual[i] : row[i];
+  };
+  switch (_type) {
+    case PUSH_COMPRESS_FP16:
+      for (size_t i = 0; i < dim; ++i) {
+        float value = value_at(i);
+        phi::dtype::float16 half(value);
+        Append(half.x, out);
+        if (residual != NULL) {
+          residual[i] = value - static_cast<float>(half);
+        }
+      }
+      break;
+    case PUSH_COMPRESS_BF16:
+      for (size_t i = 0; i < dim; ++i) {
+        float value = value_at(i);
+        phi::dtype::bfloat16 half(value);
+        Append(half.x, out);
+        if (residual != NULL) {
+          residual[i] = value - static_cast<float>(half);
+        }
+      }
+      break;
+    case PUSH_COMPRESS_INT8: {
+      float max_abs = 0;
+      for (size_t i = 0; i < dim; ++i) {
+        max_abs = std::max(max_abs, std::fabs(value_at(i)));
+      }
+      float scale = max_abs / 127;
+      Append(scale, out);
+      for (size_t i = 0; i < dim; ++i) {
+        float value = value_at(i);
+        int8_t quantized = 0;
+        if (scale > 0) {
+          quantized = static_cast<int8_t>(
+              std::max(-127.0f, std::min(127.0f, std::round(value / scale))));
+        }
+        Append(quantized, out);
+        if (residual != NULL) {
+          residual[i] = value - quantized * scale;
+        }
+      }
+      break;
+    }
+    default:
+      out->append(reinterpret_cast<const char*>(row), dim * sizeof(float));
+      break;
+  }
+}
+
+const char* PushCompressor::DecodeRow(PushCompressType type,
+                                      const char* data,
+                                      const char* end,
+                                      size_t dim,
+                                      float* row) {
+  switch (type) {
+    case PUSH_COMPRESS_FP16:
+      for (size_t i = 0; i < dim; ++i) {
+        phi::dtype::float16 half;
+        data = Read(data, end, &half.x);
+        row[i] = static_cast<float>(half);
+      }
+      return data;
+    case PUSH_COMPRESS_BF16:
+      for (size_t i = 0; i < dim; ++i) {
+        phi::dtype::bfloat16 half;
+        data = Read(data, end, &half.x);
+        row[i] = static_cast<float>(half);
+      }
+      return data;
+    case PUSH_COMPRESS_INT8: {
+      float scale = 0;
+      data = Read(data, end, &scale);
+      for (size_t i = 0; i < dim; ++i) {
+        int8_t quantized = 0;
+        data = Read(data, end, &quantized);
+        row[i] = quantized * scale;
+      }
+      return data;
+    }
+    default:
+      for (size_t i = 0; i < dim; ++i) {
+        data = Read(data, end, &row[i]);
+      }
+      return data;
+  }
+}
+
+void PushCompressor::EncodeSparse(const uint64_t* keys,
+                                  const float* const* values,
+                                  size_t num,
+                                  std::string* out) {
+  std::vector<size_t> order(num);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [keys](size_t a, size_t b) {
+    return keys[a] < keys[b];
+  });
+
+  out->clear();
+  out->reserve(9 + num * (2 + _dim * sizeof(float)));
+  Append(static_cast<uint8_t>(_type), out);
+  Append(static_cast<uint32_t>(_dim), out);
+  Append(static_cast<uint32_t>(_raw_dim), out);
+  uint64_t last_key = 0;
+  for (size_t i : order) {
+    AppendVarint(keys[i] - last_key, out);
+    last_key = keys[i];
+  }
+
+  size_t quantized_dim = _dim - _raw_dim;
+  std::unique_lock<std::mutex> lock(_mutex, std::defer_lock);
+  if (_error_feedback) {
+    lock.lock();
+  }
+  for (size_t i : order) {
+    out->append(reinterpret_cast<const char*>(values[i]),
+                _raw_dim * sizeof(float));
+    float* residual = NULL;
+    if (_error_feedback) {
+      auto itr = _sparse_residuals.find(keys[i]);
+      if (itr == _sparse_residuals.end()) {
+        // forget the errors of the cold keys
+        if (_sparse_residuals.size() >= _feedback_capacity) {
+          _sparse_residuals.clear();
+        }
+        itr = _sparse_residuals
+                  .emplace(keys[i], std::vector<float>(quantized_dim, 0))
+                  .first;
+      }
+      residual = itr->second.data();
+    }
+    EncodeRow(values[i] + _raw_dim, quantized_dim, residual, out);
+  }
+}
+
+void PushCompressor::EncodeDense(uint64_t feedback_key,
+                                 const float* values,
+                                 size_t num,
+                                 std::string* out) {
+  out->clear();
+  out->reserve(5 + num * sizeof(float));
+  Append(static_cast<uint8_t>(_type), out);
+  Append(static_cast<uint32_t>(num), out);
+
+  std::unique_lock<std::mutex> lock(_mutex, std::defer_lock);
+  float* residual = NULL;
+  if (_error_feedback) {
+    lock.lock();
+    auto& residuals = _dense_residuals[feedback_key];
+    if (residuals.size() != num) {
+      residuals.assign(num, 0);
+    }
+    residual = residuals.data();
+  }
+  for (size_t begin = 0; begin < num; begin += kDenseRowDim) {
+    size_t dim = std::min(kDenseRowDim, num - begin);
+    EncodeRow(values + begin,
+              dim,
+              residual != NULL ? residual + begin : NULL,
+              out);
+  }
+}
+
+bool PushCompressor::DecodeSparse(const std::string& data,
+                                  size_t num,
+                                  size_t expected_dim,
+                                  std::vector<uint64_t>* keys,
+                                  std::vector<float>* values) {
+  const char* ptr = data.data();
+  const char* end = ptr + data.size();
+  uint8_t type = 0;
+  uint32_t dim = 0;
+  uint32_t raw_dim = 0;
+  ptr = Read(ptr, end, &type);
+  ptr = Read(ptr, end, &dim);
+  ptr = Read(ptr, end, &raw_dim);
+  // every key takes at least one byte, check the sizes before allocating
+  if (ptr == NULL || !IsValidType(type) || raw_dim > dim ||
+      dim != expected_dim || num > static_cast<size_t>(end - ptr)) {
+    return false;
+  }
+
+  keys->resize(num);
+  uint64_t last_key = 0;
+  for (size_t i = 0; i < num && ptr != NULL; ++i) {
+    uint64_t delta = 0;
+    ptr = ReadVarint(ptr, end, &delta);
+    last_key += delta;
+    (*keys)[i] = last_key;
+  }
+
+  values->resize(num * dim);
+  for (size_t i = 0; i < num && ptr != NULL; ++i) {
+    float* row = values->data() + i * dim;
+    ptr = DecodeRow(PUSH_COMPRESS_NONE, ptr, end, raw_dim, row);
+    ptr = DecodeRow(static_cast<PushCompressType>(type),
+                    ptr,
+                    end,
+                    dim - raw_dim,
+                    row + raw_dim);
+  }
+  return ptr == end;
+}
+
+bool PushCompressor::DecodeDense(const std::string& data,
+                                 std::vector<float>* values) {
+  const char* ptr = data.data();
+  const char* end = ptr + data.size();
+  uint8_t type = 0;
+  uint32_t num = 0;
+  ptr = Read(ptr, end, &type);
+  ptr = Read(ptr, end, &num);
+  // every value takes at least one byte, check the size before allocating
+  if (ptr == NULL || !IsValidType(type) ||
+      num > static_cast<size_t>(end - ptr)) {
+    return false;
+  }
+  values->resize(num);
+  for (size_t begin = 0; begin < num && ptr != NULL; begin += kDenseRowDim) {
+    size_t dim = std::min<size_t>(kDenseRowDim, num - begin);
+    ptr = DecodeRow(static_cast<PushCompressType>(type),
+                    ptr,
+                    end,
+                    dim,
+                    values->data() + begin);
+  }
+  return ptr == end;
+}
+
+}  // namespace distributed
+}  // namespace paddle
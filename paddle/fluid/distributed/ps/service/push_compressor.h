@@ -0,0 +1,104 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+// Wire compression of the gradients pushed by the client, configured by
+// TableParameter.push_compress. The payload is self-describing, so the
+// server decodes it without knowing the config of the client.
+//
+// Sparse push:
+// |--type--|--dim--|--raw_dim--|--keys--|--values--|
+// |---1B---|--4B---|----4B-----|--------|----------|
+// The keys are sorted and sent as varint deltas, and the values follow in
+// the same order. The first raw_dim floats of a value are sent in fp32, the
+// rest in fp16/bf16, or in int8 with a fp32 scale for the row.
+//
+// Dense push:
+// |--type--|--num--|--values--|
+// |---1B---|--4B---|----------|
+// with the int8 rows of kDenseRowDim floats.
+//
+// With error feedback, the quantization error of a value is kept and added
+// to the next push of the same key, or the same dense shard, so the errors
+// do not accumulate on the server.
+class PushCompressor {
+ public:
+  static constexpr size_t kDenseRowDim = 256;
+
+  // stat_dim is the number of the leading floats of a sparse value which
+  // are not gradients, e.g. mf_dim of CtrDymfAccessor. They are sent in
+  // fp32 even if param.raw_dim is smaller.
+  PushCompressor(const PushCompressParameter& param,
+                 size_t dim,
+                 size_t stat_dim = 0);
+
+  PushCompressType type() const { return _type; }
+
+  void EncodeSparse(const uint64_t* keys,
+                    const float* const* values,
+                    size_t num,
+                    std::string* out);
+  // feedback_key identifies the part of the dense table, e.g. the server
+  void EncodeDense(uint64_t feedback_key,
+                   const float* values,
+                   size_t num,
+                   std::string* out);
+
+  // Returns false if the data is not in format, or its values are not of
+  // the dim expected by the table.
+  static bool DecodeSparse(const std::string& data,
+                           size_t num,
+                           size_t dim,
+                           std::vector<uint64_t>* keys,
+                           std::vector<float>* values);
+  static bool DecodeDense(const std::string& data, std::vector<float>* values);
+
+ private:
+  // Appends the quantized row, after adding the residual to it and keeping
+  // the new error in the residual if it is not NULL.
+  void EncodeRow(const float* row,
+                 size_t dim,
+                 float* residual,
+                 std::string* out) const;
+  static const char* DecodeRow(PushCompressType type,
+                               const char* data,
+                               const char* end,
+                               size_t dim,
+                               float* row);
+
+  PushCompressType _type;
+  size_t _dim;
+  size_t _raw_dim;
+  bool _error_feedback;
+  size_t _feedback_capacity;
+
+  std::mutex _mutex;
+  std::unordered_map<uint64_t, std::vector<float>> _sparse_residuals;
+  std::unordered_map<uint64_t, std::vector<float>> _dense_residuals;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,217 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_pull_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace paddle {
+namespace distributed {
+
+SparsePullCache::SparsePullCache(uint32_t table_id,
+                                 const SparsePullCacheParameter& param,
+                                 size_t value_dim)
+    : _value_dim(value_dim),
+      _shard_capacity((param.capacity() + kShardNum - 1) / kShardNum),
+      _max_staleness(param.max_staleness()),
+      _admit_threshold(std::max<uint32_t>(param.admit_threshold(), 1)) {
+  auto& registry = platform::MetricsRegistry::Instance();
+  platform::MetricLabels labels = {{"table", std::to_string(table_id)}};
+  _hit_counter = registry.GetCounter("paddle_ps_pull_cache_hits_total",
+                                     "Number of sparse keys served by the "
+                                     "worker side pull cache",
+                                     labels);
+  _miss_counter = registry.GetCounter("paddle_ps_pull_cache_misses_total",
+                                      "Number of sparse keys pulled from the "
+                                      "servers with the pull cache enabled",
+                                      labels);
+  _stale_counter =
+      registry.GetCounter("paddle_ps_pull_cache_stale_misses_total",
+                          "Number of cached sparse keys pulled again from "
+                          "the servers because they are too stale",
+                          labels);
+  _staleness = registry.GetHistogram(
+      "paddle_ps_pull_cache_hit_staleness",
+      "Number of pulls since the served values were pulled from the servers",
+      labels);
+}
+
+void SparsePullCache::GroupByShard(
+    const uint64_t* keys,
+    size_t num,
+    std::vector<std::vector<size_t>>* indices) const {
+  indices->resize(kShardNum);
+  for (size_t i = 0; i < num; ++i) {
+    (*indices)[ShardIndex(keys[i])].push_back(i);
+  }
+}
+
+void SparsePullCache::Lookup(uint64_t version,
+                             const uint64_t* keys,
+                             float** values,
+                             size_t num,
+                             std::vector<size_t>* misses) {
+  std::vector<std::vector<size_t>> indices;
+  GroupByShard(keys, num, &indices);
+  misses->clear();
+  misses->reserve(num);
+  uint64_t hits = 0;
+  uint64_t stale_misses = 0;
+  size_t value_bytes = _value_dim * sizeof(float);
+  for (size_t shard_id = 0; shard_id < kShardNum; ++shard_id) {
+    if (indices[shard_id].empty()) {
+      continue;
+    }
+    Shard& shard = _shards[shard_id];
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    for (size_t i : indices[shard_id]) {
+      auto itr = shard.slots.find(keys[i]);
+      if (itr == shard.slots.end()) {
+        misses->push_back(i);
+        continue;
+      }
+      uint32_t slot = itr->second;
+      if (IsStale(version, shard.versions[slot])) {
+        // refreshed in place by Update
+        misses->push_back(i);
+        ++stale_misses;
+        continue;
+      }
+      memcpy(values[i], &shard.values[slot * _value_dim], value_bytes);
+      shard.referenced[slot] = 1;
+      _staleness->Observe(version - shard.versions[slot]);
+      ++hits;
+    }
+  }
+  // keep the misses in the order of keys, as the servers see them
+  std::sort(misses->begin(), misses->end());
+
+  _hits += hits;
+  _misses += misses->size();
+  _stale_misses += stale_misses;
+  _hit_counter->Increase(hits);
+  _miss_counter->Increase(misses->size());
+  _stale_counter->Increase(stale_misses);
+}
+
+uint32_t SparsePullCache::AcquireSlot(Shard* shard, uint64_t version) {
+  if (shard->keys.size() < _shard_capacity) {
+    shard->keys.push_back(0);
+    shard->versions.push_back(0);
+    shard->referenced.push_back(0);
+    shard->values.resize(shard->values.size() + _value_dim);
+    return shard->keys.size() - 1;
+  }
+  // the referenced entries get a second chance, the stale ones do not
+  size_t slot_num = shard->keys.size();
+  while (true) {
+    uint32_t slot = shard->hand;
+    shard->hand = (shard->hand + 1) % slot_num;
+    if (shard->referenced[slot] &&
+        !IsStale(version, shard->versions[slot])) {
+      shard->referenced[slot] = 0;
+      continue;
+    }
+    shard->slots.erase(shard->keys[slot]);
+    ++_evicted;
+    return slot;
+  }
+}
+
+void SparsePullCache::Update(uint64_t version,
+                             const uint64_t* keys,
+                             float** values,
+                             size_t num) {
+  if (_shard_capacity == 0) {
+    return;
+  }
+  std::vector<std::vector<size_t>> indices;
+  GroupByShard(keys, num, &indices);
+  uint64_t admitted = 0;
+  size_t value_bytes = _value_dim * sizeof(float);
+  for (size_t shard_id = 0; shard_id < kShardNum; ++shard_id) {
+    if (indices[shard_id].empty()) {
+      continue;
+    }
+    Shard& shard = _shards[shard_id];
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    for (size_t i : indices[shard_id]) {
+      uint64_t key = keys[i];
+      uint32_t slot = 0;
+      auto itr = shard.slots.find(key);
+      if (itr != shard.slots.end()) {
+        slot = itr->second;
+        // a concurrent pull of a later version has refreshed it
+        if (shard.versions[slot] > version) {
+          continue;
+        }
+      } else {
+        uint32_t& miss_count = shard.candidates[key];
+        if (++miss_count < _admit_threshold) {
+          continue;
+        }
+        shard.candidates.erase(key);
+        slot = AcquireSlot(&shard, version);
+        shard.slots[key] = slot;
+        shard.keys[slot] = key;
+        shard.referenced[slot] = 0;
+        ++admitted;
+      }
+      memcpy(&shard.values[slot * _value_dim], values[i], value_bytes);
+      shard.versions[slot] = version;
+    }
+    // age the miss counts, so the candidates stay bounded
+    if (shard.candidates.size() > 2 * _shard_capacity) {
+      shard.candidates.clear();
+    }
+  }
+  _admitted += admitted;
+}
+
+void SparsePullCache::Clear() {
+  for (auto& shard : _shards) {
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    shard.slots.clear();
+    shard.keys.clear();
+    shard.versions.clear();
+    shard.referenced.clear();
+    shard.values.clear();
+    shard.candidates.clear();
+    shard.hand = 0;
+  }
+}
+
+size_t SparsePullCache::size() {
+  size_t size = 0;
+  for (auto& shard : _shards) {
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    size += shard.slots.size();
+  }
+  return size;
+}
+
+SparsePullCacheStat SparsePullCache::GetStat() const {
+  SparsePullCacheStat stat;
+  stat.hits = _hits;
+  stat.misses = _misses;
+  stat.stale_misses = _stale_misses;
+  stat.admitted = _admitted;
+  stat.evicted = _evicted;
+  return stat;
+}
+
+}  // namespace distributed
+}  // namespace paddle
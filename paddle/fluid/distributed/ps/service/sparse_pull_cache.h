@@ -0,0 +1,120 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/fluid/platform/runtime_metrics.h"
+
+namespace paddle {
+namespace distributed {
+
+struct SparsePullCacheStat {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  // misses of the keys which are cached but too stale
+  uint64_t stale_misses = 0;
+  uint64_t admitted = 0;
+  uint64_t evicted = 0;
+};
+
+// Worker side cache of the select values of the hot keys of a sparse table.
+// CTR traffic is highly skewed, so the head keys are served locally and only
+// the misses are pulled from the servers.
+//
+// Every pull of the table takes a new version. A cached value is served
+// until max_staleness versions after the one it was pulled at, so the
+// updates pushed by the other workers are seen within a bounded number of
+// pulls. A key is admitted after it misses admit_threshold times, and the
+// entries are evicted in CLOCK order when the cache is full.
+class SparsePullCache {
+ public:
+  SparsePullCache(uint32_t table_id,
+                  const SparsePullCacheParameter& param,
+                  size_t value_dim);
+
+  uint64_t NextVersion() { return ++_version; }
+
+  // Copies the cached values of keys into values, and returns the indices
+  // of the keys to be pulled from the servers in misses.
+  void Lookup(uint64_t version,
+              const uint64_t* keys,
+              float** values,
+              size_t num,
+              std::vector<size_t>* misses);
+  // Caches the values pulled from the servers at version.
+  void Update(uint64_t version,
+              const uint64_t* keys,
+              float** values,
+              size_t num);
+  // Drops all the entries, e.g. after the table is loaded or shrunk.
+  void Clear();
+
+  size_t size();
+  SparsePullCacheStat GetStat() const;
+
+ private:
+  static constexpr size_t kShardNum = 16;
+
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, uint32_t> slots;
+    std::vector<uint64_t> keys;
+    std::vector<uint64_t> versions;
+    std::vector<uint8_t> referenced;
+    std::vector<float> values;  // value_dim floats per slot
+    // miss counts of the keys waiting for admission
+    std::unordered_map<uint64_t, uint32_t> candidates;
+    size_t hand = 0;
+  };
+
+  size_t ShardIndex(uint64_t key) const {
+    return (key * 0x9E3779B97F4A7C15ULL) >> 60;
+  }
+  bool IsStale(uint64_t version, uint64_t cached_version) const {
+    return version > cached_version + _max_staleness;
+  }
+  // Returns the slot for a new entry of shard, evicting one if it is full.
+  uint32_t AcquireSlot(Shard* shard, uint64_t version);
+  void GroupByShard(const uint64_t* keys,
+                    size_t num,
+                    std::vector<std::vector<size_t>>* indices) const;
+
+  size_t _value_dim;
+  size_t _shard_capacity;
+  uint64_t _max_staleness;
+  uint32_t _admit_threshold;
+  std::atomic<uint64_t> _version{0};
+  Shard _shards[kShardNum];
+
+  std::atomic<uint64_t> _hits{0};
+  std::atomic<uint64_t> _misses{0};
+  std::atomic<uint64_t> _stale_misses{0};
+  std::atomic<uint64_t> _admitted{0};
+  std::atomic<uint64_t> _evicted{0};
+
+  platform::Counter* _hit_counter;
+  platform::Counter* _miss_counter;
+  platform::Counter* _stale_counter;
+  platform::Histogram* _staleness;
+};
+
+}  // namespace distributed
+}  // namespace paddle
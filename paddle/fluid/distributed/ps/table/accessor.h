@@ -181,6 +181,10 @@ class ValueAccessor {
   virtual float GetField(float* value UNUSED, const std::string& name UNUSED) {
     return 0.0;
   }
+  // Number of the leading floats of a push value which are not gradients,
+  // e.g. the slot, show and click, or 0 if unknown. Push compression sends
+  // them in fp32.
+  virtual size_t GetPushStatDim() { return 0; }
   virtual robin_hood::unordered_set<float>* GetFilteredSlots() {
     return nullptr;
   }
@@ -113,9 +113,13 @@ int32_t GraphTable::Load_to_ssd(const std::string &path,
         ::paddle::framework::GpuPsFeaInfo x;
         std::vector<uint64_t> feature_ids;
         for (size_t j = 0; j < bags[i].size(); j++) {
-          Node *v = find_node(GraphTableType::FEATURE_TABLE, bags[i][j]);
+          auto columns = find_feature_columns(bags[i][j]);
+          Node *v = nullptr;
+          if (columns.first == nullptr) {
+            v = find_node(GraphTableType::FEATURE_TABLE, bags[i][j]);
+          }
           node_id = bags[i][j];
-          if (v == NULL) {
+          if (v == NULL && columns.first == nullptr) {
             x.feature_size = 0;
             x.feature_offset = 0;
             node_fea_info_array[i].push_back(x);
@@ -125,7 +129,13 @@ int32_t GraphTable::Load_to_ssd(const std::string &path,
             int total_feature_size = 0;
             for (int k = 0; k < slot_num; ++k) {
               auto feature_ids_size =
-                  v->get_feature_ids(k, feature_array[i], slot_id_array[i]);
+                  columns.first != nullptr
+                      ? columns.first->get_feature_ids(columns.second,
+                                                       k,
+                                                       feature_array[i],
+                                                       slot_id_array[i])
+                      : v->get_feature_ids(
+                            k, feature_array[i], slot_id_array[i]);
               if (slot_feature_num_map_[k] < feature_ids_size) {
                 slot_feature_num_map_[k] = feature_ids_size;
               }
@@ -216,9 +226,13 @@ GraphTable::make_gpu_ps_graph_float_fea(int gpu_id,
         ::paddle::framework::GpuPsFeaInfo x;
         // std::vector<uint64_t> feature_ids;
         for (size_t j = 0; j < bags[i].size(); j++) {
-          Node *v = find_node(GraphTableType::FEATURE_TABLE, bags[i][j]);
+          auto columns = find_feature_columns(bags[i][j]);
+          Node *v = nullptr;
+          if (columns.first == nullptr) {
+            v = find_node(GraphTableType::FEATURE_TABLE, bags[i][j]);
+          }
           node_id = bags[i][j];
-          if (v == NULL) {
+          if (v == NULL && columns.first == nullptr) {
             x.feature_size = 0;
             x.feature_offset = 0;
             node_fea_info_array[i].push_back(x);
@@ -228,7 +242,13 @@ GraphTable::make_gpu_ps_graph_float_fea(int gpu_id,
             int total_feature_size = 0;
             for (int k = 0; k < float_slot_num; ++k) {
               auto float_feature_size =
-                  v->get_float_feature(k, feature_array[i], slot_id_array[i]);
+                  columns.first != nullptr
+                      ? columns.first->get_float_feature(columns.second,
+                                                         k,
+                                                         feature_array[i],
+                                                         slot_id_array[i])
+                      : v->get_float_feature(
+                            k, feature_array[i], slot_id_array[i]);
               total_feature_size += float_feature_size;
             }
             x.feature_size = total_feature_size;
@@ -1692,14 +1712,79 @@ void GraphTable::clear_graph() {
 std::vector<Node *> GraphShard::get_batch(int start, int end, int step) {
   if (start < 0) start = 0;
   std::vector<Node *> res;
-  for (int pos = start; pos < std::min(end, static_cast<int>(bucket.size()));
+  for (int pos = start; pos < std::min(end, static_cast<int>(get_size()));
        pos += step) {
-    res.push_back(bucket[pos]);
+    if (csr_ != nullptr) {
+      res.push_back(new Node(csr_->get_id(pos)));
+    } else if (columns_ != nullptr) {
+      res.push_back(columns_->to_node(pos));
+    } else {
+      res.push_back(bucket[pos]);
+    }
   }
   return res;
 }
 
-size_t GraphShard::get_size() { return bucket.size(); }
+size_t GraphShard::get_size() {
+  if (csr_ != nullptr) {
+    return csr_->node_size();
+  }
+  if (columns_ != nullptr) {
+    return columns_->node_size();
+  }
+  return bucket.size();
+}
+
+void GraphShard::build_csr(bool is_weighted) {
+  if (csr_ != nullptr) {
+    return;
+  }
+  std::unique_ptr<CsrEdgeBlob> csr(new CsrEdgeBlob());
+  csr->build(bucket, is_weighted);
+  clear();
+  std::unordered_map<uint64_t, int>().swap(node_location);
+  std::vector<Node *>().swap(bucket);
+  csr_ = std::move(csr);
+}
+
+void GraphShard::build_columns(int slot_num, int float_slot_num) {
+  if (columns_ != nullptr) {
+    return;
+  }
+  std::unique_ptr<GraphFeatureColumns> columns(new GraphFeatureColumns());
+  columns->build(bucket, slot_num, float_slot_num);
+  clear();
+  std::unordered_map<uint64_t, int>().swap(node_location);
+  std::vector<Node *>().swap(bucket);
+  columns_ = std::move(columns);
+}
+
+void GraphShard::decompact() {
+  if (csr_ != nullptr) {
+    std::unique_ptr<CsrEdgeBlob> csr = std::move(csr_);
+    bool is_weighted = csr->is_weighted();
+    bucket.reserve(bucket.size() + csr->node_size());
+    for (size_t row = 0; row < csr->node_size(); row++) {
+      GraphNode *node = new GraphNode(csr->get_id(row));
+      node->build_edges(is_weighted);
+      for (size_t i = 0; i < csr->get_degree(row); i++) {
+        node->add_edge(csr->get_neighbor_id(row, i),
+                       csr->get_neighbor_weight(row, i));
+      }
+      node_location[node->get_id()] = bucket.size();
+      bucket.push_back(node);
+    }
+  }
+  if (columns_ != nullptr) {
+    std::unique_ptr<GraphFeatureColumns> columns = std::move(columns_);
+    bucket.reserve(bucket.size() + columns->node_size());
+    for (size_t row = 0; row < columns->node_size(); row++) {
+      Node *node = columns->to_node(row);
+      node_location[node->get_id()] = bucket.size();
+      bucket.push_back(node);
+    }
+  }
+}
 
 int32_t GraphTable::add_comm_edge(int idx, uint64_t src_id, uint64_t dst_id) {
   size_t src_shard_id = src_id % shard_num;
@@ -1773,11 +1858,14 @@ void GraphShard::clear() {
   }
   bucket.clear();
   node_location.clear();
+  csr_.reset();
+  columns_.reset();
 }
 
 GraphShard::~GraphShard() { clear(); }
 
 void GraphShard::delete_node(uint64_t id) {
+  decompact();
   auto iter = node_location.find(id);
   if (iter == node_location.end()) return;
   int pos = iter->second;
@@ -1790,6 +1878,7 @@ void GraphShard::delete_node(uint64_t id) {
   bucket.pop_back();
 }
 GraphNode *GraphShard::add_graph_node(uint64_t id) {
+  decompact();
   if (node_location.find(id) == node_location.end()) {
     node_location[id] = bucket.size();
     bucket.push_back(new GraphNode(id));
@@ -1799,6 +1888,7 @@ GraphNode *GraphShard::add_graph_node(uint64_t id) {
 
 GraphNode *GraphShard::add_graph_node(Node *node) {
   auto id = node->get_id();
+  decompact();
   if (node_location.find(id) == node_location.end()) {
     node_location[id] = bucket.size();
     bucket.push_back(node);
@@ -1809,6 +1899,7 @@ GraphNode *GraphShard::add_graph_node(Node *node) {
 FeatureNode *GraphShard::add_feature_node(uint64_t id,
                                           bool is_overlap,
                                           int float_fea_num) {
+  decompact();
   if (node_location.find(id) == node_location.end()) {
     node_location[id] = bucket.size();
     if (float_fea_num > 0) {
@@ -1860,6 +1951,9 @@ int32_t GraphTable::Load(const std::string &path, const std::string &param) {
               << node_type << "]";
       return -1;
     }
+    if (use_feature_columns_) {
+      build_feature_columns();
+    }
   }
   return 0;
 }
@@ -2044,6 +2138,9 @@ int32_t GraphTable::parse_node_and_load(std::string ntype2files,
     graph_partition(false);
   }
 #endif
+  if (load_slot && use_feature_columns_) {
+    build_feature_columns();
+  }
   return 0;
 }
 void GraphTable::fix_feature_node_shards(bool load_slot) {
@@ -2464,6 +2561,10 @@ int32_t GraphTable::load_nodes(const std::string &path,
 
 int32_t GraphTable::build_sampler(int idx, std::string sample_type) {
   for (auto &shard : edge_shards[idx]) {
+    if (shard->is_csr()) {
+      shard->get_csr()->set_weighted_sample(sample_type == "weighted");
+      continue;
+    }
     auto bucket = shard->get_bucket();
     for (auto item : bucket) {
       item->build_sampler(sample_type);
@@ -2620,6 +2721,8 @@ int32_t GraphTable::load_edges(const std::string &path,
     // In order not to affect the sampler function of other scenario,
     // this optimization is only performed in load_edges function.
     VLOG(0) << "run in gpugraph mode!";
+  } else if (use_csr_edges_) {
+    build_csr_edges(idx);
   } else {
     std::string sample_type = "random";
     VLOG(0) << "build sampler ... ";
@@ -2634,6 +2737,232 @@ int32_t GraphTable::load_edges(const std::string &path,
   return 0;
 }
 
+void GraphTable::build_csr_edges(int idx) {
+  VLOG(0) << "build csr edges of edge_type[" << id_to_edge[idx] << "] ... ";
+  std::vector<std::future<int>> tasks;
+  for (auto &shard : edge_shards[idx]) {
+    tasks.push_back(load_node_edge_task_pool->enqueue([&shard, this]() -> int {
+      shard->build_csr(is_weighted_);
+      return 0;
+    }));
+  }
+  for (auto &task : tasks) task.get();
+  size_t node_size = 0, edge_size = 0, memory_size = 0;
+  for (auto &shard : edge_shards[idx]) {
+    node_size += shard->get_csr()->node_size();
+    edge_size += shard->get_csr()->edge_size();
+    memory_size += shard->get_csr()->memory_size();
+  }
+  VLOG(0) << "finish build csr edges of edge_type[" << id_to_edge[idx]
+          << "], node size: " << node_size << ", edge size: " << edge_size
+          << ", memory size: " << memory_size << " bytes";
+}
+
+CsrEdgeBlob *GraphTable::find_csr_edges(int idx, uint64_t id) {
+  size_t shard_id = id % shard_num;
+  if (shard_id >= shard_end || shard_id < shard_start) {
+    return nullptr;
+  }
+  return edge_shards[idx][shard_id - shard_start]->get_csr();
+}
+
+void GraphTable::build_feature_columns() {
+  VLOG(0) << "begin build feature columns";
+  std::vector<std::future<int>> tasks;
+  for (size_t idx = 0; idx < feature_shards.size(); ++idx) {
+    int slot_num = feat_name.size() > idx ? feat_name[idx].size() : 0;
+    int float_slot_num =
+        float_feat_id_map.size() > idx ? float_feat_id_map[idx].size() : 0;
+    for (auto &shard : feature_shards[idx]) {
+      if (shard->is_compact() || shard->get_bucket().empty()) {
+        continue;
+      }
+      tasks.push_back(load_node_edge_task_pool->enqueue(
+          [&shard, slot_num, float_slot_num]() -> int {
+            shard->build_columns(slot_num, float_slot_num);
+            return 0;
+          }));
+    }
+  }
+  for (auto &task : tasks) task.get();
+  size_t node_size = 0, memory_size = 0;
+  for (auto &type_shards : feature_shards) {
+    for (auto &shard : type_shards) {
+      if (shard->get_columns() != nullptr) {
+        node_size += shard->get_columns()->node_size();
+        memory_size += shard->get_columns()->memory_size();
+      }
+    }
+  }
+  VLOG(0) << "finish build feature columns, node size: " << node_size
+          << ", memory size: " << memory_size << " bytes";
+}
+
+std::pair<GraphFeatureColumns *, int64_t> GraphTable::find_feature_columns(
+    int idx, uint64_t id) {
+  size_t shard_id = id % shard_num;
+  if (shard_id >= shard_end || shard_id < shard_start) {
+    return {nullptr, -1};
+  }
+  GraphFeatureColumns *columns =
+      feature_shards[idx][shard_id - shard_start]->get_columns();
+  if (columns != nullptr) {
+    int64_t row = columns->find_row(id);
+    if (row >= 0) {
+      return {columns, row};
+    }
+  }
+  return {nullptr, -1};
+}
+
+std::pair<GraphFeatureColumns *, int64_t> GraphTable::find_feature_columns(
+    uint64_t id) {
+  for (size_t idx = 0; idx < feature_shards.size(); ++idx) {
+    auto columns = find_feature_columns(idx, id);
+    if (columns.first != nullptr) {
+      return columns;
+    }
+  }
+  return {nullptr, -1};
+}
+
+int32_t GraphTable::get_node_slot_features(const uint64_t *node_ids,
+                                           size_t node_num,
+                                           int slot_num,
+                                           int float_slot_num,
+                                           GraphNodeFeatures *res) {
+  std::vector<std::vector<size_t>> seq_id(task_pool_size_);
+  for (size_t idy = 0; idy < node_num; ++idy) {
+    seq_id[get_thread_pool_index(node_ids[idy])].push_back(idy);
+  }
+  auto for_each_node = [&](const std::function<void(size_t)> &func) {
+    std::vector<std::future<int>> tasks;
+    for (size_t i = 0; i < seq_id.size(); i++) {
+      if (seq_id[i].empty()) continue;
+      tasks.push_back(_shards_task_pool[i]->enqueue([&, i]() -> int {
+        for (auto idy : seq_id[i]) {
+          func(idy);
+        }
+        return 0;
+      }));
+    }
+    for (auto &task : tasks) task.get();
+  };
+
+  // First find every node and count its features, then copy the features
+  // of each node to its own range of the output arrays.
+  std::vector<std::pair<GraphFeatureColumns *, int64_t>> rows(node_num);
+  std::vector<Node *> nodes(node_num, nullptr);
+  res->feature_offsets.assign(node_num + 1, 0);
+  res->float_feature_offsets.assign(node_num + 1, 0);
+  for_each_node([&](size_t idy) {
+    thread_local std::vector<uint64_t> feature_ids;
+    thread_local std::vector<float> float_features;
+    thread_local std::vector<uint8_t> slot_ids;
+    rows[idy] = find_feature_columns(node_ids[idy]);
+    auto &columns = rows[idy];
+    if (columns.first == nullptr) {
+      nodes[idy] = find_node(GraphTableType::FEATURE_TABLE, node_ids[idy]);
+    }
+    uint64_t feature_size = 0, float_feature_size = 0;
+    for (int k = 0; k < slot_num; ++k) {
+      if (columns.first != nullptr) {
+        if (k < columns.first->slot_num()) {
+          feature_size += columns.first->get_feature_size(columns.second, k);
+        }
+      } else if (nodes[idy] != nullptr) {
+        feature_ids.clear();
+        feature_size += nodes[idy]->get_feature_ids(k, feature_ids, slot_ids);
+      }
+    }
+    for (int k = 0; k < float_slot_num; ++k) {
+      if (columns.first != nullptr) {
+        if (k < columns.first->float_slot_num()) {
+          float_feature_size +=
+              columns.first->get_float_feature_size(columns.second, k);
+        }
+      } else if (nodes[idy] != nullptr) {
+        float_features.clear();
+        float_feature_size +=
+            nodes[idy]->get_float_feature(k, float_features, slot_ids);
+      }
+    }
+    slot_ids.clear();
+    res->feature_offsets[idy + 1] = feature_size;
+    res->float_feature_offsets[idy + 1] = float_feature_size;
+  });
+  for (size_t idy = 0; idy < node_num; ++idy) {
+    res->feature_offsets[idy + 1] += res->feature_offsets[idy];
+    res->float_feature_offsets[idy + 1] += res->float_feature_offsets[idy];
+  }
+  res->feature_ids.resize(res->feature_offsets[node_num]);
+  res->slot_ids.resize(res->feature_offsets[node_num]);
+  res->float_features.resize(res->float_feature_offsets[node_num]);
+  res->float_slot_ids.resize(res->float_feature_offsets[node_num]);
+
+  for_each_node([&](size_t idy) {
+    thread_local std::vector<uint64_t> feature_ids;
+    thread_local std::vector<float> float_features;
+    thread_local std::vector<uint8_t> slot_ids;
+    auto &columns = rows[idy];
+    if (columns.first == nullptr && nodes[idy] == nullptr) {
+      return;
+    }
+    feature_ids.clear();
+    float_features.clear();
+    slot_ids.clear();
+    uint64_t offset = res->feature_offsets[idy];
+    for (int k = 0; k < slot_num; ++k) {
+      if (columns.first != nullptr) {
+        if (k >= columns.first->slot_num()) {
+          continue;
+        }
+        size_t num = columns.first->get_feature_size(columns.second, k);
+        const uint64_t *feas =
+            columns.first->get_feature_data(columns.second, k);
+        std::copy(feas, feas + num, res->feature_ids.begin() + offset);
+        std::fill_n(res->slot_ids.begin() + offset, num, k);
+        offset += num;
+      } else {
+        nodes[idy]->get_feature_ids(k, feature_ids, slot_ids);
+      }
+    }
+    if (columns.first == nullptr) {
+      std::copy(feature_ids.begin(),
+                feature_ids.end(),
+                res->feature_ids.begin() + offset);
+      std::copy(
+          slot_ids.begin(), slot_ids.end(), res->slot_ids.begin() + offset);
+      slot_ids.clear();
+    }
+    offset = res->float_feature_offsets[idy];
+    for (int k = 0; k < float_slot_num; ++k) {
+      if (columns.first != nullptr) {
+        if (k >= columns.first->float_slot_num()) {
+          continue;
+        }
+        size_t num = columns.first->get_float_feature_size(columns.second, k);
+        const float *feas =
+            columns.first->get_float_feature_data(columns.second, k);
+        std::copy(feas, feas + num, res->float_features.begin() + offset);
+        std::fill_n(res->float_slot_ids.begin() + offset, num, k);
+        offset += num;
+      } else {
+        nodes[idy]->get_float_feature(k, float_features, slot_ids);
+      }
+    }
+    if (columns.first == nullptr) {
+      std::copy(float_features.begin(),
+                float_features.end(),
+                res->float_features.begin() + offset);
+      std::copy(slot_ids.begin(),
+                slot_ids.end(),
+                res->float_slot_ids.begin() + offset);
+    }
+  });
+  return 0;
+}
+
 Node *GraphTable::find_node(GraphTableType table_type, uint64_t id) {
   size_t shard_id = id % shard_num;
   if (shard_id >= shard_end || shard_id < shard_start) {
@@ -2805,10 +3134,17 @@ int32_t GraphTable::random_sample_neighbors(
           index++;
         } else {
           node_id = id_list[i][k].node_key;
-          Node *node = find_node(GraphTableType::EDGE_TABLE, idx, node_id);
+          Node *node = nullptr;
+          CsrEdgeBlob *csr = find_csr_edges(idx, node_id);
+          int64_t row = -1;
+          if (csr != nullptr) {
+            row = csr->find_row(node_id);
+          } else {
+            node = find_node(GraphTableType::EDGE_TABLE, idx, node_id);
+          }
           int idy = seq_id[i][k];
           int &actual_size = actual_sizes[idy];
-          if (node == nullptr) {
+          if (node == nullptr && row < 0) {
 #ifdef PADDLE_WITH_GPU_GRAPH
             if (search_level == 2) {
               VLOG(2) << "enter sample from ssd for node_id " << node_id;
@@ -2826,7 +3162,9 @@ int32_t GraphTable::random_sample_neighbors(
             continue;
           }
           std::shared_ptr<char> &buffer = buffers[idy];
-          std::vector<int> res = node->sample_k(sample_size, rng);
+          std::vector<int> res = csr != nullptr
+                                     ? csr->sample_k(row, sample_size, rng)
+                                     : node->sample_k(sample_size, rng);
           actual_size =
               res.size() * (need_weight ? (Node::id_size + Node::weight_size)
                                         : Node::id_size);
@@ -2842,10 +3180,15 @@ int32_t GraphTable::random_sample_neighbors(
             buffer.reset(buffer_addr, char_del);
           }
           for (int &x : res) {
-            id = node->get_neighbor_id(x);
+            id = csr != nullptr ? csr->get_neighbor_id(row, x)
+                                : node->get_neighbor_id(x);
             memcpy(buffer_addr + offset, &id, Node::id_size);
             offset += Node::id_size;
-            if (need_weight) {
+            if (need_weight && csr != nullptr) {
+              weight = csr->get_neighbor_weight(row, x);
+              memcpy(buffer_addr + offset, &weight, Node::weight_size);
+              offset += Node::weight_size;
+            } else if (need_weight) {
 #ifdef PADDLE_WITH_GPU_GRAPH
               weight = node->get_neighbor_weight(x);
 #else
@@ -2934,10 +3277,13 @@ int32_t GraphTable::get_node_feat(int idx,
     uint64_t node_id = node_ids[idy];
     tasks.push_back(_shards_task_pool[get_thread_pool_index(node_id)]->enqueue(
         [&, idx, idy, node_id]() -> int {
-          Node *node = find_node(GraphTableType::FEATURE_TABLE, idx, node_id);
-
-          if (node == nullptr) {
-            return 0;
+          auto columns = find_feature_columns(idx, node_id);
+          Node *node = nullptr;
+          if (columns.first == nullptr) {
+            node = find_node(GraphTableType::FEATURE_TABLE, idx, node_id);
+            if (node == nullptr) {
+              return 0;
+            }
           }
           for (size_t feat_idx = 0; feat_idx < feature_names.size();
                ++feat_idx) {
@@ -2945,8 +3291,11 @@ int32_t GraphTable::get_node_feat(int idx,
             if (feat_id_map[idx].find(feature_name) != feat_id_map[idx].end()) {
               // res[feat_idx][idx] =
               // node->get_feature(feat_id_map[feature_name]);
-              auto feat = node->get_feature(feat_id_map[idx][feature_name]);
-              res[feat_idx][idy] = feat;
+              int slot_idx = feat_id_map[idx][feature_name];
+              res[feat_idx][idy] =
+                  columns.first != nullptr
+                      ? columns.first->get_feature(columns.second, slot_idx)
+                      : node->get_feature(slot_idx);
             }
           }
           return 0;
@@ -3313,6 +3662,8 @@ int32_t GraphTable::pull_graph_list(GraphTableType table_type,
       : table_type == GraphTableType::FEATURE_TABLE ? feature_shards[idx]
                                                     : node_shards[idx];
   std::vector<std::future<std::vector<Node *>>> tasks;
+  // nodes of csr or columnar shards are copies to be released here
+  std::vector<bool> is_compact;
   for (size_t i = 0; i < search_shards.size() && total_size > 0; i++) {
     cur_size = search_shards[i]->get_size();
     if (size + cur_size <= start) {
@@ -3321,6 +3672,7 @@ int32_t GraphTable::pull_graph_list(GraphTableType table_type,
     }
     int count = std::min(1 + (size + cur_size - start - 1) / step, total_size);
     int end = start + (count - 1) * step + 1;
+    is_compact.push_back(search_shards[i]->is_compact());
     tasks.push_back(_shards_task_pool[i % task_pool_size_]->enqueue(
         [&search_shards, this, i, start, end, step, size]()
             -> std::vector<Node *> {
@@ -3344,10 +3696,14 @@ int32_t GraphTable::pull_graph_list(GraphTableType table_type,
   char *buffer_addr = new char[size];
   buffer.reset(buffer_addr);
   int index = 0;
-  for (auto &items : res) {
+  for (size_t i = 0; i < res.size(); i++) {
+    auto &items = res[i];
     for (size_t j = 0; j < items.size(); j++) {
       items[j]->to_buffer(buffer_addr + index, need_feature);
       index += items[j]->get_size(need_feature);
+      if (is_compact[i]) {
+        delete items[j];
+      }
     }
   }
   actual_size = size;
@@ -3413,6 +3769,8 @@ void GraphTable::load_node_weight(int type_id, int idx, std::string path) {
 int32_t GraphTable::Initialize(const GraphParameter &graph) {
   task_pool_size_ = graph.task_pool_size();
   build_sampler_on_cpu = graph.build_sampler_on_cpu();
+  use_csr_edges_ = graph.use_csr_edges();
+  use_feature_columns_ = graph.use_feature_columns();
 
 #ifdef PADDLE_WITH_GPU_GRAPH
   _db = NULL;
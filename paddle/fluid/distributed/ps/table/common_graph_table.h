@@ -41,6 +41,8 @@
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
 #include "paddle/fluid/distributed/ps/table/graph/class_macro.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_edge.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_feature_columns.h"
 #include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
 #include "paddle/fluid/distributed/ps/thirdparty/round_robin.h"
 #include "paddle/fluid/string/string_helper.h"
@@ -58,22 +60,34 @@ class GraphShard {
   GraphShard() {}
   ~GraphShard();
   std::vector<Node *> &get_bucket() { return bucket; }
+  // In csr or columnar mode the returned nodes are copies owned by the
+  // caller.
   std::vector<Node *> get_batch(int start, int end, int step);
+  uint64_t get_id(int pos) {
+    if (csr_ != nullptr) {
+      return csr_->get_id(pos);
+    }
+    if (columns_ != nullptr) {
+      return columns_->get_id(pos);
+    }
+    return bucket[pos]->get_id();
+  }
   void get_ids_by_range(int start, int end, std::vector<uint64_t> *res) {
+    int size = static_cast<int>(get_size());
     res->reserve(res->size() + end - start);
-    for (int i = start; i < end && i < static_cast<int>(bucket.size()); i++) {
-      res->emplace_back(bucket[i]->get_id());
+    for (int i = start; i < end && i < size; i++) {
+      res->emplace_back(get_id(i));
     }
   }
   size_t get_all_id(std::vector<std::vector<uint64_t>> *shard_keys,
                     int slice_num) {
-    int bucket_num = bucket.size();
+    int bucket_num = get_size();
     shard_keys->resize(slice_num);
     for (int i = 0; i < slice_num; ++i) {
       (*shard_keys)[i].reserve(bucket_num / slice_num);
     }
     for (int i = 0; i < bucket_num; i++) {
-      uint64_t k = bucket[i]->get_id();
+      uint64_t k = get_id(i);
       (*shard_keys)[k % slice_num].emplace_back(k);
     }
     return bucket_num;
@@ -81,6 +95,15 @@ class GraphShard {
   size_t get_all_neighbor_id(std::vector<std::vector<uint64_t>> *total_res,
                              int slice_num) {
     std::vector<uint64_t> keys;
+    if (csr_ != nullptr) {
+      keys.reserve(csr_->edge_size());
+      for (size_t i = 0; i < csr_->node_size(); i++) {
+        for (size_t j = 0; j < csr_->get_degree(i); j++) {
+          keys.push_back(csr_->get_neighbor_id(i, j));
+        }
+      }
+      return dedup2shard_keys(&keys, total_res, slice_num);
+    }
     for (size_t i = 0; i < bucket.size(); i++) {
       size_t neighbor_size = bucket[i]->get_neighbor_size();
       size_t n = keys.size();
@@ -94,6 +117,9 @@ class GraphShard {
   size_t get_all_feature_ids(std::vector<std::vector<uint64_t>> *total_res,
                              int slice_num) {
     std::vector<uint64_t> keys;
+    if (columns_ != nullptr) {
+      columns_->get_all_feature_ids(&keys);
+    }
     for (size_t i = 0; i < bucket.size(); i++) {
       bucket[i]->get_feature_ids(&keys);
     }
@@ -132,6 +158,21 @@ class GraphShard {
   std::unordered_map<uint64_t, int> &get_node_location() {
     return node_location;
   }
+  // Moves the edges of all nodes into an immutable csr blob and releases
+  // the nodes. Adding or deleting nodes afterwards decompacts the shard.
+  void build_csr(bool is_weighted);
+  bool is_csr() const { return csr_ != nullptr; }
+  CsrEdgeBlob *get_csr() { return csr_.get(); }
+  // Moves the slot features of all nodes into immutable columns and
+  // releases the nodes. Adding or deleting nodes afterwards decompacts the
+  // shard.
+  void build_columns(int slot_num, int float_slot_num);
+  GraphFeatureColumns *get_columns() { return columns_.get(); }
+  bool is_compact() const { return csr_ != nullptr || columns_ != nullptr; }
+  // Moves the nodes of the csr blob or the columns back into the bucket,
+  // so that more nodes can be loaded into the shard. The shard is compacted
+  // again by build_csr or build_columns.
+  void decompact();
 
   void shrink_to_fit() {
     bucket.shrink_to_fit();
@@ -141,6 +182,8 @@ class GraphShard {
   }
 
   void merge_shard(GraphShard *&shard) {  // NOLINT
+    decompact();
+    shard->decompact();
     bucket.reserve(bucket.size() + shard->bucket.size());
     for (size_t i = 0; i < shard->bucket.size(); i++) {
       auto node_id = shard->bucket[i]->get_id();
@@ -158,10 +201,24 @@ class GraphShard {
  public:
   std::unordered_map<uint64_t, int> node_location;
   std::vector<Node *> bucket;
+  std::unique_ptr<CsrEdgeBlob> csr_;
+  std::unique_ptr<GraphFeatureColumns> columns_;
 };
 
 enum LRUResponse { ok = 0, blocked = 1, err = 2 };
 
+// Slot features of a batch of nodes in contiguous arrays. The uint64
+// features of node i are feature_ids[feature_offsets[i], feature_offsets[i +
+// 1]) with their slots in slot_ids, and likewise for the float features.
+struct GraphNodeFeatures {
+  std::vector<uint64_t> feature_offsets;
+  std::vector<uint64_t> feature_ids;
+  std::vector<uint8_t> slot_ids;
+  std::vector<uint64_t> float_feature_offsets;
+  std::vector<float> float_features;
+  std::vector<uint8_t> float_slot_ids;
+};
+
 struct SampleKey {
   int idx;
   uint64_t node_key;
@@ -686,6 +743,15 @@ class GraphTable : public Table {
       const std::vector<std::string> &feature_names,
       std::vector<std::vector<std::string>> &res);  // NOLINT
 
+  // Gathers the first slot_num uint64 slots and float_slot_num float slots
+  // of node_ids into res, from feature nodes or feature columns. The gpu
+  // GraphDataGenerator still takes features from make_gpu_ps_graph_fea.
+  int32_t get_node_slot_features(const uint64_t *node_ids,
+                                 size_t node_num,
+                                 int slot_num,
+                                 int float_slot_num,
+                                 GraphNodeFeatures *res);
+
   virtual int32_t set_node_feat(
       int idx,
       const std::vector<uint64_t> &node_ids,              // NOLINT
@@ -769,6 +835,16 @@ class GraphTable : public Table {
 #endif
   virtual int32_t add_comm_edge(int idx, uint64_t src_id, uint64_t dst_id);
   virtual int32_t build_sampler(int idx, std::string sample_type = "random");
+  // Compacts the loaded edges of edge type idx into csr blobs.
+  void build_csr_edges(int idx);
+  CsrEdgeBlob *find_csr_edges(int idx, uint64_t id);
+  // Compacts the loaded feature nodes into feature columns.
+  void build_feature_columns();
+  // Returns the feature columns holding id and the row of id in them, or
+  // {nullptr, -1}.
+  std::pair<GraphFeatureColumns *, int64_t> find_feature_columns(int idx,
+                                                                 uint64_t id);
+  std::pair<GraphFeatureColumns *, int64_t> find_feature_columns(uint64_t id);
   void set_slot_feature_separator(const std::string &ch);
   void set_feature_separator(const std::string &ch);
 
@@ -833,6 +909,8 @@ class GraphTable : public Table {
   int cache_ttl;
   mutable std::mutex mutex_;
   bool build_sampler_on_cpu;
+  bool use_csr_edges_ = false;
+  bool use_feature_columns_ = false;
   bool is_load_reverse_edge = false;
   std::shared_ptr<pthread_rwlock_t> rw_lock;
 #ifdef PADDLE_WITH_HETERPS
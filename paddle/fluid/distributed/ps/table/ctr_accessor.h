@@ -187,6 +187,8 @@ class CtrCommonAccessor : public ValueAccessor {
     return 0.0;
   }
 
+  size_t GetPushStatDim() override { return CtrCommonPushValue::EmbedGIndex(); }
+
  private:
   // float ShowClickScore(float show, float click);
 
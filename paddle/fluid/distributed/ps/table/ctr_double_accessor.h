@@ -208,6 +208,8 @@ class CtrDoubleAccessor : public ValueAccessor {
     }
     return 0.0;
   }
+
+  size_t GetPushStatDim() override { return CtrDoublePushValue::EmbedGIndex(); }
   // DEFINE_GET_INDEX(CtrDoubleFeatureValue, show)
   // DEFINE_GET_INDEX(CtrDoubleFeatureValue, click)
   // DEFINE_GET_INDEX(CtrDoubleFeatureValue, embed_w)
@@ -244,6 +244,8 @@ class CtrDymfAccessor : public ValueAccessor {
     return 0.0;
   }
 
+  size_t GetPushStatDim() override { return CtrDymfPushValue::EmbedGIndex(); }
+
   robin_hood::unordered_set<float>* GetFilteredSlots() override {
     return &_filtered_slots;
   }
@@ -0,0 +1,114 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#define PSERVER_BINARY_SAVE_SUFFIX ".bin"
+
+namespace paddle {
+namespace distributed {
+
+// Binary checkpoint layout of one sparse table shard:
+//
+//   BinaryShardHeader
+//   key_num fixed-width records of record_bytes each:
+//     uint64_t key | uint32_t value_size | uint32_t pad | float[value_dim]
+//
+// Every record has the same width, so a shard is written with large
+// sequential writes and loaded by walking a memory-mapped file.
+static const char kBinaryShardMagic[8] = {
+    'P', 'S', 'B', 'S', 'H', 'A', 'R', 'D'};
+static const uint32_t kBinaryShardVersion = 1;
+
+struct BinaryShardHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t value_dim;  // float num reserved for each value
+  uint64_t key_num;
+  uint64_t record_bytes;
+};
+static_assert(sizeof(BinaryShardHeader) == 32,
+              "BinaryShardHeader is part of the file format");
+
+static const size_t kBinaryShardRecordHead =
+    sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+inline size_t BinaryShardRecordBytes(uint32_t value_dim) {
+  return kBinaryShardRecordHead + value_dim * sizeof(float);
+}
+
+inline bool IsBinaryShardFile(const std::string& path) {
+  static const size_t suffix_len = strlen(PSERVER_BINARY_SAVE_SUFFIX);
+  return path.size() >= suffix_len &&
+         path.compare(path.size() - suffix_len,
+                      suffix_len,
+                      PSERVER_BINARY_SAVE_SUFFIX) == 0;
+}
+
+inline void InitBinaryShardHeader(BinaryShardHeader* header,
+                                  uint32_t value_dim,
+                                  uint64_t key_num) {
+  memcpy(header->magic, kBinaryShardMagic, sizeof(kBinaryShardMagic));
+  header->version = kBinaryShardVersion;
+  header->value_dim = value_dim;
+  header->key_num = key_num;
+  header->record_bytes = BinaryShardRecordBytes(value_dim);
+}
+
+inline bool CheckBinaryShardHeader(const BinaryShardHeader& header,
+                                   uint32_t value_dim) {
+  return memcmp(header.magic, kBinaryShardMagic, sizeof(kBinaryShardMagic)) ==
+             0 &&
+         header.version == kBinaryShardVersion &&
+         header.value_dim == value_dim &&
+         header.record_bytes == BinaryShardRecordBytes(value_dim);
+}
+
+// Writes one record into dst, which must hold BinaryShardRecordBytes bytes.
+// Floats beyond value_size are zero filled.
+inline void EncodeBinaryShardRecord(char* dst,
+                                    uint64_t key,
+                                    const float* value,
+                                    uint32_t value_size,
+                                    uint32_t value_dim) {
+  uint32_t pad = 0;
+  memcpy(dst, &key, sizeof(key));
+  memcpy(dst + sizeof(key), &value_size, sizeof(value_size));
+  memcpy(dst + sizeof(key) + sizeof(value_size), &pad, sizeof(pad));
+  char* value_dst = dst + kBinaryShardRecordHead;
+  memcpy(value_dst, value, value_size * sizeof(float));
+  if (value_size < value_dim) {
+    memset(value_dst + value_size * sizeof(float),
+           0,
+           (value_dim - value_size) * sizeof(float));
+  }
+}
+
+// Decodes the record head, value points into src (4-byte aligned when src
+// is a record of a mapped file).
+inline void DecodeBinaryShardRecord(const char* src,
+                                    uint64_t* key,
+                                    uint32_t* value_size,
+                                    const char** value) {
+  memcpy(key, src, sizeof(*key));
+  memcpy(value_size, src + sizeof(*key), sizeof(*value_size));
+  *value = src + kBinaryShardRecordHead;
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
 #include <vector>
 
 #include <mct/hash-map.hpp>
@@ -28,19 +31,250 @@ static const int CTR_SPARSE_SHARD_BUCKET_NUM_BITS = 6;
 static const size_t CTR_SPARSE_SHARD_BUCKET_NUM =
     static_cast<size_t>(1) << CTR_SPARSE_SHARD_BUCKET_NUM_BITS;
 
+// Fixed-stride float slots shared by the values of a shard. The slots are
+// carved out of large blocks, so the values of a shard are packed together
+// instead of being separate heap allocations, and the released slots are
+// reused by the next ones. It is not thread safe, like the shard itself.
+class FeatureValueSlab {
+ public:
+  explicit FeatureValueSlab(size_t block_slots = 512)
+      : _block_slots(block_slots) {}
+  FeatureValueSlab(const FeatureValueSlab&) = delete;
+  FeatureValueSlab& operator=(const FeatureValueSlab&) = delete;
+  ~FeatureValueSlab() { clear(); }
+
+  // Values of up to stride floats are kept in the slab, 0 disables it.
+  void set_stride(size_t stride) {
+    CHECK(_used_slots == 0) << "set the stride of a slab in use";
+    clear();
+    _stride = stride;
+    // a released slot holds the pointer to the next free one
+    _slot_floats = std::max(stride, sizeof(float*) / sizeof(float));
+  }
+  size_t stride() const { return _stride; }
+  size_t used_slots() const { return _used_slots; }
+  size_t capacity_slots() const { return _blocks.size() * _block_slots; }
+  size_t capacity_bytes() const {
+    return capacity_slots() * _slot_floats * sizeof(float);
+  }
+
+  float* acquire() {
+    if (_free_slots == NULL) {
+      create_new_block();
+    }
+    float* slot = _free_slots;
+    memcpy(&_free_slots, slot, sizeof(float*));
+    ++_used_slots;
+    return slot;
+  }
+  void release(float* slot) {
+    memcpy(slot, &_free_slots, sizeof(float*));
+    _free_slots = slot;
+    --_used_slots;
+  }
+  // Frees all the blocks, no slot may be in use.
+  void clear() {
+    CHECK(_used_slots == 0) << "clear a slab in use";
+    for (float* block : _blocks) {
+      free(block);
+    }
+    _blocks.clear();
+    _free_slots = NULL;
+  }
+  void swap(FeatureValueSlab& other) {
+    std::swap(_block_slots, other._block_slots);
+    std::swap(_stride, other._stride);
+    std::swap(_slot_floats, other._slot_floats);
+    std::swap(_used_slots, other._used_slots);
+    std::swap(_free_slots, other._free_slots);
+    _blocks.swap(other._blocks);
+  }
+
+ private:
+  void create_new_block() {
+    size_t alloc_size = sizeof(float) * _slot_floats * _block_slots;
+    float* block = static_cast<float*>(malloc(alloc_size));
+    PADDLE_ENFORCE_NOT_NULL(block,
+                            paddle::platform::errors::ResourceExhausted(
+                                "Fail to alloc memory of %ld size.",
+                                alloc_size));
+    _blocks.push_back(block);
+    // chain the slots in address order, so they are handed out in order
+    for (size_t i = _block_slots; i > 0; --i) {
+      release(block + (i - 1) * _slot_floats);
+      ++_used_slots;
+    }
+  }
+
+  size_t _block_slots;  // how many slots in one block
+  size_t _stride = 0;
+  size_t _slot_floats = 0;
+  size_t _used_slots = 0;
+  float* _free_slots = NULL;  // a list
+  std::vector<float*> _blocks;
+};
+
+// The slabs of the two size classes of the values of a shard, the base
+// values without the mf part and the full ones. Most keys never extend the
+// mf part, so they take a slot of the base stride only.
+class FeatureValueSlabs {
+ public:
+  void set_strides(size_t base_stride, size_t full_stride) {
+    _base.set_stride(base_stride);
+    _full.set_stride(std::max(base_stride, full_stride));
+  }
+  size_t base_stride() const { return _base.stride(); }
+  size_t full_stride() const { return _full.stride(); }
+  // The slab to keep a value of size floats in, NULL if it is too large.
+  FeatureValueSlab* fit(size_t size) {
+    if (size <= _base.stride()) {
+      return &_base;
+    }
+    return size <= _full.stride() ? &_full : NULL;
+  }
+  // The slab whose slots have capacity floats, NULL for the heap.
+  FeatureValueSlab* holder(size_t capacity) {
+    if (capacity == _base.stride()) {
+      return &_base;
+    }
+    return capacity == _full.stride() ? &_full : NULL;
+  }
+  size_t used_slots() const { return _base.used_slots() + _full.used_slots(); }
+  size_t capacity_slots() const {
+    return _base.capacity_slots() + _full.capacity_slots();
+  }
+  size_t capacity_bytes() const {
+    return _base.capacity_bytes() + _full.capacity_bytes();
+  }
+  void clear() {
+    _base.clear();
+    _full.clear();
+  }
+  void swap(FeatureValueSlabs& other) {
+    _base.swap(other._base);
+    _full.swap(other._full);
+  }
+
+ private:
+  FeatureValueSlab _base;
+  FeatureValueSlab _full;
+};
+
+// The data of a feature value, kept in a slot of the smallest slab of its
+// shard it fits in, or on the heap otherwise. It is moved to the full slab
+// when the mf part is extended.
 class FixedFeatureValue {
  public:
   FixedFeatureValue() {}
-  ~FixedFeatureValue() {}
-  float* data() { return _data.data(); }
-  size_t size() { return _data.size(); }
-  void resize(size_t size) { _data.resize(size); }
-  void shrink_to_fit() { _data.shrink_to_fit(); }
+  FixedFeatureValue(const FixedFeatureValue& other) { *this = other; }
+  FixedFeatureValue& operator=(const FixedFeatureValue& other) {
+    if (this != &other) {
+      resize(other._size);
+      if (_size > 0) {
+        memcpy(_data, other._data, _size * sizeof(float));
+      }
+    }
+    return *this;
+  }
+  ~FixedFeatureValue() { release(); }
+  float* data() { return _data; }
+  size_t size() { return _size; }
+  void resize(size_t size) {
+    if (size == 0) {
+      release();
+      _size = 0;
+      return;
+    }
+    if (size > _capacity) {
+      FeatureValueSlab* slab = _slabs != NULL ? _slabs->fit(size) : NULL;
+      float* data = NULL;
+      size_t capacity = 0;
+      if (slab != NULL) {
+        data = slab->acquire();
+        capacity = slab->stride();
+      } else {
+        data = new float[size];
+        capacity = size;
+      }
+      if (_size > 0) {
+        memcpy(data, _data, _size * sizeof(float));
+      }
+      release();
+      _data = data;
+      _capacity = static_cast<uint32_t>(capacity);
+    }
+    if (size > _size) {
+      memset(_data + _size, 0, (size - _size) * sizeof(float));
+    }
+    _size = static_cast<uint32_t>(size);
+  }
+  void shrink_to_fit() {
+    if (_size == 0 || _capacity <= _size) {
+      return;
+    }
+    FeatureValueSlab* slab = _slabs != NULL ? _slabs->fit(_size) : NULL;
+    if (slab != NULL) {
+      if (slab != holder()) {
+        relocate(_slabs);
+      }
+      return;
+    }
+    float* data = new float[_size];
+    memcpy(data, _data, _size * sizeof(float));
+    delete[] _data;
+    _data = data;
+    _capacity = _size;
+  }
+
+  // Binds a new value to the slabs of its shard.
+  void set_slabs(FeatureValueSlabs* slabs) {
+    relocate(slabs);
+    _slabs = slabs;
+  }
+  // Copies the data into a slot of the smallest slab of target it fits in,
+  // the slabs of the value are swapped with target afterwards on compaction.
+  void relocate(FeatureValueSlabs* target) {
+    FeatureValueSlab* slab = _size > 0 ? target->fit(_size) : NULL;
+    if (slab == NULL) {
+      return;
+    }
+    float* slot = slab->acquire();
+    memcpy(slot, _data, _size * sizeof(float));
+    release();
+    _data = slot;
+    _capacity = static_cast<uint32_t>(slab->stride());
+  }
 
  private:
-  std::vector<float> _data;
+  // The values on the heap are larger than the strides of the slabs, so
+  // the slab of the data is told by its capacity.
+  FeatureValueSlab* holder() const {
+    return _data != NULL && _slabs != NULL ? _slabs->holder(_capacity) : NULL;
+  }
+  void release() {
+    FeatureValueSlab* slab = holder();
+    if (slab != NULL) {
+      slab->release(_data);
+    } else {
+      delete[] _data;
+    }
+    _data = NULL;
+    _capacity = 0;
+  }
+
+  float* _data = NULL;
+  FeatureValueSlabs* _slabs = NULL;
+  uint32_t _size = 0;
+  uint32_t _capacity = 0;
 };
 
+inline void AttachValueSlab(FixedFeatureValue* value,
+                            FeatureValueSlabs* slabs) {
+  value->set_slabs(slabs);
+}
+template <class VALUE>
+inline void AttachValueSlab(VALUE*, FeatureValueSlabs*) {}
+
 template <class KEY, class VALUE>
 struct alignas(64) SparseTableShard {
  public:
@@ -100,6 +334,13 @@ struct alignas(64) SparseTableShard {
       _buckets[bucket].max_load_factor(x);
     }
   }
+  // reserve room for size more keys, spread evenly over the buckets
+  void reserve(size_t size) {
+    size_t bucket_reserve = size / CTR_SPARSE_SHARD_BUCKET_NUM + 1;
+    for (size_t bucket = 0; bucket < CTR_SPARSE_SHARD_BUCKET_NUM; bucket++) {
+      _buckets[bucket].reserve(_buckets[bucket].size() + bucket_reserve);
+    }
+  }
   size_t bucket_count() { return CTR_SPARSE_SHARD_BUCKET_NUM; }
   size_t bucket_size(size_t bucket) { return _buckets[bucket].size(); }
   void clear() {
@@ -110,6 +351,30 @@ struct alignas(64) SparseTableShard {
       }
       data.clear();
     }
+    _slabs.clear();
+  }
+  // Values of up to base_stride floats are packed in the base slab of the
+  // shard, those of up to full_stride floats in the full one, the larger
+  // ones are kept on the heap. It is set before inserting any key.
+  void set_value_strides(size_t base_stride, size_t full_stride) {
+    CHECK(empty()) << "set the value strides of a non-empty shard";
+    _slabs.set_strides(base_stride, full_stride);
+  }
+  size_t value_slab_used() { return _slabs.used_slots(); }
+  size_t value_slab_capacity() { return _slabs.capacity_slots(); }
+  size_t value_slab_bytes() { return _slabs.capacity_bytes(); }
+  // Packs the values into as few slab blocks as possible, the blocks left
+  // sparse by erasing many keys, e.g. on Shrink, are freed.
+  void compact() {
+    FeatureValueSlabs compacted;
+    compacted.set_strides(_slabs.base_stride(), _slabs.full_stride());
+    for (size_t bucket = 0; bucket < CTR_SPARSE_SHARD_BUCKET_NUM; bucket++) {
+      map_type& data = _buckets[bucket];
+      for (auto it = data.begin(); it != data.end(); ++it) {
+        ((VALUE*)(void*)it->second)->relocate(&compacted);  // NOLINT
+      }
+    }
+    _slabs.swap(compacted);
   }
   iterator begin() {
     auto it = _buckets[0].begin();
@@ -150,7 +415,9 @@ struct alignas(64) SparseTableShard {
     auto res = _buckets[bucket].insert_with_hash({key, NULL}, hash);
 
     if (res.second) {
-      res.first->second = _alloc.acquire(std::forward<ARGS>(args)...);
+      VALUE* value = _alloc.acquire(std::forward<ARGS>(args)...);
+      AttachValueSlab(value, &_slabs);
+      res.first->second = value;
     }
 
     return {{res.first, bucket, _buckets}, res.second};
@@ -195,6 +462,7 @@ struct alignas(64) SparseTableShard {
 
  private:
   map_type _buckets[CTR_SPARSE_SHARD_BUCKET_NUM];
+  FeatureValueSlabs _slabs;
   ChunkAllocator<VALUE> _alloc;
   std::hash<KEY> _hasher;
 };
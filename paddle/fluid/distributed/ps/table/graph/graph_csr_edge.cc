@@ -0,0 +1,153 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_edge.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <unordered_set>
+#include <utility>
+
+namespace paddle {
+namespace distributed {
+
+void CsrEdgeBlob::build(const std::vector<Node *> &bucket, bool is_weighted) {
+  clear();
+  std::vector<Node *> nodes(bucket);
+  std::sort(nodes.begin(), nodes.end(), [](Node *a, Node *b) {
+    return a->get_id() < b->get_id();
+  });
+  size_t node_num = nodes.size();
+  node_ids_.resize(node_num);
+  offsets_.resize(node_num + 1);
+  offsets_[0] = 0;
+  for (size_t i = 0; i < node_num; i++) {
+    node_ids_[i] = nodes[i]->get_id();
+    offsets_[i + 1] = offsets_[i] + nodes[i]->get_neighbor_size();
+  }
+  neighbors_.resize(offsets_[node_num]);
+  if (is_weighted) {
+    weights_.resize(offsets_[node_num]);
+  }
+  for (size_t i = 0; i < node_num; i++) {
+    Node *node = nodes[i];
+    size_t degree = get_degree(i);
+    uint64_t *neighbors = neighbors_.data() + offsets_[i];
+    for (size_t j = 0; j < degree; j++) {
+      neighbors[j] = node->get_neighbor_id(j);
+    }
+    if (is_weighted) {
+      float *weights = weights_.data() + offsets_[i];
+      for (size_t j = 0; j < degree; j++) {
+        weights[j] = static_cast<float>(node->get_neighbor_weight(j));
+      }
+    }
+  }
+}
+
+void CsrEdgeBlob::clear() {
+  std::vector<uint64_t>().swap(node_ids_);
+  std::vector<uint64_t>().swap(offsets_);
+  std::vector<uint64_t>().swap(neighbors_);
+  std::vector<float>().swap(weights_);
+  weighted_sample_ = false;
+}
+
+int64_t CsrEdgeBlob::find_row(uint64_t id) const {
+  auto iter = std::lower_bound(node_ids_.begin(), node_ids_.end(), id);
+  if (iter == node_ids_.end() || *iter != id) {
+    return -1;
+  }
+  return iter - node_ids_.begin();
+}
+
+std::vector<int> CsrEdgeBlob::sample_k(
+    size_t row, int k, const std::shared_ptr<std::mt19937_64> rng) const {
+  if (weighted_sample_ && static_cast<size_t>(k) < get_degree(row)) {
+    return weighted_sample_k(row, k, rng);
+  }
+  return uniform_sample_k(get_degree(row), k, rng);
+}
+
+std::vector<int> CsrEdgeBlob::uniform_sample_k(
+    size_t n, int k, const std::shared_ptr<std::mt19937_64> rng) const {
+  std::vector<int> sample_result;
+  if (k <= 0) {
+    return sample_result;
+  }
+  if (static_cast<size_t>(k) >= n) {
+    sample_result.resize(n);
+    std::iota(sample_result.begin(), sample_result.end(), 0);
+    return sample_result;
+  }
+  // Floyd's algorithm: draws k distinct indexes with k random numbers. For
+  // the usual small k a linear scan of the result beats a hash set.
+  const int kLinearScanLimit = 64;
+  std::unordered_set<int> selected;
+  sample_result.reserve(k);
+  for (int j = static_cast<int>(n) - k; j < static_cast<int>(n); j++) {
+    std::uniform_int_distribution<int> distrib(0, j);
+    int rand_int = distrib(*rng);
+    if (k <= kLinearScanLimit) {
+      auto iter =
+          std::find(sample_result.begin(), sample_result.end(), rand_int);
+      if (iter != sample_result.end()) {
+        rand_int = j;
+      }
+    } else if (!selected.insert(rand_int).second) {
+      rand_int = j;
+      selected.insert(rand_int);
+    }
+    sample_result.push_back(rand_int);
+  }
+  return sample_result;
+}
+
+std::vector<int> CsrEdgeBlob::weighted_sample_k(
+    size_t row, int k, const std::shared_ptr<std::mt19937_64> rng) const {
+  // Efraimidis-Spirakis: keeping the k largest log(u) / w keys samples
+  // without replacement with probabilities proportional to the weights.
+  size_t degree = get_degree(row);
+  const float *weights = weights_.data() + offsets_[row];
+  std::uniform_real_distribution<float> distrib(
+      std::numeric_limits<float>::min(), 1.0);
+  std::vector<std::pair<float, int>> keys(degree);
+  for (size_t i = 0; i < degree; i++) {
+    float key = weights[i] > 0 ? std::log(distrib(*rng)) / weights[i]
+                               : -std::numeric_limits<float>::infinity();
+    keys[i] = std::make_pair(key, static_cast<int>(i));
+  }
+  std::nth_element(keys.begin(),
+                   keys.begin() + k,
+                   keys.end(),
+                   std::greater<std::pair<float, int>>());
+  std::vector<int> sample_result(k);
+  for (int i = 0; i < k; i++) {
+    sample_result[i] = keys[i].second;
+  }
+  return sample_result;
+}
+
+size_t CsrEdgeBlob::memory_size() const {
+  return node_ids_.capacity() * sizeof(uint64_t) +
+         offsets_.capacity() * sizeof(uint64_t) +
+         neighbors_.capacity() * sizeof(uint64_t) +
+         weights_.capacity() * sizeof(float);
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,82 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
+
+namespace paddle {
+namespace distributed {
+
+// Immutable compressed sparse row (CSR) adjacency of one edge shard.
+// Node ids are kept sorted, and the neighbors of the node in row i are
+// neighbors_[offsets_[i], offsets_[i + 1]). Compared to one GraphNode per
+// node, with its own edge blob and sampler, this costs 16 bytes per node
+// plus 8 (12 if weighted) bytes per edge, and keeps the neighbors of a node
+// in one contiguous range.
+class CsrEdgeBlob {
+ public:
+  CsrEdgeBlob() {}
+  ~CsrEdgeBlob() {}
+
+  // Builds the adjacency from the edges of the nodes in bucket. The nodes
+  // are not released, which is left to the caller.
+  void build(const std::vector<Node *> &bucket, bool is_weighted);
+  void clear();
+  void set_weighted_sample(bool weighted_sample) {
+    weighted_sample_ = weighted_sample && is_weighted();
+  }
+
+  size_t node_size() const { return node_ids_.size(); }
+  size_t edge_size() const { return neighbors_.size(); }
+  bool is_weighted() const { return !weights_.empty(); }
+  // Returns the row of id, or -1 if id has no row in this blob.
+  int64_t find_row(uint64_t id) const;
+  uint64_t get_id(size_t row) const { return node_ids_[row]; }
+  size_t get_degree(size_t row) const {
+    return offsets_[row + 1] - offsets_[row];
+  }
+  uint64_t get_neighbor_id(size_t row, int idx) const {
+    return neighbors_[offsets_[row] + idx];
+  }
+  float get_neighbor_weight(size_t row, int idx) const {
+    return weights_.empty() ? 1.0 : weights_[offsets_[row] + idx];
+  }
+  // Samples at most k distinct neighbor indexes of row without replacement.
+  // Sampling is uniform unless weighted sample is set on a weighted blob.
+  std::vector<int> sample_k(size_t row,
+                            int k,
+                            const std::shared_ptr<std::mt19937_64> rng) const;
+  size_t memory_size() const;
+
+ private:
+  std::vector<int> uniform_sample_k(
+      size_t n, int k, const std::shared_ptr<std::mt19937_64> rng) const;
+  std::vector<int> weighted_sample_k(
+      size_t row, int k, const std::shared_ptr<std::mt19937_64> rng) const;
+
+  std::vector<uint64_t> node_ids_;
+  std::vector<uint64_t> offsets_;
+  std::vector<uint64_t> neighbors_;
+  std::vector<float> weights_;
+  bool weighted_sample_ = false;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -25,6 +25,8 @@ void WeightedGraphEdgeBlob::add_edge(int64_t id, float weight = 1) {
   id_arr.push_back(id);
 #ifdef PADDLE_WITH_CUDA
   weight_arr.push_back((half)weight);
+#else
+  weight_arr.push_back(weight);
 #endif
 }
 }  // namespace distributed
@@ -0,0 +1,161 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_feature_columns.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace paddle {
+namespace distributed {
+
+void GraphFeatureColumns::build(const std::vector<Node *> &bucket,
+                                int slot_num,
+                                int float_slot_num) {
+  std::vector<Node *> nodes(bucket);
+  std::sort(nodes.begin(), nodes.end(), [](Node *a, Node *b) {
+    return a->get_id() < b->get_id();
+  });
+  size_t node_num = nodes.size();
+  node_ids_.resize(node_num);
+  offsets_.assign(slot_num, std::vector<uint32_t>(node_num + 1, 0));
+  values_.assign(slot_num, std::vector<uint64_t>());
+  float_offsets_.assign(float_slot_num,
+                        std::vector<uint32_t>(node_num + 1, 0));
+  float_values_.assign(float_slot_num, std::vector<float>());
+
+  std::vector<uint64_t> feature_ids;
+  std::vector<float> float_features;
+  std::vector<uint8_t> slot_ids;
+  for (size_t i = 0; i < node_num; i++) {
+    Node *node = nodes[i];
+    node_ids_[i] = node->get_id();
+    for (int slot = 0; slot < slot_num; slot++) {
+      node->get_feature_ids(slot, &feature_ids);
+      auto &values = values_[slot];
+      values.insert(values.end(), feature_ids.begin(), feature_ids.end());
+      PADDLE_ENFORCE_LE(values.size(),
+                        std::numeric_limits<uint32_t>::max(),
+                        ::paddle::platform::errors::OutOfRange(
+                            "Too many features in slot %d of a shard.", slot));
+      offsets_[slot][i + 1] = values.size();
+    }
+    for (int slot = 0; slot < float_slot_num; slot++) {
+      float_features.clear();
+      node->get_float_feature(slot, float_features, slot_ids);
+      auto &values = float_values_[slot];
+      values.insert(values.end(), float_features.begin(), float_features.end());
+      PADDLE_ENFORCE_LE(
+          values.size(),
+          std::numeric_limits<uint32_t>::max(),
+          ::paddle::platform::errors::OutOfRange(
+              "Too many features in float slot %d of a shard.", slot));
+      float_offsets_[slot][i + 1] = values.size();
+    }
+    slot_ids.clear();
+  }
+  for (auto &values : values_) {
+    values.shrink_to_fit();
+  }
+  for (auto &values : float_values_) {
+    values.shrink_to_fit();
+  }
+}
+
+int64_t GraphFeatureColumns::find_row(uint64_t id) const {
+  auto iter = std::lower_bound(node_ids_.begin(), node_ids_.end(), id);
+  if (iter == node_ids_.end() || *iter != id) {
+    return -1;
+  }
+  return iter - node_ids_.begin();
+}
+
+std::string GraphFeatureColumns::get_feature(size_t row, int slot_idx) const {
+  if (slot_idx >= slot_num()) {
+    return std::string("");
+  }
+  return std::string(
+      reinterpret_cast<const char *>(get_feature_data(row, slot_idx)),
+      get_feature_size(row, slot_idx) * sizeof(uint64_t));
+}
+
+int GraphFeatureColumns::get_feature_ids(size_t row,
+                                         int slot_idx,
+                                         std::vector<uint64_t> &feature_id,
+                                         std::vector<uint8_t> &slot_id) const {
+  if (slot_idx >= slot_num()) {
+    return 0;
+  }
+  size_t num = get_feature_size(row, slot_idx);
+  const uint64_t *feas = get_feature_data(row, slot_idx);
+  feature_id.insert(feature_id.end(), feas, feas + num);
+  slot_id.insert(slot_id.end(), num, slot_idx);
+  return num;
+}
+
+int GraphFeatureColumns::get_float_feature(
+    size_t row,
+    int slot_idx,
+    std::vector<float> &float_feature,
+    std::vector<uint8_t> &slot_id) const {
+  if (slot_idx >= float_slot_num()) {
+    return 0;
+  }
+  size_t num = get_float_feature_size(row, slot_idx);
+  const float *feas = get_float_feature_data(row, slot_idx);
+  float_feature.insert(float_feature.end(), feas, feas + num);
+  slot_id.insert(slot_id.end(), num, slot_idx);
+  return num;
+}
+
+void GraphFeatureColumns::get_all_feature_ids(
+    std::vector<uint64_t> *res) const {
+  for (auto &values : values_) {
+    res->insert(res->end(), values.begin(), values.end());
+  }
+}
+
+FeatureNode *GraphFeatureColumns::to_node(size_t row) const {
+  FeatureNode *node = float_slot_num() > 0 ? new FloatFeatureNode(get_id(row))
+                                           : new FeatureNode(get_id(row));
+  node->set_feature_size(slot_num());
+  for (int slot = 0; slot < slot_num(); slot++) {
+    node->set_feature(slot, get_feature(row, slot));
+  }
+  if (float_slot_num() > 0) {
+    node->set_float_feature_size(float_slot_num());
+    for (int slot = 0; slot < float_slot_num(); slot++) {
+      node->mutable_float_feature(slot)->assign(
+          reinterpret_cast<const char *>(get_float_feature_data(row, slot)),
+          get_float_feature_size(row, slot) * sizeof(float));
+    }
+  }
+  return node;
+}
+
+size_t GraphFeatureColumns::memory_size() const {
+  size_t size = node_ids_.capacity() * sizeof(uint64_t);
+  for (int slot = 0; slot < slot_num(); slot++) {
+    size += offsets_[slot].capacity() * sizeof(uint32_t) +
+            values_[slot].capacity() * sizeof(uint64_t);
+  }
+  for (int slot = 0; slot < float_slot_num(); slot++) {
+    size += float_offsets_[slot].capacity() * sizeof(uint32_t) +
+            float_values_[slot].capacity() * sizeof(float);
+  }
+  return size;
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,89 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
+
+namespace paddle {
+namespace distributed {
+
+// Immutable columnar slot features of the nodes of one feature shard. Node
+// ids are kept sorted, and the features of slot s of the node in row i are
+// values_[s][offsets_[s][i], offsets_[s][i + 1]), packed without the
+// std::string per slot and per node that FeatureNode keeps. Float slots are
+// stored the same way in float_offsets_ and float_values_.
+class GraphFeatureColumns {
+ public:
+  GraphFeatureColumns() {}
+  ~GraphFeatureColumns() {}
+
+  // Builds the columns from the first slot_num uint64 slots and the first
+  // float_slot_num float slots of the nodes in bucket. The nodes are not
+  // released, which is left to the caller.
+  void build(const std::vector<Node *> &bucket,
+             int slot_num,
+             int float_slot_num);
+
+  size_t node_size() const { return node_ids_.size(); }
+  int slot_num() const { return static_cast<int>(values_.size()); }
+  int float_slot_num() const { return static_cast<int>(float_values_.size()); }
+  // Returns the row of id, or -1 if id has no row in the columns.
+  int64_t find_row(uint64_t id) const;
+  uint64_t get_id(size_t row) const { return node_ids_[row]; }
+
+  size_t get_feature_size(size_t row, int slot_idx) const {
+    return offsets_[slot_idx][row + 1] - offsets_[slot_idx][row];
+  }
+  const uint64_t *get_feature_data(size_t row, int slot_idx) const {
+    return values_[slot_idx].data() + offsets_[slot_idx][row];
+  }
+  size_t get_float_feature_size(size_t row, int slot_idx) const {
+    return float_offsets_[slot_idx][row + 1] - float_offsets_[slot_idx][row];
+  }
+  const float *get_float_feature_data(size_t row, int slot_idx) const {
+    return float_values_[slot_idx].data() + float_offsets_[slot_idx][row];
+  }
+
+  // Same as the FeatureNode methods of the same names.
+  std::string get_feature(size_t row, int slot_idx) const;
+  int get_feature_ids(size_t row,
+                      int slot_idx,
+                      std::vector<uint64_t> &feature_id,     // NOLINT
+                      std::vector<uint8_t> &slot_id) const;  // NOLINT
+  int get_float_feature(size_t row,
+                        int slot_idx,
+                        std::vector<float> &float_feature,     // NOLINT
+                        std::vector<uint8_t> &slot_id) const;  // NOLINT
+  // Appends the features of all uint64 slots of all nodes to res.
+  void get_all_feature_ids(std::vector<uint64_t> *res) const;
+  // Returns a new FeatureNode holding the features of row, owned by the
+  // caller.
+  FeatureNode *to_node(size_t row) const;
+  size_t memory_size() const;
+
+ private:
+  std::vector<uint64_t> node_ids_;
+  std::vector<std::vector<uint32_t>> offsets_;
+  std::vector<std::vector<uint64_t>> values_;
+  std::vector<std::vector<uint32_t>> float_offsets_;
+  std::vector<std::vector<float>> float_values_;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -12,13 +12,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <fcntl.h>
 #include <omp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <sstream>
 
 #include "glog/logging.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
 #include "paddle/fluid/distributed/common/local_random.h"
 #include "paddle/fluid/distributed/common/topk_calculator.h"
+#include "paddle/fluid/distributed/ps/table/depends/binary_shard_format.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
 #include "paddle/fluid/framework/archive.h"
 #include "paddle/fluid/framework/io/fs.h"
@@ -38,10 +45,17 @@ PD_DEFINE_bool(pserver_enable_create_feasign_randomly,
 PD_DEFINE_int32(pserver_table_save_max_retry,
                 3,
                 "pserver_table_save_max_retry");
+PD_DEFINE_double(pserver_sparse_slab_compact_ratio,
+                 0.5,
+                 "compact the value slab of a shard after shrink when the "
+                 "ratio of used slots is lower than it");
 
 namespace paddle {
 namespace distributed {
 
+// keys packed into one block when streaming binary shards
+static const size_t kBinaryShardBlockKeys = 8192;
+
 int32_t MemorySparseTable::Initialize() {
   auto &profiler = CostProfiler::instance();
   profiler.register_profiler("pserver_sparse_update_all");
@@ -75,7 +89,7 @@ int32_t MemorySparseTable::InitializeValue() {
           << " _real_local_shard_num: " << _real_local_shard_num
           << " _task_pool_size:" << _task_pool_size;
 
-  _local_shards.reset(new shard_type[_real_local_shard_num]);
+  _local_shards.reset(CreateShards(_real_local_shard_num));
 
   if (_config.enable_revert()) {
     // calculate merged shard number based on config param;
@@ -99,11 +113,35 @@ int32_t MemorySparseTable::InitializeValue() {
     LOG(INFO) << "merged shard info: [" << _m_sparse_table_shard_num << "|"
               << _m_avg_local_shard_num << "|" << _m_real_local_shard_num
               << "]";
-    _local_shards_new.reset(new shard_type[_real_local_shard_num]);  // NOLINT
+    _local_shards_new.reset(CreateShards(_real_local_shard_num));
   }
   return 0;
 }
 
+MemorySparseTable::shard_type *MemorySparseTable::CreateShards(int shard_num) {
+  auto *shards = new shard_type[shard_num];  // NOLINT
+  // the values of a shard are packed in fixed-stride slots, those without
+  // the mf part in slots of the base dim, the extended ones of the full dim
+  const auto &accessor_info = _value_accesor->GetAccessorInfo();
+  size_t full_dim = accessor_info.size / sizeof(float);
+  size_t base_dim = full_dim - accessor_info.mf_size / sizeof(float);
+  for (int i = 0; i < shard_num; ++i) {
+    shards[i].set_value_strides(base_dim, full_dim);
+  }
+  return shards;
+}
+
+void MemorySparseTable::CompactShard(shard_type *shard) {
+  size_t capacity = shard->value_slab_capacity();
+  if (capacity == 0 || shard->value_slab_used() >=
+                           FLAGS_pserver_sparse_slab_compact_ratio * capacity) {
+    return;
+  }
+  shard->compact();
+  VLOG(1) << "MemorySparseTable compact shard, slab capacity:" << capacity
+          << " -> " << shard->value_slab_capacity();
+}
+
 int32_t MemorySparseTable::Load(const std::string &path,
                                 const std::string &param) {
   std::string table_path = TableDir(path);
@@ -162,32 +200,43 @@ int32_t MemorySparseTable::Load(const std::string &path,
     do {
       is_read_failed = false;
       err_no = 0;
-      std::string line_data;
-      auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
-      char *end = NULL;
-      auto &shard = _local_shards[i];
-      try {
-        while (read_channel->read_line(line_data) == 0 &&
-               line_data.size() > 1) {
-          uint64_t key = std::strtoul(line_data.data(), &end, 10);
-          auto &value = shard[key];
-          value.resize(feature_value_size);
-          int parse_size = _value_accesor->ParseFromString(++end, value.data());
-          value.resize(parse_size);
-        }
-        read_channel->close();
-        if (err_no == -1) {
+      if (IsBinaryShardFile(channel_config.path)) {
+        if (0 != LoadBinaryShard(channel_config.path, &_local_shards[i])) {
           ++retry_num;
           is_read_failed = true;
           LOG(ERROR)
-              << "MemorySparseTable load failed after read, retry it! path:"
+              << "MemorySparseTable load binary shard failed, retry it! path:"
               << channel_config.path << " , retry_num=" << retry_num;
         }
-      } catch (...) {
-        ++retry_num;
-        is_read_failed = true;
-        LOG(ERROR) << "MemorySparseTable load failed, retry it! path:"
-                   << channel_config.path << " , retry_num=" << retry_num;
+      } else {
+        std::string line_data;
+        auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
+        char *end = NULL;
+        auto &shard = _local_shards[i];
+        try {
+          while (read_channel->read_line(line_data) == 0 &&
+                 line_data.size() > 1) {
+            uint64_t key = std::strtoul(line_data.data(), &end, 10);
+            auto &value = shard[key];
+            value.resize(feature_value_size);
+            int parse_size =
+                _value_accesor->ParseFromString(++end, value.data());
+            value.resize(parse_size);
+          }
+          read_channel->close();
+          if (err_no == -1) {
+            ++retry_num;
+            is_read_failed = true;
+            LOG(ERROR)
+                << "MemorySparseTable load failed after read, retry it! path:"
+                << channel_config.path << " , retry_num=" << retry_num;
+          }
+        } catch (...) {
+          ++retry_num;
+          is_read_failed = true;
+          LOG(ERROR) << "MemorySparseTable load failed, retry it! path:"
+                     << channel_config.path << " , retry_num=" << retry_num;
+        }
       }
       if (retry_num > FLAGS_pserver_table_save_max_retry) {
         LOG(ERROR) << "MemorySparseTable load failed reach max limit!";
@@ -300,6 +349,162 @@ int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
   return 0;
 }
 
+static int32_t InsertBinaryShardRecords(const char *records,
+                                        size_t key_num,
+                                        uint32_t value_dim,
+                                        MemorySparseTable::shard_type *shard) {
+  size_t record_bytes = BinaryShardRecordBytes(value_dim);
+  for (size_t i = 0; i < key_num; ++i, records += record_bytes) {
+    uint64_t key = 0;
+    uint32_t value_size = 0;
+    const char *value_data = nullptr;
+    DecodeBinaryShardRecord(records, &key, &value_size, &value_data);
+    if (value_size > value_dim) {
+      LOG(ERROR) << "MemorySparseTable binary record of key:" << key
+                 << " has value_size:" << value_size
+                 << " larger than value_dim:" << value_dim;
+      return -1;
+    }
+    auto &value = (*shard)[key];
+    value.resize(value_size);
+    memcpy(value.data(), value_data, value_size * sizeof(float));
+  }
+  return 0;
+}
+
+int32_t MemorySparseTable::SaveBinaryShard(shard_type *shard,
+                                           int save_param,
+                                           FsWriteChannel *write_channel,
+                                           int *feasign_size) {
+  uint32_t value_dim = _value_accesor->GetAccessorInfo().size / sizeof(float);
+  uint64_t key_num = 0;
+  for (auto it = shard->begin(); it != shard->end(); ++it) {
+    if (_value_accesor->Save(it.value().data(), save_param)) {
+      ++key_num;
+    }
+  }
+  BinaryShardHeader header;
+  InitBinaryShardHeader(&header, value_dim, key_num);
+  if (0 != write_channel->write(reinterpret_cast<const char *>(&header),
+                                sizeof(header))) {
+    return -1;
+  }
+
+  // records are packed into blocks so that the channel sees large writes
+  size_t record_bytes = header.record_bytes;
+  std::vector<char> block(kBinaryShardBlockKeys * record_bytes);
+  size_t block_keys = 0;
+  uint64_t save_num = 0;
+  for (auto it = shard->begin(); it != shard->end(); ++it) {
+    if (!_value_accesor->Save(it.value().data(), save_param)) {
+      continue;
+    }
+    if (it.value().size() > value_dim) {
+      LOG(ERROR) << "MemorySparseTable value size:" << it.value().size()
+                 << " of key:" << it.key()
+                 << " exceeds accessor dim:" << value_dim;
+      return -1;
+    }
+    EncodeBinaryShardRecord(block.data() + block_keys * record_bytes,
+                            it.key(),
+                            it.value().data(),
+                            it.value().size(),
+                            value_dim);
+    ++save_num;
+    if (++block_keys == kBinaryShardBlockKeys) {
+      if (0 != write_channel->write(block.data(), block_keys * record_bytes)) {
+        return -1;
+      }
+      block_keys = 0;
+    }
+  }
+  if (block_keys > 0 &&
+      0 != write_channel->write(block.data(), block_keys * record_bytes)) {
+    return -1;
+  }
+  *feasign_size = static_cast<int>(save_num);
+  return save_num == key_num ? 0 : -1;
+}
+
+int32_t MemorySparseTable::LoadBinaryShard(const std::string &path,
+                                           shard_type *shard) {
+  uint32_t value_dim = _value_accesor->GetAccessorInfo().size / sizeof(float);
+  // local shard files are mapped and inserted without any copy into
+  // intermediate buffers, remote ones are streamed block by block
+  if (paddle::framework::fs_select_internal(path) == 0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      LOG(ERROR) << "MemorySparseTable open binary shard failed, path:" << path;
+      return -1;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 ||
+        static_cast<size_t>(file_stat.st_size) < sizeof(BinaryShardHeader)) {
+      close(fd);
+      LOG(ERROR) << "MemorySparseTable binary shard is truncated, path:"
+                 << path;
+      return -1;
+    }
+    size_t file_size = file_stat.st_size;
+    void *addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+      LOG(ERROR) << "MemorySparseTable mmap binary shard failed, path:"
+                 << path;
+      return -1;
+    }
+    madvise(addr, file_size, MADV_SEQUENTIAL);
+    const char *data = static_cast<const char *>(addr);
+    BinaryShardHeader header;
+    memcpy(&header, data, sizeof(header));
+    int32_t ret = -1;
+    if (CheckBinaryShardHeader(header, value_dim) &&
+        file_size == sizeof(header) + header.key_num * header.record_bytes) {
+      shard->reserve(header.key_num);
+      ret = InsertBinaryShardRecords(
+          data + sizeof(header), header.key_num, value_dim, shard);
+    } else {
+      LOG(ERROR) << "MemorySparseTable binary shard header mismatch, path:"
+                 << path << " value_dim:" << value_dim;
+    }
+    munmap(addr, file_size);
+    return ret;
+  }
+
+  int err_no = 0;
+  FsChannelConfig channel_config;
+  channel_config.path = path;
+  auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
+  BinaryShardHeader header;
+  if (read_channel->read(reinterpret_cast<char *>(&header), sizeof(header)) !=
+          static_cast<int>(sizeof(header)) ||
+      !CheckBinaryShardHeader(header, value_dim)) {
+    read_channel->close();
+    LOG(ERROR) << "MemorySparseTable binary shard header mismatch, path:"
+               << path << " value_dim:" << value_dim;
+    return -1;
+  }
+  shard->reserve(header.key_num);
+  std::vector<char> block(kBinaryShardBlockKeys * header.record_bytes);
+  uint64_t remain = header.key_num;
+  while (remain > 0) {
+    size_t block_keys = std::min<uint64_t>(remain, kBinaryShardBlockKeys);
+    size_t block_bytes = block_keys * header.record_bytes;
+    if (read_channel->read(block.data(), block_bytes) !=
+            static_cast<int>(block_bytes) ||
+        InsertBinaryShardRecords(block.data(), block_keys, value_dim, shard) !=
+            0) {
+      read_channel->close();
+      LOG(ERROR) << "MemorySparseTable binary shard is truncated, path:"
+                 << path;
+      return -1;
+    }
+    remain -= block_keys;
+  }
+  read_channel->close();
+  return err_no == -1 ? -1 : 0;
+}
+
 void MemorySparseTable::Revert() {
   for (int i = 0; i < _real_local_shard_num; ++i) {
     _local_shards_new[i].clear();
@@ -324,7 +529,7 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
   // patch model
   if (save_param == 5) {
     _local_shards_patch_model.reset(_local_shards_new.release());
-    _local_shards_new.reset(new shard_type[_real_local_shard_num]);  // NOLINT
+    _local_shards_new.reset(CreateShards(_real_local_shard_num));
     _save_patch_model_thread = std::thread(std::bind(
         &MemorySparseTable::SavePatch, this, std::string(dirname), save_param));
     return 0;
@@ -340,6 +545,10 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
   std::atomic<uint32_t> feasign_size_all{0};
 
   size_t file_start_idx = _avg_local_shard_num * _shard_idx;
+  // binary format only serves checkpoint and batch model, which are
+  // loaded back by pserver; xbox models keep the text format
+  bool save_binary = _config.save_format() == SPARSE_SAVE_BINARY &&
+                     (save_param == 0 || save_param == 3);
 
 #ifdef PADDLE_WITH_HETERPS
   int thread_num = _real_local_shard_num;
@@ -350,7 +559,15 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
 #pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < _real_local_shard_num; ++i) {
     FsChannelConfig channel_config;
-    if (_config.compress_in_save() && (save_param == 0 || save_param == 3)) {
+    if (save_binary) {
+      channel_config.path =
+          ::paddle::string::format_string("%s/part-%03d-%05d%s",
+                                          table_path.c_str(),
+                                          _shard_idx,
+                                          file_start_idx + i,
+                                          PSERVER_BINARY_SAVE_SUFFIX);
+    } else if (_config.compress_in_save() &&
+               (save_param == 0 || save_param == 3)) {
       channel_config.path =
           ::paddle::string::format_string("%s/part-%03d-%05d.gz",
                                           table_path.c_str(),
@@ -362,9 +579,12 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
                                                             _shard_idx,
                                                             file_start_idx + i);
     }
-    channel_config.converter = _value_accesor->Converter(save_param).converter;
-    channel_config.deconverter =
-        _value_accesor->Converter(save_param).deconverter;
+    if (!save_binary) {
+      channel_config.converter =
+          _value_accesor->Converter(save_param).converter;
+      channel_config.deconverter =
+          _value_accesor->Converter(save_param).deconverter;
+    }
     bool is_write_failed = false;
     int feasign_size = 0;
     int retry_num = 0;
@@ -384,27 +604,39 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
       is_write_failed = false;
       auto write_channel =
           _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
-      for (auto it = shard.begin(); it != shard.end(); ++it) {
-        if (_config.enable_sparse_table_cache() &&
-            (save_param == 1 || save_param == 2) &&
-            _value_accesor->Save(it.value().data(), 4)) {
-          CostTimer timer10("sprase table top push");
-          tk.push(i, _value_accesor->GetField(it.value().data(), "show"));
+      if (save_binary) {
+        if (0 != SaveBinaryShard(
+                     &shard, save_param, write_channel.get(), &feasign_size)) {
+          ++retry_num;
+          is_write_failed = true;
+          LOG(ERROR)
+              << "MemorySparseTable save binary shard failed, retry it! path:"
+              << channel_config.path << " , retry_num=" << retry_num;
         }
+      } else {
+        for (auto it = shard.begin(); it != shard.end(); ++it) {
+          if (_config.enable_sparse_table_cache() &&
+              (save_param == 1 || save_param == 2) &&
+              _value_accesor->Save(it.value().data(), 4)) {
+            CostTimer timer10("sprase table top push");
+            tk.push(i, _value_accesor->GetField(it.value().data(), "show"));
+          }
 
-        if (_value_accesor->Save(it.value().data(), save_param)) {
-          std::string format_value = _value_accesor->ParseToString(
-              it.value().data(), it.value().size());
-          if (0 != write_channel->write_line(::paddle::string::format_string(
-                       "%lu %s", it.key(), format_value.c_str()))) {
-            ++retry_num;
-            is_write_failed = true;
-            LOG(ERROR)
-                << "MemorySparseTable save prefix failed, retry it! path:"
-                << channel_config.path << " , retry_num=" << retry_num;
-            break;
+          if (_value_accesor->Save(it.value().data(), save_param)) {
+            std::string format_value = _value_accesor->ParseToString(
+                it.value().data(), it.value().size());
+            if (0 !=
+                write_channel->write_line(::paddle::string::format_string(
+                    "%lu %s", it.key(), format_value.c_str()))) {
+              ++retry_num;
+              is_write_failed = true;
+              LOG(ERROR)
+                  << "MemorySparseTable save prefix failed, retry it! path:"
+                  << channel_config.path << " , retry_num=" << retry_num;
+              break;
+            }
+            ++feasign_size;
           }
-          ++feasign_size;
         }
       }
       write_channel->close();
@@ -463,7 +695,7 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
   // patch model
   if (save_param == 5) {
     _local_shards_patch_model.reset(_local_shards_new.release());
-    _local_shards_new.reset(new shard_type[_real_local_shard_num]);
+    _local_shards_new.reset(CreateShards(_real_local_shard_num));
     _save_patch_model_thread = std::thread(std::bind(
         &MemorySparseTable::SavePatch, this, std::string(dirname), save_param));
     return 0;
@@ -1293,6 +1525,7 @@ int32_t MemorySparseTable::Shrink(const std::string &param) {
         ++it;
       }
     }
+    CompactShard(&shard);
     shrink_size_all += feasign_size;
   }
   VLOG(0) << "MemorySparseTable::Shrink success, shrink size:"
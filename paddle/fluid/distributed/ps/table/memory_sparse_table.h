@@ -118,6 +118,16 @@ class MemorySparseTable : public Table {
   virtual int32_t SavePatch(const std::string& path, int save_param);
   virtual int32_t LoadPatch(const std::vector<std::string>& file_list,
                             int save_param);
+  // binary checkpoint of one local shard, see depends/binary_shard_format.h
+  int32_t SaveBinaryShard(shard_type* shard,
+                          int save_param,
+                          FsWriteChannel* write_channel,
+                          int* feasign_size);
+  int32_t LoadBinaryShard(const std::string& path, shard_type* shard);
+  // new shards with the value slab sized by the accessor
+  shard_type* CreateShards(int shard_num);
+  // frees the slab blocks left sparse by erasing keys
+  void CompactShard(shard_type* shard);
 
   int _task_pool_size = 24;
   int _avg_local_shard_num;
@@ -175,6 +175,8 @@ class SparseAccessor : public ValueAccessor {
     return 0.0;
   }
 
+  size_t GetPushStatDim() override { return SparsePushValue::EmbedGIndex(); }
+
  private:
   // float ShowClickScore(float show, float click);
 
@@ -526,6 +526,7 @@ int32_t SSDSparseTable::Shrink(const std::string& param) {
         ++it;
       }
     }
+    CompactShard(&shard);
     auto* it = _db->get_iterator(i);
     for (it->SeekToFirst(); it->Valid(); it->Next()) {
       if (_value_accesor->Shrink(
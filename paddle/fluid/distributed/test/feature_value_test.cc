@@ -46,5 +46,90 @@ TEST(BENCHMARK, LargeScaleKV) {
   ASSERT_FLOAT_EQ(value_data[3], 0.3);
 }
 
+TEST(FeatureValueSlab, ReuseAndCompact) {
+  typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+  shard_type shard;
+  shard.set_value_strides(4, 4);
+  for (uint64_t key = 0; key < 2048; ++key) {
+    auto& feature_value = shard[key];
+    feature_value.resize(3);
+    feature_value.data()[0] = static_cast<float>(key);
+  }
+  ASSERT_EQ(shard.value_slab_used(), 2048UL);
+  size_t capacity = shard.value_slab_capacity();
+
+  // extended in place up to the stride, moved to the heap beyond it
+  auto& extended = shard[0];
+  extended.resize(4);
+  ASSERT_EQ(shard.value_slab_used(), 2048UL);
+  extended.resize(6);
+  ASSERT_EQ(shard.value_slab_used(), 2047UL);
+  ASSERT_FLOAT_EQ(extended.data()[0], 0.0);
+  ASSERT_FLOAT_EQ(extended.data()[5], 0.0);
+
+  for (uint64_t key = 1; key < 2048; ++key) {
+    if (key % 8 != 0) {
+      shard.erase(key);
+    }
+  }
+  ASSERT_EQ(shard.value_slab_used(), 255UL);
+  // the released slots are reused by the new keys
+  for (uint64_t key = 4096; key < 4196; ++key) {
+    shard[key].resize(4);
+  }
+  ASSERT_EQ(shard.value_slab_capacity(), capacity);
+
+  shard.compact();
+  ASSERT_EQ(shard.value_slab_used(), 355UL);
+  ASSERT_LT(shard.value_slab_capacity(), capacity);
+  for (uint64_t key = 8; key < 2048; key += 8) {
+    auto itr = shard.find(key);
+    ASSERT_TRUE(itr != shard.end());
+    ASSERT_EQ(itr.value().size(), 3UL);
+    ASSERT_FLOAT_EQ(itr.value().data()[0], static_cast<float>(key));
+  }
+  ASSERT_EQ(shard[0].size(), 6UL);
+
+  shard.clear();
+  ASSERT_EQ(shard.value_slab_capacity(), 0UL);
+}
+
+TEST(FeatureValueSlab, MfSizeClasses) {
+  typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+  const size_t base_dim = 7;
+  const size_t full_dim = 16;
+  shard_type shard;
+  shard.set_value_strides(base_dim, full_dim);
+  for (uint64_t key = 0; key < 2048; ++key) {
+    auto& feature_value = shard[key];
+    feature_value.resize(base_dim);
+    feature_value.data()[0] = static_cast<float>(key);
+  }
+  // the keys without mf take base_dim floats each
+  ASSERT_EQ(shard.value_slab_bytes(), 2048 * base_dim * sizeof(float));
+
+  // extending the mf part moves the value to the full slab
+  auto& extended = shard[5];
+  extended.resize(full_dim);
+  extended.data()[full_dim - 1] = 1.0;
+  ASSERT_EQ(shard.value_slab_used(), 2048UL);
+  ASSERT_FLOAT_EQ(extended.data()[0], 5.0);
+  ASSERT_FLOAT_EQ(extended.data()[base_dim], 0.0);
+  ASSERT_GT(shard.value_slab_bytes(), 2048 * base_dim * sizeof(float));
+  // and the released base slot is reused by the next key
+  shard[4096].resize(base_dim);
+  ASSERT_EQ(shard.value_slab_used(), 2049UL);
+  ASSERT_EQ(shard.value_slab_capacity(), 2048UL + 512UL);
+
+  shard.compact();
+  ASSERT_EQ(shard.value_slab_used(), 2049UL);
+  auto itr = shard.find(5);
+  ASSERT_TRUE(itr != shard.end());
+  ASSERT_EQ(itr.value().size(), full_dim);
+  ASSERT_FLOAT_EQ(itr.value().data()[0], 5.0);
+  ASSERT_FLOAT_EQ(itr.value().data()[full_dim - 1], 1.0);
+  shard.clear();
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -14,12 +14,14 @@
 
 #include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>  // NOLINT
 #include <fstream>
 #include <iomanip>
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -86,3 +88,242 @@ void testGraphSample() {
 }
 
 TEST(testGraphSample, Run) { testGraphSample(); }
+
+void init_csr_graph_table(distributed::GraphTable *graph_table,
+                          bool use_csr_edges) {
+  ::paddle::distributed::GraphParameter table_proto;
+  table_proto.add_edge_types("user2item");
+  table_proto.add_node_types("user");
+  table_proto.add_node_types("item");
+  table_proto.add_graph_feature();
+  table_proto.add_graph_feature();
+  table_proto.set_shard_num(7);
+  table_proto.set_use_csr_edges(use_csr_edges);
+  graph_table->Initialize(table_proto);
+}
+
+void testCsrEdgeSample() {
+  prepare_file(edge_file_name, edges);
+  distributed::GraphTable node_table, csr_table;
+  init_csr_graph_table(&node_table, false);
+  init_csr_graph_table(&csr_table, true);
+  ASSERT_EQ(node_table.Load(edge_file_name, "e>user2item"), 0);
+  ASSERT_EQ(csr_table.Load(edge_file_name, "e>user2item"), 0);
+
+  std::vector<uint64_t> node_ids = {37, 96, 59, 97, 45};
+  std::unordered_map<uint64_t, std::unordered_set<uint64_t>> neighbors;
+  for (auto &edge : edges) {
+    auto items = paddle::string::split_string<std::string>(edge, "\t");
+    neighbors[std::stoull(items[0])].insert(std::stoull(items[1]));
+  }
+
+  for (int sample_size : {1, 2, 3, 10}) {
+    for (auto *table : {&node_table, &csr_table}) {
+      std::vector<std::shared_ptr<char>> buffers(node_ids.size());
+      std::vector<int> actual_sizes(node_ids.size(), 0);
+      table->random_sample_neighbors(
+          0, node_ids.data(), sample_size, buffers, actual_sizes, false);
+      for (size_t i = 0; i < node_ids.size(); i++) {
+        auto &expected = neighbors[node_ids[i]];
+        size_t num = actual_sizes[i] / sizeof(uint64_t);
+        ASSERT_EQ(num, std::min(expected.size(), size_t(sample_size)));
+        std::unordered_set<uint64_t> sampled;
+        for (size_t j = 0; j < num; j++) {
+          uint64_t id = 0;
+          memcpy(&id, buffers[i].get() + j * sizeof(uint64_t), sizeof(id));
+          ASSERT_TRUE(expected.count(id));
+          sampled.insert(id);
+        }
+        ASSERT_EQ(sampled.size(), num);
+      }
+    }
+  }
+
+  std::vector<std::vector<uint64_t>> node_keys, csr_keys;
+  node_table.get_all_neighbor_id(
+      distributed::GraphTableType::EDGE_TABLE, 0, 1, &node_keys);
+  csr_table.get_all_neighbor_id(
+      distributed::GraphTableType::EDGE_TABLE, 0, 1, &csr_keys);
+  std::sort(node_keys[0].begin(), node_keys[0].end());
+  std::sort(csr_keys[0].begin(), csr_keys[0].end());
+  ASSERT_EQ(node_keys[0], csr_keys[0]);
+
+  node_keys.clear();
+  csr_keys.clear();
+  node_table.get_all_id(
+      distributed::GraphTableType::EDGE_TABLE, 0, 1, &node_keys);
+  csr_table.get_all_id(
+      distributed::GraphTableType::EDGE_TABLE, 0, 1, &csr_keys);
+  std::sort(node_keys[0].begin(), node_keys[0].end());
+  std::sort(csr_keys[0].begin(), csr_keys[0].end());
+  ASSERT_EQ(node_keys[0], csr_keys[0]);
+
+  std::unique_ptr<char[]> buffer;
+  int actual_size = 0;
+  csr_table.pull_graph_list(distributed::GraphTableType::EDGE_TABLE,
+                            0,
+                            0,
+                            100,
+                            buffer,
+                            actual_size,
+                            false,
+                            1);
+  ASSERT_EQ(actual_size,
+            static_cast<int>(csr_keys[0].size()) *
+                (distributed::Node::id_size + distributed::Node::int_size));
+}
+
+TEST(testGraphSample, CsrEdges) { testCsrEdgeSample(); }
+
+std::vector<std::string> more_edges = {std::string("37\t46\t0.5"),
+                                       std::string("98\t49\t0.2")};
+char more_edge_file_name[] = "more_edges.txt";
+
+void testCsrEdgeIncrementalLoad() {
+  prepare_file(edge_file_name, edges);
+  prepare_file(more_edge_file_name, more_edges);
+  distributed::GraphTable csr_table;
+  init_csr_graph_table(&csr_table, true);
+  ASSERT_EQ(csr_table.Load(edge_file_name, "e>user2item"), 0);
+  // Loading into compacted shards decompacts and compacts them again.
+  ASSERT_EQ(csr_table.Load(more_edge_file_name, "e>user2item"), 0);
+
+  std::unordered_map<uint64_t, std::unordered_set<uint64_t>> neighbors;
+  for (auto *edge_list : {&edges, &more_edges}) {
+    for (auto &edge : *edge_list) {
+      auto items = paddle::string::split_string<std::string>(edge, "\t");
+      neighbors[std::stoull(items[0])].insert(std::stoull(items[1]));
+    }
+  }
+  std::vector<uint64_t> node_ids = {37, 96, 59, 97, 98};
+  std::vector<std::shared_ptr<char>> buffers(node_ids.size());
+  std::vector<int> actual_sizes(node_ids.size(), 0);
+  csr_table.random_sample_neighbors(
+      0, node_ids.data(), 10, buffers, actual_sizes, false);
+  for (size_t i = 0; i < node_ids.size(); i++) {
+    auto &expected = neighbors[node_ids[i]];
+    size_t num = actual_sizes[i] / sizeof(uint64_t);
+    ASSERT_EQ(num, expected.size());
+    for (size_t j = 0; j < num; j++) {
+      uint64_t id = 0;
+      memcpy(&id, buffers[i].get() + j * sizeof(uint64_t), sizeof(id));
+      ASSERT_TRUE(expected.count(id));
+    }
+  }
+}
+
+TEST(testGraphSample, CsrEdgesIncrementalLoad) {
+  testCsrEdgeIncrementalLoad();
+}
+
+std::vector<std::string> feature_nodes = {
+    std::string("user\t37\tb:13 14\ta:0.34"),
+    std::string("user\t96\tb:15 10 9\ta:0.31 0.2"),
+    std::string("user\t59\ta:0.11"),
+    std::string("user\t97\tb:12"),
+    std::string("item\t45\tb:21 22"),
+    std::string("item\t145"),
+    std::string("item\t112\tb:7")};
+char feature_node_file_name[] = "feature_nodes.txt";
+
+void init_feature_graph_table(distributed::GraphTable *graph_table,
+                              bool use_feature_columns) {
+  ::paddle::distributed::GraphParameter table_proto;
+  table_proto.add_edge_types("user2item");
+  table_proto.add_node_types("user");
+  table_proto.add_node_types("item");
+  auto *user_feature = table_proto.add_graph_feature();
+  user_feature->add_name("b");
+  user_feature->add_dtype("feasign");
+  user_feature->add_shape(-1);
+  user_feature->add_name("a");
+  user_feature->add_dtype("float32");
+  user_feature->add_shape(-1);
+  auto *item_feature = table_proto.add_graph_feature();
+  item_feature->add_name("b");
+  item_feature->add_dtype("feasign");
+  item_feature->add_shape(-1);
+  table_proto.set_shard_num(7);
+  table_proto.set_use_feature_columns(use_feature_columns);
+  graph_table->Initialize(table_proto);
+  graph_table->set_slot_feature_separator(":");
+}
+
+void testFeatureColumns() {
+  prepare_file(feature_node_file_name, feature_nodes);
+  distributed::GraphTable node_table, column_table;
+  init_feature_graph_table(&node_table, false);
+  init_feature_graph_table(&column_table, true);
+  for (auto *table : {&node_table, &column_table}) {
+    ASSERT_EQ(table->Load(feature_node_file_name, "nuser"), 0);
+    ASSERT_EQ(table->Load(feature_node_file_name, "nitem"), 0);
+  }
+
+  std::vector<uint64_t> node_ids = {96, 45, 1000, 37, 145, 59, 112, 97};
+  distributed::GraphNodeFeatures node_res, column_res;
+  node_table.get_node_slot_features(
+      node_ids.data(), node_ids.size(), 1, 1, &node_res);
+  column_table.get_node_slot_features(
+      node_ids.data(), node_ids.size(), 1, 1, &column_res);
+  ASSERT_EQ(node_res.feature_offsets, column_res.feature_offsets);
+  ASSERT_EQ(node_res.feature_ids, column_res.feature_ids);
+  ASSERT_EQ(node_res.slot_ids, column_res.slot_ids);
+  ASSERT_EQ(node_res.float_feature_offsets, column_res.float_feature_offsets);
+  ASSERT_EQ(node_res.float_features, column_res.float_features);
+  ASSERT_EQ(node_res.float_slot_ids, column_res.float_slot_ids);
+  std::vector<uint64_t> expected_ids = {15, 10, 9, 21, 22, 13, 14, 7, 12};
+  ASSERT_EQ(column_res.feature_ids, expected_ids);
+  std::vector<uint64_t> expected_offsets = {0, 3, 5, 5, 7, 7, 7, 8, 9};
+  ASSERT_EQ(column_res.feature_offsets, expected_offsets);
+  ASSERT_EQ(column_res.float_features.size(), size_t(4));
+
+  std::vector<uint64_t> user_ids = {37, 96, 59, 97};
+  std::vector<std::string> feature_names = {"b"};
+  std::vector<std::vector<std::string>> node_feat(
+      1, std::vector<std::string>(user_ids.size())),
+      column_feat(1, std::vector<std::string>(user_ids.size()));
+  node_table.get_node_feat(0, user_ids, feature_names, node_feat);
+  column_table.get_node_feat(0, user_ids, feature_names, column_feat);
+  ASSERT_EQ(node_feat, column_feat);
+
+  std::vector<std::vector<uint64_t>> node_keys, column_keys;
+  node_table.get_all_feature_ids(
+      distributed::GraphTableType::FEATURE_TABLE, 0, 1, &node_keys);
+  column_table.get_all_feature_ids(
+      distributed::GraphTableType::FEATURE_TABLE, 0, 1, &column_keys);
+  std::sort(node_keys[0].begin(), node_keys[0].end());
+  std::sort(column_keys[0].begin(), column_keys[0].end());
+  ASSERT_EQ(node_keys[0], column_keys[0]);
+}
+
+TEST(testGraphSample, FeatureColumns) { testFeatureColumns(); }
+
+std::vector<std::string> more_feature_nodes = {
+    std::string("user\t200\tb:5\ta:0.5"), std::string("item\t201\tb:6 8")};
+char more_feature_node_file_name[] = "more_feature_nodes.txt";
+
+void testFeatureColumnsIncrementalLoad() {
+  prepare_file(feature_node_file_name, feature_nodes);
+  prepare_file(more_feature_node_file_name, more_feature_nodes);
+  distributed::GraphTable column_table;
+  init_feature_graph_table(&column_table, true);
+  ASSERT_EQ(column_table.Load(feature_node_file_name, "nuser"), 0);
+  ASSERT_EQ(column_table.Load(feature_node_file_name, "nitem"), 0);
+  // Loading into compacted shards decompacts and compacts them again.
+  ASSERT_EQ(column_table.Load(more_feature_node_file_name, "nuser"), 0);
+  ASSERT_EQ(column_table.Load(more_feature_node_file_name, "nitem"), 0);
+
+  std::vector<uint64_t> node_ids = {37, 200, 45, 201};
+  distributed::GraphNodeFeatures res;
+  column_table.get_node_slot_features(
+      node_ids.data(), node_ids.size(), 1, 1, &res);
+  std::vector<uint64_t> expected_ids = {13, 14, 5, 21, 22, 6, 8};
+  ASSERT_EQ(res.feature_ids, expected_ids);
+  std::vector<uint64_t> expected_offsets = {0, 2, 3, 5, 7};
+  ASSERT_EQ(res.feature_offsets, expected_offsets);
+  ASSERT_EQ(res.float_features.size(), size_t(2));
+}
+
+TEST(testGraphSample, FeatureColumnsIncrementalLoad) {
+  testFeatureColumnsIncrementalLoad();
+}
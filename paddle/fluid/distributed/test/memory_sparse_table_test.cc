@@ -152,5 +152,64 @@ TEST(MemorySparseTable, SGD) {
   }
 }
 
+TEST(MemorySparseTable, BinarySaveLoad) {
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(10);
+  table_config.set_save_format(SPARSE_SAVE_BINARY);
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(8);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_embed_sgd_param()->set_name("SparseNaiveSGDRule");
+  auto *naive_param =
+      accessor_config->mutable_embed_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(0.1);
+  naive_param->set_initial_range(0.3);
+  accessor_config->mutable_embedx_sgd_param()->set_name("SparseNaiveSGDRule");
+  naive_param = accessor_config->mutable_embedx_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(0.1);
+  naive_param->set_initial_range(0.3);
+  FsClientParameter fs_config;
+
+  MemorySparseTable save_table;
+  save_table.SetShard(0, 1);
+  ASSERT_EQ(save_table.Initialize(table_config, fs_config), 0);
+  MemorySparseTable load_table;
+  load_table.SetShard(0, 1);
+  ASSERT_EQ(load_table.Initialize(table_config, fs_config), 0);
+
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < 1000; ++key) {
+    keys.push_back(key * 7919);
+  }
+  std::vector<uint32_t> fres(keys.size(), 1);
+  std::vector<float> pull_values(keys.size() * 11);
+  auto pull_value = PullSparseValue(keys, fres, 8);
+  ASSERT_EQ(save_table.PullSparse(pull_values.data(), pull_value), 0);
+
+  std::string path = "/tmp/memory_sparse_table_binary_test";
+  ASSERT_EQ(save_table.Save(path, "0"), 0);
+  ASSERT_EQ(load_table.Load(path, "0"), 0);
+  ASSERT_EQ(load_table.LocalSize(), save_table.LocalSize());
+
+  for (int i = 0; i < 10; ++i) {
+    auto *saved = reinterpret_cast<MemorySparseTable::shard_type *>(
+        save_table.GetShard(i));
+    auto *loaded = reinterpret_cast<MemorySparseTable::shard_type *>(
+        load_table.GetShard(i));
+    ASSERT_EQ(saved->size(), loaded->size());
+    for (auto it = saved->begin(); it != saved->end(); ++it) {
+      auto loaded_it = loaded->find(it.key());
+      ASSERT_TRUE(loaded_it != loaded->end());
+      ASSERT_EQ(loaded_it.value().size(), it.value().size());
+      for (size_t j = 0; j < it.value().size(); ++j) {
+        ASSERT_FLOAT_EQ(loaded_it.value().data()[j], it.value().data()[j]);
+      }
+    }
+  }
+}
+
 }  // namespace distributed
 }  // namespace paddle
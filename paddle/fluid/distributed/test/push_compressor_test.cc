@@ -0,0 +1,200 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/push_compressor.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/ctr_dymf_accessor.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+void RandomValues(size_t num, std::vector<float>* values) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.0, 1.0);
+  values->resize(num);
+  for (auto& value : *values) {
+    value = dist(rng);
+  }
+}
+
+}  // namespace
+
+TEST(PushCompressor, SparseRoundTrip) {
+  const size_t dim = 12;
+  const size_t raw_dim = 3;
+  std::vector<uint64_t> keys = {1000005, 7, 1000001, 7, 1ULL << 62};
+  std::vector<float> values;
+  RandomValues(keys.size() * dim, &values);
+  std::vector<const float*> value_ptrs;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    // the slot ids are kept exactly
+    values[i * dim] = 65536 + i;
+    value_ptrs.push_back(values.data() + i * dim);
+  }
+
+  for (auto type :
+       {PUSH_COMPRESS_FP16, PUSH_COMPRESS_BF16, PUSH_COMPRESS_INT8}) {
+    PushCompressParameter param;
+    param.set_type(type);
+    param.set_raw_dim(raw_dim);
+    param.set_error_feedback(false);
+    PushCompressor compressor(param, dim);
+    std::string data;
+    compressor.EncodeSparse(
+        keys.data(), value_ptrs.data(), keys.size(), &data);
+    ASSERT_LT(data.size(), keys.size() * (sizeof(uint64_t) + dim * 4) * 2 / 3);
+
+    std::vector<uint64_t> decoded_keys;
+    std::vector<float> decoded_values;
+    ASSERT_TRUE(PushCompressor::DecodeSparse(
+        data, keys.size(), dim, &decoded_keys, &decoded_values));
+    ASSERT_EQ(decoded_keys,
+              std::vector<uint64_t>({7, 7, 1000001, 1000005, 1ULL << 62}));
+    // the values follow the sorted keys
+    std::vector<size_t> order = {1, 3, 2, 0, 4};
+    float tolerance = type == PUSH_COMPRESS_BF16 ? 1.0 / 64 : 1.0 / 127;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      const float* expected = value_ptrs[order[i]];
+      const float* decoded = decoded_values.data() + i * dim;
+      for (size_t j = 0; j < raw_dim; ++j) {
+        ASSERT_EQ(decoded[j], expected[j]);
+      }
+      for (size_t j = raw_dim; j < dim; ++j) {
+        ASSERT_NEAR(decoded[j], expected[j], tolerance);
+      }
+    }
+
+    // values of another dim are rejected
+    ASSERT_FALSE(PushCompressor::DecodeSparse(
+        data, keys.size(), dim + 1, &decoded_keys, &decoded_values));
+    // truncated data is rejected
+    data.pop_back();
+    ASSERT_FALSE(PushCompressor::DecodeSparse(
+        data, keys.size(), dim, &decoded_keys, &decoded_values));
+  }
+}
+
+TEST(PushCompressor, SparseDymfStats) {
+  // slot, show, click, mf_dim, embed_g and 8 embedx_g of CtrDymfAccessor
+  using PushValue = CtrDymfAccessor::CtrDymfPushValue;
+  const size_t dim = PushValue::EmbedxGIndex() + 8;
+  std::vector<uint64_t> keys = {3, 1, 2};
+  std::vector<float> values;
+  RandomValues(keys.size() * dim, &values);
+  std::vector<const float*> value_ptrs;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    float* value = values.data() + i * dim;
+    value[PushValue::SlotIndex()] = 100 + i;
+    value[PushValue::ShowIndex()] = 3;
+    value[PushValue::ClickIndex()] = 1;
+    value[PushValue::MfDimIndex()] = 5;
+    // the largest gradient sets the int8 scale, which 5 is not a multiple of
+    value[PushValue::EmbedGIndex()] = 7.3;
+    value_ptrs.push_back(value);
+  }
+
+  // the default raw_dim covers slot, show and click only
+  PushCompressParameter param;
+  param.set_type(PUSH_COMPRESS_INT8);
+  param.set_error_feedback(false);
+  CtrDymfAccessor accessor;
+  ASSERT_EQ(accessor.GetPushStatDim(),
+            static_cast<size_t>(PushValue::EmbedGIndex()));
+  PushCompressor compressor(param, dim, accessor.GetPushStatDim());
+  std::string data;
+  compressor.EncodeSparse(keys.data(), value_ptrs.data(), keys.size(), &data);
+
+  std::vector<uint64_t> decoded_keys;
+  std::vector<float> decoded_values;
+  ASSERT_TRUE(PushCompressor::DecodeSparse(
+      data, keys.size(), dim, &decoded_keys, &decoded_values));
+  ASSERT_EQ(decoded_keys, std::vector<uint64_t>({1, 2, 3}));
+  std::vector<size_t> order = {1, 2, 0};
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const float* expected = value_ptrs[order[i]];
+    const float* decoded = decoded_values.data() + i * dim;
+    for (int j = 0; j < PushValue::EmbedGIndex(); ++j) {
+      ASSERT_EQ(decoded[j], expected[j]);
+    }
+    for (size_t j = PushValue::EmbedGIndex(); j < dim; ++j) {
+      ASSERT_NEAR(decoded[j], expected[j], 7.3 / 127);
+    }
+  }
+}
+
+TEST(PushCompressor, DenseErrorFeedback) {
+  const size_t num = 1000;
+  std::vector<float> values;
+  RandomValues(num, &values);
+  // small gradients which int8 rounds off without error feedback
+  values[0] = 1;
+  for (size_t i = 1; i < num; ++i) {
+    values[i] *= 1e-3;
+  }
+
+  PushCompressParameter param;
+  param.set_type(PUSH_COMPRESS_INT8);
+  PushCompressor compressor(param, 0);
+  const int steps = 100;
+  std::vector<float> applied(num, 0);
+  std::string data;
+  std::vector<float> decoded;
+  for (int step = 0; step < steps; ++step) {
+    compressor.EncodeDense(0, values.data(), num, &data);
+    ASSERT_LT(data.size(), num * sizeof(float) / 3);
+    ASSERT_TRUE(PushCompressor::DecodeDense(data, &decoded));
+    ASSERT_EQ(decoded.size(), num);
+    for (size_t i = 0; i < num; ++i) {
+      applied[i] += decoded[i];
+    }
+  }
+  // the accumulated error is bounded by one quantization step
+  for (size_t i = 0; i < num; ++i) {
+    ASSERT_NEAR(applied[i], values[i] * steps, 1.0 / 127);
+  }
+}
+
+TEST(PushCompressor, DenseRejectsCorruptData) {
+  std::vector<float> values;
+  RandomValues(100, &values);
+  PushCompressParameter param;
+  param.set_type(PUSH_COMPRESS_INT8);
+  PushCompressor compressor(param, 0);
+  std::string data;
+  compressor.EncodeDense(0, values.data(), values.size(), &data);
+
+  std::vector<float> decoded;
+  // a count larger than the message is rejected before allocating
+  std::string corrupt = data;
+  uint32_t num = UINT32_MAX;
+  memcpy(&corrupt[1], &num, sizeof(num));
+  ASSERT_FALSE(PushCompressor::DecodeDense(corrupt, &decoded));
+  ASSERT_TRUE(decoded.empty());
+  // truncated data is rejected
+  data.pop_back();
+  ASSERT_FALSE(PushCompressor::DecodeDense(data, &decoded));
+}
+
+}  // namespace distributed
+}  // namespace paddle
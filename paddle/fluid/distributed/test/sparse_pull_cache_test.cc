@@ -0,0 +1,185 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/sparse_pull_cache.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/service/env.h"
+#include "paddle/fluid/distributed/ps/service/ps_client.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+// pulls one key through the cache, the servers return server_value
+bool CachedPull(SparsePullCache *cache,
+                uint64_t key,
+                float server_value,
+                float *value) {
+  uint64_t version = cache->NextVersion();
+  std::vector<size_t> misses;
+  cache->Lookup(version, &key, &value, 1, &misses);
+  if (misses.empty()) {
+    return true;
+  }
+  value[0] = server_value;
+  value[1] = server_value;
+  cache->Update(version, &key, &value, 1);
+  return false;
+}
+
+}  // namespace
+
+TEST(SparsePullCache, AdmissionAndStaleness) {
+  SparsePullCacheParameter param;
+  param.set_capacity(64);
+  param.set_max_staleness(2);
+  param.set_admit_threshold(2);
+  SparsePullCache cache(0, param, 2);
+
+  float value[2];
+  // admitted on the second miss
+  ASSERT_FALSE(CachedPull(&cache, 7, 1.0, value));
+  ASSERT_EQ(cache.size(), 0UL);
+  ASSERT_FALSE(CachedPull(&cache, 7, 2.0, value));
+  ASSERT_EQ(cache.size(), 1UL);
+
+  ASSERT_TRUE(CachedPull(&cache, 7, 3.0, value));
+  ASSERT_FLOAT_EQ(value[1], 2.0);
+  ASSERT_TRUE(CachedPull(&cache, 7, 4.0, value));
+  ASSERT_FLOAT_EQ(value[1], 2.0);
+  // served for at most max_staleness pulls, then refreshed
+  ASSERT_FALSE(CachedPull(&cache, 7, 5.0, value));
+  ASSERT_TRUE(CachedPull(&cache, 7, 6.0, value));
+  ASSERT_FLOAT_EQ(value[1], 5.0);
+
+  auto stat = cache.GetStat();
+  ASSERT_EQ(stat.hits, 3UL);
+  ASSERT_EQ(stat.misses, 3UL);
+  ASSERT_EQ(stat.stale_misses, 1UL);
+  ASSERT_EQ(stat.admitted, 1UL);
+
+  cache.Clear();
+  ASSERT_EQ(cache.size(), 0UL);
+}
+
+TEST(SparsePullCache, Eviction) {
+  SparsePullCacheParameter param;
+  param.set_capacity(16);
+  param.set_max_staleness(1000);
+  param.set_admit_threshold(1);
+  SparsePullCache cache(0, param, 2);
+
+  float value[2];
+  for (uint64_t key = 0; key < 256; ++key) {
+    CachedPull(&cache, key, key, value);
+  }
+  ASSERT_LE(cache.size(), 16UL);
+  auto stat = cache.GetStat();
+  ASSERT_EQ(stat.admitted, 256UL);
+  ASSERT_EQ(stat.admitted - stat.evicted, cache.size());
+}
+
+TEST(SparsePullCache, PsLocalClient) {
+  PSParameter ps_param;
+  auto *server_param = ps_param.mutable_server_param();
+  auto *downpour_server_param = server_param->mutable_downpour_server_param();
+  downpour_server_param->mutable_service_param()->set_client_class(
+      "PsLocalClient");
+  auto *table_param = downpour_server_param->add_downpour_table_param();
+  table_param->set_table_id(0);
+  table_param->set_table_class("MemorySparseTable");
+  table_param->set_shard_num(10);
+  table_param->set_type(PS_SPARSE_TABLE);
+  table_param->mutable_pull_cache()->set_capacity(1024);
+  table_param->mutable_pull_cache()->set_max_staleness(2);
+  table_param->mutable_pull_cache()->set_admit_threshold(1);
+
+  auto *accessor_param = table_param->mutable_accessor();
+  accessor_param->set_accessor_class("CtrCommonAccessor");
+  accessor_param->set_fea_dim(11);
+  accessor_param->set_embedx_dim(8);
+  accessor_param->set_embedx_threshold(5);
+  accessor_param->mutable_embed_sgd_param()->set_name("SparseNaiveSGDRule");
+  auto *naive_param =
+      accessor_param->mutable_embed_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(0.1);
+  naive_param->set_initial_range(0.3);
+  accessor_param->mutable_embedx_sgd_param()->set_name("SparseNaiveSGDRule");
+  naive_param = accessor_param->mutable_embedx_sgd_param()->mutable_naive();
+  naive_param->set_learning_rate(0.1);
+  naive_param->set_initial_range(0.3);
+
+  std::unique_ptr<PSClient> client(PSClientFactory::Create(ps_param));
+  ASSERT_TRUE(client != nullptr);
+  PaddlePSEnvironment env;
+  std::map<uint64_t, std::vector<Region>> regions;
+  ASSERT_EQ(client->Configure(ps_param, regions, env, 0), 0);
+  auto *cache = client->GetPullSparseCache(0);
+  ASSERT_TRUE(cache != nullptr);
+
+  auto *accessor = client->GetTableAccessor(0);
+  size_t select_dim = accessor->GetAccessorInfo().select_dim;
+  size_t update_dim = accessor->GetAccessorInfo().update_dim;
+  std::vector<uint64_t> keys = {1, 2, 3};
+  std::vector<float> values(keys.size() * select_dim);
+  std::vector<float *> value_ptrs;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    value_ptrs.push_back(values.data() + i * select_dim);
+  }
+  auto pull = [&]() {
+    client->PullSparse(value_ptrs.data(), 0, keys.data(), keys.size(), true)
+        .wait();
+  };
+
+  // the show of the keys are 1 after the push
+  std::vector<float> push_values(keys.size() * update_dim, 0);
+  std::vector<const float *> push_ptrs;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    push_values[i * update_dim + 1] = 1;
+    push_ptrs.push_back(push_values.data() + i * update_dim);
+  }
+  client
+      ->PushSparseRawGradient(
+          0, keys.data(), push_ptrs.data(), keys.size(), nullptr)
+      .wait();
+  pull();
+  ASSERT_EQ(cache->GetStat().misses, keys.size());
+  ASSERT_FLOAT_EQ(values[0], 1);
+
+  // the cached shows are served until they are too stale
+  client
+      ->PushSparseRawGradient(
+          0, keys.data(), push_ptrs.data(), keys.size(), nullptr)
+      .wait();
+  pull();
+  pull();
+  ASSERT_EQ(cache->GetStat().hits, 2 * keys.size());
+  ASSERT_FLOAT_EQ(values[0], 1);
+  pull();
+  ASSERT_EQ(cache->GetStat().stale_misses, keys.size());
+  ASSERT_GT(values[0], 1);
+
+  // the cache is dropped when the table is shrunk
+  client->Shrink(0, "").wait();
+  ASSERT_EQ(cache->size(), 0UL);
+}
+
+}  // namespace distributed
+}  // namespace paddle
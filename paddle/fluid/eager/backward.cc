@@ -14,10 +14,22 @@
 
 #include "paddle/fluid/eager/backward.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+#include "paddle/common/flags.h"
 #include "paddle/fluid/eager/general_grad.h"
 #include "paddle/fluid/memory/stats.h"
+#include "paddle/phi/core/threadpool.h"
 #include "paddle/phi/kernels/autotune/switch_autotune.h"
 
+COMMON_DECLARE_int32(eager_backward_num_threads);
+COMMON_DECLARE_bool(eager_backward_deterministic);
+
 namespace egr {
 
 std::unordered_map<GradNodeBase*, int> getInDegreeMap(
@@ -100,6 +112,391 @@ void DuplicateCheck(const std::vector<paddle::Tensor>& inputs, bool is_input) {
   }
 }
 
+namespace {
+
+// Set on the threads of the backward pool while they run grad nodes, so that
+// a backward started from inside a grad node runs sequentially instead of
+// waiting on the pool it occupies.
+thread_local bool is_parallel_backward_worker = false;
+
+// The tracer and grad mode are thread local. Gives a worker those of the
+// thread that started backward while it runs grad nodes.
+class ParallelBackwardWorkerGuard {
+ public:
+  ParallelBackwardWorkerGuard(
+      const std::shared_ptr<paddle::imperative::Tracer>& tracer,
+      bool has_grad)
+      : prev_tracer_(Controller::Instance().GetCurrentTracer()) {
+    Controller::Instance().SetCurrentTracer(tracer);
+    if (tracer) {
+      prev_has_grad_ = tracer->HasGrad();
+      tracer->SetHasGrad(has_grad);
+    }
+    is_parallel_backward_worker = true;
+  }
+
+  ~ParallelBackwardWorkerGuard() {
+    is_parallel_backward_worker = false;
+    auto& tracer = Controller::Instance().GetCurrentTracer();
+    if (tracer) {
+      tracer->SetHasGrad(prev_has_grad_);
+    }
+    Controller::Instance().SetCurrentTracer(prev_tracer_);
+  }
+
+ private:
+  std::shared_ptr<paddle::imperative::Tracer> prev_tracer_;
+  bool prev_has_grad_{true};
+};
+
+// One pool per thread number. A pool is never destroyed, since a backward
+// started before FLAGS_eager_backward_num_threads changed may still run on it.
+phi::ThreadPool* GetBackwardThreadPool(int num_threads) {
+  static std::mutex mutex;
+  static std::unordered_map<int, std::unique_ptr<phi::ThreadPool>> pools;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& pool = pools[num_threads];
+  if (pool == nullptr) {
+    VLOG(3) << "Create backward thread pool with " << num_threads
+            << " threads";
+    pool = std::make_unique<phi::ThreadPool>(num_threads);
+  }
+  return pool.get();
+}
+
+bool UseParallelBackward(const paddle::platform::Place& place,
+                         bool is_general_grad,
+                         bool create_graph,
+                         bool has_force_sequential_nodes) {
+  // GeneralGrad prunes the graph while it runs, and create_graph or force
+  // sequential nodes depend on the order the grad nodes run in, so they
+  // keep the sequential engine. Device kernels are already asynchronous.
+  return FLAGS_eager_backward_num_threads > 1 &&
+         !is_parallel_backward_worker && !is_general_grad && !create_graph &&
+         !has_force_sequential_nodes && paddle::platform::is_cpu_place(place);
+}
+
+// Runs the grad nodes of a backward graph on a thread pool. A node is sent to
+// the pool once all the nodes it takes grads from have run, that is once its
+// in-degree drops to zero. The worker that runs a node goes on with one of
+// the nodes it made ready, preferring GradNodeAccumulation as the sequential
+// engine does, and sends the others to the pool.
+//
+// Grads flowing into a node are summed in its GradTensorHolder under the
+// node's lock. In deterministic mode they are kept until the node runs and
+// then summed in the order the sequential engine would sum them, so results
+// do not depend on thread scheduling.
+class ParallelBackwardExecutor {
+ public:
+  ParallelBackwardExecutor(
+      std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+          node_input_buffers_dict,
+      const std::unordered_map<GradNodeBase*, int>& node_in_degree_map,
+      const paddle::platform::Place& place,
+      bool retain_graph,
+      bool deterministic)
+      : node_input_buffers_dict_(node_input_buffers_dict),
+        node_in_degree_map_(node_in_degree_map),
+        place_(place),
+        retain_graph_(retain_graph),
+        deterministic_(deterministic),
+        tracer_(Controller::Instance().GetCurrentTracer()),
+        has_grad_(tracer_ ? tracer_->HasGrad() : true),
+        pool_(GetBackwardThreadPool(FLAGS_eager_backward_num_threads)) {}
+
+  void Run(const std::deque<GradNodeBase*>& startup_nodes) {
+    InitNodeStates(startup_nodes);
+    for (auto* node : startup_nodes) {
+      if (node_states_[node]->in_degree == 0) {
+        Schedule(node);
+      }
+    }
+    Wait();
+    // Like the sequential engine, still run a startup node that takes grads
+    // from another startup node which did not produce them.
+    for (auto* node : startup_nodes) {
+      if (!node_states_[node]->started && error_ == nullptr) {
+        Schedule(node);
+        Wait();
+      }
+    }
+    if (error_ != nullptr) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+ private:
+  struct PendingGrad {
+    // Order of the producer node, and slot and rank of its grad output.
+    std::tuple<size_t, size_t, size_t> key;
+    size_t slot_id;
+    size_t rank;
+    paddle::Tensor tensor;
+  };
+
+  struct NodeState {
+    std::mutex mutex;
+    std::unique_ptr<GradTensorHolder> buffer;
+    int in_degree{0};
+    size_t order{0};
+    bool started{false};
+    std::vector<PendingGrad> pending_grads;
+  };
+
+  // Creates the state of every node of the graph up front, so that
+  // node_states_ is only read while the nodes run. The order of a node is
+  // its position in a run of the sequential engine.
+  void InitNodeStates(const std::deque<GradNodeBase*>& startup_nodes) {
+    for (auto& iter : node_in_degree_map_) {
+      auto state = std::make_unique<NodeState>();
+      state->in_degree = iter.second;
+      node_states_[iter.first] = std::move(state);
+    }
+    for (auto* node : startup_nodes) {
+      if (!node_states_.count(node)) {
+        node_states_[node] = std::make_unique<NodeState>();
+      }
+      auto iter = node_input_buffers_dict_->find(node);
+      if (iter != node_input_buffers_dict_->end()) {
+        node_states_[node]->buffer = std::move(iter->second);
+        node_input_buffers_dict_->erase(iter);
+      }
+    }
+
+    std::unordered_map<GradNodeBase*, int> in_degree_map = node_in_degree_map_;
+    std::unordered_set<GradNodeBase*> ordered;
+    std::deque<GradNodeBase*> queue = startup_nodes;
+    size_t order = 0;
+    while (!queue.empty()) {
+      GradNodeBase* node = queue.front();
+      queue.pop_front();
+      if ((!queue.empty() && in_degree_map[node] != 0) ||
+          !ordered.insert(node).second) {
+        continue;
+      }
+      node_states_[node]->order = order++;
+      for (const auto& meta_list : node->OutputMeta()) {
+        for (const GradSlotMeta& meta : meta_list) {
+          GradNodeBase* next_node = meta.GetEdge().GetMutableGradNode().get();
+          if (!next_node || --in_degree_map[next_node] != 0) {
+            continue;
+          }
+          if (dynamic_cast<egr::GradNodeAccumulation*>(next_node)) {
+            queue.push_front(next_node);
+          } else {
+            queue.push_back(next_node);
+          }
+        }
+      }
+    }
+  }
+
+  void Schedule(GradNodeBase* node) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++running_tasks_;
+    }
+    pool_->Run([this, node] { Execute(node); });
+  }
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [this] { return running_tasks_ == 0; });
+  }
+
+  void Execute(GradNodeBase* node) {
+    {
+      ParallelBackwardWorkerGuard guard(tracer_, has_grad_);
+      while (node != nullptr && !HasError()) {
+        try {
+          node = RunNode(node);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (error_ == nullptr) {
+            error_ = std::current_exception();
+          }
+          node = nullptr;
+        }
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--running_tasks_ == 0) {
+      finished_.notify_all();
+    }
+  }
+
+  bool HasError() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_ != nullptr;
+  }
+
+  // Runs node and passes its grad outputs to the next nodes. Returns one of
+  // the next nodes that became ready to be run by the calling thread, or
+  // nullptr.
+  GradNodeBase* RunNode(GradNodeBase* node) {
+    VLOG(3) << "Preparing GradNode:" << node->name() << " addr:" << node;
+    paddle::platform::RecordEvent node_record_event(
+        std::string((*node).name()),
+        paddle::platform::TracerEventType::Operator,
+        1);
+    NodeState* state = node_states_.at(node).get();
+    std::unique_ptr<GradTensorHolder> node_input_buffer;
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      AddPendingGrads(state);
+      node_input_buffer = std::move(state->buffer);
+      state->started = true;
+    }
+    PADDLE_ENFORCE_NOT_NULL(
+        node_input_buffer.get(),
+        paddle::platform::errors::Fatal(
+            "Unable to find next node in the GradTensorHolder \n"
+            "Trying to run Node without configuring its GradTensorHolder."));
+
+    // Check input
+    EnforceGradNodeHasInput(node);
+
+    VLOG(7) << "Run Backward Kernel with GradTensorHolder.";
+    paddle::small_vector<std::vector<paddle::Tensor>, kSlotSmallVectorSize>
+        grad_output_tensors;
+    {
+      // Accumulation nodes write leaf grads and run the reduce hooks of
+      // data parallel, which are not thread safe, so they run one by one.
+      std::unique_lock<std::mutex> lock(accumulation_mutex_,
+                                        std::defer_lock);
+      if (dynamic_cast<egr::GradNodeAccumulation*>(node)) {
+        lock.lock();
+      }
+      grad_output_tensors = (*node)(node_input_buffer->Buffers(),
+                                    /*create_graph=*/false,
+                                    /*is_new_grad=*/false);
+    }
+
+    if (!retain_graph_) {
+      VLOG(3)
+          << "retain_graph is false, need to clear the TensorWrapper of nodes.";
+      node->ClearTensorWrappers();
+    }
+    node_input_buffer.reset();
+
+    const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+        metas = node->OutputMeta();
+    PADDLE_ENFORCE(metas.size() == grad_output_tensors.size() || metas.empty(),
+                   paddle::platform::errors::Fatal(
+                       "Number of edges should be either empty ( for leaf node "
+                       ") or the same as number of output grad tensors, but we "
+                       "got edges size is: %d, grad_output size is: %d",
+                       metas.size(),
+                       grad_output_tensors.size()));
+
+    std::vector<GradNodeBase*> ready_nodes;
+    for (size_t i = 0; i < metas.size(); i++) {
+      for (size_t j = 0; j < metas[i].size(); j++) {
+        const Edge& edge = metas[i][j].GetEdge();
+        if (!edge.IsInitialized()) {
+          continue;
+        }
+        auto edge_rank = edge.GetEdgeRankInfo();
+        auto next_node_shared = edge.GetMutableGradNode();
+        if (!next_node_shared || !next_node_shared.get() ||
+            grad_output_tensors[i].empty()) {
+          continue;
+        }
+        PADDLE_ENFORCE_LT(
+            j,
+            grad_output_tensors[i].size(),
+            paddle::platform::errors::Fatal(
+                "Rank of grad_output_tensors should be less than "
+                "grad_output_tensors[i].size(), which is: %d. This error may "
+                "indicate autoprune or autograd api error. ",
+                grad_output_tensors.size()));
+        paddle::Tensor& grad_output_tensor = grad_output_tensors[i][j];
+
+        auto* next_node = next_node_shared.get();
+        NodeState* next_state = node_states_.at(next_node).get();
+        std::lock_guard<std::mutex> lock(next_state->mutex);
+        if (next_state->buffer == nullptr) {
+          next_state->buffer =
+              std::make_unique<GradTensorHolder>(next_node->InputMeta());
+        }
+        if (deterministic_) {
+          next_state->pending_grads.push_back(
+              PendingGrad{std::make_tuple(state->order, i, j),
+                          edge_rank.first,
+                          edge_rank.second,
+                          grad_output_tensor});
+        } else {
+          next_state->buffer->add(
+              edge_rank.first, edge_rank.second, grad_output_tensor, false);
+        }
+
+        next_state->in_degree--;
+        PADDLE_ENFORCE(
+            next_state->in_degree >= 0,
+            paddle::platform::errors::Fatal(
+                "Detected in-degree value smaller than zero. For Node: %s"
+                "Node's in-degree cannot be negative.",
+                next_node->name()));
+        if (next_state->in_degree == 0) {
+          ready_nodes.push_back(next_node);
+        }
+      }
+    }
+    paddle::memory::LogDeviceMemoryStats(place_, std::string((*node).name()));
+
+    if (ready_nodes.empty()) {
+      return nullptr;
+    }
+    auto next_iter = std::find_if(
+        ready_nodes.begin(), ready_nodes.end(), [](GradNodeBase* next_node) {
+          return dynamic_cast<egr::GradNodeAccumulation*>(next_node) !=
+                 nullptr;
+        });
+    if (next_iter == ready_nodes.end()) {
+      next_iter = ready_nodes.begin();
+    }
+    for (auto iter = ready_nodes.begin(); iter != ready_nodes.end(); ++iter) {
+      if (iter != next_iter) {
+        Schedule(*iter);
+      }
+    }
+    return *next_iter;
+  }
+
+  // Sums the grads kept for the node in deterministic mode. Must hold the
+  // lock of state.
+  void AddPendingGrads(NodeState* state) {
+    std::sort(state->pending_grads.begin(),
+              state->pending_grads.end(),
+              [](const PendingGrad& a, const PendingGrad& b) {
+                return a.key < b.key;
+              });
+    for (auto& grad : state->pending_grads) {
+      state->buffer->add(grad.slot_id, grad.rank, grad.tensor, false);
+    }
+    state->pending_grads.clear();
+  }
+
+  std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+      node_input_buffers_dict_;
+  const std::unordered_map<GradNodeBase*, int>& node_in_degree_map_;
+  paddle::platform::Place place_;
+  bool retain_graph_;
+  bool deterministic_;
+  std::shared_ptr<paddle::imperative::Tracer> tracer_;
+  bool has_grad_;
+  phi::ThreadPool* pool_;
+
+  std::unordered_map<GradNodeBase*, std::unique_ptr<NodeState>> node_states_;
+  std::mutex accumulation_mutex_;
+  std::mutex mutex_;
+  std::condition_variable finished_;
+  size_t running_tasks_{0};
+  std::exception_ptr error_{nullptr};
+};
+
+}  // namespace
+
 GeneralGrad* GeneralGrad::general_grad_ = new GeneralGrad();
 
 std::vector<paddle::Tensor> RunBackward(
@@ -243,6 +640,21 @@ std::vector<paddle::Tensor> RunBackward(
 
   VLOG(5) << "Startup_ops's size is " << queue.size();
 
+  if (UseParallelBackward(place,
+                          is_general_grad,
+                          create_graph,
+                          !force_sequential_nodes_set.empty())) {
+    VLOG(3) << "Run Backward with " << FLAGS_eager_backward_num_threads
+            << " threads";
+    ParallelBackwardExecutor executor(&node_input_buffers_dict,
+                                      node_in_degree_map,
+                                      place,
+                                      retain_graph,
+                                      FLAGS_eager_backward_deterministic);
+    executor.Run(queue);
+    queue.clear();
+  }
+
   /* --- Topological Visit --- */
   // 1. Pop queue
   // 2. Run node
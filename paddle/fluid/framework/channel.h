@@ -22,8 +22,10 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>  // NOLINT
 #include <deque>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -45,11 +47,57 @@ class ChannelObject {
     capacity_ = (std::min)(MaxCapacity(), capacity);
   }
 
-  const std::deque<T>& GetData() const { return data_; }
+  // a sharded channel moves its data into the first shard to return it
+  const std::deque<T>& GetData() {
+    if (shards_.empty()) {
+      return data_;
+    }
+    Shard& first = *shards_[0];
+    for (size_t i = 1; i < shards_.size(); ++i) {
+      Shard& shard = *shards_[i];
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      if (shard.data.empty()) {
+        continue;
+      }
+      std::lock_guard<std::mutex> first_lock(first.mutex);
+      std::move(shard.data.begin(),
+                shard.data.end(),
+                std::back_inserter(first.data));
+      shard.data.clear();
+    }
+    return first.data;
+  }
   void Clear() {
     std::unique_lock<std::mutex> lock(mutex_);
     data_.clear();
     data_.shrink_to_fit();
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> shard_lock(shard->mutex);
+      shard->data.clear();
+      shard->data.shrink_to_fit();
+    }
+    sharded_size_ = 0;
+    Notify();
+  }
+
+  size_t ShardNum() { return shards_.empty() ? 1 : shards_.size(); }
+
+  // With shard_num > 1 the data is kept in shard_num queues with their own
+  // locks. Each thread writes to and first reads from the shard it is hashed
+  // to, so producers and consumers on different threads rarely contend, and
+  // mutex_ is only taken to wait while the channel is empty or full. The
+  // data is no longer read in the order it is written. Can only be called
+  // when the channel is empty.
+  void SetShardNum(size_t shard_num) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CHECK(EmptyUnlocked()) << "can only set shard num of an empty channel";
+    shards_.clear();
+    if (shard_num > 1) {
+      CHECK(capacity_ > 0) << "a sharded channel must have capacity";
+      for (size_t i = 0; i < shard_num; ++i) {
+        shards_.emplace_back(new Shard());
+      }
+    }
   }
 
   size_t Capacity() {
@@ -74,9 +122,12 @@ class ChannelObject {
 
   template <class U>
   void InheritFrom(const std::shared_ptr<ChannelObject<U>>& other) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    capacity_ = other->Capacity();
-    block_size_ = other->BlockSize();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      capacity_ = other->Capacity();
+      block_size_ = other->BlockSize();
+    }
+    SetShardNum(other->ShardNum());
   }
 
   bool Closed() {
@@ -94,15 +145,25 @@ class ChannelObject {
   void Close() {
     std::lock_guard<std::mutex> lock(mutex_);
     closed_ = true;
+    if (!shards_.empty()) {
+      empty_cond_.notify_all();
+      full_cond_.notify_all();
+    }
     Notify();
   }
 
   size_t Size() {
+    if (!shards_.empty()) {
+      return sharded_size_;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
     return data_.size();
   }
 
   bool Empty() {
+    if (!shards_.empty()) {
+      return sharded_size_ == 0;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
     return EmptyUnlocked();
   }
@@ -116,6 +177,9 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
+    if (!shards_.empty()) {
+      return ShardedRead(n, p, false);
+    }
 
     std::unique_lock<std::mutex> lock(mutex_);
     size_t finished = Read(n, p, lock);
@@ -135,6 +199,9 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
+    if (!shards_.empty()) {
+      return ShardedWrite(n, p);
+    }
     std::unique_lock<std::mutex> lock(mutex_);
     size_t finished = Write(n, p, lock);
     Notify();
@@ -146,6 +213,9 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
+    if (!shards_.empty()) {
+      return ShardedWrite(n, std::make_move_iterator(p));
+    }
     std::unique_lock<std::mutex> lock(mutex_);
     size_t finished = WriteMove(n, p, lock);
     Notify();
@@ -164,6 +234,12 @@ class ChannelObject {
     if (size == 0) {
       return 0;
     }
+    if (!shards_.empty()) {
+      p.resize(size);
+      size_t finished = ShardedRead(size, &p[0], true);
+      p.resize(finished);
+      return finished;
+    }
     std::unique_lock<std::mutex> lock(mutex_);
     p.resize(size);
     size_t finished = Read(size, &p[0], lock, true);
@@ -194,17 +270,25 @@ class ChannelObject {
   size_t Write(std::vector<T>&& p) { return WriteMove(p.size(), &p[0]); }
 
  private:
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::deque<T> data;
+  };
+
   size_t capacity_ = MaxCapacity();
   size_t block_size_ = 1024;
-  bool closed_ = false;
+  std::atomic<bool> closed_{false};
   std::mutex mutex_;
   // use deque to store data
   std::deque<T> data_;
   size_t reading_count_ = 0;
-  int empty_waiters_ = 0;
-  int full_waiters_ = 0;
+  std::atomic<int> empty_waiters_{0};
+  std::atomic<int> full_waiters_{0};
   std::condition_variable empty_cond_;
   std::condition_variable full_cond_;
+  // used instead of data_ when the channel is sharded
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<size_t> sharded_size_{0};
 
   static constexpr size_t MaxCapacity() {
     return (std::numeric_limits<size_t>::max)() / 2;
@@ -219,9 +303,103 @@ class ChannelObject {
     }
   }
 
-  bool EmptyUnlocked() { return data_.empty(); }
+  bool EmptyUnlocked() {
+    return shards_.empty() ? data_.empty() : sharded_size_ == 0;
+  }
+
+  bool FullUnlocked() {
+    return shards_.empty() ? data_.size() >= capacity_ + reading_count_
+                           : sharded_size_ >= capacity_;
+  }
+
+  // the shard a thread writes to and reads from first
+  size_t HomeShard() {
+    static std::atomic<size_t> thread_count{0};
+    thread_local size_t thread_index = thread_count++;
+    return thread_index % shards_.size();
+  }
+
+  // Waiters register themselves before checking the size under mutex_, and
+  // the other side changes the size before checking for waiters, so a
+  // wakeup can not be lost between them. Writers add to the size before
+  // they push the data, so it never drops below the number of queued data,
+  // and a reader which finds the shards empty while the size is not zero
+  // retries until the data arrives.
+  void NotifySharded(std::atomic<int>* waiters,
+                     std::condition_variable* cond) {
+    if (*waiters != 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cond->notify_all();
+    }
+  }
+
+  size_t ShardedRead(size_t n, T* p, bool once) {
+    size_t finished = 0;
+    size_t home = HomeShard();
+    while (true) {
+      size_t taken = 0;
+      for (size_t i = 0; i < shards_.size() && finished < n; ++i) {
+        Shard& shard = *shards_[(home + i) % shards_.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t m = (std::min)(n - finished, shard.data.size());
+        for (size_t j = 0; j < m; j++) {
+          p[finished++] = std::move(shard.data.front());
+          shard.data.pop_front();
+        }
+        taken += m;
+      }
+      if (taken > 0) {
+        sharded_size_ -= taken;
+        NotifySharded(&full_waiters_, &full_cond_);
+      }
+      if (finished == n || (once && finished > 0)) {
+        break;
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      empty_waiters_++;
+      while (sharded_size_ == 0 && !closed_) {
+        empty_cond_.wait(lock);
+      }
+      empty_waiters_--;
+      if (sharded_size_ == 0) {
+        break;
+      }
+    }
+    return finished;
+  }
 
-  bool FullUnlocked() { return data_.size() >= capacity_ + reading_count_; }
+  // It is a const T* for Write() and a move iterator for WriteMove().
+  template <class Iter>
+  size_t ShardedWrite(size_t n, Iter p) {
+    size_t finished = 0;
+    Shard& shard = *shards_[HomeShard()];
+    while (finished < n && !closed_) {
+      // reserve room for m data
+      size_t size = sharded_size_;
+      size_t m = 0;
+      do {
+        m = size < capacity_ ? (std::min)(n - finished, capacity_ - size) : 0;
+      } while (m > 0 &&
+               !sharded_size_.compare_exchange_weak(size, size + m));
+      if (m == 0) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        full_waiters_++;
+        while (sharded_size_ >= capacity_ && !closed_) {
+          full_cond_.wait(lock);
+        }
+        full_waiters_--;
+        continue;
+      }
+      {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (size_t i = 0; i < m; i++) {
+          shard.data.push_back(p[finished++]);
+        }
+      }
+      NotifySharded(&empty_waiters_, &empty_cond_);
+    }
+    return finished;
+  }
 
   bool WaitForRead(std::unique_lock<std::mutex>& lock) {  // NOLINT
 #ifdef _LINUX
@@ -26,6 +26,8 @@ limitations under the License. */
 #include <sys/stat.h>
 #endif
 #include "io/fs.h"
+#include "paddle/fluid/framework/slot_line_parser.h"
+#include "paddle/fluid/framework/slot_record_file.h"
 #include "paddle/fluid/platform/monitor.h"
 #include "paddle/fluid/platform/timer.h"
 
@@ -849,13 +851,10 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
     int use_slots_num = use_slots_.size();
     instance->resize(use_slots_num);
     const char* str = reader.get();
-    std::string line = std::string(str);
-
-    char* endptr = const_cast<char*>(str);
-    int pos = 0;
+    SlotLineParser parser(str, reader.length());
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = parser.NextCount();
 
       if (num <= 0) {
         std::stringstream ss;
@@ -864,7 +863,7 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
         ss << "The Origin Input Data:\n";
         ss << "----------------------\n";
 
-        ss << line << "\n";
+        ss << str << "\n";
 
         ss << "\n----------------------\n";
         ss << "Some Possible Errors:\n";
@@ -882,23 +881,15 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
         (*instance)[idx].Init(all_slots_type_[i]);
         if ((*instance)[idx].GetType()[0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
-            (*instance)[idx].AddValue(feasign);
+            (*instance)[idx].AddValue(parser.NextFloat());
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
-            (*instance)[idx].AddValue(feasign);
+            (*instance)[idx].AddValue(parser.NextUint64());
           }
         }
-        pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          // pos = line.find_first_of(' ', pos + 1);
-          while (line[pos + 1] != ' ') {
-            pos++;
-          }
-        }
+        parser.SkipTokens(num);
       }
     }
     return true;
@@ -916,11 +907,10 @@ bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
     instance->resize(use_slots_num);
     // parse line
     const char* str = line.c_str();
-    char* endptr = const_cast<char*>(str);
-    int pos = 0;
+    SlotLineParser parser(str, line.size());
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = parser.NextCount();
       PADDLE_ENFORCE_NE(
           num,
           0,
@@ -942,20 +932,15 @@ bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
         (*instance)[idx].Init(all_slots_type_[i]);
         if ((*instance)[idx].GetType()[0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
-            (*instance)[idx].AddValue(feasign);
+            (*instance)[idx].AddValue(parser.NextFloat());
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
-            (*instance)[idx].AddValue(feasign);
+            (*instance)[idx].AddValue(parser.NextUint64());
           }
         }
-        pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          pos = line.find_first_of(' ', pos + 1);
-        }
+        parser.SkipTokens(num);
       }
     }
   } else {
@@ -1136,44 +1121,29 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
     return false;
   } else {
     const char* str = reader.get();
-    std::string line = std::string(str);
-    // VLOG(3) << line;
-    char* endptr = const_cast<char*>(str);
-    int pos = 0;
+    SlotLineParser parser(str, reader.length());
+    const char* token = nullptr;
+    size_t len = 0;
     if (parse_ins_id_) {
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = parser.NextCount();
       CHECK(num == 1);  // NOLINT
-      pos = endptr - str + 1;
-      size_t len = 0;
-      while (str[pos + len] != ' ') {
-        ++len;
-      }
-      instance->ins_id_ = std::string(str + pos, len);
-      pos += len + 1;
+      parser.NextToken(&token, &len);
+      instance->ins_id_ = std::string(token, len);
       VLOG(3) << "ins_id " << instance->ins_id_;
     }
     if (parse_content_) {
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = parser.NextCount();
       CHECK(num == 1);  // NOLINT
-      pos = endptr - str + 1;
-      size_t len = 0;
-      while (str[pos + len] != ' ') {
-        ++len;
-      }
-      instance->content_ = std::string(str + pos, len);
-      pos += len + 1;
+      parser.NextToken(&token, &len);
+      instance->content_ = std::string(token, len);
       VLOG(3) << "content " << instance->content_;
     }
     if (parse_logkey_) {
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = parser.NextCount();
       CHECK(num == 1);  // NOLINT
-      pos = endptr - str + 1;
-      size_t len = 0;
-      while (str[pos + len] != ' ') {
-        ++len;
-      }
+      parser.NextToken(&token, &len);
       // parse_logkey
-      std::string log_key = std::string(str + pos, len);
+      std::string log_key = std::string(token, len);
       uint64_t search_id;
       uint32_t cmatch;
       uint32_t rank;
@@ -1183,11 +1153,10 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
       instance->search_id = search_id;
       instance->cmatch = cmatch;
       instance->rank = rank;
-      pos += len + 1;
     }
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = parser.NextCount();
       PADDLE_ENFORCE_NE(
           num,
           0,
@@ -1212,15 +1181,14 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
                            "please check this error line: %s",
                            str));
 
-        char* uidptr = endptr;
-        uint64_t feasign = (uint64_t)strtoull(uidptr, &uidptr, 10);
-        instance->uid_ = feasign;
+        SlotLineParser uid_parser = parser;
+        instance->uid_ = uid_parser.NextUint64();
       }
 #endif
       if (idx != -1) {
         if (all_slots_type_[i][0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = parser.NextFloat();
             // if float feasign is equal to zero, ignore it
             // except when slot is dense
             if (fabs(feasign) < 1e-6 && !use_slots_is_dense_[i]) {
@@ -1232,7 +1200,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = parser.NextUint64();
             // if uint64 feasign is equal to zero, ignore it
             // except when slot is dense
             if (feasign == 0 && !use_slots_is_dense_[i]) {
@@ -1243,14 +1211,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
             instance->uint64_feasigns_.emplace_back(f, idx);
           }
         }
-        pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          // pos = line.find_first_of(' ', pos + 1);
-          while (line[pos + 1] != ' ') {
-            pos++;
-          }
-        }
+        parser.SkipTokens(num);
       }
     }
     instance->float_feasigns_.shrink_to_fit();
@@ -1270,11 +1232,10 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
     VLOG(3) << line;
     // parse line
     const char* str = line.c_str();
-    char* endptr = const_cast<char*>(str);
-    int pos = 0;
+    SlotLineParser parser(str, line.size());
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = parser.NextCount();
       PADDLE_ENFORCE_NE(
           num,
           0,
@@ -1295,7 +1256,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
       if (idx != -1) {
         if (all_slots_type_[i][0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = parser.NextFloat();
             if (fabs(feasign) < 1e-6) {
               continue;
             }
@@ -1305,7 +1266,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = parser.NextUint64();
             if (feasign == 0) {
               continue;
             }
@@ -1314,11 +1275,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
             instance->uint64_feasigns_.emplace_back(f, idx);
           }
         }
-        pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          pos = line.find_first_of(' ', pos + 1);
-        }
+        parser.SkipTokens(num);
       }
     }
     instance->float_feasigns_.shrink_to_fit();
@@ -2345,6 +2303,10 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByCommand() {
   while (this->PickOneFile(&filename)) {
     VLOG(3) << "PickOneFile, filename=" << filename
             << ", thread_id=" << thread_id_;
+    if (IsSlotRecordFile(filename)) {
+      LoadIntoMemoryFromSlotRecordFile(filename);
+      continue;
+    }
     int lines = 0;
     std::vector<SlotRecord> record_vec;
     platform::Timer timeline;
@@ -2401,6 +2363,59 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByCommand() {
 #endif
 }
 
+void SlotRecordInMemoryDataFeed::LoadIntoMemoryFromSlotRecordFile(
+    const std::string& filename) {
+  platform::Timer timeline;
+  timeline.Start();
+  SlotRecordFileReader reader(filename);
+  SlotRecordFileSchema schema;
+  for (auto& info : used_slots_info_) {
+    schema.slot_names.push_back(info.slot);
+    schema.slot_types.push_back(info.type[0]);
+  }
+  PADDLE_ENFORCE_EQ(reader.schema() == schema,
+                    true,
+                    platform::errors::InvalidArgument(
+                        "The slots of SlotRecord file %s are different from "
+                        "the used slots of the data feed.",
+                        filename));
+
+  std::default_random_engine engine(std::random_device{}());
+  std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+  bool sample = std::abs(sample_rate_ - 1.0f) >= 1e-5f;
+  size_t records = 0;
+  std::vector<SlotRecord> record_vec;
+  while (reader.NextBlock()) {
+    if (reader.record_num() == 0) {
+      continue;
+    }
+    SlotRecordPool().get(&record_vec, static_cast<int>(reader.record_num()));
+    reader.ReadBlock(&record_vec[0]);
+    if (sample) {
+      size_t num = 0;
+      for (size_t i = 0; i < record_vec.size(); ++i) {
+        if (distribution(engine) < sample_rate_) {
+          std::swap(record_vec[num++], record_vec[i]);
+        }
+      }
+      if (num < record_vec.size()) {
+        SlotRecordPool().put(&record_vec[num], record_vec.size() - num);
+        record_vec.resize(num);
+      }
+    }
+    records += record_vec.size();
+    if (!record_vec.empty()) {
+      input_channel_->Write(std::move(record_vec));
+    }
+    record_vec.clear();
+  }
+  timeline.Pause();
+  VLOG(3) << "LoadIntoMemory() read SlotRecord file, file=" << filename
+          << ", records=" << records
+          << ", cost time=" << timeline.ElapsedSec()
+          << " seconds, thread_id=" << thread_id_;
+}
+
 static void parser_log_key(const std::string& log_key,
                            uint64_t* search_id,
                            uint32_t* cmatch,
@@ -2419,35 +2434,22 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
   SlotRecord& rec = (*ins);
   // parse line
   const char* str = line.c_str();
-  char* endptr = const_cast<char*>(str);
-  int pos = 0;
-
-  thread_local std::vector<std::vector<float>> slot_float_feasigns;
-  thread_local std::vector<std::vector<uint64_t>> slot_uint64_feasigns;
-  slot_float_feasigns.resize(float_use_slot_size_);
-  slot_uint64_feasigns.resize(uint64_use_slot_size_);
+  SlotLineParser parser(str, line.size());
+  const char* token = nullptr;
+  size_t len = 0;
 
   if (parse_ins_id_) {
-    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+    int num = parser.NextCount();
     CHECK(num == 1);  // NOLINT
-    pos = static_cast<int>(endptr - str + 1);
-    size_t len = 0;
-    while (str[pos + len] != ' ') {
-      ++len;
-    }
-    rec->ins_id_ = std::string(str + pos, len);
-    pos += static_cast<int>(len + 1);
+    parser.NextToken(&token, &len);
+    rec->ins_id_ = std::string(token, len);
   }
   if (parse_logkey_) {
-    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+    int num = parser.NextCount();
     CHECK(num == 1);  // NOLINT
-    pos = static_cast<int>(endptr - str + 1);
-    size_t len = 0;
-    while (str[pos + len] != ' ') {
-      ++len;
-    }
+    parser.NextToken(&token, &len);
     // parse_logkey
-    std::string log_key = std::string(str + pos, len);
+    std::string log_key = std::string(token, len);
     uint64_t search_id = 0;
     uint32_t cmatch = 0;
     uint32_t rank = 0;
@@ -2457,14 +2459,20 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
     rec->search_id = search_id;
     rec->cmatch = cmatch;
     rec->rank = rank;
-    pos += static_cast<int>(len + 1);
   }
 
-  int float_total_slot_num = 0;
-  int uint64_total_slot_num = 0;
+  // The feasigns are decoded straight into the value arrays of the record,
+  // which keep their capacity while the record is in the SlotObjPool. Used
+  // slots are numbered by slot_value_idx in the order they appear in the
+  // line, so the offset of each slot is its start in the values.
+  auto& float_feasigns = rec->slot_float_feasigns_;
+  auto& uint64_feasigns = rec->slot_uint64_feasigns_;
+  float_feasigns.slot_offsets.resize(float_use_slot_size_ + 1);
+  uint64_feasigns.slot_offsets.resize(uint64_use_slot_size_ + 1);
+  size_t uint64_begin = uint64_feasigns.slot_values.size();
 
   for (auto& info : all_slots_info_) {
-    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+    int num = parser.NextCount();
     PADDLE_ENFORCE(num,
                    "The number of ids can not be zero, you need padding "
                    "it in data generator; or if there is something wrong with "
@@ -2473,42 +2481,34 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
                    str);
     if (info.used_idx != -1) {
       if (info.type[0] == 'f') {  // float
-        auto& slot_fea = slot_float_feasigns[info.slot_value_idx];
-        slot_fea.clear();
+        auto& values = float_feasigns.slot_values;
+        float_feasigns.slot_offsets[info.slot_value_idx] =
+            static_cast<uint32_t>(values.size());
         for (int j = 0; j < num; ++j) {
-          float feasign = strtof(endptr, &endptr);
+          float feasign = parser.NextFloat();
           if (fabs(feasign) < 1e-6 && !used_slots_info_[info.used_idx].dense) {
             continue;
           }
-          slot_fea.push_back(feasign);
-          ++float_total_slot_num;
+          values.push_back(feasign);
         }
       } else if (info.type[0] == 'u') {  // uint64
-        auto& slot_fea = slot_uint64_feasigns[info.slot_value_idx];
-        slot_fea.clear();
+        auto& values = uint64_feasigns.slot_values;
+        uint64_feasigns.slot_offsets[info.slot_value_idx] =
+            static_cast<uint32_t>(values.size());
         for (int j = 0; j < num; ++j) {
-          uint64_t feasign =
-              static_cast<uint64_t>(strtoull(endptr, &endptr, 10));
-          slot_fea.push_back(feasign);
-          ++uint64_total_slot_num;
+          values.push_back(parser.NextUint64());
         }
       }
-      pos = static_cast<int>(endptr - str);
     } else {
-      for (int j = 0; j <= num; ++j) {
-        // pos = line.find_first_of(' ', pos + 1);
-        while (line[pos + 1] != ' ') {
-          pos++;
-        }
-      }
+      parser.SkipTokens(num);
     }
   }
-  rec->slot_float_feasigns_.add_slot_feasigns(slot_float_feasigns,
-                                              float_total_slot_num);
-  rec->slot_uint64_feasigns_.add_slot_feasigns(slot_uint64_feasigns,
-                                               uint64_total_slot_num);
+  float_feasigns.slot_offsets[float_use_slot_size_] =
+      static_cast<uint32_t>(float_feasigns.slot_values.size());
+  uint64_feasigns.slot_offsets[uint64_use_slot_size_] =
+      static_cast<uint32_t>(uint64_feasigns.slot_values.size());
 
-  return (uint64_total_slot_num > 0);
+  return (uint64_feasigns.slot_values.size() > uint64_begin);
 }
 
 void SlotRecordInMemoryDataFeed::AssignFeedVar(const Scope& scope) {
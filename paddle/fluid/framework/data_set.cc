@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/framework/data_set.h"
 
+#include <exception>
+
 #include "google/protobuf/text_format.h"
 #if (defined PADDLE_WITH_DISTRIBUTE) && (defined PADDLE_WITH_PSCORE)
 #include "paddle/fluid/distributed/index_dataset/index_sampler.h"
@@ -22,6 +24,7 @@
 #include "paddle/fluid/framework/data_feed_factory.h"
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
 #include "paddle/fluid/framework/io/fs.h"
+#include "paddle/fluid/framework/slot_record_file.h"
 #include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/platform/monitor.h"
 #include "paddle/fluid/platform/timer.h"
@@ -42,6 +45,7 @@ COMMON_DECLARE_bool(graph_get_neighbor_id);
 COMMON_DECLARE_int32(gpugraph_storage_mode);
 COMMON_DECLARE_string(graph_edges_split_mode);
 COMMON_DECLARE_bool(query_dest_rank_by_multi_node);
+COMMON_DECLARE_int32(dataset_channel_shard_num);
 
 namespace paddle {
 namespace framework {
@@ -225,21 +229,32 @@ std::vector<paddle::framework::DataFeed*> DatasetImpl<T>::GetReaders() {
   return ret;
 }
 
+// channel of the instances between readers and workers, which is sharded
+// when FLAGS_dataset_channel_shard_num > 1
+template <typename T>
+static paddle::framework::Channel<T> MakeDatasetChannel() {
+  auto channel = paddle::framework::MakeChannel<T>();
+  if (FLAGS_dataset_channel_shard_num > 1) {
+    channel->SetShardNum(FLAGS_dataset_channel_shard_num);
+  }
+  return channel;
+}
+
 template <typename T>
 void DatasetImpl<T>::CreateChannel() {
   if (input_channel_ == nullptr) {
-    input_channel_ = paddle::framework::MakeChannel<T>();
+    input_channel_ = MakeDatasetChannel<T>();
   }
   if (multi_output_channel_.empty()) {
     multi_output_channel_.reserve(channel_num_);
     for (int i = 0; i < channel_num_; ++i) {
-      multi_output_channel_.push_back(paddle::framework::MakeChannel<T>());
+      multi_output_channel_.push_back(MakeDatasetChannel<T>());
     }
   }
   if (multi_consume_channel_.empty()) {
     multi_consume_channel_.reserve(channel_num_);
     for (int i = 0; i < channel_num_; ++i) {
-      multi_consume_channel_.push_back(paddle::framework::MakeChannel<T>());
+      multi_consume_channel_.push_back(MakeDatasetChannel<T>());
     }
   }
   if (input_pv_channel_ == nullptr) {
@@ -747,6 +762,13 @@ void DatasetImpl<T>::DumpSampleNeighbors(std::string dump_path) {
 #endif
 }
 
+template <typename T>
+void DatasetImpl<T>::DumpSlotRecordFiles(const std::string& path UNUSED,
+                                         int file_num UNUSED) {
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "DumpSlotRecordFiles is only supported by SlotRecordDataset."));
+}
+
 // do tdm sample
 void MultiSlotDataset::TDMSample(const std::string tree_name,
                                  const std::string tree_path,
@@ -1015,8 +1037,8 @@ void DatasetImpl<T>::DynamicAdjustChannelNum(int channel_num,
   for (int i = 0; i < channel_num; ++i) {
     local_vec.clear();
     total_data_channel->Read(local_vec);
-    new_other_channels.push_back(paddle::framework::MakeChannel<T>());
-    new_channels.push_back(paddle::framework::MakeChannel<T>());
+    new_other_channels.push_back(MakeDatasetChannel<T>());
+    new_channels.push_back(MakeDatasetChannel<T>());
     new_channels[i]->Write(std::move(local_vec));
     new_other_pv_channels.push_back(
         paddle::framework::MakeChannel<PvInstance>());
@@ -1860,7 +1882,7 @@ void MultiSlotDataset::SlotsShuffle(
 template class DatasetImpl<SlotRecord>;
 void SlotRecordDataset::CreateChannel() {
   if (input_channel_ == nullptr) {
-    input_channel_ = paddle::framework::MakeChannel<SlotRecord>();
+    input_channel_ = MakeDatasetChannel<SlotRecord>();
   }
 }
 void SlotRecordDataset::CreateReaders() {
@@ -2033,6 +2055,70 @@ void SlotRecordDataset::DynamicAdjustBatchNum() {
 #endif
 }
 
+void SlotRecordDataset::DumpSlotRecordFiles(const std::string& path,
+                                            int file_num) {
+  VLOG(3) << "SlotRecordDataset::DumpSlotRecordFiles() begin";
+  PADDLE_ENFORCE_GT(file_num,
+                    0,
+                    platform::errors::InvalidArgument(
+                        "The number of SlotRecord files should be greater "
+                        "than 0, but received %d.",
+                        file_num));
+  platform::Timer timeline;
+  timeline.Start();
+
+  // the records stay in memory, after PrepareTrain they are in input_records_
+  std::vector<SlotRecord> channel_records;
+  const std::vector<SlotRecord>* records = &input_records_;
+  if (input_records_.empty() && input_channel_ != nullptr &&
+      input_channel_->Size() != 0) {
+    input_channel_->Close();
+    input_channel_->ReadAll(channel_records);
+    records = &channel_records;
+  }
+
+  SlotRecordFileSchema schema =
+      SlotRecordFileSchema::FromDataFeedDesc(data_feed_desc_);
+  size_t record_num = records->size();
+  size_t file_records = (record_num + file_num - 1) / file_num;
+  std::vector<std::thread> dump_threads;
+  // the errors of the workers are rethrown here after they all finish
+  std::vector<std::exception_ptr> dump_errors(file_num);
+  for (int i = 0; i < file_num; ++i) {
+    size_t begin = std::min(record_num, i * file_records);
+    size_t end = std::min(record_num, begin + file_records);
+    dump_threads.push_back(std::thread([&, i, begin, end]() {
+      try {
+        std::string filename = string::format_string(
+            "%s/part-%05d%s", path.c_str(), i, kSlotRecordFileSuffix);
+        SlotRecordFileWriter writer(filename, schema);
+        writer.Write(records->data() + begin, end - begin);
+        writer.Close();
+      } catch (...) {
+        dump_errors[i] = std::current_exception();
+      }
+    }));
+  }
+  for (std::thread& t : dump_threads) {
+    t.join();
+  }
+
+  if (!channel_records.empty()) {
+    input_channel_->Open();
+    input_channel_->Write(std::move(channel_records));
+    input_channel_->Close();
+  }
+  for (auto& error : dump_errors) {
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+  }
+  timeline.Pause();
+  VLOG(3) << "SlotRecordDataset::DumpSlotRecordFiles() end, records="
+          << record_num << ", files=" << file_num
+          << ", cost time=" << timeline.ElapsedSec() << " seconds";
+}
+
 void SlotRecordDataset::DynamicAdjustReadersNum(int thread_num) {
   if (thread_num_ == thread_num) {
     DynamicAdjustBatchNum();
@@ -177,6 +177,9 @@ class Dataset {
 
   virtual void DumpWalkPath(std::string dump_path, size_t dump_rate) = 0;
   virtual void DumpSampleNeighbors(std::string dump_path) = 0;
+  // dump the data in memory into file_num SlotRecord files under path, which
+  // are loaded again without parsing text
+  virtual void DumpSlotRecordFiles(const std::string& path, int file_num) = 0;
   virtual const std::vector<uint64_t>& GetGpuGraphTotalKeys() = 0;
   virtual const std::vector<std::vector<uint64_t>*>& GetPassKeysVec() = 0;
   virtual const std::vector<std::vector<uint32_t>*>& GetPassRanksVec() = 0;
@@ -280,6 +283,7 @@ class DatasetImpl : public Dataset {
   virtual void ClearSampleState();
   virtual void DumpWalkPath(std::string dump_path, size_t dump_rate);
   virtual void DumpSampleNeighbors(std::string dump_path);
+  virtual void DumpSlotRecordFiles(const std::string& path, int file_num);
 
   std::vector<paddle::framework::Channel<T>>& GetMultiOutputChannel() {
     return multi_output_channel_;
@@ -440,6 +444,7 @@ class SlotRecordDataset : public DatasetImpl<SlotRecord> {
   virtual void PrepareTrain();
   virtual void DynamicAdjustReadersNum(int thread_num);
   void DynamicAdjustBatchNum();
+  virtual void DumpSlotRecordFiles(const std::string& path, int file_num);
 
  protected:
   bool enable_heterps_ = true;
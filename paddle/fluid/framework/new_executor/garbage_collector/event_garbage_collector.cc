@@ -127,6 +127,7 @@ void InterpreterCoreEventGarbageCollector::Add(
   if (!garbage) {
     return;
   }
+  RecordGarbage(garbage);
 
   if (max_memory_size_ <= 1) {
     Free(garbage, event, ctx);
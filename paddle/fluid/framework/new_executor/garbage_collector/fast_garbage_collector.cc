@@ -85,6 +85,7 @@ void InterpreterCoreFastGarbageCollector::Add(Garbage garbage) {
   if (!garbage) {
     return;
   }
+  RecordGarbage(garbage);
 
   if (max_memory_size_ > 1) {
     std::unique_ptr<GarbageQueue> pending_delete_garbages;
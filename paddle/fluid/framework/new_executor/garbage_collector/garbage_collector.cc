@@ -17,6 +17,7 @@
 #include "paddle/fluid/framework/new_executor/garbage_collector/event_garbage_collector.h"
 #include "paddle/fluid/framework/new_executor/garbage_collector/fast_garbage_collector.h"
 #include "paddle/fluid/framework/new_executor/garbage_collector/no_event_garbage_collector.h"
+#include "paddle/fluid/platform/runtime_metrics.h"
 
 namespace paddle {
 namespace framework {
@@ -27,6 +28,17 @@ InterpreterCoreGarbageCollector::InterpreterCoreGarbageCollector() {
   cur_memory_size_ = 0;
 }
 
+void InterpreterCoreGarbageCollector::RecordGarbage(const Garbage& garbage) {
+  static auto* frees = platform::MetricsRegistry::Instance().GetCounter(
+      "paddle_executor_gc_frees_total",
+      "Number of allocations freed by the executor garbage collectors");
+  static auto* freed_bytes = platform::MetricsRegistry::Instance().GetCounter(
+      "paddle_executor_gc_freed_bytes_total",
+      "Bytes of allocations freed by the executor garbage collectors");
+  frees->Increase();
+  freed_bytes->Increase(static_cast<int64_t>(garbage->size()));
+}
+
 std::unique_ptr<InterpreterCoreGarbageCollector>
 CreateInterpreterCoreGarbageCollector(
     const platform::Place& place,
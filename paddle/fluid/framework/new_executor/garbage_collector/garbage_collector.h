@@ -43,6 +43,9 @@ class InterpreterCoreGarbageCollector {
   DISABLE_COPY_AND_ASSIGN(InterpreterCoreGarbageCollector);
 
  protected:
+  // count the garbage into the runtime metrics
+  void RecordGarbage(const Garbage& garbage);
+
   std::unique_ptr<GarbageQueue> garbages_;
   int64_t max_memory_size_;
   int64_t cur_memory_size_;
@@ -84,6 +84,7 @@ void InterpreterCoreNoEventGarbageCollector::Add(
   if (!garbage) {
     return;
   }
+  RecordGarbage(garbage);
   if (max_memory_size_ <= 1) {
     queue_->AddTask([container = garbage, ctx = ctx]() { ctx->Wait(); });
   } else {
@@ -37,6 +37,7 @@
 #include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
 #include "paddle/fluid/pir/dialect/operator/utils/op_yaml_info_parser.h"
 #include "paddle/fluid/platform/flags.h"
+#include "paddle/fluid/platform/runtime_metrics.h"
 #include "paddle/phi/core/distributed/comm_context_manager.h"
 #include "paddle/phi/core/kernel_context.h"
 #include "paddle/phi/core/kernel_factory.h"
@@ -53,6 +54,7 @@ COMMON_DECLARE_bool(use_mkldnn);
 COMMON_DECLARE_bool(check_nan_inf);
 COMMON_DECLARE_string(static_runtime_data_save_path);
 COMMON_DECLARE_bool(save_static_runtime_data);
+COMMON_DECLARE_bool(enable_executor_metrics);
 
 namespace paddle {
 namespace framework {
@@ -129,6 +131,29 @@ void AsyncWorkQueue::AddTask(const OpFuncType& op_func_type,
   queue_group_->AddTask(op_func_type == OpFuncType::kGpuAsync, std::move(fn));
 }
 
+OpDispatchMetricsGuard::OpDispatchMetricsGuard()
+    : enabled_(FLAGS_enable_executor_metrics) {
+  if (enabled_) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+OpDispatchMetricsGuard::~OpDispatchMetricsGuard() {
+  if (!enabled_) {
+    return;
+  }
+  static auto* ops = platform::MetricsRegistry::Instance().GetCounter(
+      "paddle_executor_ops_total", "Number of ops dispatched by executors");
+  static auto* latency = platform::MetricsRegistry::Instance().GetHistogram(
+      "paddle_executor_op_dispatch_us",
+      "Host time of dispatching an op in microseconds, kernels launched "
+      "asynchronously are not waited");
+  ops->Increase();
+  latency->Observe(std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start_)
+                       .count());
+}
+
 bool IsCommunicationOp(const OperatorBase* op) {
   const std::string& op_name = op->Type();
   const std::set<std::string> special_comm_op_set = {
@@ -66,6 +66,18 @@ class AsyncWorkQueue {
   std::unique_ptr<WorkQueueGroup> queue_group_;
 };
 
+// Counts the op dispatched in its scope and records the host latency of the
+// dispatch into the runtime metrics, if FLAGS_enable_executor_metrics is set.
+class OpDispatchMetricsGuard {
+ public:
+  OpDispatchMetricsGuard();
+  ~OpDispatchMetricsGuard();
+
+ private:
+  bool enabled_;
+  std::chrono::steady_clock::time_point start_;
+};
+
 bool IsCommunicationOp(const OperatorBase* op);
 
 bool IsCommunicationOp(const Instruction& instr);
@@ -0,0 +1,397 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/static_memory_planner.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+namespace {
+
+// large enough for the alignment of any kernel on any device
+constexpr size_t kArenaAlignment = 256;
+
+// no step, offset or block
+constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+size_t AlignTo(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+// A view of [offset, offset + size) of the arena, which keeps the arena alive
+// as long as a tensor holds it.
+class ArenaAllocation : public phi::Allocation {
+ public:
+  ArenaAllocation(const std::shared_ptr<phi::Allocation>& arena,
+                  size_t offset,
+                  size_t size)
+      : phi::Allocation(static_cast<uint8_t*>(arena->ptr()) + offset,
+                        size,
+                        arena->place()),
+        arena_(arena) {}
+
+ private:
+  std::shared_ptr<phi::Allocation> arena_;
+};
+
+const phi::DenseTensor* GetDenseTensor(const Variable* var) {
+  if (var == nullptr || !var->IsType<phi::DenseTensor>()) {
+    return nullptr;
+  }
+  return &var->Get<phi::DenseTensor>();
+}
+
+}  // namespace
+
+size_t AssignMemoryOffsets(std::vector<MemoryBlock>* blocks,
+                           size_t alignment) {
+  std::vector<size_t> order(blocks->size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    const MemoryBlock& lhs = (*blocks)[a];
+    const MemoryBlock& rhs = (*blocks)[b];
+    if (lhs.size != rhs.size) {
+      return lhs.size > rhs.size;
+    }
+    return lhs.first_step < rhs.first_step;
+  });
+
+  // placed blocks, sorted by offset
+  std::vector<size_t> placed;
+  size_t arena_size = 0;
+  for (size_t i : order) {
+    MemoryBlock& block = (*blocks)[i];
+    size_t size = AlignTo(block.size, alignment);
+    size_t best_offset = kNone;
+    size_t best_gap = kNone;
+    size_t prev_end = 0;
+    for (size_t j : placed) {
+      const MemoryBlock& other = (*blocks)[j];
+      if (other.last_step < block.first_step ||
+          other.first_step > block.last_step) {
+        continue;
+      }
+      if (other.offset >= prev_end) {
+        size_t gap = other.offset - prev_end;
+        if (gap >= size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = prev_end;
+        }
+      }
+      prev_end =
+          std::max(prev_end, other.offset + AlignTo(other.size, alignment));
+    }
+    block.offset = best_offset == kNone ? prev_end : best_offset;
+    arena_size = std::max(arena_size, block.offset + size);
+
+    auto pos = std::upper_bound(
+        placed.begin(),
+        placed.end(),
+        block.offset,
+        [&](size_t offset, size_t j) { return offset < (*blocks)[j].offset; });
+    placed.insert(pos, i);
+  }
+  return arena_size;
+}
+
+StaticMemoryPlanner::StaticMemoryPlanner(
+    const std::vector<std::unique_ptr<InstructionBase>>& instructions,
+    const std::vector<size_t>& execute_order,
+    const std::vector<Variable*>& vars,
+    const std::vector<bool>& plannable)
+    : vars_(vars),
+      plannable_(plannable),
+      step_(instructions.size(), 0),
+      var_last_step_(vars.size(), 0) {
+  std::vector<bool> read(vars.size(), false);
+  std::vector<bool> written(vars.size(), false);
+  for (size_t step = 0; step < execute_order.size(); ++step) {
+    const InstructionBase* instr = instructions.at(execute_order[step]).get();
+    step_.at(instr->Id()) = step;
+    for (auto& item : instr->Inputs()) {
+      for (int var_id : item.second) {
+        if (var_id >= 0) {
+          var_last_step_[var_id] = step;
+          read[var_id] = true;
+        }
+      }
+    }
+    for (auto& item : instr->Outputs()) {
+      for (int var_id : item.second) {
+        if (var_id >= 0) {
+          var_last_step_[var_id] = step;
+          written[var_id] = true;
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i < vars.size(); ++i) {
+    if (read[i] && !written[i]) {
+      input_vars_.push_back(i);
+    }
+  }
+}
+
+void StaticMemoryPlanner::BeforeRun() {
+  if (state_ == kPlanned) {
+    if (!need_replan_ && !InputsChanged()) {
+      return;
+    }
+    VLOG(4) << "Drop the static memory plan since "
+            << (need_replan_ ? "a planned buffer is too small"
+                             : "the input shapes changed");
+    DropPlan();
+  }
+
+  // (re)start a profiling run
+  state_ = kProfiling;
+  size_t n = vars_.size();
+  parent_.resize(n + 1);
+  std::iota(parent_.begin(), parent_.end(), 0);
+  recorded_.assign(n + 1, false);
+  first_step_.assign(n + 1, kNone);
+  last_step_.assign(n + 1, 0);
+  std::copy(var_last_step_.begin(), var_last_step_.end(), last_step_.begin());
+  last_step_[n] = kNone;
+  max_size_.assign(n + 1, 0);
+  place_.assign(n + 1, phi::Place());
+  has_place_.assign(n + 1, false);
+  excluded_.assign(n + 1, false);
+  excluded_[n] = true;
+
+  // allocations which are held before the run, by feeds and parameters,
+  // must not be planned even if a kernel shares them with an output
+  owners_.clear();
+  for (size_t i = 0; i < n; ++i) {
+    const phi::DenseTensor* tensor = GetDenseTensor(vars_[i]);
+    if (!plannable_[i] && tensor != nullptr && tensor->Holder()) {
+      owners_[tensor->Holder().get()] = n;
+    }
+  }
+  SaveInputs();
+}
+
+void StaticMemoryPlanner::RecordOutputs(const InstructionBase& instr) {
+  size_t step = step_.at(instr.Id());
+  for (auto& item : instr.Outputs()) {
+    for (int var_id : item.second) {
+      if (var_id < 0) {
+        continue;
+      }
+      const phi::DenseTensor* tensor = GetDenseTensor(vars_[var_id]);
+      if (tensor == nullptr || !tensor->Holder()) {
+        continue;
+      }
+      const phi::Allocation* holder = tensor->Holder().get();
+      recorded_[var_id] = true;
+
+      // the previous owner of the allocation still holds it if it is alive,
+      // otherwise the allocation has been freed and reused
+      auto iter = owners_.find(holder);
+      if (iter != owners_.end() && last_step_[Find(iter->second)] >= step) {
+        Union(iter->second, var_id);
+      }
+      owners_[holder] = var_id;
+
+      size_t root = Find(var_id);
+      first_step_[root] = std::min(first_step_[root], step);
+      max_size_[root] = std::max(max_size_[root], holder->size());
+      if (!plannable_[var_id]) {
+        excluded_[root] = true;
+      }
+      if (!has_place_[root]) {
+        place_[root] = holder->place();
+        has_place_[root] = true;
+      } else if (place_[root] != holder->place()) {
+        excluded_[root] = true;
+      }
+    }
+  }
+}
+
+void StaticMemoryPlanner::AfterRun() {
+  if (state_ == kProfiling) {
+    BuildPlan();
+    return;
+  }
+  // a kernel which needed more memory than planned has replaced the view
+  // with its own allocation
+  for (size_t i = 0; i < vars_.size(); ++i) {
+    if (!planned_[i]) {
+      continue;
+    }
+    const phi::DenseTensor* tensor = GetDenseTensor(vars_[i]);
+    if (tensor != nullptr && tensor->Holder() &&
+        tensor->Holder() != views_[i]) {
+      need_replan_ = true;
+      break;
+    }
+  }
+}
+
+void StaticMemoryPlanner::Clear() {
+  if (state_ == kPlanned) {
+    DropPlan();
+  }
+  state_ = kProfiling;
+}
+
+size_t StaticMemoryPlanner::ArenaSize() const {
+  size_t size = 0;
+  for (auto& item : arenas_) {
+    size += item.second->size();
+  }
+  return size;
+}
+
+bool StaticMemoryPlanner::InputsChanged() const {
+  for (size_t i = 0; i < input_vars_.size(); ++i) {
+    const phi::DenseTensor* tensor = GetDenseTensor(vars_[input_vars_[i]]);
+    if (tensor == nullptr) {
+      continue;
+    }
+    if (tensor->dims() != input_dims_[i] ||
+        tensor->dtype() != input_dtypes_[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void StaticMemoryPlanner::SaveInputs() {
+  input_dims_.assign(input_vars_.size(), phi::DDim());
+  input_dtypes_.assign(input_vars_.size(), phi::DataType::UNDEFINED);
+  for (size_t i = 0; i < input_vars_.size(); ++i) {
+    const phi::DenseTensor* tensor = GetDenseTensor(vars_[input_vars_[i]]);
+    if (tensor != nullptr) {
+      input_dims_[i] = tensor->dims();
+      input_dtypes_[i] = tensor->dtype();
+    }
+  }
+}
+
+void StaticMemoryPlanner::DropPlan() {
+  for (size_t i = 0; i < vars_.size(); ++i) {
+    if (!planned_[i]) {
+      continue;
+    }
+    auto* tensor = vars_[i]->GetMutable<phi::DenseTensor>();
+    if (tensor->Holder() == views_[i]) {
+      tensor->MoveMemoryHolder();
+    }
+  }
+  planned_.clear();
+  views_.clear();
+  arenas_.clear();
+  planned_var_num_ = 0;
+  need_replan_ = false;
+}
+
+void StaticMemoryPlanner::BuildPlan() {
+  size_t n = vars_.size();
+  // one block for each set of variables sharing a buffer, grouped by place
+  std::map<phi::Place, std::vector<MemoryBlock>> blocks;
+  std::map<phi::Place, std::vector<size_t>> block_roots;
+  std::vector<size_t> block_index(n, kNone);
+  size_t total_size = 0;
+  for (size_t i = 0; i < n; ++i) {
+    size_t root = Find(i);
+    if (!recorded_[i] || excluded_[root] || max_size_[root] == 0 ||
+        block_index[root] != kNone) {
+      continue;
+    }
+    const phi::Place& place = place_[root];
+    block_index[root] = blocks[place].size();
+    blocks[place].push_back(
+        MemoryBlock{first_step_[root], last_step_[root], max_size_[root]});
+    block_roots[place].push_back(root);
+    total_size += max_size_[root];
+  }
+
+  std::vector<std::shared_ptr<phi::Allocation>> root_views(n + 1);
+  for (auto& item : blocks) {
+    const phi::Place& place = item.first;
+    std::vector<MemoryBlock>& place_blocks = item.second;
+    size_t arena_size = AssignMemoryOffsets(&place_blocks, kArenaAlignment);
+    std::shared_ptr<phi::Allocation> arena =
+        memory::AllocShared(place, arena_size);
+    arenas_[place] = arena;
+    for (size_t i = 0; i < place_blocks.size(); ++i) {
+      root_views[block_roots[place][i]] = std::make_shared<ArenaAllocation>(
+          arena, place_blocks[i].offset, place_blocks[i].size);
+    }
+  }
+
+  planned_.assign(n, false);
+  views_.assign(n, nullptr);
+  for (size_t i = 0; i < n; ++i) {
+    size_t root = Find(i);
+    if (!recorded_[i] || root_views[root] == nullptr) {
+      continue;
+    }
+    auto* tensor = vars_[i]->GetMutable<phi::DenseTensor>();
+    tensor->MoveMemoryHolder();
+    tensor->ResetHolder(root_views[root]);
+    planned_[i] = true;
+    views_[i] = root_views[root];
+    ++planned_var_num_;
+  }
+
+  owners_.clear();
+  state_ = kPlanned;
+  VLOG(1) << "Static memory plan: " << planned_var_num_ << " variables in "
+          << ArenaSize() << " bytes of arena, " << total_size
+          << " bytes without packing";
+}
+
+size_t StaticMemoryPlanner::Find(size_t var_id) {
+  while (parent_[var_id] != var_id) {
+    parent_[var_id] = parent_[parent_[var_id]];
+    var_id = parent_[var_id];
+  }
+  return var_id;
+}
+
+void StaticMemoryPlanner::Union(size_t a, size_t b) {
+  size_t root = Find(a);
+  size_t other = Find(b);
+  if (root == other) {
+    return;
+  }
+  parent_[other] = root;
+  first_step_[root] = std::min(first_step_[root], first_step_[other]);
+  last_step_[root] = std::max(last_step_[root], last_step_[other]);
+  max_size_[root] = std::max(max_size_[root], max_size_[other]);
+  excluded_[root] = excluded_[root] || excluded_[other];
+  if (has_place_[other]) {
+    if (!has_place_[root]) {
+      place_[root] = place_[other];
+      has_place_[root] = true;
+    } else if (place_[root] != place_[other]) {
+      excluded_[root] = true;
+    }
+  }
+}
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
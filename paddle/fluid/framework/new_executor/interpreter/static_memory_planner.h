@@ -0,0 +1,152 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/framework/variable.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/allocator.h"
+#include "paddle/phi/core/ddim.h"
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+// A buffer which is alive from the first_step-th to the last_step-th
+// instruction of the execution order.
+struct MemoryBlock {
+  size_t first_step;
+  size_t last_step;
+  size_t size;
+  // assigned by AssignMemoryOffsets
+  size_t offset{0};
+};
+
+// Assigns an offset to each block so that blocks which are alive at the same
+// step never overlap, and returns the size of the arena holding all of them.
+// Blocks are placed from the largest to the smallest, each into the tightest
+// gap left between the blocks it overlaps with in time. Offsets and the arena
+// size are multiples of alignment.
+size_t AssignMemoryOffsets(std::vector<MemoryBlock>* blocks, size_t alignment);
+
+// StaticMemoryPlanner places the intermediate DenseTensors of a sequentially
+// executed instruction list into one preallocated arena per place, instead of
+// allocating them from the allocator and freeing them by GC in every run.
+//
+// The first run after (re)planning is a profiling run, which executes as
+// usual while the planner records the holder every instruction writes into
+// its outputs. Values sharing a holder (inplace and share-data kernels) are
+// planned as one buffer, and buffers that share memory with a variable which
+// can not be planned (parameters, feeds, fetches, skip-gc variables) are left
+// to the allocator. After the run, the buffers are packed by their liveness
+// and every planned variable holds a view into the arena, which the kernels
+// reuse through DenseTensor::AllocateFrom as long as it is large enough.
+//
+// The plan is dropped and rebuilt when the shape or dtype of a variable read
+// by the instructions but written by none of them (feeds and parameters)
+// changes, or when a kernel needed more memory than was planned.
+class StaticMemoryPlanner {
+ public:
+  // instructions are run in the order of execute_order on a single stream.
+  // plannable[i] tells whether the i-th variable of vars may be planned,
+  // i.e. it is an intermediate which is garbage collected in each run.
+  StaticMemoryPlanner(
+      const std::vector<std::unique_ptr<InstructionBase>>& instructions,
+      const std::vector<size_t>& execute_order,
+      const std::vector<Variable*>& vars,
+      const std::vector<bool>& plannable);
+
+  // Called before each run, starts a profiling run if there is no valid plan
+  // for the current inputs.
+  void BeforeRun();
+
+  // Called after instr runs and before its variables are garbage collected.
+  void RecordOutputs(const InstructionBase& instr);
+
+  // Called after each successful run, builds the plan after a profiling run.
+  void AfterRun();
+
+  // Releases the arena views held by the planned variables, must be called
+  // before the instructions run in another order or concurrently.
+  void Clear();
+
+  bool IsProfiling() const { return state_ == kProfiling; }
+
+  // Planned variables keep their arena view and must not be garbage
+  // collected.
+  bool IsPlanned(size_t var_id) const {
+    return state_ == kPlanned && planned_[var_id];
+  }
+
+  size_t PlannedVarNum() const { return planned_var_num_; }
+
+  // Total arena bytes over all places.
+  size_t ArenaSize() const;
+
+ private:
+  enum State { kProfiling, kPlanned };
+
+  bool InputsChanged() const;
+  void SaveInputs();
+  void DropPlan();
+  void BuildPlan();
+
+  // union-find over the variables, the root keeps the merged liveness
+  size_t Find(size_t var_id);
+  void Union(size_t a, size_t b);
+
+  std::vector<Variable*> vars_;
+  std::vector<bool> plannable_;
+  // step_[instr_id] is the position of the instruction in the execute order
+  std::vector<size_t> step_;
+  // the step of the last instruction which reads or writes each variable
+  std::vector<size_t> var_last_step_;
+  // variables read but not written by the instructions
+  std::vector<size_t> input_vars_;
+  std::vector<phi::DDim> input_dims_;
+  std::vector<phi::DataType> input_dtypes_;
+
+  State state_{kProfiling};
+  bool need_replan_{false};
+
+  // profiling, indexed by variable id, and the id vars_.size() stands for
+  // all the variables which can not be planned
+  std::vector<size_t> parent_;
+  std::vector<bool> recorded_;
+  // liveness, size, place of the buffer of each root
+  std::vector<size_t> first_step_;
+  std::vector<size_t> last_step_;
+  std::vector<size_t> max_size_;
+  std::vector<phi::Place> place_;
+  std::vector<bool> has_place_;
+  std::vector<bool> excluded_;
+  // the variable last seen holding each allocation
+  std::unordered_map<const phi::Allocation*, size_t> owners_;
+
+  // plan
+  std::vector<bool> planned_;
+  size_t planned_var_num_{0};
+  std::vector<std::shared_ptr<phi::Allocation>> views_;
+  std::map<phi::Place, std::shared_ptr<phi::Allocation>> arenas_;
+};
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
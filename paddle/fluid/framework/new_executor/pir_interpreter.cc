@@ -80,6 +80,7 @@ COMMON_DECLARE_bool(dynamic_static_unified_comm);
 
 COMMON_DECLARE_bool(enable_pir_in_executor);
 COMMON_DECLARE_bool(enable_pir_in_executor_trace_run);
+COMMON_DECLARE_bool(pir_interpreter_static_memory_plan);
 
 #define CREATE_INSTR(instr_name)                                   \
   vec_instruction_base_.emplace_back(std::make_unique<instr_name>( \
@@ -1118,6 +1119,12 @@ void PirInterpreter::CheckGC(InstructionBase* instr) {
       continue;
     }
 
+    if (memory_planner_ && memory_planner_->IsPlanned(var_id)) {
+      VLOG(4) << value_exe_info_->GetNameById(static_cast<int>(var_id))
+              << " is statically planned, skip gc";
+      continue;
+    }
+
     if (is_ready) {
       VLOG(6) << "Async delete variable with name : "
               << value_exe_info_->GetNameById(static_cast<int>(var_id));
@@ -1131,6 +1138,42 @@ void PirInterpreter::CheckGC(InstructionBase* instr) {
   instr->ClearEagerGCVars();
 }
 
+void PirInterpreter::PrepareStaticMemoryPlan() {
+  // Intermediates can only share the arena when the instructions run one by
+  // one in the trace order on a single stream, and no sub block reads them.
+  bool enable = FLAGS_pir_interpreter_static_memory_plan &&
+                sub_blocks_.empty() && !FLAGS_new_executor_use_cuda_graph;
+  for (size_t i = 1; enable && i < vec_instruction_base_.size(); ++i) {
+    enable = &vec_instruction_base_[i]->DeviceContext() ==
+             &vec_instruction_base_[0]->DeviceContext();
+  }
+  if (!enable) {
+    if (memory_planner_) {
+      memory_planner_->Clear();
+      memory_planner_.reset();
+    }
+    return;
+  }
+
+  if (!memory_planner_) {
+    std::unordered_set<std::string> fetch_var_names(fetch_var_names_.begin(),
+                                                    fetch_var_names_.end());
+    const auto& var_list = value_exe_info_->GetVarList();
+    std::vector<bool> plannable(var_list.size(), false);
+    for (size_t i = 0; i < var_list.size() && i < var_ref_count_.size(); ++i) {
+      const std::string& name =
+          value_exe_info_->GetNameById(static_cast<int>(i));
+      // only the vars which are garbage collected in every run
+      plannable[i] = var_ref_count_[i] > 0 &&
+                     !parameter_var_names_.count(name) &&
+                     !fetch_var_names.count(name);
+    }
+    memory_planner_ = std::make_unique<interpreter::StaticMemoryPlanner>(
+        vec_instruction_base_, trace_execute_order_, var_list, plannable);
+  }
+  memory_planner_->BeforeRun();
+}
+
 void PirInterpreter::CalculateLastLiveOps() {
   VLOG(4) << "PirInterpreter(): " << this << " start CalculateLastLiveOps";
   // calculate last_live_ops_
@@ -1470,9 +1513,13 @@ void PirInterpreter::TraceRunImpl() {
   }
 
   interpreter::ResetAtomicGuard guard(&deps_, &refs_);
+  PrepareStaticMemoryPlan();
   VLOG(4) << "Tracing Instruction List";
 
   TraceRunInstructionList(vec_instruction_base_);
+  if (memory_planner_) {
+    memory_planner_->AfterRun();
+  }
   VLOG(4) << "Done TraceRunInstructionList";
 }
 
@@ -1483,6 +1530,11 @@ void PirInterpreter::MultiThreadRunImpl() {
   }
 
   interpreter::ResetAtomicGuard guard(&deps_, &refs_);
+  // the static memory plan relies on the trace execute order
+  if (memory_planner_) {
+    memory_planner_->Clear();
+    memory_planner_.reset();
+  }
   VLOG(4) << "Multi Thread Run Instruction List";
 
   async_work_queue_ = GetWorkQueue();
@@ -1733,7 +1785,10 @@ void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
             << "Before: " << cur_place << " "
             << instr_node->DebugStringEx(scope_, value_exe_info_.get());
     if (!instr_node->IsArtificial()) {
-      instr_node->Run();
+      {
+        interpreter::OpDispatchMetricsGuard metrics_guard;
+        instr_node->Run();
+      }
 
       if (FLAGS_benchmark) {
         instr_node->DeviceContext().Wait();
@@ -1753,6 +1808,9 @@ void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
               << " runs on " << platform::GetCurrentThreadName() << "\n"
               << "After: " << cur_place << " "
               << instr_node->DebugStringEx(scope_, value_exe_info_.get());
+      if (memory_planner_ && memory_planner_->IsProfiling()) {
+        memory_planner_->RecordOutputs(*instr_node);
+      }
       CheckGC(instr_node);
       VLOG(4) << "done CheckGC";
       memory::LogDeviceMemoryStats(cur_place, instr_node->Name());
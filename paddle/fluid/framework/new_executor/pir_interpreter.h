@@ -15,6 +15,7 @@
 #pragma once
 #include <memory>
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/framework/new_executor/interpreter/static_memory_planner.h"
 #include "paddle/fluid/framework/new_executor/interpreter_base_impl.h"
 #include "paddle/pir/core/value.h"
 
@@ -109,6 +110,11 @@ class PirInterpreter : public InterpreterBaseImpl {
   // Only for debug
   Variable* DebugVar(const std::string& name) const override;
 
+  // nullptr unless the last run was planned statically
+  const interpreter::StaticMemoryPlanner* MemoryPlanner() const {
+    return memory_planner_.get();
+  }
+
   std::unordered_map<std::string, std::shared_ptr<EventInter>>*
   GetForceEventsToWaitInfo() {
     return force_events_to_wait_;
@@ -183,6 +189,9 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   std::unique_ptr<InterpreterCoreGarbageCollector> gc_;
 
+  // only for trace run, see FLAGS_pir_interpreter_static_memory_plan
+  std::unique_ptr<interpreter::StaticMemoryPlanner> memory_planner_;
+
   // last_live_ops_[i] contains the id of operators that last access the i-th
   // var
   std::map<size_t, std::set<size_t>> last_live_ops_;
@@ -243,6 +252,8 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   void CheckGC(InstructionBase* instr);
 
+  void PrepareStaticMemoryPlan();
+
   void RecordStreamForGC(InstructionBase* instr);
 
   void SolvePersisableVarNames();
@@ -1173,7 +1173,10 @@ void ProgramInterpreter::RunInstruction(const Instruction& instr_node) {
 #endif
 
     if (!instr_node.IsArtificial()) {
-      RunOperator(instr_node);
+      {
+        interpreter::OpDispatchMetricsGuard metrics_guard;
+        RunOperator(instr_node);
+      }
       CheckGC(instr_node);
       if (FLAGS_log_memory_stats) {
         memory::LogDeviceMemoryStats(place_, instr_node.OpBase()->Type());
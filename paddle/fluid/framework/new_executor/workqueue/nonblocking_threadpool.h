@@ -19,6 +19,7 @@
 #include "paddle/fluid/framework/new_executor/workqueue/thread_environment.h"
 #include "paddle/fluid/platform/os_info.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
+#include "paddle/fluid/platform/runtime_metrics.h"
 
 namespace paddle {
 namespace framework {
@@ -44,7 +45,11 @@ class ThreadPoolTempl {
         ec_(num_threads),
         num_threads_(num_threads),
         thread_data_(num_threads),
-        name_(name) {
+        name_(name),
+        pending_tasks_(platform::MetricsRegistry::Instance().GetGauge(
+            "paddle_workqueue_pending_tasks",
+            "Number of tasks waiting in work queues",
+            {{"queue", name}})) {
     // Calculate coprimes of all numbers [1, num_threads].
     // Coprimes are used for random walks over all threads in Steal
     // and NonEmptyQueueIndex. Iteration is based on the fact that if we take
@@ -75,9 +80,15 @@ class ThreadPoolTempl {
       ec_.Notify(true);
     } else {
       // Since we were cancelled, there might be entries in the queues.
-      // Empty them to prevent their destructor from asserting.
+      // Empty them to prevent their destructor from asserting, and take the
+      // dropped tasks off the pending gauge.
       for (size_t i = 0; i < thread_data_.size(); i++) {
-        thread_data_[i].queue.Flush();
+        Queue& q = thread_data_[i].queue;
+        while (!q.Empty()) {
+          if (q.PopFront().f) {
+            pending_tasks_->Add(-1);
+          }
+        }
       }
     }
     // Join threads explicitly (by destroying) to avoid destruction order within
@@ -107,6 +118,7 @@ class ThreadPoolTempl {
 
   void AddTaskWithHint(std::function<void()> fn, int start, int limit) {
     Task t = env_.CreateTask(std::move(fn));
+    pending_tasks_->Add(1);
     PerThread* pt = GetPerThread();
     if (pt->pool == this) {
       // Worker thread of this pool, push onto the thread's queue.
@@ -136,6 +148,7 @@ class ThreadPoolTempl {
       VLOG(6) << "Add task, Notify";
       ec_.Notify(false);
     } else {
+      pending_tasks_->Add(-1);
       env_.ExecuteTask(t);  // Push failed, execute directly.
     }
   }
@@ -244,6 +257,8 @@ class ThreadPoolTempl {
   const int num_threads_;
   std::vector<ThreadData> thread_data_;
   std::string name_;
+  // shared by the pools of the same name
+  platform::Gauge* pending_tasks_;
 
   // Main worker thread loop.
   void WorkerLoop(int thread_id) {
@@ -282,6 +297,7 @@ class ThreadPoolTempl {
           }
         }
         if (t.f) {
+          pending_tasks_->Add(-1);
           env_.ExecuteTask(t);
         }
       }
@@ -311,6 +327,7 @@ class ThreadPoolTempl {
           }
         }
         if (t.f) {
+          pending_tasks_->Add(-1);
           env_.ExecuteTask(t);
         }
       }
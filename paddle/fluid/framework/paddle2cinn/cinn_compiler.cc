@@ -55,6 +55,7 @@
 
 COMMON_DECLARE_bool(enable_pe_launch_cinn);
 COMMON_DECLARE_bool(enable_cinn_auto_tune);
+COMMON_DECLARE_string(cinn_tuning_record_file);
 COMMON_DECLARE_string(cinn_subgraph_graphviz_dir);
 namespace paddle {
 namespace framework {
@@ -331,7 +332,14 @@ std::unique_ptr<CinnCompiledObject> CinnCompiler::CompileGraph(
   if (FLAGS_enable_cinn_auto_tune) {
     VLOG(4) << "Compile with auto-tune";
     auto_tuner = std::make_unique<AutoTuner>(target, cinn_graph.get());
-    auto_tuner->Initialize(AutoTuner::Config(), graph_compiler.get());
+    AutoTuner::Config tuner_config;
+    if (!FLAGS_cinn_tuning_record_file.empty()) {
+      tuner_config.database_config.type =
+          ::cinn::auto_schedule::DatabaseType::kBinaryFile;
+      tuner_config.database_config.record_file_path =
+          FLAGS_cinn_tuning_record_file;
+    }
+    auto_tuner->Initialize(tuner_config, graph_compiler.get());
     ::cinn::auto_schedule::TuningOptions tuning_options;
     tuning_options.num_measure_trials = 0;
     auto tuning_result = auto_tuner->Tune(tuning_options);
@@ -0,0 +1,262 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PADDLE_SLOT_PARSER_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && \
+                          __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define PADDLE_SLOT_PARSER_SWAR
+#endif
+
+namespace paddle {
+namespace framework {
+
+// A cursor over one line of the MultiSlot text format, where each slot is
+// written as its number of feasigns followed by the feasigns, all separated
+// by spaces, e.g. "2 1024 2048 1 0.5".
+//
+// Numbers are decoded in place without strtol/strtoull/strtof on the common
+// inputs: digit runs are found 16 bytes at a time with SSE2 and converted 8
+// digits at a time with SWAR arithmetic. Integers that overflow uint64_t and
+// floats that can not be converted exactly on the fast path, e.g. with an
+// exponent or more than 24 bits of mantissa, fall back to the strto*
+// functions, so the results are always the same as theirs.
+//
+// The line must be null terminated, as std::string::c_str() and
+// LineFileReader::get() are.
+class SlotLineParser {
+ public:
+  SlotLineParser(const char* str, size_t len)
+      : begin_(str), pos_(str), end_(str + len) {}
+
+  const char* pos() const { return pos_; }
+  size_t offset() const { return pos_ - begin_; }
+
+  // Returns the number of feasigns of the next slot, like strtol.
+  int NextCount() {
+    const char* start = pos_;
+    uint64_t value = 0;
+    if (NextDigits(&value) && value <= INT32_MAX) {
+      return static_cast<int>(value);
+    }
+    char* endptr = nullptr;
+    long num = strtol(start, &endptr, 10);  // NOLINT
+    pos_ = endptr;
+    return static_cast<int>(num);
+  }
+
+  uint64_t NextUint64() {
+    const char* start = pos_;
+    uint64_t value = 0;
+    if (NextDigits(&value)) {
+      return value;
+    }
+    char* endptr = nullptr;
+    value = static_cast<uint64_t>(strtoull(start, &endptr, 10));
+    pos_ = endptr;
+    return value;
+  }
+
+  float NextFloat() {
+    const char* start = pos_;
+    float value = 0;
+    if (NextFastFloat(&value)) {
+      return value;
+    }
+    char* endptr = nullptr;
+    value = strtof(start, &endptr);
+    pos_ = endptr;
+    return value;
+  }
+
+  // Returns the next space separated token without copying it.
+  void NextToken(const char** token, size_t* len) {
+    SkipSpaces();
+    *token = pos_;
+    while (pos_ < end_ && !IsSpace(*pos_)) {
+      ++pos_;
+    }
+    *len = pos_ - *token;
+  }
+
+  void SkipTokens(int num) {
+    const char* token = nullptr;
+    size_t len = 0;
+    for (int i = 0; i < num; ++i) {
+      NextToken(&token, &len);
+    }
+  }
+
+ private:
+  static bool IsSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+  }
+
+  static bool IsDigit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+  }
+
+  // A number ends at a space or at the end of the line, anything else, such
+  // as an exponent or a hex prefix, is left to the strto* functions.
+  bool IsNumberEnd(const char* p) const { return p == end_ || IsSpace(*p); }
+
+  void SkipSpaces() {
+    while (pos_ < end_ && IsSpace(*pos_)) {
+      ++pos_;
+    }
+  }
+
+  // Returns the length of the run of digits starting at p.
+  size_t DigitRunLength(const char* p) const {
+    const char* q = p;
+#ifdef PADDLE_SLOT_PARSER_SSE2
+    const __m128i lower = _mm_set1_epi8('0' - 1);
+    const __m128i upper = _mm_set1_epi8('9' + 1);
+    while (end_ - q >= 16) {
+      __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+      __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(chars, lower),
+                                       _mm_cmplt_epi8(chars, upper));
+      unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(is_digit)) &
+                      0xFFFFu;
+      if (mask != 0) {
+#ifdef _MSC_VER
+        unsigned long index;  // NOLINT
+        _BitScanForward(&index, mask);
+        return q - p + index;
+#else
+        return q - p + __builtin_ctz(mask);
+#endif
+      }
+      q += 16;
+    }
+#endif
+    while (q < end_ && IsDigit(*q)) {
+      ++q;
+    }
+    return q - p;
+  }
+
+#ifdef PADDLE_SLOT_PARSER_SWAR
+  // Converts 8 ASCII digits at p, see "Faster Integer Parsing" by Kholdstare
+  // and Lemire.
+  static uint64_t Parse8Digits(const char* p) {
+    uint64_t val;
+    std::memcpy(&val, p, sizeof(val));
+    val -= 0x3030303030303030ULL;
+    val = (val * 10) + (val >> 8);
+    val = (((val & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+           (((val >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >>
+          32;
+    return val;
+  }
+#endif
+
+  // Converts the n <= 19 digits at p.
+  static uint64_t ParseDigits(const char* p, size_t n) {
+    uint64_t value = 0;
+#ifdef PADDLE_SLOT_PARSER_SWAR
+    for (; n >= 8; n -= 8, p += 8) {
+      value = value * 100000000ULL + Parse8Digits(p);
+    }
+#endif
+    for (; n > 0; --n, ++p) {
+      value = value * 10 + (*p - '0');
+    }
+    return value;
+  }
+
+  // Decodes an unsigned integer that fits in uint64_t and is ended by a space
+  // or the end of the line. Returns false and leaves the cursor after the
+  // leading spaces otherwise.
+  bool NextDigits(uint64_t* value) {
+    SkipSpaces();
+    size_t n = DigitRunLength(pos_);
+    if (n == 0 || !IsNumberEnd(pos_ + n)) {
+      return false;
+    }
+    if (n <= 19) {
+      *value = ParseDigits(pos_, n);
+    } else if (n == 20 && std::memcmp(pos_, "18446744073709551615", 20) <= 0) {
+      // Hashed feasigns often take all 20 digits of uint64_t.
+      *value = ParseDigits(pos_, 19) * 10 + (pos_[19] - '0');
+    } else {
+      return false;
+    }
+    pos_ += n;
+    return true;
+  }
+
+  // Decodes [-]digits[.digits] exactly when the digits form an integer
+  // mantissa below 2^24 and there are at most 10 fractional digits. Then
+  // both the mantissa and the power of ten are exact floats and a single
+  // division rounds correctly, as strtof does.
+  bool NextFastFloat(float* value) {
+    static constexpr float kPow10[] = {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    SkipSpaces();
+    const char* p = pos_;
+    bool negative = (p < end_ && *p == '-');
+    if (negative) {
+      ++p;
+    }
+    size_t int_len = DigitRunLength(p);
+    const char* frac = p + int_len;
+    size_t frac_len = 0;
+    if (frac < end_ && *frac == '.') {
+      ++frac;
+      frac_len = DigitRunLength(frac);
+    }
+    const char* number_end = frac + frac_len;
+    if (int_len + frac_len == 0 || int_len + frac_len > 19 ||
+        frac_len >= sizeof(kPow10) / sizeof(kPow10[0]) ||
+        !IsNumberEnd(number_end)) {
+      return false;
+    }
+    uint64_t mantissa = ParseDigits(p, int_len);
+    for (size_t i = 0; i < frac_len; ++i) {
+      mantissa = mantissa * 10 + (frac[i] - '0');
+    }
+    if (mantissa > (1ULL << 24)) {
+      return false;
+    }
+    float result = static_cast<float>(mantissa) / kPow10[frac_len];
+    *value = negative ? -result : result;
+    pos_ = number_end;
+    return true;
+  }
+
+  const char* begin_;
+  const char* pos_;
+  const char* end_;
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+#undef PADDLE_SLOT_PARSER_SSE2
+#undef PADDLE_SLOT_PARSER_SWAR
@@ -0,0 +1,445 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/slot_record_file.h"
+
+#ifdef _LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "paddle/fluid/framework/io/fs.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+template <typename T>
+void AppendPod(std::string* out, const T& value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void AppendSlotValues(std::string* out,
+                      const SlotValues<T>& values,
+                      size_t slot_num) {
+  if (values.slot_offsets.empty()) {
+    // a record without values of this type
+    out->append((slot_num + 1) * sizeof(uint32_t), '\0');
+    return;
+  }
+  PADDLE_ENFORCE_EQ(values.slot_offsets.size(),
+                    slot_num + 1,
+                    platform::errors::InvalidArgument(
+                        "The record has %d slot offsets, but the schema of "
+                        "the SlotRecord file has %d slots.",
+                        values.slot_offsets.size() - 1,
+                        slot_num));
+  uint32_t value_num = values.slot_offsets[slot_num];
+  out->append(reinterpret_cast<const char*>(values.slot_offsets.data()),
+              values.slot_offsets.size() * sizeof(uint32_t));
+  out->append(reinterpret_cast<const char*>(values.slot_values.data()),
+              value_num * sizeof(T));
+}
+
+template <typename T>
+void ReadPod(const char** p, const char* end, T* value) {
+  PADDLE_ENFORCE_LE(
+      sizeof(T),
+      static_cast<size_t>(end - *p),
+      platform::errors::InvalidArgument("The SlotRecord block is truncated."));
+  memcpy(value, *p, sizeof(T));
+  *p += sizeof(T);
+}
+
+template <typename T>
+void ReadSlotValues(const char** p,
+                    const char* end,
+                    size_t slot_num,
+                    SlotValues<T>* values) {
+  size_t offsets_size = (slot_num + 1) * sizeof(uint32_t);
+  PADDLE_ENFORCE_LE(
+      offsets_size,
+      static_cast<size_t>(end - *p),
+      platform::errors::InvalidArgument("The SlotRecord block is truncated."));
+  values->slot_offsets.resize(slot_num + 1);
+  memcpy(values->slot_offsets.data(), *p, offsets_size);
+  *p += offsets_size;
+
+  size_t values_size = values->slot_offsets[slot_num] * sizeof(T);
+  PADDLE_ENFORCE_LE(
+      values_size,
+      static_cast<size_t>(end - *p),
+      platform::errors::InvalidArgument("The SlotRecord block is truncated."));
+  values->slot_values.resize(values->slot_offsets[slot_num]);
+  if (values_size > 0) {
+    memcpy(values->slot_values.data(), *p, values_size);
+  }
+  *p += values_size;
+}
+
+bool EndsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() &&
+         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+SlotRecordFileSchema SlotRecordFileSchema::FromDataFeedDesc(
+    const DataFeedDesc& desc) {
+  SlotRecordFileSchema schema;
+  const auto& multi_slot_desc = desc.multi_slot_desc();
+  for (int i = 0; i < multi_slot_desc.slots_size(); ++i) {
+    const auto& slot = multi_slot_desc.slots(i);
+    if (!slot.is_used()) {
+      continue;
+    }
+    schema.slot_names.push_back(slot.name());
+    schema.slot_types.push_back(slot.type()[0]);
+  }
+  return schema;
+}
+
+size_t SlotRecordFileSchema::uint64_slot_num() const {
+  return std::count(slot_types.begin(), slot_types.end(), 'u');
+}
+
+size_t SlotRecordFileSchema::float_slot_num() const {
+  return std::count(slot_types.begin(), slot_types.end(), 'f');
+}
+
+bool IsSlotRecordFile(const std::string& path) {
+  return EndsWith(path, kSlotRecordFileSuffix);
+}
+
+SlotRecordFileWriter::SlotRecordFileWriter(const std::string& path,
+                                           const SlotRecordFileSchema& schema,
+                                           bool compress,
+                                           size_t block_size)
+    : path_(path),
+      uint64_slot_num_(schema.uint64_slot_num()),
+      float_slot_num_(schema.float_slot_num()),
+      compress_(compress),
+      block_size_(block_size) {
+  int err_no = 0;
+  fp_ = fs_open_write(path_, &err_no, "");
+  PADDLE_ENFORCE_EQ(
+      fp_ != nullptr && err_no == 0,
+      true,
+      platform::errors::Unavailable("Failed to open %s for writing.", path_));
+
+  std::string header(kSlotRecordFileMagic, sizeof(kSlotRecordFileMagic));
+  AppendPod(&header, kSlotRecordFileVersion);
+  AppendPod(&header, static_cast<uint32_t>(schema.slot_names.size()));
+  for (size_t i = 0; i < schema.slot_names.size(); ++i) {
+    header.push_back(schema.slot_types[i]);
+    AppendPod(&header, static_cast<uint32_t>(schema.slot_names[i].size()));
+    header.append(schema.slot_names[i]);
+  }
+  PADDLE_ENFORCE_EQ(
+      fwrite(header.data(), 1, header.size(), fp_.get()),
+      header.size(),
+      platform::errors::Unavailable("Failed to write to %s.", path_));
+  block_.reserve(block_size_ + block_size_ / 8);
+}
+
+SlotRecordFileWriter::~SlotRecordFileWriter() {
+  if (fp_ != nullptr) {
+    Close();
+  }
+}
+
+void SlotRecordFileWriter::Write(const SlotRecordObject& rec) {
+  AppendPod(&block_, rec.search_id);
+  AppendPod(&block_, rec.rank);
+  AppendPod(&block_, rec.cmatch);
+  AppendPod(&block_, static_cast<uint32_t>(rec.ins_id_.size()));
+  block_.append(rec.ins_id_);
+  AppendSlotValues(&block_, rec.slot_uint64_feasigns_, uint64_slot_num_);
+  AppendSlotValues(&block_, rec.slot_float_feasigns_, float_slot_num_);
+  ++block_record_num_;
+  if (block_.size() >= block_size_) {
+    FlushBlock();
+  }
+}
+
+void SlotRecordFileWriter::Write(const SlotRecord* recs, size_t num) {
+  for (size_t i = 0; i < num; ++i) {
+    Write(*recs[i]);
+  }
+}
+
+void SlotRecordFileWriter::Close() {
+  FlushBlock();
+  fp_.reset();
+}
+
+void SlotRecordFileWriter::FlushBlock() {
+  if (block_record_num_ == 0) {
+    return;
+  }
+  SlotRecordBlockHeader header;
+  header.record_num = block_record_num_;
+  header.compressed = 0;
+  header.raw_size = block_.size();
+  header.reserved = 0;
+  const std::string* payload = &block_;
+  if (compress_) {
+    uLongf compressed_size = compressBound(block_.size());
+    compressed_block_.resize(compressed_size);
+    int ret = compress2(reinterpret_cast<Bytef*>(&compressed_block_[0]),
+                        &compressed_size,
+                        reinterpret_cast<const Bytef*>(block_.data()),
+                        block_.size(),
+                        Z_BEST_SPEED);
+    PADDLE_ENFORCE_EQ(
+        ret,
+        Z_OK,
+        platform::errors::External("Failed to compress a SlotRecord block, "
+                                   "zlib returns %d.",
+                                   ret));
+    if (compressed_size < block_.size()) {
+      compressed_block_.resize(compressed_size);
+      header.compressed = 1;
+      payload = &compressed_block_;
+    }
+  }
+  header.stored_size = payload->size();
+  header.checksum = crc32(0L,
+                          reinterpret_cast<const Bytef*>(payload->data()),
+                          payload->size());
+
+  PADDLE_ENFORCE_EQ(
+      fwrite(&header, sizeof(header), 1, fp_.get()),
+      1,
+      platform::errors::Unavailable("Failed to write to %s.", path_));
+  PADDLE_ENFORCE_EQ(
+      fwrite(payload->data(), 1, payload->size(), fp_.get()),
+      payload->size(),
+      platform::errors::Unavailable("Failed to write to %s.", path_));
+  block_.clear();
+  block_record_num_ = 0;
+}
+
+SlotRecordFileReader::SlotRecordFileReader(const std::string& path)
+    : path_(path) {
+  memset(&header_, 0, sizeof(header_));
+  bool local = fs_select_internal(path_) == 0;
+#ifdef _LINUX
+  if (local) {
+    fd_ = open(path_.c_str(), O_RDONLY);
+    PADDLE_ENFORCE_NE(
+        fd_,
+        -1,
+        platform::errors::Unavailable(
+            "Failed to open %s, error number is %s.", path_, strerror(errno)));
+    struct stat sb;
+    PADDLE_ENFORCE_EQ(
+        fstat(fd_, &sb),
+        0,
+        platform::errors::Unavailable(
+            "Failed to stat %s, error number is %s.", path_, strerror(errno)));
+    end_ = static_cast<size_t>(sb.st_size);
+    if (end_ > 0) {
+      buffer_ = reinterpret_cast<char*>(
+          mmap(nullptr, end_, PROT_READ, MAP_PRIVATE, fd_, 0));
+      PADDLE_ENFORCE_NE(buffer_,
+                        MAP_FAILED,
+                        platform::errors::Unavailable(
+                            "Memory map of %s failed, error number is %s.",
+                            path_,
+                            strerror(errno)));
+      madvise(buffer_, end_, MADV_SEQUENTIAL);
+    }
+  }
+#else
+  local = false;
+#endif
+  if (!local) {
+    int err_no = 0;
+    fp_ = fs_open_read(path_, &err_no, "", true);
+    PADDLE_ENFORCE_EQ(
+        fp_ != nullptr && err_no == 0,
+        true,
+        platform::errors::Unavailable("Failed to open %s for reading.", path_));
+  }
+  ReadFileHeader();
+}
+
+SlotRecordFileReader::~SlotRecordFileReader() {
+#ifdef _LINUX
+  if (buffer_ != nullptr) {
+    munmap(buffer_, end_);
+    buffer_ = nullptr;
+  }
+  if (fd_ != -1) {
+    close(fd_);
+    fd_ = -1;
+  }
+#endif
+}
+
+const char* SlotRecordFileReader::ReadBytes(size_t size, size_t* read_size) {
+  if (fd_ != -1) {
+    if (end_ - offset_ < size) {
+      if (read_size != nullptr) {
+        *read_size = end_ - offset_;
+      }
+      return nullptr;
+    }
+    const char* p = buffer_ + offset_;
+    offset_ += size;
+    if (read_size != nullptr) {
+      *read_size = size;
+    }
+    return p;
+  }
+  read_buffer_.resize(size);
+  size_t n = size > 0 ? fread(&read_buffer_[0], 1, size, fp_.get()) : 0;
+  if (read_size != nullptr) {
+    *read_size = n;
+  }
+  if (n != size) {
+    return nullptr;
+  }
+  return read_buffer_.data();
+}
+
+void SlotRecordFileReader::ReadFileHeader() {
+  const char* p =
+      ReadBytes(sizeof(kSlotRecordFileMagic) + sizeof(uint32_t) * 2);
+  PADDLE_ENFORCE_EQ(
+      p != nullptr &&
+          memcmp(p, kSlotRecordFileMagic, sizeof(kSlotRecordFileMagic)) == 0,
+      true,
+      platform::errors::InvalidArgument("%s is not a SlotRecord file.", path_));
+  uint32_t version = 0;
+  uint32_t slot_num = 0;
+  memcpy(&version, p + sizeof(kSlotRecordFileMagic), sizeof(uint32_t));
+  memcpy(&slot_num,
+         p + sizeof(kSlotRecordFileMagic) + sizeof(uint32_t),
+         sizeof(uint32_t));
+  PADDLE_ENFORCE_EQ(version,
+                    kSlotRecordFileVersion,
+                    platform::errors::InvalidArgument(
+                        "The SlotRecord file %s has version %d, but only "
+                        "version %d is supported.",
+                        path_,
+                        version,
+                        kSlotRecordFileVersion));
+
+  for (uint32_t i = 0; i < slot_num; ++i) {
+    p = ReadBytes(1 + sizeof(uint32_t));
+    PADDLE_ENFORCE_NOT_NULL(p,
+                            platform::errors::InvalidArgument(
+                                "The header of %s is truncated.", path_));
+    char type = p[0];
+    uint32_t name_size = 0;
+    memcpy(&name_size, p + 1, sizeof(uint32_t));
+    p = ReadBytes(name_size);
+    PADDLE_ENFORCE_NOT_NULL(p,
+                            platform::errors::InvalidArgument(
+                                "The header of %s is truncated.", path_));
+    schema_.slot_types.push_back(type);
+    schema_.slot_names.emplace_back(p, name_size);
+  }
+  uint64_slot_num_ = schema_.uint64_slot_num();
+  float_slot_num_ = schema_.float_slot_num();
+}
+
+bool SlotRecordFileReader::NextBlock() {
+  size_t read_size = 0;
+  const char* p = ReadBytes(sizeof(SlotRecordBlockHeader), &read_size);
+  if (p == nullptr) {
+    PADDLE_ENFORCE_EQ(read_size,
+                      0,
+                      platform::errors::InvalidArgument(
+                          "The SlotRecord file %s ends with a truncated "
+                          "block header.",
+                          path_));
+    return false;
+  }
+  memcpy(&header_, p, sizeof(header_));
+  payload_ = ReadBytes(header_.stored_size);
+  PADDLE_ENFORCE_NOT_NULL(
+      payload_,
+      platform::errors::InvalidArgument("The SlotRecord file %s is truncated.",
+                                        path_));
+  uint32_t checksum = crc32(
+      0L, reinterpret_cast<const Bytef*>(payload_), header_.stored_size);
+  PADDLE_ENFORCE_EQ(checksum,
+                    header_.checksum,
+                    platform::errors::InvalidArgument(
+                        "The checksum of a block in %s mismatches, the file "
+                        "may be corrupted.",
+                        path_));
+  if (header_.compressed) {
+    uncompressed_block_.resize(header_.raw_size);
+    uLongf raw_size = header_.raw_size;
+    int ret = uncompress(reinterpret_cast<Bytef*>(&uncompressed_block_[0]),
+                         &raw_size,
+                         reinterpret_cast<const Bytef*>(payload_),
+                         header_.stored_size);
+    PADDLE_ENFORCE_EQ(ret == Z_OK && raw_size == header_.raw_size,
+                      true,
+                      platform::errors::InvalidArgument(
+                          "Failed to uncompress a block in %s, zlib returns "
+                          "%d.",
+                          path_,
+                          ret));
+    payload_ = uncompressed_block_.data();
+  } else {
+    PADDLE_ENFORCE_EQ(header_.raw_size,
+                      header_.stored_size,
+                      platform::errors::InvalidArgument(
+                          "The raw size %d of an uncompressed block in %s "
+                          "differs from its stored size %d.",
+                          header_.raw_size,
+                          path_,
+                          header_.stored_size));
+  }
+  return true;
+}
+
+void SlotRecordFileReader::ReadBlock(SlotRecord* recs) {
+  const char* p = payload_;
+  const char* end = payload_ + header_.raw_size;
+  for (uint32_t i = 0; i < header_.record_num; ++i) {
+    SlotRecord rec = recs[i];
+    ReadPod(&p, end, &rec->search_id);
+    ReadPod(&p, end, &rec->rank);
+    ReadPod(&p, end, &rec->cmatch);
+    uint32_t ins_id_size = 0;
+    ReadPod(&p, end, &ins_id_size);
+    PADDLE_ENFORCE_LE(ins_id_size,
+                      static_cast<size_t>(end - p),
+                      platform::errors::InvalidArgument(
+                          "The SlotRecord block is truncated."));
+    rec->ins_id_.assign(p, ins_id_size);
+    p += ins_id_size;
+    ReadSlotValues(&p, end, uint64_slot_num_, &rec->slot_uint64_feasigns_);
+    ReadSlotValues(&p, end, float_slot_num_, &rec->slot_float_feasigns_);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
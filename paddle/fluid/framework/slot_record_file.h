@@ -0,0 +1,150 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/data_feed.h"
+
+namespace paddle {
+namespace framework {
+
+// A binary file of SlotRecords, so that data which is loaded by many jobs is
+// parsed from text only once.
+//
+// The file starts with a header which describes the used slots:
+//   magic "PSRF", uint32 version, uint32 slot num,
+//   then for each used slot: char type ('u' or 'f'), uint32 name length, name.
+// The records follow in blocks, each is a SlotRecordBlockHeader and the
+// payload, which is compressed with zlib unless that does not make it
+// smaller. In the uncompressed payload each record is stored as
+//   uint64 search_id, uint32 rank, uint32 cmatch,
+//   uint32 ins_id length, ins_id,
+//   uint32 uint64 slot offsets[uint64 slot num + 1], uint64 values,
+//   uint32 float slot offsets[float slot num + 1], float values,
+// which is the layout of SlotValues, so the reader copies them into the
+// record with one memcpy each. All numbers are little endian.
+//
+// Local files are mapped into memory and uncompressed blocks are decoded
+// from the mapping in place. Files on HDFS/AFS are read block by block
+// through fs_open_read.
+static const char kSlotRecordFileMagic[4] = {'P', 'S', 'R', 'F'};
+static const uint32_t kSlotRecordFileVersion = 1;
+// Files with this suffix in the file list are loaded as SlotRecord files
+// instead of text.
+static const char kSlotRecordFileSuffix[] = ".slotrec";
+
+struct SlotRecordBlockHeader {
+  uint32_t record_num;
+  uint32_t compressed;
+  uint64_t raw_size;
+  uint64_t stored_size;
+  // crc32 of the stored payload
+  uint32_t checksum;
+  uint32_t reserved;
+};
+
+struct SlotRecordFileSchema {
+  // names and types ('u' or 'f') of the used slots, in the order of the slots
+  // in the data feed desc
+  std::vector<std::string> slot_names;
+  std::vector<char> slot_types;
+
+  static SlotRecordFileSchema FromDataFeedDesc(const DataFeedDesc& desc);
+  size_t uint64_slot_num() const;
+  size_t float_slot_num() const;
+  bool operator==(const SlotRecordFileSchema& other) const {
+    return slot_names == other.slot_names && slot_types == other.slot_types;
+  }
+  bool operator!=(const SlotRecordFileSchema& other) const {
+    return !(*this == other);
+  }
+};
+
+bool IsSlotRecordFile(const std::string& path);
+
+class SlotRecordFileWriter {
+ public:
+  SlotRecordFileWriter(const std::string& path,
+                       const SlotRecordFileSchema& schema,
+                       bool compress = true,
+                       size_t block_size = 4 * 1024 * 1024);
+  ~SlotRecordFileWriter();
+
+  void Write(const SlotRecordObject& rec);
+  void Write(const SlotRecord* recs, size_t num);
+  // flushes the last block, called by the destructor if not called before
+  void Close();
+
+ private:
+  void FlushBlock();
+
+  std::string path_;
+  std::shared_ptr<FILE> fp_;
+  size_t uint64_slot_num_;
+  size_t float_slot_num_;
+  bool compress_;
+  size_t block_size_;
+  uint32_t block_record_num_ = 0;
+  std::string block_;
+  std::string compressed_block_;
+};
+
+class SlotRecordFileReader {
+ public:
+  explicit SlotRecordFileReader(const std::string& path);
+  ~SlotRecordFileReader();
+
+  const SlotRecordFileSchema& schema() const { return schema_; }
+  // Moves to the next block, returns false at the end of the file.
+  bool NextBlock();
+  // Number of records in the current block.
+  size_t record_num() const { return header_.record_num; }
+  // Decodes the records of the current block into recs, which must hold
+  // record_num() records.
+  void ReadBlock(SlotRecord* recs);
+
+ private:
+  void ReadFileHeader();
+  // Returns a pointer to the next size bytes of the file, nullptr if fewer
+  // bytes are left. If read_size is given, the number of bytes that could be
+  // read is stored in it.
+  const char* ReadBytes(size_t size, size_t* read_size = nullptr);
+
+  std::string path_;
+  // local files
+  int fd_ = -1;
+  char* buffer_ = nullptr;
+  size_t end_ = 0;
+  size_t offset_ = 0;
+  // HDFS/AFS files
+  std::shared_ptr<FILE> fp_;
+  std::string read_buffer_;
+
+  SlotRecordFileSchema schema_;
+  size_t uint64_slot_num_ = 0;
+  size_t float_slot_num_ = 0;
+  SlotRecordBlockHeader header_;
+  const char* payload_ = nullptr;
+  std::string uncompressed_block_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,489 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "glog/logging.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/float16.h"
+#include "paddle/phi/common/bfloat16.h"
+
+namespace paddle_infer {
+namespace services {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// the latencies of the latest requests kept for the percentiles
+constexpr size_t kLatencyWindow = 10000;
+
+size_t SizeOfDataType(DataType dtype) {
+  switch (dtype) {
+    case DataType::FLOAT32:
+      return sizeof(float);
+    case DataType::INT64:
+      return sizeof(int64_t);
+    case DataType::INT32:
+      return sizeof(int32_t);
+    case DataType::UINT8:
+      return sizeof(uint8_t);
+    case DataType::INT8:
+      return sizeof(int8_t);
+    case DataType::FLOAT16:
+      return sizeof(paddle::platform::float16);
+    case DataType::BOOL:
+      return sizeof(bool);
+    case DataType::FLOAT64:
+      return sizeof(double);
+    case DataType::BFLOAT16:
+      return sizeof(phi::dtype::bfloat16);
+    default:
+      PADDLE_THROW(paddle::platform::errors::Unimplemented(
+          "Unsupported data type (%d) in DynamicBatcher.",
+          static_cast<int>(dtype)));
+  }
+}
+
+template <typename T>
+void CopyFromHost(Tensor* tensor, const void* data) {
+  tensor->CopyFromCpu(static_cast<const T*>(data));
+}
+
+template <typename T>
+void CopyToHost(const Tensor& tensor, void* data) {
+  tensor.CopyToCpu(static_cast<T*>(data));
+}
+
+#define DYNAMIC_BATCHER_VISIT_DTYPE(data_type, func, ...)                   \
+  switch (data_type) {                                                      \
+    case DataType::FLOAT32:                                                 \
+      func<float>(__VA_ARGS__);                                             \
+      break;                                                                \
+    case DataType::INT64:                                                   \
+      func<int64_t>(__VA_ARGS__);                                           \
+      break;                                                                \
+    case DataType::INT32:                                                   \
+      func<int32_t>(__VA_ARGS__);                                           \
+      break;                                                                \
+    case DataType::UINT8:                                                   \
+      func<uint8_t>(__VA_ARGS__);                                           \
+      break;                                                                \
+    case DataType::INT8:                                                    \
+      func<int8_t>(__VA_ARGS__);                                            \
+      break;                                                                \
+    case DataType::FLOAT16:                                                 \
+      func<paddle::platform::float16>(__VA_ARGS__);                         \
+      break;                                                                \
+    case DataType::BOOL:                                                    \
+      func<bool>(__VA_ARGS__);                                              \
+      break;                                                                \
+    case DataType::FLOAT64:                                                 \
+      func<double>(__VA_ARGS__);                                            \
+      break;                                                                \
+    case DataType::BFLOAT16:                                                \
+      func<phi::dtype::bfloat16>(__VA_ARGS__);                              \
+      break;                                                                \
+    default:                                                                \
+      PADDLE_THROW(paddle::platform::errors::Unimplemented(                 \
+          "Unsupported data type (%d) in DynamicBatcher.",                  \
+          static_cast<int>(data_type)));                                    \
+  }
+
+}  // namespace
+
+struct DynamicBatcher::Impl {
+  struct Request {
+    const std::vector<paddle::PaddleTensor>* inputs;
+    std::vector<paddle::PaddleTensor>* outputs;
+    // the first dimension shared by all the inputs
+    int rows;
+    bool has_lod;
+    Clock::time_point arrival;
+    std::promise<bool> done;
+  };
+
+  Impl(PredictorPool* pool, const DynamicBatcherOptions& options);
+  ~Impl();
+
+  void Validate(const Request& request) const;
+  bool CanBatch(const Request& a, const Request& b) const;
+  void Work(Predictor* predictor);
+  void RunBatch(Predictor* predictor,
+                const std::vector<std::shared_ptr<Request>>& batch);
+  void RecordBatch(size_t request_num);
+  void RecordLatency(double latency_us);
+
+  DynamicBatcherOptions options;
+
+  std::mutex mu;
+  std::condition_variable cv;
+  // shared with the workers, which may still hold a request after its Run
+  // returns
+  std::deque<std::shared_ptr<Request>> queue;
+  // increased by each new request, so a collecting worker waits for new
+  // requests instead of the ones it can not batch
+  uint64_t queue_version{0};
+  // only one worker collects a batch at a time, so that the requests are
+  // not spread over idle workers
+  bool collecting{false};
+  bool stop{false};
+  std::vector<std::thread> workers;
+
+  mutable std::mutex stats_mu;
+  uint64_t request_num{0};
+  uint64_t batch_num{0};
+  uint64_t batched_request_num{0};
+  double latency_sum_us{0};
+  double max_latency_us{0};
+  std::vector<double> latencies_us;
+  size_t next_latency{0};
+  Clock::time_point stats_start;
+};
+
+DynamicBatcher::Impl::Impl(PredictorPool* pool,
+                           const DynamicBatcherOptions& options)
+    : options(options), stats_start(Clock::now()) {
+  PADDLE_ENFORCE_NOT_NULL(pool,
+                          paddle::platform::errors::InvalidArgument(
+                              "The predictor pool should not be nullptr."));
+  PADDLE_ENFORCE_GE(options.max_batch_size,
+                    1,
+                    paddle::platform::errors::InvalidArgument(
+                        "The max batch size should be at least 1, but it's %d",
+                        options.max_batch_size));
+  for (size_t i = 0; i < pool->Size(); ++i) {
+    Predictor* predictor = pool->Retrieve(i);
+    workers.emplace_back([this, predictor] { Work(predictor); });
+  }
+}
+
+DynamicBatcher::Impl::~Impl() {
+  {
+    std::lock_guard<std::mutex> lock(mu);
+    stop = true;
+  }
+  cv.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void DynamicBatcher::Impl::Validate(const Request& request) const {
+  PADDLE_ENFORCE_GT(request.inputs->size(),
+                    0UL,
+                    paddle::platform::errors::InvalidArgument(
+                        "The request of DynamicBatcher has no input."));
+  PADDLE_ENFORCE_GT(request.rows,
+                    0,
+                    paddle::platform::errors::InvalidArgument(
+                        "The batch size of the request should be positive, "
+                        "but it's %d.",
+                        request.rows));
+  for (auto& input : *request.inputs) {
+    PADDLE_ENFORCE_EQ(
+        !input.shape.empty() && input.shape[0] == request.rows,
+        true,
+        paddle::platform::errors::InvalidArgument(
+            "The inputs of a request should have the same first dimension, "
+            "but the one of input (%s) is not %d.",
+            input.name,
+            request.rows));
+    size_t numel = 1;
+    for (int dim : input.shape) {
+      numel *= dim;
+    }
+    PADDLE_ENFORCE_EQ(
+        input.data.length(),
+        numel * SizeOfDataType(input.dtype),
+        paddle::platform::errors::InvalidArgument(
+            "The data of input (%s) has %d bytes, which does not match its "
+            "shape and data type.",
+            input.name,
+            input.data.length()));
+  }
+}
+
+bool DynamicBatcher::Impl::CanBatch(const Request& a,
+                                    const Request& b) const {
+  if (a.has_lod || b.has_lod || a.inputs->size() != b.inputs->size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.inputs->size(); ++i) {
+    const paddle::PaddleTensor& x = (*a.inputs)[i];
+    const paddle::PaddleTensor& y = (*b.inputs)[i];
+    if (x.name != y.name || x.dtype != y.dtype ||
+        x.shape.size() != y.shape.size() ||
+        !std::equal(x.shape.begin() + 1, x.shape.end(), y.shape.begin() + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DynamicBatcher::Impl::Work(Predictor* predictor) {
+  std::vector<std::shared_ptr<Request>> batch;
+  while (true) {
+    batch.clear();
+    {
+      std::unique_lock<std::mutex> lock(mu);
+      cv.wait(lock, [this] { return stop || (!collecting && !queue.empty()); });
+      if (queue.empty()) {
+        return;
+      }
+      collecting = true;
+      std::shared_ptr<Request> first = queue.front();
+      queue.pop_front();
+      batch.push_back(first);
+      int rows = first->rows;
+      Clock::time_point deadline =
+          first->arrival +
+          std::chrono::microseconds(options.max_queue_delay_us);
+      while (!first->has_lod && rows < options.max_batch_size) {
+        for (auto iter = queue.begin(); iter != queue.end();) {
+          if (rows + (*iter)->rows <= options.max_batch_size &&
+              CanBatch(*first, **iter)) {
+            rows += (*iter)->rows;
+            batch.push_back(*iter);
+            iter = queue.erase(iter);
+          } else {
+            ++iter;
+          }
+        }
+        if (rows >= options.max_batch_size || stop) {
+          break;
+        }
+        uint64_t version = queue_version;
+        if (!cv.wait_until(lock, deadline, [this, version] {
+              return stop || queue_version != version;
+            })) {
+          break;
+        }
+      }
+      collecting = false;
+    }
+    // let the next idle worker collect the remaining requests
+    cv.notify_all();
+
+    RecordBatch(batch.size());
+    RunBatch(predictor, batch);
+  }
+}
+
+void DynamicBatcher::Impl::RunBatch(
+    Predictor* predictor, const std::vector<std::shared_ptr<Request>>& batch) {
+  bool ok = true;
+  try {
+    const Request& first = *batch.front();
+    int rows = 0;
+    for (auto& request : batch) {
+      rows += request->rows;
+      request->outputs->clear();
+    }
+
+    std::vector<char> buffer;
+    for (size_t i = 0; i < first.inputs->size(); ++i) {
+      const paddle::PaddleTensor& input = (*first.inputs)[i];
+      const void* data = input.data.data();
+      if (batch.size() > 1) {
+        buffer.clear();
+        for (auto& request : batch) {
+          const paddle::PaddleBuf& buf = (*request->inputs)[i].data;
+          const char* begin = static_cast<const char*>(buf.data());
+          buffer.insert(buffer.end(), begin, begin + buf.length());
+        }
+        data = buffer.data();
+      }
+      std::vector<int> shape = input.shape;
+      shape[0] = rows;
+      auto tensor = predictor->GetInputHandle(input.name);
+      tensor->Reshape(shape);
+      DYNAMIC_BATCHER_VISIT_DTYPE(input.dtype, CopyFromHost, tensor.get(), data)
+      if (first.has_lod) {
+        tensor->SetLoD(input.lod);
+      }
+    }
+
+    PADDLE_ENFORCE_EQ(predictor->Run(),
+                      true,
+                      paddle::platform::errors::Fatal(
+                          "Failed to run the predictor in DynamicBatcher."));
+
+    for (auto& name : predictor->GetOutputNames()) {
+      auto tensor = predictor->GetOutputHandle(name);
+      std::vector<int> shape = tensor->shape();
+      DataType dtype = tensor->type();
+      size_t numel = 1;
+      for (int dim : shape) {
+        numel *= dim;
+      }
+      size_t bytes = numel * SizeOfDataType(dtype);
+      if (batch.size() == 1) {
+        paddle::PaddleTensor output;
+        output.name = name;
+        output.shape = shape;
+        output.dtype = dtype;
+        output.lod = tensor->lod();
+        output.data.Resize(bytes);
+        DYNAMIC_BATCHER_VISIT_DTYPE(
+            dtype, CopyToHost, *tensor, output.data.data())
+        first.outputs->push_back(std::move(output));
+        continue;
+      }
+
+      PADDLE_ENFORCE_EQ(
+          !shape.empty() && shape[0] == rows,
+          true,
+          paddle::platform::errors::InvalidArgument(
+              "The first dimension of output (%s) should be the batch size "
+              "%d to be split to the requests.",
+              name,
+              rows));
+      buffer.resize(bytes);
+      DYNAMIC_BATCHER_VISIT_DTYPE(dtype, CopyToHost, *tensor, buffer.data())
+      size_t row_bytes = bytes / rows;
+      size_t offset = 0;
+      for (auto& request : batch) {
+        paddle::PaddleTensor output;
+        output.name = name;
+        output.shape = shape;
+        output.shape[0] = request->rows;
+        output.dtype = dtype;
+        output.data.Resize(row_bytes * request->rows);
+        std::memcpy(output.data.data(),
+                    buffer.data() + offset,
+                    output.data.length());
+        offset += output.data.length();
+        request->outputs->push_back(std::move(output));
+      }
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "DynamicBatcher failed to run a batch of " << batch.size()
+               << " requests: " << e.what();
+    ok = false;
+  }
+  for (auto& request : batch) {
+    request->done.set_value(ok);
+  }
+}
+
+void DynamicBatcher::Impl::RecordBatch(size_t request_num) {
+  std::lock_guard<std::mutex> lock(stats_mu);
+  ++batch_num;
+  batched_request_num += request_num;
+}
+
+void DynamicBatcher::Impl::RecordLatency(double latency_us) {
+  std::lock_guard<std::mutex> lock(stats_mu);
+  ++request_num;
+  latency_sum_us += latency_us;
+  max_latency_us = std::max(max_latency_us, latency_us);
+  if (latencies_us.size() < kLatencyWindow) {
+    latencies_us.push_back(latency_us);
+  } else {
+    latencies_us[next_latency] = latency_us;
+    next_latency = (next_latency + 1) % kLatencyWindow;
+  }
+}
+
+DynamicBatcher::DynamicBatcher(PredictorPool* pool,
+                               const DynamicBatcherOptions& options)
+    : impl_(new Impl(pool, options)) {}
+
+DynamicBatcher::~DynamicBatcher() = default;
+
+bool DynamicBatcher::Run(const std::vector<paddle::PaddleTensor>& inputs,
+                         std::vector<paddle::PaddleTensor>* outputs) {
+  auto request = std::make_shared<Impl::Request>();
+  request->inputs = &inputs;
+  request->outputs = outputs;
+  request->rows = inputs.empty() || inputs[0].shape.empty()
+                      ? 0
+                      : inputs[0].shape[0];
+  request->has_lod = std::any_of(
+      inputs.begin(), inputs.end(), [](const paddle::PaddleTensor& input) {
+        return !input.lod.empty();
+      });
+  request->arrival = Clock::now();
+  try {
+    impl_->Validate(*request);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << e.what();
+    return false;
+  }
+
+  std::future<bool> done = request->done.get_future();
+  {
+    std::lock_guard<std::mutex> lock(impl_->mu);
+    impl_->queue.push_back(request);
+    ++impl_->queue_version;
+  }
+  impl_->cv.notify_all();
+  bool ok = done.get();
+
+  impl_->RecordLatency(std::chrono::duration<double, std::micro>(
+                           Clock::now() - request->arrival)
+                           .count());
+  return ok;
+}
+
+DynamicBatcherStats DynamicBatcher::GetStats() const {
+  std::lock_guard<std::mutex> lock(impl_->stats_mu);
+  DynamicBatcherStats stats;
+  stats.request_num = impl_->request_num;
+  stats.batch_num = impl_->batch_num;
+  if (impl_->batch_num > 0) {
+    stats.avg_batch_requests =
+        static_cast<double>(impl_->batched_request_num) / impl_->batch_num;
+  }
+  if (impl_->request_num > 0) {
+    stats.avg_latency_us = impl_->latency_sum_us / impl_->request_num;
+    stats.max_latency_us = impl_->max_latency_us;
+    std::vector<double> latencies = impl_->latencies_us;
+    std::sort(latencies.begin(), latencies.end());
+    stats.p50_latency_us = latencies[latencies.size() * 50 / 100];
+    stats.p99_latency_us = latencies[latencies.size() * 99 / 100];
+  }
+  double seconds =
+      std::chrono::duration<double>(Clock::now() - impl_->stats_start).count();
+  if (seconds > 0) {
+    stats.throughput = impl_->request_num / seconds;
+  }
+  return stats;
+}
+
+void DynamicBatcher::ResetStats() {
+  std::lock_guard<std::mutex> lock(impl_->stats_mu);
+  impl_->request_num = 0;
+  impl_->batch_num = 0;
+  impl_->batched_request_num = 0;
+  impl_->latency_sum_us = 0;
+  impl_->max_latency_us = 0;
+  impl_->latencies_us.clear();
+  impl_->next_latency = 0;
+  impl_->stats_start = Clock::now();
+}
+
+#undef DYNAMIC_BATCHER_VISIT_DTYPE
+
+}  // namespace services
+}  // namespace paddle_infer
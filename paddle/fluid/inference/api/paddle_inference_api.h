@@ -269,10 +269,87 @@ class PD_INFER_DECL PredictorPool {
   /// \brief Get \param id-th predictor.
   Predictor* Retrieve(size_t idx);
 
+  /// \brief The number of predictors in the pool.
+  size_t Size() const { return preds_.size() + 1; }
+
  private:
   std::shared_ptr<Predictor> main_pred_;
   std::vector<std::unique_ptr<Predictor>> preds_;
 };
+
+struct PD_INFER_DECL DynamicBatcherOptions {
+  /// The largest sum of the first dimension of the requests in a batch.
+  int max_batch_size{32};
+  /// How long the first request of a batch waits for others to join it, in
+  /// microseconds.
+  int64_t max_queue_delay_us{1000};
+};
+
+struct PD_INFER_DECL DynamicBatcherStats {
+  uint64_t request_num{0};
+  uint64_t batch_num{0};
+  /// The average number of requests in a batch.
+  double avg_batch_requests{0};
+  /// The latency of DynamicBatcher::Run, in microseconds. The percentiles
+  /// are of the latest requests.
+  double avg_latency_us{0};
+  double p50_latency_us{0};
+  double p99_latency_us{0};
+  double max_latency_us{0};
+  /// Requests per second since the batcher is created or its stats reset.
+  double throughput{0};
+};
+
+///
+/// \class DynamicBatcher
+///
+/// \brief DynamicBatcher serves the requests of many threads with the
+/// predictors of a PredictorPool. Requests which arrive within a short delay
+/// are concatenated along the first (batch) dimension, run by one predictor,
+/// and the outputs are split back to the requests. So the kernels run larger
+/// batches when each serving thread only has a batch of one.
+///
+/// Requests are batched together when their inputs have the same names, data
+/// types and shapes except the first dimension. All the outputs of the model
+/// must have the batch as the first dimension. Requests with LoD run alone.
+///
+/// \code{cpp}
+///   services::PredictorPool pool(config, 4);
+///   services::DynamicBatcher batcher(&pool);
+///   // in each serving thread
+///   std::vector<paddle::PaddleTensor> outputs;
+///   batcher.Run(inputs, &outputs);
+/// \endcode
+///
+class PD_INFER_DECL DynamicBatcher {
+ public:
+  DynamicBatcher() = delete;
+  DynamicBatcher(const DynamicBatcher&) = delete;
+  DynamicBatcher& operator=(const DynamicBatcher&) = delete;
+
+  /// \brief Serve with all the predictors of \param pool, each by a thread.
+  explicit DynamicBatcher(PredictorPool* pool,
+                          const DynamicBatcherOptions& options = {});
+  ~DynamicBatcher();
+
+  ///
+  /// \brief Run the inputs on host as a part of a batch, thread safe.
+  ///
+  /// \param[in] inputs The input tensors, matched to the model by name.
+  /// \param[out] outputs The output tensors of the request.
+  /// \return Whether the run is successful
+  ///
+  bool Run(const std::vector<paddle::PaddleTensor>& inputs,
+           std::vector<paddle::PaddleTensor>* outputs);
+
+  DynamicBatcherStats GetStats() const;
+
+  void ResetStats();
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
 }  // namespace services
 
 }  // namespace paddle_infer
@@ -23,6 +23,7 @@
 #include "paddle/fluid/memory/allocation/naive_best_fit_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
 #include "paddle/fluid/memory/allocation/stat_allocator.h"
+#include "paddle/fluid/memory/allocation/thread_cached_cpu_allocator.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/place.h"
@@ -98,6 +99,10 @@ PADDLE_DEFINE_EXPORTED_bool(use_cuda_managed_memory,
 COMMON_DECLARE_string(allocator_strategy);
 COMMON_DECLARE_uint64(auto_growth_chunk_size_in_mb);
 COMMON_DECLARE_bool(use_auto_growth_pinned_allocator);
+COMMON_DECLARE_bool(use_thread_cached_cpu_allocator);
+COMMON_DECLARE_uint64(thread_cached_cpu_allocator_max_block_size_in_kb);
+COMMON_DECLARE_uint64(thread_cached_cpu_allocator_thread_cache_size_in_mb);
+COMMON_DECLARE_uint64(thread_cached_cpu_allocator_central_cache_size_in_mb);
 
 namespace paddle {
 namespace memory {
@@ -218,7 +223,7 @@ class AllocatorFacadePrivate {
       }
 
       case AllocatorStrategy::kAutoGrowth: {
-        InitNaiveBestFitCPUAllocator();
+        InitAutoGrowthCPUAllocator();
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
         allow_free_idle_chunk_ = allow_free_idle_chunk;
         for (int dev_id = 0; dev_id < platform::GetGPUDeviceCount(); ++dev_id) {
@@ -730,6 +735,23 @@ class AllocatorFacadePrivate {
 #endif
   }
 
+  void InitAutoGrowthCPUAllocator() {
+#if defined(__APPLE__) && defined(__arm64__)
+    InitNaiveBestFitCPUAllocator();
+#else
+    if (!FLAGS_use_thread_cached_cpu_allocator) {
+      InitNaiveBestFitCPUAllocator();
+      return;
+    }
+    allocators_[platform::CPUPlace()] =
+        std::make_shared<ThreadCachedCPUAllocator>(
+            std::make_shared<CPUAllocator>(),
+            FLAGS_thread_cached_cpu_allocator_max_block_size_in_kb << 10,
+            FLAGS_thread_cached_cpu_allocator_thread_cache_size_in_mb << 20,
+            FLAGS_thread_cached_cpu_allocator_central_cache_size_in_mb << 20);
+#endif
+  }
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   void InitNaiveBestFitCUDAPinnedAllocator() {
     if (FLAGS_use_auto_growth_pinned_allocator) {
@@ -20,6 +20,7 @@
 #include "paddle/fluid/memory/allocation/aligned_allocator.h"
 #include "paddle/fluid/platform/flags.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
+#include "paddle/fluid/platform/runtime_metrics.h"
 
 PADDLE_DEFINE_EXPORTED_READONLY_bool(
     free_idle_chunk,
@@ -45,6 +46,24 @@ namespace paddle {
 namespace memory {
 namespace allocation {
 
+namespace {
+platform::Counter *CacheHits() {
+  static auto *hits = platform::MetricsRegistry::Instance().GetCounter(
+      "paddle_allocator_cache_hits_total",
+      "Number of allocations served from the free blocks of "
+      "auto_growth allocators");
+  return hits;
+}
+
+platform::Counter *CacheMisses() {
+  static auto *misses = platform::MetricsRegistry::Instance().GetCounter(
+      "paddle_allocator_cache_misses_total",
+      "Number of allocations of auto_growth allocators which allocate a new "
+      "chunk");
+  return misses;
+}
+}  // namespace
+
 AutoGrowthBestFitAllocator::AutoGrowthBestFitAllocator(
     const std::shared_ptr<Allocator> &underlying_allocator,
     size_t alignment,
@@ -73,6 +92,7 @@ phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
   auto iter = free_blocks_.lower_bound(std::make_pair(size, nullptr));
   BlockIt block_it;
   if (iter != free_blocks_.end()) {
+    CacheHits()->Increase();
     block_it = iter->second;
     free_blocks_.erase(iter);
     auto *chunk = block_it->chunk_;
@@ -92,6 +112,7 @@ phi::Allocation *AutoGrowthBestFitAllocator::AllocateImpl(
       block_it->is_free_ = false;
     }
   } else {
+    CacheMisses()->Increase();
     if (FLAGS_free_when_no_cache_hit) {
       FreeIdleChunks();
     }
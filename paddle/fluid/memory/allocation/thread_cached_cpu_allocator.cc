@@ -0,0 +1,268 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_cached_cpu_allocator.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// requests smaller than kMinClassSize share the smallest size class
+static constexpr size_t kMinClassSize = 256;
+// every power of two is split into kClassesPerDoubling size classes, which
+// bounds the internal fragmentation by 25%
+static constexpr size_t kClassesPerDoubling = 4;
+// blocks moved between a thread cache and the central list at once
+static constexpr size_t kTransferBatchSize = 16;
+static constexpr size_t kUncachedClass = std::numeric_limits<size_t>::max();
+
+struct ThreadCachedCPUAllocator::ThreadCachedAllocation : public Allocation {
+  ThreadCachedAllocation(DecoratedAllocationPtr block,
+                         size_t size,
+                         size_t size_class)
+      : Allocation(block->ptr(), block->base_ptr(), size, block->place()),
+        block_(std::move(block)),
+        size_class_(size_class) {}
+
+  DecoratedAllocationPtr block_;
+  size_t size_class_;
+};
+
+class ThreadCachedCPUAllocator::CentralCache {
+ public:
+  CentralCache(std::shared_ptr<Allocator> underlying_allocator,
+               size_t class_num,
+               size_t capacity)
+      : underlying_allocator_(std::move(underlying_allocator)),
+        free_lists_(new FreeList[class_num]),
+        class_num_(class_num),
+        capacity_(capacity) {}
+
+  Allocator* UnderlyingAllocator() { return underlying_allocator_.get(); }
+
+  // Move at most max_num blocks of size_class to the back of blocks, and
+  // return the total size of moved blocks.
+  size_t Pop(size_t size_class,
+             size_t max_num,
+             std::vector<DecoratedAllocationPtr>* blocks) {
+    auto& free_list = free_lists_[size_class];
+    std::lock_guard<SpinLock> guard(free_list.lock);
+    size_t moved_size = 0;
+    while (max_num-- > 0 && !free_list.blocks.empty()) {
+      moved_size += free_list.blocks.back()->size();
+      blocks->emplace_back(std::move(free_list.blocks.back()));
+      free_list.blocks.pop_back();
+    }
+    cached_size_ -= moved_size;
+    return moved_size;
+  }
+
+  // Take the last num blocks of blocks. Blocks that do not fit in the
+  // central list are returned to the underlying allocator.
+  void Push(size_t size_class,
+            size_t num,
+            std::vector<DecoratedAllocationPtr>* blocks) {
+    auto& free_list = free_lists_[size_class];
+    std::lock_guard<SpinLock> guard(free_list.lock);
+    for (; num > 0 && !blocks->empty(); --num) {
+      size_t block_size = blocks->back()->size();
+      if (cached_size_ + block_size <= capacity_) {
+        cached_size_ += block_size;
+        free_list.blocks.emplace_back(std::move(blocks->back()));
+      }
+      blocks->pop_back();
+    }
+  }
+
+  uint64_t Release() {
+    uint64_t released_size = 0;
+    for (size_t i = 0; i < class_num_; ++i) {
+      auto& free_list = free_lists_[i];
+      std::lock_guard<SpinLock> guard(free_list.lock);
+      for (auto& block : free_list.blocks) {
+        released_size += block->size();
+      }
+      free_list.blocks.clear();
+    }
+    cached_size_ -= released_size;
+    return released_size;
+  }
+
+ private:
+  struct FreeList {
+    SpinLock lock;
+    std::vector<DecoratedAllocationPtr> blocks;
+  };
+
+  // declared first so that it outlives the cached blocks
+  std::shared_ptr<Allocator> underlying_allocator_;
+  std::unique_ptr<FreeList[]> free_lists_;
+  size_t class_num_;
+  size_t capacity_;
+  std::atomic<size_t> cached_size_{0};
+};
+
+class ThreadCachedCPUAllocator::ThreadCache {
+ public:
+  ThreadCache(std::shared_ptr<CentralCache> central_cache,
+              size_t class_num,
+              size_t capacity)
+      : central_cache_(std::move(central_cache)),
+        free_lists_(class_num),
+        capacity_(capacity) {}
+
+  ~ThreadCache() { Release(); }
+
+  DecoratedAllocationPtr Pop(size_t size_class) {
+    auto& free_list = free_lists_[size_class];
+    if (free_list.empty()) {
+      cached_size_ +=
+          central_cache_->Pop(size_class, kTransferBatchSize, &free_list);
+      if (free_list.empty()) {
+        return nullptr;
+      }
+    }
+    auto block = std::move(free_list.back());
+    free_list.pop_back();
+    cached_size_ -= block->size();
+    return block;
+  }
+
+  void Push(size_t size_class, DecoratedAllocationPtr block) {
+    auto& free_list = free_lists_[size_class];
+    cached_size_ += block->size();
+    free_list.emplace_back(std::move(block));
+    if (cached_size_ > capacity_) {
+      // give back half of the growing list, the central list hands them
+      // out to the threads that keep allocating this size class
+      size_t num = (free_list.size() + 1) / 2;
+      cached_size_ -= num * free_list.back()->size();
+      central_cache_->Push(size_class, num, &free_list);
+    }
+  }
+
+  uint64_t Release() {
+    uint64_t released_size = cached_size_;
+    for (size_t i = 0; i < free_lists_.size(); ++i) {
+      central_cache_->Push(i, free_lists_[i].size(), &free_lists_[i]);
+    }
+    cached_size_ = 0;
+    return released_size;
+  }
+
+ private:
+  std::shared_ptr<CentralCache> central_cache_;
+  std::vector<std::vector<DecoratedAllocationPtr>> free_lists_;
+  size_t capacity_;
+  size_t cached_size_{0};
+};
+
+ThreadCachedCPUAllocator::ThreadCacheMap&
+ThreadCachedCPUAllocator::ThreadCaches() {
+  static thread_local ThreadCacheMap caches;
+  return caches;
+}
+
+static std::atomic<uint64_t> allocator_id{0};
+
+ThreadCachedCPUAllocator::ThreadCachedCPUAllocator(
+    std::shared_ptr<Allocator> underlying_allocator,
+    size_t max_cached_block_size,
+    size_t thread_cache_size,
+    size_t central_cache_size)
+    : thread_cache_size_(thread_cache_size), id_(++allocator_id) {
+  for (size_t base = kMinClassSize; base <= max_cached_block_size;
+       base *= 2) {
+    for (size_t i = 0; i < kClassesPerDoubling; ++i) {
+      size_t class_size = base + i * (base / kClassesPerDoubling);
+      if (class_size > max_cached_block_size) {
+        break;
+      }
+      class_sizes_.emplace_back(class_size);
+    }
+  }
+  central_cache_ = std::make_shared<CentralCache>(
+      std::move(underlying_allocator), class_sizes_.size(), central_cache_size);
+  VLOG(4) << "ThreadCachedCPUAllocator " << id_ << " with "
+          << class_sizes_.size() << " size classes, max cached block size "
+          << max_cached_block_size << ", thread cache size "
+          << thread_cache_size << ", central cache size "
+          << central_cache_size;
+}
+
+ThreadCachedCPUAllocator::~ThreadCachedCPUAllocator() {
+  // caches of other threads are released when those threads exit, they
+  // keep the central cache alive until then
+  ThreadCaches().erase(id_);
+}
+
+size_t ThreadCachedCPUAllocator::SizeClassOf(size_t size) const {
+  auto iter = std::lower_bound(class_sizes_.begin(), class_sizes_.end(), size);
+  return iter == class_sizes_.end() ? 0 : *iter;
+}
+
+ThreadCachedCPUAllocator::ThreadCache*
+ThreadCachedCPUAllocator::GetThreadCache() {
+  auto& caches = ThreadCaches();
+  auto iter = caches.find(id_);
+  if (iter == caches.end()) {
+    iter = caches
+               .emplace(id_,
+                        std::make_unique<ThreadCache>(central_cache_,
+                                                      class_sizes_.size(),
+                                                      thread_cache_size_))
+               .first;
+  }
+  return iter->second.get();
+}
+
+phi::Allocation* ThreadCachedCPUAllocator::AllocateImpl(size_t size) {
+  auto* underlying_allocator = central_cache_->UnderlyingAllocator();
+  auto iter = std::lower_bound(class_sizes_.begin(), class_sizes_.end(), size);
+  if (iter == class_sizes_.end()) {
+    auto block =
+        static_unique_ptr_cast<Allocation>(underlying_allocator->Allocate(size));
+    return new ThreadCachedAllocation(std::move(block), size, kUncachedClass);
+  }
+  size_t size_class = iter - class_sizes_.begin();
+  auto block = GetThreadCache()->Pop(size_class);
+  if (block == nullptr) {
+    block = static_unique_ptr_cast<Allocation>(
+        underlying_allocator->Allocate(*iter));
+  }
+  return new ThreadCachedAllocation(std::move(block), size, size_class);
+}
+
+void ThreadCachedCPUAllocator::FreeImpl(phi::Allocation* allocation) {
+  auto* cached_allocation = static_cast<ThreadCachedAllocation*>(allocation);
+  auto block = std::move(cached_allocation->block_);
+  size_t size_class = cached_allocation->size_class_;
+  delete cached_allocation;
+  if (size_class != kUncachedClass) {
+    GetThreadCache()->Push(size_class, std::move(block));
+  }
+}
+
+uint64_t ThreadCachedCPUAllocator::ReleaseImpl(const platform::Place& place) {
+  GetThreadCache()->Release();
+  return central_cache_->Release();
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,87 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation/spin_lock.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * ThreadCachedCPUAllocator caches freed host blocks by size class so that
+ * repeated CPU allocations of similar sizes do not go to the underlying
+ * allocator (malloc/free) every time.
+ *
+ * Each thread owns a small cache per size class. A block freed on another
+ * thread is cached by the freeing thread, and blocks move between threads
+ * through a central free list shared by all threads:
+ *
+ *   Allocate: thread cache -> central free list -> underlying allocator
+ *   Free:     thread cache -> central free list (when the thread cache is
+ *             full) -> underlying allocator (when the central list is full)
+ *
+ * Blocks larger than the biggest size class bypass the cache. Release()
+ * returns idle cached blocks of the central list and the calling thread to
+ * the underlying allocator. The underlying allocator keeps the host
+ * Reserved stat, so cached memory stays visible in memory/stats.h.
+ */
+class ThreadCachedCPUAllocator : public Allocator {
+ public:
+  ThreadCachedCPUAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                           size_t max_cached_block_size,
+                           size_t thread_cache_size,
+                           size_t central_cache_size);
+
+  ~ThreadCachedCPUAllocator() override;
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // size class that size is rounded up to, 0 if size is not cached
+  size_t SizeClassOf(size_t size) const;
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+  void FreeImpl(phi::Allocation* allocation) override;
+  uint64_t ReleaseImpl(const platform::Place& place) override;
+
+ private:
+  class CentralCache;
+  class ThreadCache;
+  struct ThreadCachedAllocation;
+
+  using ThreadCacheMap =
+      std::unordered_map<uint64_t, std::unique_ptr<ThreadCache>>;
+  static ThreadCacheMap& ThreadCaches();
+  ThreadCache* GetThreadCache();
+
+  std::shared_ptr<CentralCache> central_cache_;
+  std::vector<size_t> class_sizes_;
+  size_t thread_cache_size_;
+  // identify this allocator in the thread local cache map, addresses can
+  // be reused by another allocator after destruction
+  uint64_t id_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
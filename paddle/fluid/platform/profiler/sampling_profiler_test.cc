@@ -0,0 +1,121 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/api/profiler/sampling_profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
+
+using paddle::platform::RecordEvent;
+using paddle::platform::TracerEventType;
+using phi::SamplingProfiler;
+using phi::SamplingProfilerOptions;
+
+TEST(SamplingProfilerTest, CollapsedStacksAndLatency) {
+  SamplingProfiler::Clear();
+  SamplingProfilerOptions options;
+  options.sample_rate = 2;
+  options.max_level = 2;
+  SamplingProfiler::Enable(options);
+  std::string kernel_name = "matmul_kernel";
+  for (int i = 0; i < 10; ++i) {
+    RecordEvent op("matmul", TracerEventType::Operator, 1);
+    {
+      RecordEvent kernel(kernel_name, TracerEventType::OperatorInner, 2);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    { RecordEvent verbose("verbose", TracerEventType::UserDefined, 3); }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  SamplingProfiler::Disable();
+  // not sampled after disabled
+  { RecordEvent op("relu", TracerEventType::Operator, 1); }
+
+  auto stats = SamplingProfiler::LatencyStats();
+  ASSERT_EQ(stats.size(), 2UL);
+  EXPECT_EQ(stats[0].name, "matmul");
+  EXPECT_EQ(stats[0].count, 5UL);
+  EXPECT_GE(stats[0].p50_us, 3000);
+  EXPECT_GE(stats[0].max_us, stats[0].p90_us);
+  EXPECT_EQ(stats[1].name, "matmul_kernel");
+  EXPECT_EQ(stats[1].count, 5UL);
+
+  std::string stacks = SamplingProfiler::CollapsedStacks();
+  EXPECT_NE(stacks.find("matmul;matmul_kernel "), std::string::npos);
+  // the self time of the op itself
+  EXPECT_EQ(stacks.find("matmul "), 0UL);
+  EXPECT_EQ(stacks.find("verbose"), std::string::npos);
+
+  SamplingProfiler::Clear();
+  EXPECT_TRUE(SamplingProfiler::LatencyStats().empty());
+}
+
+void RunScaleThread(size_t buffer_size) {
+  SamplingProfilerOptions options;
+  options.sample_rate = 1;
+  options.buffer_size = buffer_size;
+  SamplingProfiler::Enable(options);
+  std::thread([]() {
+    for (int i = 0; i < 100; ++i) {
+      RecordEvent op("scale", TracerEventType::Operator, 1);
+    }
+  }).join();
+  SamplingProfiler::Disable();
+}
+
+TEST(SamplingProfilerTest, BoundedBuffer) {
+  SamplingProfiler::Clear();
+  RunScaleThread(4);
+  auto stats = SamplingProfiler::LatencyStats();
+  ASSERT_EQ(stats.size(), 1UL);
+  EXPECT_EQ(stats[0].name, "scale");
+  EXPECT_EQ(stats[0].count, 4UL);
+  SamplingProfiler::Clear();
+
+  // the buffer released by the exited thread is not reused with another size
+  RunScaleThread(8);
+  stats = SamplingProfiler::LatencyStats();
+  ASSERT_EQ(stats.size(), 1UL);
+  EXPECT_EQ(stats[0].count, 8UL);
+  SamplingProfiler::Clear();
+}
+
+TEST(SamplingProfilerTest, BoundedNames) {
+  SamplingProfiler::Clear();
+  SamplingProfilerOptions options;
+  options.sample_rate = 1;
+  options.buffer_size = 16;
+  SamplingProfiler::Enable(options);
+  std::thread([]() {
+    for (size_t i = 0; i < SamplingProfiler::kMaxNames + 10; ++i) {
+      RecordEvent op("op_" + std::to_string(i), TracerEventType::Operator, 1);
+    }
+  }).join();
+  SamplingProfiler::Disable();
+
+  auto stats = SamplingProfiler::LatencyStats();
+  ASSERT_FALSE(stats.empty());
+  auto iter = std::find_if(
+      stats.begin(), stats.end(), [](const phi::OpLatencyStats& stat) {
+        return stat.name == "<other>";
+      });
+  ASSERT_NE(iter, stats.end());
+  EXPECT_GE(iter->count, 10UL);
+  SamplingProfiler::Clear();
+}
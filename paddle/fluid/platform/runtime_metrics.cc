@@ -0,0 +1,276 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/runtime_metrics.h"
+
+#include <sstream>
+
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/monitor.h"
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+const char* TypeName(MetricType type) {
+  switch (type) {
+    case MetricType::kCounter:
+      return "counter";
+    case MetricType::kGauge:
+      return "gauge";
+    default:
+      return "histogram";
+  }
+}
+
+std::string EscapeLabelValue(const std::string& value) {
+  std::string escaped;
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (c == '\n') {
+      escaped.append("\\n");
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+// {k1="v1",k2="v2"}, extra is appended as the last label
+std::string LabelsString(const MetricLabels& labels,
+                         const std::string& extra = "") {
+  if (labels.empty() && extra.empty()) {
+    return "";
+  }
+  std::string str = "{";
+  for (const auto& label : labels) {
+    if (str.size() > 1) str.push_back(',');
+    str += label.first + "=\"" + EscapeLabelValue(label.second) + "\"";
+  }
+  if (!extra.empty()) {
+    if (str.size() > 1) str.push_back(',');
+    str += extra;
+  }
+  str.push_back('}');
+  return str;
+}
+
+// metric names may only contain [a-zA-Z0-9_:]
+std::string SanitizeName(const std::string& name) {
+  std::string sanitized = name;
+  for (char& c : sanitized) {
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '_' && c != ':') {
+      c = '_';
+    }
+  }
+  return sanitized;
+}
+
+template <typename T>
+void ExportStats(const std::string& help, std::ostream& os) {
+  for (const auto& stat : StatRegistry<T>::Instance().publish()) {
+    std::string name = "paddle_" + SanitizeName(stat.key);
+    os << "# HELP " << name << " " << help << "\n";
+    os << "# TYPE " << name << " gauge\n";
+    os << name << " " << stat.value << "\n";
+  }
+}
+
+}  // namespace
+
+int MetricCellIndex() {
+  static std::atomic<int> next_index{0};
+  thread_local int index =
+      next_index.fetch_add(1, std::memory_order_relaxed) % kMetricCells;
+  return index;
+}
+
+int64_t Counter::Value() const {
+  int64_t value = 0;
+  for (const auto& cell : cells_) {
+    value += cell.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+void Gauge::Set(int64_t value) {
+  int index = MetricCellIndex();
+  for (int i = 0; i < kMetricCells; ++i) {
+    cells_[i].value.store(i == index ? value : 0, std::memory_order_relaxed);
+  }
+}
+
+int64_t Gauge::Value() const {
+  int64_t value = 0;
+  for (const auto& cell : cells_) {
+    value += cell.value.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+std::vector<int64_t> Histogram::BucketCounts() const {
+  std::vector<int64_t> counts(kNumBuckets, 0);
+  for (const auto& cell : cells_) {
+    for (int i = 0; i < kNumBuckets; ++i) {
+      counts[i] += cell.buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+  return counts;
+}
+
+int64_t Histogram::Sum() const {
+  int64_t sum = 0;
+  for (const auto& cell : cells_) {
+    sum += cell.sum.load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+MetricsRegistry& MetricsRegistry::Instance() {
+  // never destroyed, metrics may be updated during static destruction
+  static MetricsRegistry* registry = new MetricsRegistry();
+  return *registry;
+}
+
+Metric* MetricsRegistry::GetOrCreate(const std::string& name,
+                                     const std::string& help,
+                                     MetricType type,
+                                     const MetricLabels& labels) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = families_.find(name);
+  if (iter == families_.end()) {
+    iter = families_.emplace(name, Family()).first;
+    iter->second.help = help;
+    iter->second.type = type;
+  }
+  Family& family = iter->second;
+  PADDLE_ENFORCE_EQ(
+      family.type == type,
+      true,
+      platform::errors::AlreadyExists(
+          "Metric %s has been registered as a %s, but is requested as a %s.",
+          name,
+          TypeName(family.type),
+          TypeName(type)));
+
+  auto& metric = family.metrics[LabelsString(labels)];
+  if (metric == nullptr) {
+    switch (type) {
+      case MetricType::kCounter:
+        metric = std::make_unique<Counter>(labels);
+        break;
+      case MetricType::kGauge:
+        metric = std::make_unique<Gauge>(labels);
+        break;
+      case MetricType::kHistogram:
+        metric = std::make_unique<Histogram>(labels);
+        break;
+    }
+  }
+  return metric.get();
+}
+
+Counter* MetricsRegistry::GetCounter(const std::string& name,
+                                     const std::string& help,
+                                     const MetricLabels& labels) {
+  return static_cast<Counter*>(
+      GetOrCreate(name, help, MetricType::kCounter, labels));
+}
+
+Gauge* MetricsRegistry::GetGauge(const std::string& name,
+                                 const std::string& help,
+                                 const MetricLabels& labels) {
+  return static_cast<Gauge*>(
+      GetOrCreate(name, help, MetricType::kGauge, labels));
+}
+
+Histogram* MetricsRegistry::GetHistogram(const std::string& name,
+                                         const std::string& help,
+                                         const MetricLabels& labels) {
+  return static_cast<Histogram*>(
+      GetOrCreate(name, help, MetricType::kHistogram, labels));
+}
+
+std::vector<MetricSample> MetricsRegistry::Snapshot() const {
+  std::vector<MetricSample> samples;
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (const auto& [name, family] : families_) {
+    for (const auto& [labels_str, metric] : family.metrics) {
+      MetricSample sample;
+      sample.name = name;
+      sample.help = family.help;
+      sample.type = family.type;
+      sample.labels = metric->labels();
+      switch (family.type) {
+        case MetricType::kCounter:
+          sample.value = static_cast<const Counter*>(metric.get())->Value();
+          break;
+        case MetricType::kGauge:
+          sample.value = static_cast<const Gauge*>(metric.get())->Value();
+          break;
+        case MetricType::kHistogram: {
+          auto* histogram = static_cast<const Histogram*>(metric.get());
+          sample.bucket_counts = histogram->BucketCounts();
+          sample.sum = histogram->Sum();
+          for (int64_t count : sample.bucket_counts) {
+            sample.value += count;
+          }
+          break;
+        }
+      }
+      samples.emplace_back(std::move(sample));
+    }
+  }
+  return samples;
+}
+
+std::string MetricsRegistry::ExportPrometheusText() const {
+  std::ostringstream os;
+  std::string last_name;
+  for (const auto& sample : Snapshot()) {
+    if (sample.name != last_name) {
+      os << "# HELP " << sample.name << " " << sample.help << "\n";
+      os << "# TYPE " << sample.name << " " << TypeName(sample.type) << "\n";
+      last_name = sample.name;
+    }
+    if (sample.type != MetricType::kHistogram) {
+      os << sample.name << LabelsString(sample.labels) << " " << sample.value
+         << "\n";
+      continue;
+    }
+    int64_t cumulative = 0;
+    for (int i = 0; i < Histogram::kNumBuckets; ++i) {
+      cumulative += sample.bucket_counts[i];
+      std::string le = i == Histogram::kNumBuckets - 1
+                           ? "+Inf"
+                           : std::to_string(Histogram::BucketBound(i));
+      os << sample.name << "_bucket"
+         << LabelsString(sample.labels, "le=\"" + le + "\"") << " "
+         << cumulative << "\n";
+    }
+    os << sample.name << "_sum" << LabelsString(sample.labels) << " "
+       << sample.sum << "\n";
+    os << sample.name << "_count" << LabelsString(sample.labels) << " "
+       << sample.value << "\n";
+  }
+  ExportStats<int64_t>("Value of the int64 StatRegistry", os);
+  ExportStats<float>("Value of the float StatRegistry", os);
+  return os.str();
+}
+
+}  // namespace platform
+}  // namespace paddle
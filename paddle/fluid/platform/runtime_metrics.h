@@ -0,0 +1,205 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/macros.h"
+
+namespace paddle {
+namespace platform {
+
+// Runtime metrics which are cheap enough to be always on. A metric is
+// registered once by name and labels, and the returned pointer is cached by
+// the call site, e.g.
+//
+//   static auto* ops = MetricsRegistry::Instance().GetCounter(
+//       "paddle_executor_ops_total", "Number of dispatched ops");
+//   ops->Increase();
+//
+// Updates are relaxed atomic adds into a cell picked by the calling thread,
+// so threads updating the same metric rarely share a cache line. Reading a
+// metric sums the cells of all threads.
+
+enum class MetricType { kCounter, kGauge, kHistogram };
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+constexpr int kMetricCells = 32;
+
+// The cell of the calling thread, threads are assigned round robin
+int MetricCellIndex();
+
+struct alignas(64) MetricCell {
+  std::atomic<int64_t> value{0};
+};
+
+class Metric {
+ public:
+  Metric(MetricType type, const MetricLabels& labels)
+      : type_(type), labels_(labels) {}
+  virtual ~Metric() = default;
+
+  MetricType type() const { return type_; }
+  const MetricLabels& labels() const { return labels_; }
+
+ private:
+  MetricType type_;
+  MetricLabels labels_;
+
+  DISABLE_COPY_AND_ASSIGN(Metric);
+};
+
+// Monotonically increasing value, e.g. the number of dispatched ops.
+class Counter : public Metric {
+ public:
+  explicit Counter(const MetricLabels& labels = {})
+      : Metric(MetricType::kCounter, labels) {}
+
+  void Increase(int64_t value = 1) {
+    cells_[MetricCellIndex()].value.fetch_add(value,
+                                              std::memory_order_relaxed);
+  }
+
+  int64_t Value() const;
+
+ private:
+  MetricCell cells_[kMetricCells];
+};
+
+// Value that goes up and down, e.g. the number of pending tasks.
+class Gauge : public Metric {
+ public:
+  explicit Gauge(const MetricLabels& labels = {})
+      : Metric(MetricType::kGauge, labels) {}
+
+  void Add(int64_t value) {
+    cells_[MetricCellIndex()].value.fetch_add(value,
+                                              std::memory_order_relaxed);
+  }
+
+  // Only for gauges with a single writer, a concurrent Add may be lost.
+  void Set(int64_t value);
+
+  int64_t Value() const;
+
+ private:
+  MetricCell cells_[kMetricCells];
+};
+
+// Distribution of values, e.g. latencies in microseconds. The upper bounds
+// of the buckets are 1, 2, 4, ..., 2^(kNumBuckets - 2) and +Inf.
+class Histogram : public Metric {
+ public:
+  static constexpr int kNumBuckets = 22;
+
+  explicit Histogram(const MetricLabels& labels = {})
+      : Metric(MetricType::kHistogram, labels) {}
+
+  void Observe(int64_t value) {
+    Cell& cell = cells_[MetricCellIndex()];
+    cell.buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    cell.sum.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  // The upper bound of the bucket, the last one is unbounded
+  static int64_t BucketBound(int bucket) { return int64_t(1) << bucket; }
+
+  // Count of each bucket, not cumulative
+  std::vector<int64_t> BucketCounts() const;
+  int64_t Sum() const;
+
+ private:
+  static int BucketIndex(int64_t value) {
+    int bucket = 0;
+    while (bucket < kNumBuckets - 1 && BucketBound(bucket) < value) {
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  struct alignas(64) Cell {
+    std::atomic<int64_t> buckets[kNumBuckets] = {};
+    std::atomic<int64_t> sum{0};
+  };
+  Cell cells_[kMetricCells];
+};
+
+// Value of a metric at the time of MetricsRegistry::Snapshot.
+struct MetricSample {
+  std::string name;
+  std::string help;
+  MetricType type;
+  MetricLabels labels;
+  // value of a counter or a gauge, or the number of observations of a
+  // histogram
+  int64_t value{0};
+  // only for histograms
+  int64_t sum{0};
+  std::vector<int64_t> bucket_counts;
+};
+
+class MetricsRegistry {
+ public:
+  static MetricsRegistry& Instance();
+
+  // Return the metric of the name and labels, which is created on the first
+  // call and lives as long as the process.
+  Counter* GetCounter(const std::string& name,
+                      const std::string& help,
+                      const MetricLabels& labels = {});
+  Gauge* GetGauge(const std::string& name,
+                  const std::string& help,
+                  const MetricLabels& labels = {});
+  Histogram* GetHistogram(const std::string& name,
+                          const std::string& help,
+                          const MetricLabels& labels = {});
+
+  std::vector<MetricSample> Snapshot() const;
+
+  // Export the metrics and the values of StatRegistry in the Prometheus text
+  // exposition format.
+  std::string ExportPrometheusText() const;
+
+ private:
+  MetricsRegistry() = default;
+
+  struct Family {
+    std::string help;
+    MetricType type;
+    // labels string -> metric
+    std::map<std::string, std::unique_ptr<Metric>> metrics;
+  };
+
+  Metric* GetOrCreate(const std::string& name,
+                      const std::string& help,
+                      MetricType type,
+                      const MetricLabels& labels);
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Family> families_;
+
+  DISABLE_COPY_AND_ASSIGN(MetricsRegistry);
+};
+
+}  // namespace platform
+}  // namespace paddle
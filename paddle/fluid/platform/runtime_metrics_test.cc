@@ -0,0 +1,99 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/runtime_metrics.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(Metrics, Counter) {
+  auto& registry = MetricsRegistry::Instance();
+  Counter* counter = registry.GetCounter("test_counter_total", "A counter");
+  EXPECT_EQ(registry.GetCounter("test_counter_total", "A counter"), counter);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([counter]() {
+      for (int j = 0; j < 1000; ++j) {
+        counter->Increase();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(counter->Value(), 8000);
+
+  // another metric of the same name and type but different labels
+  Counter* labeled = registry.GetCounter(
+      "test_counter_total", "A counter", {{"device", "gpu:0"}});
+  EXPECT_NE(labeled, counter);
+  EXPECT_EQ(labeled->Value(), 0);
+  EXPECT_ANY_THROW(registry.GetGauge("test_counter_total", "A counter"));
+}
+
+TEST(Metrics, Gauge) {
+  Gauge* gauge =
+      MetricsRegistry::Instance().GetGauge("test_gauge", "A gauge");
+  gauge->Add(5);
+  std::thread([gauge]() { gauge->Add(-2); }).join();
+  EXPECT_EQ(gauge->Value(), 3);
+  gauge->Set(10);
+  EXPECT_EQ(gauge->Value(), 10);
+}
+
+TEST(Metrics, HistogramAndExport) {
+  auto& registry = MetricsRegistry::Instance();
+  Histogram* histogram =
+      registry.GetHistogram("test_latency_us", "A histogram", {{"op", "x"}});
+  for (int64_t value : std::vector<int64_t>{0, 1, 3, 4, 5, 1LL << 30}) {
+    histogram->Observe(value);
+  }
+  auto counts = histogram->BucketCounts();
+  EXPECT_EQ(counts[0], 2);  // <= 1
+  EXPECT_EQ(counts[2], 2);  // (2, 4]
+  EXPECT_EQ(counts[3], 1);  // (4, 8]
+  EXPECT_EQ(counts[Histogram::kNumBuckets - 1], 1);
+  EXPECT_EQ(histogram->Sum(), 13 + (int64_t(1) << 30));
+
+  bool found = false;
+  for (const auto& sample : registry.Snapshot()) {
+    if (sample.name == "test_latency_us") {
+      EXPECT_EQ(sample.type, MetricType::kHistogram);
+      EXPECT_EQ(sample.value, 6);
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found);
+
+  std::string text = registry.ExportPrometheusText();
+  EXPECT_NE(text.find("# TYPE test_latency_us histogram\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_latency_us_bucket{op=\"x\",le=\"4\"} 4\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_latency_us_bucket{op=\"x\",le=\"+Inf\"} 6\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_latency_us_count{op=\"x\"} 6\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE test_gauge gauge\ntest_gauge 10\n"),
+            std::string::npos);
+}
+
+}  // namespace platform
+}  // namespace paddle
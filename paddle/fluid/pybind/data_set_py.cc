@@ -385,6 +385,9 @@ void BindDataset(py::module *m) {
            py::call_guard<py::gil_scoped_release>())
       .def("dump_sample_neighbors",
            &framework::Dataset::DumpSampleNeighbors,
+           py::call_guard<py::gil_scoped_release>())
+      .def("dump_slot_record_files",
+           &framework::Dataset::DumpSlotRecordFiles,
            py::call_guard<py::gil_scoped_release>());
 
   py::class_<IterableDatasetWrapper>(*m, "IterableDatasetWrapper")
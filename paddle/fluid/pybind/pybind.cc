@@ -99,6 +99,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/profiler/event_python.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 #include "paddle/fluid/platform/profiler/profiler.h"
+#include "paddle/fluid/platform/runtime_metrics.h"
 #include "paddle/fluid/pybind/auto_parallel_py.h"
 #include "paddle/fluid/pybind/bind_cost_model.h"
 #include "paddle/fluid/pybind/bind_fleet_executor.h"
@@ -128,6 +129,7 @@ limitations under the License. */
 #include "paddle/fluid/pybind/ps_gpu_wrapper_py.h"
 #include "paddle/fluid/pybind/pybind_variant_caster.h"
 #include "paddle/fluid/pybind/xpu_streams_py.h"
+#include "paddle/phi/api/profiler/sampling_profiler.h"
 #include "paddle/phi/backends/cpu/cpu_info.h"
 #include "paddle/phi/backends/device_manager.h"
 #include "paddle/phi/core/compat/convert_utils.h"
@@ -2178,6 +2180,25 @@ All parameter, weight, gradient are variables in Paddle.
     }
     return stats_map;
   });
+  m.def("get_runtime_metrics", []() {
+    std::unordered_map<std::string, int64_t> metrics_map;
+    for (const auto &sample :
+         paddle::platform::MetricsRegistry::Instance().Snapshot()) {
+      std::string key = sample.name;
+      for (const auto &label : sample.labels) {
+        key += "," + label.first + "=" + label.second;
+      }
+      metrics_map[key] = sample.value;
+      if (sample.type == paddle::platform::MetricType::kHistogram) {
+        metrics_map[key + ",sum"] = sample.sum;
+      }
+    }
+    return metrics_map;
+  });
+  m.def("export_runtime_metrics", []() {
+    return paddle::platform::MetricsRegistry::Instance()
+        .ExportPrometheusText();
+  });
   m.def("device_memory_stat_current_value",
         memory::DeviceMemoryStatCurrentValue);
   m.def("device_memory_stat_peak_value", memory::DeviceMemoryStatPeakValue);
@@ -2695,6 +2716,37 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("disable_memory_recorder", &paddle::platform::DisableMemoryRecorder);
   m.def("enable_op_info_recorder", &phi::EnableOpInfoRecorder);
   m.def("disable_op_info_recorder", &phi::DisableOpInfoRecorder);
+  m.def(
+      "enable_sampling_profiler",
+      [](uint32_t sample_rate, uint32_t max_level, size_t buffer_size) {
+        phi::SamplingProfilerOptions options;
+        options.sample_rate = sample_rate;
+        options.max_level = max_level;
+        options.buffer_size = buffer_size;
+        phi::SamplingProfiler::Enable(options);
+      },
+      py::arg("sample_rate") = 100,
+      py::arg("max_level") = 2,
+      py::arg("buffer_size") = 8192);
+  m.def("disable_sampling_profiler", &phi::SamplingProfiler::Disable);
+  m.def("clear_sampling_profiler", &phi::SamplingProfiler::Clear);
+  m.def("sampling_profiler_collapsed_stacks",
+        &phi::SamplingProfiler::CollapsedStacks);
+  m.def("sampling_profiler_latency_stats", []() {
+    py::list stats;
+    for (const auto &stat : phi::SamplingProfiler::LatencyStats()) {
+      py::dict item;
+      item["name"] = stat.name;
+      item["count"] = stat.count;
+      item["total_us"] = stat.total_us;
+      item["p50_us"] = stat.p50_us;
+      item["p90_us"] = stat.p90_us;
+      item["p99_us"] = stat.p99_us;
+      item["max_us"] = stat.max_us;
+      stats.append(item);
+    }
+    return stats;
+  });
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   m.def("set_cublas_switch", phi::SetAllowTF32Cublas);
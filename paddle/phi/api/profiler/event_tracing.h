@@ -92,6 +92,8 @@ class TEST_API RecordEvent {
   TracerEventType type_{TracerEventType::UserDefined};
   std::string* attr_{nullptr};
   bool finished_{false};
+  // token of SamplingProfiler, -1 if the event is not counted
+  int sample_token_{-1};
 };
 
 }  // namespace phi
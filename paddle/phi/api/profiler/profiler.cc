@@ -27,6 +27,7 @@ limitations under the License. */
 #include "paddle/phi/api/profiler/host_event_recorder.h"
 #include "paddle/phi/api/profiler/host_tracer.h"
 #include "paddle/phi/api/profiler/profiler_helper.h"
+#include "paddle/phi/api/profiler/sampling_profiler.h"
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/core/os_info.h"
 #ifdef PADDLE_WITH_CUDA
@@ -108,6 +109,9 @@ RecordEvent::RecordEvent(const char *name,
   }
 #endif
 #endif
+  if (UNLIKELY(SamplingProfiler::IsEnabled())) {
+    sample_token_ = SamplingProfiler::PushEvent(name, level);
+  }
   if (UNLIKELY(HostTraceLevel::GetInstance().NeedTrace(level) == false)) {
     return;
   }
@@ -142,6 +146,9 @@ RecordEvent::RecordEvent(const std::string &name,
   }
 #endif
 #endif
+  if (UNLIKELY(SamplingProfiler::IsEnabled())) {
+    sample_token_ = SamplingProfiler::PushEvent(name, level);
+  }
   if (UNLIKELY(HostTraceLevel::GetInstance().NeedTrace(level) == false)) {
     return;
   }
@@ -176,6 +183,9 @@ RecordEvent::RecordEvent(const std::string &name,
 #endif
 #endif
 
+  if (UNLIKELY(SamplingProfiler::IsEnabled())) {
+    sample_token_ = SamplingProfiler::PushEvent(name, level);
+  }
   if (UNLIKELY(HostTraceLevel::GetInstance().NeedTrace(level) == false)) {
     return;
   }
@@ -224,6 +234,10 @@ void RecordEvent::End() {
   }
 #endif
 #endif
+  if (UNLIKELY(sample_token_ != SamplingProfiler::kNoToken)) {
+    SamplingProfiler::PopEvent(sample_token_);
+    sample_token_ = SamplingProfiler::kNoToken;
+  }
   if (LIKELY(FLAGS_enable_host_event_recorder_hook && is_enabled_)) {
     uint64_t end_ns = PosixInNsec();
     if (LIKELY(shallow_copy_name_ != nullptr)) {
@@ -0,0 +1,324 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/api/profiler/sampling_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+
+#include "paddle/phi/core/os_info.h"
+
+namespace phi {
+
+std::atomic<bool> SamplingProfiler::enabled_{false};
+
+namespace {
+
+struct SampledEvent {
+  // frames[depth - 1] is the event itself, the others are its parents
+  const char* frames[SamplingProfiler::kMaxDepth];
+  int depth = 0;
+  uint64_t self_ns = 0;
+  uint64_t total_ns = 0;
+};
+
+// Ring buffer of the sampled events of a thread. The lock is only taken
+// for sampled events, and is contended only while aggregating.
+class SampleBuffer {
+ public:
+  explicit SampleBuffer(size_t capacity)
+      : events_(std::max<size_t>(capacity, 1)) {}
+
+  size_t Capacity() const { return events_.size(); }
+
+  void Add(const SampledEvent& event) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    events_[num_added_ % events_.size()] = event;
+    ++num_added_;
+  }
+
+  template <typename Fn>
+  void ForEach(Fn&& fn) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    size_t num_events = std::min<size_t>(num_added_, events_.size());
+    for (size_t i = 0; i < num_events; ++i) {
+      fn(events_[i]);
+    }
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    num_added_ = 0;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<SampledEvent> events_;
+  uint64_t num_added_ = 0;
+};
+
+struct SamplerRegistry {
+  std::atomic<uint32_t> sample_rate{100};
+  std::atomic<uint32_t> max_level{2};
+  std::atomic<size_t> buffer_size{8192};
+
+  std::mutex mutex;
+  std::vector<std::shared_ptr<SampleBuffer>> buffers;
+  // buffers released by the exited threads, reused by the new ones
+  std::vector<std::shared_ptr<SampleBuffer>> free_buffers;
+  // storage of the event names passed as std::string, never cleared since
+  // the events being sampled may point to them
+  std::unordered_set<std::string> names;
+};
+
+SamplerRegistry& Registry() {
+  // never destroyed, threads may exit during static destruction
+  static SamplerRegistry* registry = new SamplerRegistry();
+  return *registry;
+}
+
+const char* InternName(const std::string& name) {
+  SamplerRegistry& registry = Registry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  auto iter = registry.names.find(name);
+  if (iter != registry.names.end()) {
+    return iter->c_str();
+  }
+  if (registry.names.size() >= SamplingProfiler::kMaxNames) {
+    return "<other>";
+  }
+  return registry.names.insert(name).first->c_str();
+}
+
+class ThreadSampler {
+ public:
+  struct Frame {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t child_ns;
+  };
+
+  ~ThreadSampler() {
+    if (buffer_ != nullptr) {
+      SamplerRegistry& registry = Registry();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      registry.free_buffers.emplace_back(std::move(buffer_));
+    }
+  }
+
+  SampleBuffer* Buffer() {
+    if (buffer_ == nullptr) {
+      SamplerRegistry& registry = Registry();
+      std::lock_guard<std::mutex> guard(registry.mutex);
+      size_t capacity = std::max<size_t>(registry.buffer_size.load(), 1);
+      // the free buffers of another size are not reused, so that the size
+      // set by Enable applies to the new threads, their samples are kept
+      auto& free_buffers = registry.free_buffers;
+      free_buffers.erase(
+          std::remove_if(free_buffers.begin(),
+                         free_buffers.end(),
+                         [capacity](const std::shared_ptr<SampleBuffer>& b) {
+                           return b->Capacity() != capacity;
+                         }),
+          free_buffers.end());
+      if (!free_buffers.empty()) {
+        buffer_ = std::move(free_buffers.back());
+        free_buffers.pop_back();
+      } else {
+        buffer_ = std::make_shared<SampleBuffer>(capacity);
+        registry.buffers.push_back(buffer_);
+      }
+    }
+    return buffer_.get();
+  }
+
+  // nesting depth of the counted events
+  int depth = 0;
+  // whether the current tree is sampled
+  bool sampling = false;
+  uint64_t num_trees = 0;
+  int num_frames = 0;
+  Frame frames[SamplingProfiler::kMaxDepth];
+
+ private:
+  std::shared_ptr<SampleBuffer> buffer_;
+};
+
+ThreadSampler& CurrentSampler() {
+  thread_local ThreadSampler sampler;
+  return sampler;
+}
+
+template <typename NameFn>
+int Push(NameFn&& name_fn, uint32_t level) {
+  SamplerRegistry& registry = Registry();
+  if (level > registry.max_level.load(std::memory_order_relaxed)) {
+    return SamplingProfiler::kNoToken;
+  }
+  ThreadSampler& sampler = CurrentSampler();
+  if (sampler.depth++ == 0) {
+    uint32_t sample_rate = registry.sample_rate.load(std::memory_order_relaxed);
+    sampler.sampling = ++sampler.num_trees % sample_rate == 0;
+  }
+  if (!sampler.sampling || sampler.num_frames >= SamplingProfiler::kMaxDepth) {
+    // counted for the nesting only
+    return 0;
+  }
+  auto& frame = sampler.frames[sampler.num_frames++];
+  frame.name = name_fn();
+  frame.start_ns = PosixInNsec();
+  frame.child_ns = 0;
+  return sampler.num_frames;
+}
+
+// The frames are separated by ';' in collapsed stacks
+std::string FrameName(const char* name) {
+  std::string frame(name);
+  std::replace(frame.begin(), frame.end(), ';', ',');
+  return frame;
+}
+
+template <typename Fn>
+void ForEachSample(Fn&& fn) {
+  std::vector<std::shared_ptr<SampleBuffer>> buffers;
+  {
+    SamplerRegistry& registry = Registry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    buffers = registry.buffers;
+  }
+  for (auto& buffer : buffers) {
+    buffer->ForEach(fn);
+  }
+}
+
+double Percentile(const std::vector<uint64_t>& sorted_ns, double percent) {
+  size_t rank = static_cast<size_t>(
+      std::ceil(percent / 100.0 * static_cast<double>(sorted_ns.size())));
+  return sorted_ns[std::max<size_t>(rank, 1) - 1] / 1000.0;
+}
+
+}  // namespace
+
+void SamplingProfiler::Enable(const SamplingProfilerOptions& options) {
+  SamplerRegistry& registry = Registry();
+  registry.sample_rate = std::max<uint32_t>(options.sample_rate, 1);
+  registry.max_level = options.max_level;
+  registry.buffer_size = options.buffer_size;
+  enabled_ = true;
+}
+
+void SamplingProfiler::Disable() { enabled_ = false; }
+
+int SamplingProfiler::PushEvent(const char* name, uint32_t level) {
+  return Push([name]() { return name; }, level);
+}
+
+int SamplingProfiler::PushEvent(const std::string& name, uint32_t level) {
+  return Push([&name]() { return InternName(name); }, level);
+}
+
+void SamplingProfiler::PopEvent(int token) {
+  if (token == kNoToken) {
+    return;
+  }
+  ThreadSampler& sampler = CurrentSampler();
+  if (sampler.depth > 0) {
+    --sampler.depth;
+  }
+  // the frames above token are dropped if the events do not end in order
+  if (token > 0 && token <= sampler.num_frames) {
+    uint64_t end_ns = PosixInNsec();
+    auto& frame = sampler.frames[token - 1];
+    SampledEvent event;
+    event.depth = token;
+    for (int i = 0; i < token; ++i) {
+      event.frames[i] = sampler.frames[i].name;
+    }
+    event.total_ns = end_ns - frame.start_ns;
+    event.self_ns =
+        event.total_ns > frame.child_ns ? event.total_ns - frame.child_ns : 0;
+    if (token > 1) {
+      sampler.frames[token - 2].child_ns += event.total_ns;
+    }
+    sampler.num_frames = token - 1;
+    sampler.Buffer()->Add(event);
+  }
+  if (sampler.depth == 0) {
+    sampler.sampling = false;
+    sampler.num_frames = 0;
+  }
+}
+
+std::string SamplingProfiler::CollapsedStacks() {
+  std::map<std::string, uint64_t> self_ns;
+  ForEachSample([&self_ns](const SampledEvent& event) {
+    std::string stack = FrameName(event.frames[0]);
+    for (int i = 1; i < event.depth; ++i) {
+      stack += ";" + FrameName(event.frames[i]);
+    }
+    self_ns[stack] += event.self_ns;
+  });
+  std::ostringstream os;
+  for (const auto& [stack, ns] : self_ns) {
+    if (ns >= 1000) {
+      os << stack << " " << ns / 1000 << "\n";
+    }
+  }
+  return os.str();
+}
+
+std::vector<OpLatencyStats> SamplingProfiler::LatencyStats() {
+  std::map<std::string, std::vector<uint64_t>> latencies;
+  ForEachSample([&latencies](const SampledEvent& event) {
+    latencies[event.frames[event.depth - 1]].push_back(event.total_ns);
+  });
+  std::vector<OpLatencyStats> stats;
+  stats.reserve(latencies.size());
+  for (auto& [name, total_ns] : latencies) {
+    std::sort(total_ns.begin(), total_ns.end());
+    OpLatencyStats stat;
+    stat.name = name;
+    stat.count = total_ns.size();
+    for (uint64_t ns : total_ns) {
+      stat.total_us += ns / 1000.0;
+    }
+    stat.p50_us = Percentile(total_ns, 50);
+    stat.p90_us = Percentile(total_ns, 90);
+    stat.p99_us = Percentile(total_ns, 99);
+    stat.max_us = total_ns.back() / 1000.0;
+    stats.emplace_back(std::move(stat));
+  }
+  std::sort(stats.begin(),
+            stats.end(),
+            [](const OpLatencyStats& lhs, const OpLatencyStats& rhs) {
+              return lhs.total_us > rhs.total_us;
+            });
+  return stats;
+}
+
+void SamplingProfiler::Clear() {
+  SamplerRegistry& registry = Registry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  for (auto& buffer : registry.buffers) {
+    buffer->Clear();
+  }
+}
+
+}  // namespace phi
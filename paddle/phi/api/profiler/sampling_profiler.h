@@ -0,0 +1,87 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "paddle/utils/test_macros.h"
+
+namespace phi {
+
+struct SamplingProfilerOptions {
+  // Record one of every sample_rate top-level RecordEvent trees, with all
+  // the events nested in it.
+  uint32_t sample_rate = 100;
+  // Events with a larger level are neither recorded nor counted.
+  uint32_t max_level = 2;
+  // Number of sampled events kept by each thread, the oldest ones are
+  // overwritten. It applies to the threads which start sampling after it
+  // is set.
+  size_t buffer_size = 8192;
+};
+
+struct OpLatencyStats {
+  std::string name;
+  uint64_t count = 0;
+  double total_us = 0;
+  double p50_us = 0;
+  double p90_us = 0;
+  double p99_us = 0;
+  double max_us = 0;
+};
+
+// SamplingProfiler is a light-weight alternative to the host tracer which
+// can be left on in production. Instead of recording every event, it
+// samples whole trees of nested RecordEvents, e.g. an op with its kernels,
+// and keeps them in fixed-size per-thread ring buffers, so the memory is
+// bounded by the number of threads. The samples are aggregated into
+// collapsed stacks for flame graphs and latency percentiles per event name.
+class TEST_API SamplingProfiler {
+ public:
+  static constexpr int kMaxDepth = 16;
+  static constexpr int kNoToken = -1;
+  // At most kMaxNames distinct event names passed as std::string are kept,
+  // the events with other names are recorded as "<other>".
+  static constexpr size_t kMaxNames = 16384;
+
+  static void Enable(const SamplingProfilerOptions& options);
+  static void Disable();
+  static bool IsEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  // Called by RecordEvent on construction. The returned token must be passed
+  // to PopEvent when the event ends, unless it is kNoToken.
+  static int PushEvent(const char* name, uint32_t level);
+  static int PushEvent(const std::string& name, uint32_t level);
+  static void PopEvent(int token);
+
+  // One line per stack, "outer;inner;innermost self_time_us", which can be
+  // passed to flamegraph.pl directly.
+  static std::string CollapsedStacks();
+  // Latencies of the sampled events grouped by name, ordered by the total
+  // time in descending order.
+  static std::vector<OpLatencyStats> LatencyStats();
+  // Drop all the samples.
+  static void Clear();
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+}  // namespace phi
@@ -24,6 +24,8 @@
 #include <gloo/scatter.h>
 #include <gloo/types.h>
 
+#include <cstring>
+
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/distributed/check/static_check.h"
@@ -32,6 +34,17 @@
 namespace phi {
 namespace distributed {
 
+namespace {
+
+// Takes the reduce function that SetReduceFunc picks for a data type.
+struct ReduceFunction {
+  using Func = void (*)(void*, const void*, const void*, size_t);
+  void setReduceFunction(Func func) { this->func = func; }
+  Func func = nullptr;
+};
+
+}  // namespace
+
 GlooCommContext::GlooCommContext(
     int rank,
     int size,
@@ -136,6 +149,150 @@ void GlooCommContext::Scatter(phi::DenseTensor* out_tensor,
   gloo::scatter(opts);
 }
 
+void GlooCommContext::AllToAll(phi::DenseTensor* out_tensor,
+                               const phi::DenseTensor& in_tensor,
+                               const std::vector<int64_t>& out_numel_each_rank,
+                               const std::vector<int64_t>& in_numel_each_rank,
+                               uint32_t tag) {
+  // gloo only uses CPU now
+  CommStaticCheck::CheckShape(*out_tensor,
+                              in_tensor,
+                              /*dst_rank*/ rank_,
+                              /*cur_rank*/ rank_,
+                              size_,
+                              /*out_size_factor*/ 0,
+                              /*in_size_factor*/ 0,
+                              phi::AllocationType::CPU);
+  PADDLE_ENFORCE_EQ(
+      out_numel_each_rank.size() == static_cast<size_t>(size_) &&
+          in_numel_each_rank.size() == static_cast<size_t>(size_),
+      true,
+      phi::errors::InvalidArgument(
+          "The length of size_each_rank of all_to_all must be equal to "
+          "world_size %d.",
+          size_));
+
+  // Byte offsets of the parts of each rank.
+  const size_t elem_size = phi::SizeOf(in_tensor.dtype());
+  std::vector<size_t> in_offsets(size_ + 1, 0);
+  std::vector<size_t> out_offsets(size_ + 1, 0);
+  for (int i = 0; i < size_; i++) {
+    in_offsets[i + 1] = in_offsets[i] + in_numel_each_rank[i] * elem_size;
+    out_offsets[i + 1] = out_offsets[i] + out_numel_each_rank[i] * elem_size;
+  }
+  PADDLE_ENFORCE_EQ(
+      in_offsets[size_] <= in_tensor.numel() * elem_size &&
+          out_offsets[size_] <= out_tensor->numel() * elem_size,
+      true,
+      phi::errors::InvalidArgument(
+          "The sum of size_each_rank of all_to_all exceeds the numel of the "
+          "tensor."));
+  PADDLE_ENFORCE_EQ(
+      in_numel_each_rank[rank_],
+      out_numel_each_rank[rank_],
+      phi::errors::InvalidArgument(
+          "The numel sent to and received from rank %d itself must be equal, "
+          "but got %d and %d.",
+          rank_,
+          in_numel_each_rank[rank_],
+          out_numel_each_rank[rank_]));
+
+  // gloo only support mutable data input
+  char* in_data = static_cast<char*>(const_cast<void*>(in_tensor.data()));
+  char* out_data = static_cast<char*>(out_tensor->data());
+  if (in_offsets[rank_ + 1] > in_offsets[rank_]) {
+    std::memcpy(out_data + out_offsets[rank_],
+                in_data + in_offsets[rank_],
+                in_offsets[rank_ + 1] - in_offsets[rank_]);
+  }
+  if (size_ == 1) {
+    return;
+  }
+
+  // Post all receives before the sends, pairing rank + i with rank - i so
+  // that no peer is waited on by everybody at the same step.
+  auto in = gloo_context_->createUnboundBuffer(in_data, in_offsets[size_]);
+  auto out = gloo_context_->createUnboundBuffer(out_data, out_offsets[size_]);
+  const auto slot = gloo::Slot::build(kAllToAllSlotPrefix, tag);
+  int send_num = 0;
+  int recv_num = 0;
+  for (int i = 1; i < size_; i++) {
+    int src = (rank_ - i + size_) % size_;
+    size_t recv_bytes = out_offsets[src + 1] - out_offsets[src];
+    if (recv_bytes > 0) {
+      out->recv(src, slot, out_offsets[src], recv_bytes);
+      recv_num++;
+    }
+  }
+  for (int i = 1; i < size_; i++) {
+    int dst = (rank_ + i) % size_;
+    size_t send_bytes = in_offsets[dst + 1] - in_offsets[dst];
+    if (send_bytes > 0) {
+      in->send(dst, slot, in_offsets[dst], send_bytes);
+      send_num++;
+    }
+  }
+  const auto timeout = gloo_context_->getTimeout();
+  for (int i = 0; i < send_num; i++) {
+    in->waitSend(timeout);
+  }
+  for (int i = 0; i < recv_num; i++) {
+    out->waitRecv(timeout);
+  }
+}
+
+void GlooCommContext::ReduceScatter(phi::DenseTensor* out_tensor,
+                                    const phi::DenseTensor& in_tensor,
+                                    int reduce_type,
+                                    uint32_t tag) {
+  // gloo only uses CPU now
+  CommStaticCheck::ScatterLikeShape(*out_tensor,
+                                    in_tensor,
+                                    /*dst_rank*/ rank_,
+                                    /*cur_rank*/ rank_,
+                                    size_,
+                                    phi::AllocationType::CPU);
+  const auto& dtype = in_tensor.dtype();
+  const size_t chunk_numel = out_tensor->numel();
+  const size_t chunk_bytes = chunk_numel * phi::SizeOf(dtype);
+  const char* in_data = static_cast<const char*>(in_tensor.data());
+  char* out_data = static_cast<char*>(out_tensor->data());
+  if (size_ == 1 || chunk_bytes == 0) {
+    std::memcpy(out_data, in_data, chunk_bytes);
+    return;
+  }
+
+  ReduceFunction reduce_func;
+  GENERATE_FUNC(dtype, SetReduceFunc, &reduce_func, reduce_type);
+
+  // Ring reduce-scatter: at step s, every rank sends its partial sum of
+  // chunk rank - s - 1 to the next rank, and adds the partial sum of chunk
+  // rank - s - 2 received from the previous rank to its own. After size - 1
+  // steps chunk rank holds the contributions of all ranks. Each rank sends
+  // (size - 1) / size of the input, where allreduce would send twice that.
+  std::vector<char> work(in_data, in_data + chunk_bytes * size_);
+  std::vector<char> recv(chunk_bytes);
+  auto work_buffer =
+      gloo_context_->createUnboundBuffer(work.data(), work.size());
+  auto recv_buffer =
+      gloo_context_->createUnboundBuffer(recv.data(), recv.size());
+  const auto slot = gloo::Slot::build(kReduceScatterSlotPrefix, tag);
+  const auto timeout = gloo_context_->getTimeout();
+  const int next = (rank_ + 1) % size_;
+  const int prev = (rank_ - 1 + size_) % size_;
+  for (int step = 0; step < size_ - 1; step++) {
+    int send_chunk = (rank_ - step - 1 + 2 * size_) % size_;
+    int recv_chunk = (rank_ - step - 2 + 2 * size_) % size_;
+    recv_buffer->recv(prev, slot);
+    work_buffer->send(next, slot, send_chunk * chunk_bytes, chunk_bytes);
+    recv_buffer->waitRecv(timeout);
+    work_buffer->waitSend(timeout);
+    char* chunk = work.data() + recv_chunk * chunk_bytes;
+    reduce_func.func(chunk, chunk, recv.data(), chunk_numel);
+  }
+  std::memcpy(out_data, work.data() + rank_ * chunk_bytes, chunk_bytes);
+}
+
 void GlooCommContext::Barrier() {
   gloo::BarrierOptions opts(gloo_context_);
   gloo::barrier(opts);
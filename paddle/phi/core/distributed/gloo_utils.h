@@ -159,6 +159,8 @@ void SetReduceFunc(P* opts, int reduce_type) {
 std::shared_ptr<gloo::transport::Device> CreateGlooDevice();
 
 constexpr uint8_t kSendRecvSlotPrefix = 0x08;
+constexpr uint8_t kAllToAllSlotPrefix = 0x09;
+constexpr uint8_t kReduceScatterSlotPrefix = 0x0A;
 
 class SendRecvOptions {
  public:
@@ -14,6 +14,10 @@
 
 #include "paddle/phi/core/kernel_factory.h"
 
+#include <array>
+#include <deque>
+#include <mutex>
+
 #include "glog/logging.h"
 #include "paddle/common/flags.h"
 #include "paddle/phi/core/enforce.h"
@@ -60,6 +64,73 @@ KernelFactory& KernelFactory::Instance() {
   return g_op_kernel_factory;
 }
 
+namespace {
+
+struct KernelNameRegistry {
+  std::mutex mutex;
+  std::unordered_map<std::string, KernelNameId> ids;
+  // A deque never moves its elements, so the names handed out stay valid.
+  std::deque<std::string> names;
+};
+
+KernelNameRegistry& GetKernelNameRegistry() {
+  static KernelNameRegistry registry;
+  return registry;
+}
+
+// A direct mapped cache of kernel selections, one per thread so that the
+// lookup needs no lock. An entry is only valid for the kernels_version_ it
+// was filled at, because registering kernels may rehash the maps the cached
+// kernel pointers point into.
+struct KernelSelectionCacheEntry {
+  uint64_t key{0};
+  uint64_t version{0};
+  const Kernel* kernel{nullptr};
+  bool has_fallback_cpu{false};
+  bool is_stride_kernel{false};
+};
+
+constexpr int kKernelSelectionCacheBits = 9;
+constexpr size_t kKernelSelectionCacheSize = 1UL << kKernelSelectionCacheBits;
+
+// Bits 0-19 of the key are the KernelKey hash, bits 20-22 the flags the
+// selection depends on and bits 32-63 the kernel name id.
+uint64_t KernelSelectionCacheKey(KernelNameId kernel_name_id,
+                                 const KernelKey& kernel_key,
+                                 bool use_strided_kernel) {
+  uint64_t flags = (FLAGS_use_stride_kernel && use_strided_kernel ? 1 : 0) |
+                   (FLAGS_enable_api_kernel_fallback ? 2 : 0) |
+                   (FLAGS_run_kp_kernel ? 4 : 0);
+  return (static_cast<uint64_t>(kernel_name_id) << 32) | (flags << 20) |
+         kernel_key.hash_value();
+}
+
+}  // namespace
+
+KernelNameId KernelFactory::InternKernelName(const std::string& kernel_name) {
+  auto& registry = GetKernelNameRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  auto iter = registry.ids.find(kernel_name);
+  if (iter != registry.ids.end()) {
+    return iter->second;
+  }
+  auto id = static_cast<KernelNameId>(registry.names.size());
+  registry.names.push_back(kernel_name);
+  registry.ids.emplace(kernel_name, id);
+  return id;
+}
+
+const std::string& KernelFactory::GetKernelName(KernelNameId kernel_name_id) {
+  auto& registry = GetKernelNameRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  PADDLE_ENFORCE_LT(
+      kernel_name_id,
+      registry.names.size(),
+      phi::errors::InvalidArgument("The kernel name id %d is not interned.",
+                                   kernel_name_id));
+  return registry.names[kernel_name_id];
+}
+
 bool KernelFactory::HasCompatiblePhiKernel(const std::string& op_type) const {
   if (deprecated_op_names.find(op_type) == deprecated_op_names.end()) {
     if (phi::OpUtilsMap::Instance().Contains(op_type) ||
@@ -342,6 +413,34 @@ KernelResult KernelFactory::SelectKernelOrThrowError(
   return {kernel_iter->second, false, false};
 }
 
+KernelResult KernelFactory::SelectKernelOrThrowError(
+    KernelNameId kernel_name_id,
+    const KernelKey& kernel_key,
+    bool use_strided_kernel) const {
+  thread_local std::array<KernelSelectionCacheEntry, kKernelSelectionCacheSize>
+      cache;
+  uint64_t key =
+      KernelSelectionCacheKey(kernel_name_id, kernel_key, use_strided_kernel);
+  // Fibonacci hashing, the top bits of the product depend on all bits of key.
+  size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >>
+                                    (64 - kKernelSelectionCacheBits));
+  auto& entry = cache[slot];
+  uint64_t version = kernels_version_.load(std::memory_order_acquire);
+  if (entry.kernel != nullptr && entry.key == key &&
+      entry.version == version) {
+    return {*entry.kernel, entry.has_fallback_cpu, entry.is_stride_kernel};
+  }
+
+  auto result = SelectKernelOrThrowError(
+      GetKernelName(kernel_name_id), kernel_key, use_strided_kernel);
+  entry.key = key;
+  entry.version = version;
+  entry.kernel = &result.kernel;
+  entry.has_fallback_cpu = result.has_fallback_cpu;
+  entry.is_stride_kernel = result.is_stride_kernel;
+  return result;
+}
+
 const KernelArgsDef& KernelFactory::GetFirstKernelArgsDef(
     const std::string& kernel_name) const {
   auto iter = kernels_.find(kernel_name);
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <ostream>
 #include <unordered_map>
@@ -296,6 +297,14 @@ using KernelKeyMap = paddle::flat_hash_map<KernelKey, Kernel, KernelKey::Hash>;
 
 using KernelNameMap = paddle::flat_hash_map<std::string, KernelKeyMap>;
 
+/**
+ * Note: A kernel name interned by KernelFactory::InternKernelName. Callers
+ *       that select the same kernel repeatedly, such as the generated API
+ *       functions, intern the name once and select by id, which is served
+ *       from a per-thread cache without hashing the name string.
+ */
+using KernelNameId = uint32_t;
+
 struct KernelResult {
   KernelResult(const Kernel& kernel, bool fallback_cpu, bool is_stride_kernel)
       : kernel(kernel),
@@ -317,7 +326,18 @@ class KernelFactory {
  public:
   static KernelFactory& Instance();
 
-  KernelNameMap& kernels() { return kernels_; }
+  // NOTE: The returned map may be modified by the caller, so every call
+  // invalidates the kernel selection caches of all threads.
+  KernelNameMap& kernels() {
+    kernels_version_.fetch_add(1, std::memory_order_acq_rel);
+    return kernels_;
+  }
+
+  // The same kernel_name always gets the same id, whether or not the kernel
+  // is registered yet. Ids are valid for the lifetime of the process.
+  static KernelNameId InternKernelName(const std::string& kernel_name);
+
+  static const std::string& GetKernelName(KernelNameId kernel_name_id);
 
   bool HasCompatiblePhiKernel(const std::string& op_type) const;
 
@@ -327,6 +347,12 @@ class KernelFactory {
                                         const KernelKey& kernel_key,
                                         bool use_strided_kernel = false) const;
 
+  // Same as above, but repeated selections of the same kernel with the same
+  // key are served from a per-thread cache.
+  KernelResult SelectKernelOrThrowError(KernelNameId kernel_name_id,
+                                        const KernelKey& kernel_key,
+                                        bool use_strided_kernel = false) const;
+
   bool HasKernel(const std::string& kernel_name,
                  const KernelKey& kernel_key) const;
 
@@ -353,6 +379,10 @@ class KernelFactory {
 
   KernelNameMap kernels_;
 
+  // Bumped on every access that may modify kernels_, a cached selection is
+  // only used if it was made at the current version.
+  std::atomic<uint64_t> kernels_version_{0};
+
   // Get the low precision kernel list of current module.
   std::map<const std::string, OpCount> low_precision_kernels_;
 };
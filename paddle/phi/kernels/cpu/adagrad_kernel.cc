@@ -79,23 +79,24 @@ struct SparseAdagradFunctor<phi::CPUContext, T> {
     auto& merge_rows = grad_merge.rows();
     auto* grad_merge_data = grad_merge.mutable_value()->template data<T>();
 
-    // 2. m += g_m * g_m
-    auto grad_square =
-        SquareSelectedRows<phi::CPUContext, T>(context, grad_merge);
-
-    phi::funcs::SelectedRowsAddToTensor<phi::CPUContext, T> functor;
-    functor(context, grad_square, moment);
-
-    // 3. update parameter
+    // 2. m += g_m * g_m and update parameter, the merged rows are unique
+    // so they are updated in parallel
     auto* lr = learning_rate.data<T>();
     auto* param_data = param->data<T>();
     auto* moment_data = moment->data<T>();
-
-    for (size_t i = 0; i < merge_rows.size(); i++) {
+    int64_t merge_row_count = static_cast<int64_t>(merge_rows.size());
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t i = 0; i < merge_row_count; i++) {
+      const T* grad_row = grad_merge_data + i * grad_width;
+      T* moment_row = moment_data + merge_rows[i] * grad_width;
+      T* param_row = param_data + merge_rows[i] * grad_width;
       for (int64_t j = 0; j < grad_width; j++) {
-        param_data[merge_rows[i] * grad_width + j] -=
-            lr[0] * grad_merge_data[i * grad_width + j] /
-            (std::sqrt(moment_data[merge_rows[i] * grad_width + j]) + epsilon);
+        moment_row[j] += grad_row[j] * grad_row[j];
+        param_row[j] -=
+            lr[0] * grad_row[j] / (std::sqrt(moment_row[j]) + epsilon);
       }
     }
   }
@@ -16,8 +16,13 @@ limitations under the License. */
 
 #include <algorithm>
 #include <map>
+#include <numeric>
 #include <set>
+#include <utility>
 #include <vector>
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
 
 #include "paddle/common/ddim.h"
 #include "paddle/phi/core/mixed_vector.h"
@@ -435,68 +440,190 @@ typename std::enable_if<std::is_integral<T>::value>::type elementwise_add_to(
   }
 }
 
-template <typename T, typename DeviceContext>
-typename std::enable_if<std::is_same<T, phi::dtype::bfloat16>::value>::type
-add_sparse_inputs(const std::vector<const phi::SelectedRows*>& inputs,
-                  const std::unordered_map<int64_t, size_t>& rows_to_id,
-                  int64_t input_width,
-                  const DeviceContext& context,
-                  T* out_data) {
-#ifndef PADDLE_WITH_DNNL
-  auto blas = phi::funcs::GetBlas<DeviceContext, T>(context);
+// Inputs with fewer rows are sorted by comparison, and the radix sort
+// gives each thread at least kRadixSortRowsPerThread rows.
+constexpr size_t kRadixSortMinRows = 1024;
+constexpr size_t kRadixSortRowsPerThread = 16384;
+constexpr int kRadixBits = 8;
+constexpr size_t kRadixBuckets = 1 << kRadixBits;
+// The merged rows are added in parallel above this number of elements.
+constexpr size_t kParallelMergeNumel = 1 << 16;
+
+// Returns the positions of rows in the order of the row ids, keeping the
+// order of the duplicated ones. The row ids are radix sorted a byte per
+// pass over the bits of the largest one, with each pass split among the
+// threads by chunks of rows.
+static void SortRowPositions(const std::vector<int64_t>& rows,
+                             std::vector<size_t>* positions) {
+  size_t num = rows.size();
+  positions->resize(num);
+  std::iota(positions->begin(), positions->end(), 0);
+  if (num < 2) {
+    return;
+  }
+  auto min_max = std::minmax_element(rows.begin(), rows.end());
+  if (num < kRadixSortMinRows || *min_max.first < 0) {
+    std::stable_sort(
+        positions->begin(), positions->end(), [&rows](size_t a, size_t b) {
+          return rows[a] < rows[b];
+        });
+    return;
+  }
+
+  uint64_t max_row = static_cast<uint64_t>(*min_max.second);
+  std::vector<std::pair<uint64_t, size_t>> entries(num);
+  std::vector<std::pair<uint64_t, size_t>> buffer(num);
+  for (size_t i = 0; i < num; ++i) {
+    entries[i] = std::make_pair(static_cast<uint64_t>(rows[i]), i);
+  }
+  int thread_num = 1;
+#ifdef PADDLE_WITH_MKLML
+  thread_num = static_cast<int>(std::max<size_t>(
+      1,
+      std::min<size_t>(omp_get_max_threads(), num / kRadixSortRowsPerThread)));
+#endif
+  size_t chunk = (num + thread_num - 1) / thread_num;
+  std::vector<size_t> counts(thread_num * kRadixBuckets);
+  for (int shift = 0; shift < 64 && (max_row >> shift) > 0;
+       shift += kRadixBits) {
+    std::fill(counts.begin(), counts.end(), 0);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(thread_num)
 #endif
+    for (int t = 0; t < thread_num; ++t) {
+      size_t* count = counts.data() + t * kRadixBuckets;
+      size_t end = std::min(num, (t + 1) * chunk);
+      for (size_t i = t * chunk; i < end; ++i) {
+        ++count[(entries[i].first >> shift) & (kRadixBuckets - 1)];
+      }
+    }
+    // the chunks write to a bucket in order, so the sort is stable
+    size_t offset = 0;
+    for (size_t bucket = 0; bucket < kRadixBuckets; ++bucket) {
+      for (int t = 0; t < thread_num; ++t) {
+        size_t& count = counts[t * kRadixBuckets + bucket];
+        size_t bucket_num = count;
+        count = offset;
+        offset += bucket_num;
+      }
+    }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(thread_num)
+#endif
+    for (int t = 0; t < thread_num; ++t) {
+      size_t* count = counts.data() + t * kRadixBuckets;
+      size_t end = std::min(num, (t + 1) * chunk);
+      for (size_t i = t * chunk; i < end; ++i) {
+        buffer[count[(entries[i].first >> shift) & (kRadixBuckets - 1)]++] =
+            entries[i];
+      }
+    }
+    entries.swap(buffer);
+  }
+  for (size_t i = 0; i < num; ++i) {
+    (*positions)[i] = entries[i].second;
+  }
+}
+
+// Groups the rows of the inputs by row id. The row ids are returned sorted
+// in merge_rows, and the rows merged into merge_rows[i] are
+// row_data[offsets[i]] to row_data[offsets[i + 1] - 1], in the order of the
+// inputs.
+template <typename T>
+void group_sparse_inputs(const std::vector<const phi::SelectedRows*>& inputs,
+                         int64_t input_width,
+                         std::vector<int64_t>* merge_rows,
+                         std::vector<const T*>* row_data,
+                         std::vector<size_t>* offsets) {
+  std::vector<int64_t> input_rows;
+  std::vector<const T*> input_data;
   for (auto* input : inputs) {
     if (input->rows().empty()) {
       continue;
     }
-    auto* input_data = input->value().data<T>();
-    auto& input_rows = input->rows();
+    auto* data = input->value().data<T>();
+    auto& rows = input->rows();
+    for (size_t i = 0; i < rows.size(); ++i) {
+      input_rows.push_back(rows[i]);
+      input_data.push_back(data + i * input_width);
+    }
+  }
+
+  std::vector<size_t> positions;
+  SortRowPositions(input_rows, &positions);
+  merge_rows->clear();
+  offsets->clear();
+  row_data->resize(positions.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    int64_t row = input_rows[positions[i]];
+    if (merge_rows->empty() || merge_rows->back() != row) {
+      merge_rows->push_back(row);
+      offsets->push_back(i);
+    }
+    (*row_data)[i] = input_data[positions[i]];
+  }
+  offsets->push_back(positions.size());
+}
+
+// Each output row is the sum of its own group of input rows, so the output
+// rows are added in parallel without any synchronization.
+template <typename T, typename DeviceContext>
+void add_grouped_inputs(const std::vector<const T*>& row_data,
+                        const std::vector<size_t>& offsets,
+                        int64_t input_width,
+                        const DeviceContext& context,
+                        T* out_data) {
+  auto blas = phi::funcs::GetBlas<DeviceContext, T>(context);
+  size_t width = static_cast<size_t>(input_width);
+  int64_t merged_num = static_cast<int64_t>(offsets.size()) - 1;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(static) \
+    if (row_data.size() * width > kParallelMergeNumel)
+#endif
+  for (int64_t i = 0; i < merged_num; ++i) {
+    T* out_row = out_data + i * input_width;
+    std::copy(row_data[offsets[i]], row_data[offsets[i]] + width, out_row);
+    for (size_t j = offsets[i] + 1; j < offsets[i + 1]; ++j) {
+      elementwise_add_to<T, DeviceContext>(&blas, width, row_data[j], out_row);
+    }
+  }
+}
 
+template <typename T, typename DeviceContext>
+typename std::enable_if<std::is_same<T, phi::dtype::bfloat16>::value>::type
+add_sparse_inputs(const std::vector<const T*>& row_data,
+                  const std::vector<size_t>& offsets,
+                  int64_t input_width,
+                  const DeviceContext& context,
+                  T* out_data) {
 #ifdef PADDLE_WITH_DNNL
-    OneDNNContext onednn_context(context.GetPlace());
-    funcs::OneDNNAXPYHandler<T> axpy_handler(
-        input_width, T(1.f), onednn_context.GetEngine());
-    for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
-      axpy_handler(&input_data[i * input_width],
-                   &out_data[out_i * input_width]);
+  OneDNNContext onednn_context(context.GetPlace());
+  funcs::OneDNNAXPYHandler<T> axpy_handler(
+      input_width, T(1.f), onednn_context.GetEngine());
+  for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+    T* out_row = &out_data[i * input_width];
+    std::copy(
+        row_data[offsets[i]], row_data[offsets[i]] + input_width, out_row);
+    for (size_t j = offsets[i] + 1; j < offsets[i + 1]; ++j) {
+      axpy_handler(row_data[j], out_row);
     }
+  }
 #else
-    for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
-      elementwise_add_to<T, DeviceContext>(&blas,
-                                           static_cast<size_t>(input_width),
-                                           &input_data[i * input_width],
-                                           &out_data[out_i * input_width]);
-    }
+  add_grouped_inputs<T, DeviceContext>(
+      row_data, offsets, input_width, context, out_data);
 #endif
-  }
 }
 
 template <typename T, typename DeviceContext>
 typename std::enable_if<!std::is_same<T, phi::dtype::bfloat16>::value>::type
-add_sparse_inputs(const std::vector<const phi::SelectedRows*>& inputs,
-                  const std::unordered_map<int64_t, size_t>& rows_to_id,
+add_sparse_inputs(const std::vector<const T*>& row_data,
+                  const std::vector<size_t>& offsets,
                   int64_t input_width,
                   const DeviceContext& context,
                   T* out_data) {
   VLOG(4) << "[CPU] add_sparse_inputs <" << typeid(T).name();
-  auto blas = phi::funcs::GetBlas<DeviceContext, T>(context);
-  for (auto* input : inputs) {
-    if (input->rows().empty()) {
-      continue;
-    }
-    auto* input_data = input->value().data<T>();
-    auto& input_rows = input->rows();
-
-    for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
-      elementwise_add_to<T, DeviceContext>(&blas,
-                                           static_cast<size_t>(input_width),
-                                           &input_data[i * input_width],
-                                           &out_data[out_i * input_width]);
-    }
-  }
+  add_grouped_inputs<T, DeviceContext>(
+      row_data, offsets, input_width, context, out_data);
 }
 
 template <typename DeviceContext, typename T>
@@ -540,7 +667,6 @@ struct MergeAddImpl {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     phi::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
     size_t row_num = 0;
     for (auto* input : inputs) {
       if (input->rows().empty()) {
@@ -556,18 +682,23 @@ struct MergeAddImpl {
           input->height(),
           phi::errors::InvalidArgument("All inputs should have same height."));
       row_num += input->rows().size();
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
     }
 
+    std::vector<int64_t> merge_rows;
+    std::vector<const T*> row_data;
+    std::vector<size_t> offsets;
+    group_sparse_inputs<T>(
+        inputs, input_width, &merge_rows, &row_data, &offsets);
+
     out.set_height(input_height);
     DenseTensor* out_tensor = out.mutable_value();
     out_tensor->Resize(common::make_ddim(
-        {static_cast<int64_t>(merged_row_set.size()), input_width}));
+        {static_cast<int64_t>(merge_rows.size()), input_width}));
     auto* out_data = context.template Alloc<T>(out_tensor);
 
-    if (merged_row_set.size() == row_num && !sorted_result) {
+    if (merge_rows.size() == row_num && !sorted_result) {
       // no duplicated ids, just concat the result together
-      std::vector<int64_t> merge_rows;
+      merge_rows.clear();
       merge_rows.reserve(row_num);
       // concat rows
       for (auto* in : inputs) {
@@ -589,25 +720,9 @@ struct MergeAddImpl {
         copied_numel += static_cast<int64_t>(in_numel);
       }
     } else {
-      std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                      merged_row_set.end());
-
-      if (sorted_result) {
-        std::sort(merge_rows.begin(), merge_rows.end());
-      }
-
       out.set_rows(merge_rows);
-
-      phi::funcs::SetConstant<DeviceContext, T> constant_functor;
-      constant_functor(context, out.mutable_value(), static_cast<T>(0.f));
-
-      std::unordered_map<int64_t, size_t> rows_to_id;
-      for (size_t i = 0; i < merge_rows.size(); ++i) {
-        rows_to_id[merge_rows[i]] = i;
-      }
-
       add_sparse_inputs<T, DeviceContext>(
-          inputs, rows_to_id, input_width, context, out_data);
+          row_data, offsets, input_width, context, out_data);
     }
   }
 };
@@ -855,8 +970,6 @@ struct MergeAverage<phi::CPUContext, T> {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     phi::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
-    size_t row_num = 0;
     for (auto* input : inputs) {
       if (input->rows().empty()) {
         continue;
@@ -870,47 +983,26 @@ struct MergeAverage<phi::CPUContext, T> {
           input_height,
           input->height(),
           phi::errors::InvalidArgument("All input should have same height."));
-      row_num += input->rows().size();
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
     }
 
+    std::vector<int64_t> merge_rows;
+    std::vector<const T*> row_data;
+    std::vector<size_t> offsets;
+    group_sparse_inputs<T>(
+        inputs, input_width, &merge_rows, &row_data, &offsets);
+
     out.set_height(input_height);
 
     DenseTensor* out_tensor = out.mutable_value();
     out_tensor->Resize(common::make_ddim(
-        {static_cast<int64_t>(merged_row_set.size()), input_width}));
+        {static_cast<int64_t>(merge_rows.size()), input_width}));
     auto* out_data = context.template Alloc<T>(out_tensor);
 
-    std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                    merged_row_set.end());
-    std::sort(merge_rows.begin(), merge_rows.end());
-
     out.set_rows(merge_rows);
 
-    phi::funcs::SetConstant<phi::CPUContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), static_cast<T>(0.0));
-
-    std::unordered_map<int64_t, size_t> rows_to_id;
-    for (size_t i = 0; i < merge_rows.size(); ++i) {
-      rows_to_id[merge_rows[i]] = i;
-    }
-
-    auto blas = phi::funcs::GetBlas<phi::CPUContext, T>(context);
-    for (auto* input : inputs) {
-      if (input->rows().empty()) {
-        continue;
-      }
-      auto* input_data = input->value().data<T>();
-      auto& input_rows = input->rows();
+    add_grouped_inputs<T, phi::CPUContext>(
+        row_data, offsets, input_width, context, out_data);
 
-      for (size_t i = 0; i < input_rows.size(); i++) {
-        size_t out_i = rows_to_id[input_rows[i]];
-        elementwise_add_to<T>(&blas,
-                              static_cast<size_t>(input_width),
-                              &input_data[i * input_width],
-                              &out_data[out_i * input_width]);
-      }
-    }
     size_t input_width_cast = static_cast<size_t>(input_width);
     T count = static_cast<T>(inputs.size());
     for (size_t i = 0; i < merge_rows.size(); i++) {
@@ -0,0 +1,297 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+
+#include "paddle/common/ddim.h"
+
+namespace phi {
+namespace funcs {
+
+/*
+ * Element wise copy between two views of the same shape on CPU, which is
+ * what ContiguousKernel and StridedCopyKernel do. Strides are counted in
+ * elements. Instead of computing the offsets of every element with div/mod
+ * over all dimensions, the copy is planned once:
+ *
+ *   1. size-1 dims are dropped, dims are ordered by the out stride and
+ *      adjacent dims that are contiguous in both views are merged, e.g. a
+ *      slice of the last dim becomes a single [rows, cols] copy;
+ *   2. the innermost dim is copied with memcpy when it is contiguous in
+ *      both views, or with a strided loop otherwise;
+ *   3. when the input is contiguous along another dim (a transpose), the
+ *      two dims are copied in cache sized tiles so that both the reads and
+ *      the writes touch whole cache lines;
+ *   4. the outer dims are walked with an incremental index, split into
+ *      chunks that run in parallel with OpenMP.
+ */
+class StridedCopyPlan {
+ public:
+  static constexpr int kMaxRank = common::DDim::kMaxRank;
+  // elements in a tile side of the transpose copy
+  static constexpr int64_t kTileSize = 32;
+  // smallest number of elements copied by one parallel task
+  static constexpr int64_t kParallelGrain = 32768;
+
+  StridedCopyPlan(int rank,
+                  const int64_t* dims,
+                  const int64_t* in_strides,
+                  const int64_t* out_strides) {
+    std::array<int, kMaxRank> order;
+    for (int i = 0; i < rank; ++i) {
+      if (dims[i] == 0) {
+        numel_ = 0;
+        return;
+      }
+      numel_ *= dims[i];
+      if (dims[i] == 1) {
+        continue;
+      }
+      // broadcast outputs are written in the original element order
+      serial_ = serial_ || out_strides[i] == 0;
+      order[rank_++] = i;
+    }
+    if (!serial_) {
+      // outer dims first, the out view usually ends up in memory order
+      std::stable_sort(order.begin(), order.begin() + rank_, [&](int a, int b) {
+        return out_strides[a] > out_strides[b];
+      });
+    }
+    int coalesced = 0;
+    for (int i = 0; i < rank_; ++i) {
+      int d = order[i];
+      if (coalesced > 0 && !serial_ &&
+          in_strides_[coalesced - 1] == in_strides[d] * dims[d] &&
+          out_strides_[coalesced - 1] == out_strides[d] * dims[d]) {
+        dims_[coalesced - 1] *= dims[d];
+        in_strides_[coalesced - 1] = in_strides[d];
+        out_strides_[coalesced - 1] = out_strides[d];
+        continue;
+      }
+      dims_[coalesced] = dims[d];
+      in_strides_[coalesced] = in_strides[d];
+      out_strides_[coalesced] = out_strides[d];
+      ++coalesced;
+    }
+    rank_ = coalesced;
+
+    // the tiled copy pays off when the input is contiguous along a dim that
+    // is not the innermost one of the output
+    if (!serial_ && rank_ >= 2 && in_strides_[rank_ - 1] != 1 &&
+        out_strides_[rank_ - 1] == 1 && dims_[rank_ - 1] >= kTileSize) {
+      for (int i = rank_ - 2; i >= 0; --i) {
+        if (in_strides_[i] == 1 && dims_[i] >= kTileSize) {
+          tile_dim_ = i;
+          break;
+        }
+      }
+    }
+  }
+
+  int64_t numel() const { return numel_; }
+  int rank() const { return rank_; }
+  bool tiled() const { return tile_dim_ >= 0; }
+
+  template <typename T>
+  void Run(const T* in, T* out) const {
+    if (numel_ == 0) {
+      return;
+    }
+    if (rank_ == 0) {
+      *out = *in;
+      return;
+    }
+    if (serial_) {
+      RunRows(in, out, 0, numel_ / dims_[rank_ - 1]);
+      return;
+    }
+    if (tiled()) {
+      RunTiled(in, out);
+      return;
+    }
+    int64_t inner = dims_[rank_ - 1];
+    int64_t outer = numel_ / inner;
+    if (rank_ == 1 || inner >= kParallelGrain) {
+      // split the innermost dim instead, there are too few rows
+      int64_t chunk_num = (inner + kParallelGrain - 1) / kParallelGrain;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (chunk_num > 1)
+#endif
+      for (int64_t c = 0; c < chunk_num; ++c) {
+        int64_t begin = c * kParallelGrain;
+        int64_t len = std::min(kParallelGrain, inner - begin);
+        for (int64_t o = 0; o < outer; ++o) {
+          int64_t in_offset = 0, out_offset = 0;
+          Offsets(o, rank_ - 1, &in_offset, &out_offset);
+          CopyRow(in + in_offset + begin * in_strides_[rank_ - 1],
+                  out + out_offset + begin * out_strides_[rank_ - 1],
+                  len);
+        }
+      }
+      return;
+    }
+    int64_t rows_per_chunk = std::max<int64_t>(1, kParallelGrain / inner);
+    int64_t chunk_num = (outer + rows_per_chunk - 1) / rows_per_chunk;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (chunk_num > 1)
+#endif
+    for (int64_t c = 0; c < chunk_num; ++c) {
+      int64_t begin = c * rows_per_chunk;
+      RunRows(in, out, begin, std::min(outer, begin + rows_per_chunk));
+    }
+  }
+
+ private:
+  // offsets of the index-th element of the first outer_rank dims
+  void Offsets(int64_t index,
+               int outer_rank,
+               int64_t* in_offset,
+               int64_t* out_offset) const {
+    for (int i = outer_rank - 1; i >= 0; --i) {
+      int64_t idx = index % dims_[i];
+      index /= dims_[i];
+      *in_offset += idx * in_strides_[i];
+      *out_offset += idx * out_strides_[i];
+    }
+  }
+
+  template <typename T>
+  void CopyRow(const T* in, T* out, int64_t len) const {
+    const int64_t in_stride = in_strides_[rank_ - 1];
+    const int64_t out_stride = out_strides_[rank_ - 1];
+    if (in_stride == 1 && out_stride == 1) {
+      std::memcpy(out, in, len * sizeof(T));
+    } else if (out_stride == 1) {
+      for (int64_t i = 0; i < len; ++i) {
+        out[i] = in[i * in_stride];
+      }
+    } else {
+      for (int64_t i = 0; i < len; ++i) {
+        out[i * out_stride] = in[i * in_stride];
+      }
+    }
+  }
+
+  // copy rows [begin, end) of the innermost dim
+  template <typename T>
+  void RunRows(const T* in, T* out, int64_t begin, int64_t end) const {
+    const int outer_rank = rank_ - 1;
+    const int64_t inner = dims_[outer_rank];
+    std::array<int64_t, kMaxRank> index;
+    int64_t in_offset = 0, out_offset = 0;
+    int64_t tmp = begin;
+    for (int i = outer_rank - 1; i >= 0; --i) {
+      index[i] = tmp % dims_[i];
+      tmp /= dims_[i];
+      in_offset += index[i] * in_strides_[i];
+      out_offset += index[i] * out_strides_[i];
+    }
+    for (int64_t row = begin; row < end; ++row) {
+      CopyRow(in + in_offset, out + out_offset, inner);
+      for (int i = outer_rank - 1; i >= 0; --i) {
+        in_offset += in_strides_[i];
+        out_offset += out_strides_[i];
+        if (++index[i] < dims_[i]) {
+          break;
+        }
+        in_offset -= in_strides_[i] * dims_[i];
+        out_offset -= out_strides_[i] * dims_[i];
+        index[i] = 0;
+      }
+    }
+  }
+
+  // dims_[tile_dim_] is contiguous in the input and the innermost dim is
+  // contiguous in the output, they are copied in kTileSize x kTileSize tiles
+  template <typename T>
+  void RunTiled(const T* in, T* out) const {
+    const int inner_dim = rank_ - 1;
+    const int64_t rows = dims_[tile_dim_];
+    const int64_t cols = dims_[inner_dim];
+    const int64_t out_row_stride = out_strides_[tile_dim_];
+    const int64_t in_col_stride = in_strides_[inner_dim];
+    const int64_t row_tiles = (rows + kTileSize - 1) / kTileSize;
+    const int64_t col_tiles = (cols + kTileSize - 1) / kTileSize;
+    const int64_t tiles_per_slice = row_tiles * col_tiles;
+    const int64_t slices = numel_ / (rows * cols);
+
+    // the other dims, enumerated by the slice index
+    std::array<int64_t, kMaxRank> dims, in_strides, out_strides;
+    int other_rank = 0;
+    for (int i = 0; i < inner_dim; ++i) {
+      if (i != tile_dim_) {
+        dims[other_rank] = dims_[i];
+        in_strides[other_rank] = in_strides_[i];
+        out_strides[other_rank] = out_strides_[i];
+        ++other_rank;
+      }
+    }
+
+    const int64_t total_tiles = slices * tiles_per_slice;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (numel_ > kParallelGrain)
+#endif
+    for (int64_t t = 0; t < total_tiles; ++t) {
+      int64_t slice = t / tiles_per_slice;
+      int64_t row_begin = (t % tiles_per_slice) / col_tiles * kTileSize;
+      int64_t col_begin = (t % col_tiles) * kTileSize;
+      int64_t row_end = std::min(rows, row_begin + kTileSize);
+      int64_t col_end = std::min(cols, col_begin + kTileSize);
+
+      int64_t in_offset = 0, out_offset = 0;
+      for (int i = other_rank - 1; i >= 0; --i) {
+        int64_t idx = slice % dims[i];
+        slice /= dims[i];
+        in_offset += idx * in_strides[i];
+        out_offset += idx * out_strides[i];
+      }
+      // the tile of the input is read column by column from the cache
+      for (int64_t r = row_begin; r < row_end; ++r) {
+        const T* src = in + in_offset + r;
+        T* dst = out + out_offset + r * out_row_stride;
+        for (int64_t c = col_begin; c < col_end; ++c) {
+          dst[c] = src[c * in_col_stride];
+        }
+      }
+    }
+  }
+
+  int rank_{0};
+  int tile_dim_{-1};
+  bool serial_{false};
+  int64_t numel_{1};
+  std::array<int64_t, kMaxRank> dims_;
+  std::array<int64_t, kMaxRank> in_strides_;
+  std::array<int64_t, kMaxRank> out_strides_;
+};
+
+template <typename T>
+void StridedCopy(const T* in,
+                 const common::DDim& in_strides,
+                 T* out,
+                 const common::DDim& out_strides,
+                 const common::DDim& dims) {
+  StridedCopyPlan plan(
+      dims.size(), dims.Get(), in_strides.Get(), out_strides.Get());
+  plan.Run(in, out);
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,199 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/common/scalar.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/selected_rows.h"
+#include "paddle/phi/kernels/funcs/algorithm.h"
+#include "paddle/phi/kernels/funcs/jit/kernels.h"
+#include "paddle/phi/kernels/funcs/selected_rows_functor.h"
+
+namespace phi {
+namespace sr {
+
+// Adam, or AdamW if with_decay, of a dense param with a SelectedRows grad on
+// CPU. The duplicated rows of grad are merged first, then every row of param
+// is updated by the jit kernel in one pass over its moments, with the rows
+// split among the threads. In lazy_mode only the rows in grad are updated,
+// otherwise the others are updated with a zero gradient.
+template <typename T>
+void AdamSparseGradUpdate(const phi::CPUContext& dev_ctx,
+                          const DenseTensor& param,
+                          const SelectedRows& grad,
+                          const DenseTensor& learning_rate,
+                          const DenseTensor& moment1,
+                          const DenseTensor& moment2,
+                          const DenseTensor& beta1_pow,
+                          const DenseTensor& beta2_pow,
+                          const Scalar& beta1,
+                          const Scalar& beta2,
+                          const Scalar& epsilon,
+                          float lr_ratio,
+                          float coeff,
+                          bool with_decay,
+                          bool lazy_mode,
+                          bool use_global_beta_pow,
+                          DenseTensor* param_out,
+                          DenseTensor* moment1_out,
+                          DenseTensor* moment2_out,
+                          DenseTensor* beta1_pow_out,
+                          DenseTensor* beta2_pow_out) {
+  T beta1_ = beta1.to<T>();
+  T beta2_ = beta2.to<T>();
+  T epsilon_ = epsilon.to<T>();
+
+  VLOG(3) << "beta1_pow.numel() : " << beta1_pow.numel();
+  VLOG(3) << "beta2_pow.numel() : " << beta2_pow.numel();
+  VLOG(3) << "param.numel(): " << param.numel();
+
+  PADDLE_ENFORCE_EQ(
+      beta1_pow_out->numel(),
+      1,
+      errors::InvalidArgument("beta1 pow output size should be 1, but received "
+                              "value is:%d.",
+                              beta1_pow_out->numel()));
+
+  PADDLE_ENFORCE_EQ(
+      beta2_pow_out->numel(),
+      1,
+      errors::InvalidArgument("beta2 pow output size should be 1, but received "
+                              "value is:%d.",
+                              beta2_pow_out->numel()));
+
+  if (grad.rows().empty()) {
+    VLOG(3) << "grad row size is 0!!";
+    return;
+  }
+
+  std::vector<int64_t> cpu_rows(grad.rows().begin(), grad.rows().end());
+  bool is_strict_sorted = true;
+  for (size_t i = 1; i < cpu_rows.size(); ++i) {
+    if (cpu_rows[i - 1] >= cpu_rows[i]) {
+      is_strict_sorted = false;
+      break;
+    }
+  }
+
+  phi::SelectedRows tmp_grad_merge;
+  const phi::SelectedRows* grad_merge_ptr = nullptr;
+  if (is_strict_sorted) {
+    grad_merge_ptr = &grad;
+  } else {
+    // merge duplicated rows if any.
+    // The rows of grad_merge have been sorted inside MergeAdd functor
+    phi::funcs::scatter::MergeAdd<phi::CPUContext, T> merge_func;
+    merge_func(dev_ctx, grad, &tmp_grad_merge, true);
+    grad_merge_ptr = &tmp_grad_merge;
+  }
+
+  auto& grad_merge = *grad_merge_ptr;
+  auto& grad_tensor = grad_merge.value();
+  const T* grad_data = grad_tensor.template data<T>();
+  const int64_t* rows = grad_merge.rows().data();
+  int64_t row_count = static_cast<int64_t>(grad_merge.rows().size());
+  int64_t row_numel = grad_tensor.numel() / row_count;
+
+  T beta1_p = beta1_pow.data<T>()[0];
+  T beta2_p = beta2_pow.data<T>()[0];
+  // update beta1 and beta2
+  if (!use_global_beta_pow) {
+    dev_ctx.template Alloc<T>(beta1_pow_out)[0] = beta1_ * beta1_p;
+    dev_ctx.template Alloc<T>(beta2_pow_out)[0] = beta2_ * beta2_p;
+  }
+
+  T old_lr = learning_rate.data<T>()[0];
+  T learning_rate_ = old_lr * (sqrt(1 - beta2_p) / (1 - beta1_p));
+  T eps = epsilon_ * sqrt(1 - beta2_p);
+  T lr_ratio_ = static_cast<T>(lr_ratio);
+  T coeff_ = static_cast<T>(coeff);
+
+  const T* param_ptr = param.data<T>();
+  const T* mom1_ptr = moment1.data<T>();
+  const T* mom2_ptr = moment2.data<T>();
+  T* param_out_ptr = dev_ctx.template Alloc<T>(param_out);
+  T* mom1_out_ptr = dev_ctx.template Alloc<T>(moment1_out);
+  T* mom2_out_ptr = dev_ctx.template Alloc<T>(moment2_out);
+
+  auto adam =
+      phi::jit::KernelFuncs<phi::jit::AdamTuple<T>, phi::CPUPlace>::Cache().At(
+          phi::jit::adam_attr_t(beta1_, beta2_));
+  auto adamw =
+      phi::jit::KernelFuncs<phi::jit::AdamWTuple<T>, phi::CPUPlace>::Cache().At(
+          1);
+  auto update_row = [&](int64_t row, const T* grad_row) {
+    const int64_t offset = row * row_numel;
+    if (with_decay) {
+      adamw(beta1_,
+            beta2_,
+            -learning_rate_,
+            eps,
+            old_lr,
+            lr_ratio_,
+            coeff_,
+            row_numel,
+            grad_row,
+            mom1_ptr + offset,
+            mom2_ptr + offset,
+            param_ptr + offset,
+            mom1_out_ptr + offset,
+            mom2_out_ptr + offset,
+            param_out_ptr + offset);
+    } else {
+      adam(beta1_,
+           beta2_,
+           -learning_rate_,
+           eps,
+           row_numel,
+           grad_row,
+           mom1_ptr + offset,
+           mom2_ptr + offset,
+           param_ptr + offset,
+           mom1_out_ptr + offset,
+           mom2_out_ptr + offset,
+           param_out_ptr + offset);
+    }
+  };
+
+  if (lazy_mode) {
+    VLOG(3) << "run cpu lazy mode";
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t i = 0; i < row_count; ++i) {
+      update_row(rows[i], grad_data + i * row_numel);
+    }
+  } else {
+    std::vector<T> zero_grad(row_numel, static_cast<T>(0));
+    int64_t param_row_count = param.numel() / row_numel;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int64_t i = 0; i < param_row_count; ++i) {
+      int64_t row_idx = phi::funcs::BinarySearch<int64_t>(rows, row_count, i);
+      update_row(i,
+                 row_idx >= 0 ? grad_data + row_idx * row_numel
+                              : zero_grad.data());
+    }
+  }
+}
+
+}  // namespace sr
+}  // namespace phi
@@ -21,8 +21,8 @@
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/tensor_utils.h"
 #include "paddle/phi/kernels/adam_kernel.h"
-#include "paddle/phi/kernels/funcs/adam_functors.h"
 #include "paddle/phi/kernels/selected_rows/adam_kernel.h"
+#include "paddle/phi/kernels/selected_rows/cpu/adam_kernel_impl.h"
 
 namespace phi {
 namespace sr {
@@ -95,40 +95,29 @@ void AdamwDenseParamSparseGradKernel(
     return;
   }
 
-  auto* param_ =
-      master_param.is_initialized() ? master_param.get_ptr() : &param;
-  T coeff_ = static_cast<T>(coeff);
-  T lr_ratio_ = static_cast<T>(lr_ratio);
-  funcs::AdamWFunctor<T, funcs::CPUAdamW> functor(
-      coeff_,
-      lr_ratio_,
-      learning_rate.data<T>(),
-      const_cast<T*>(param_->data<T>()));
-  functor(param_->numel());
-
-  AdamDenseParamSparseGradKernel<T, Context>(dev_ctx,
-                                             param,
-                                             grad,
-                                             learning_rate,
-                                             moment1,
-                                             moment2,
-                                             beta1_pow,
-                                             beta2_pow,
-                                             master_param,
-                                             skip_update,
-                                             beta1,
-                                             beta2,
-                                             epsilon,
-                                             lazy_mode,
-                                             min_row_size_to_use_multithread,
-                                             multi_precision,
-                                             use_global_beta_pow,
-                                             param_out,
-                                             moment1_out,
-                                             moment2_out,
-                                             beta1_pow_out,
-                                             beta2_pow_out,
-                                             master_param_outs);
+  // the decay is fused into the update of each row, so in lazy_mode the
+  // rows without gradient are not decayed
+  AdamSparseGradUpdate<T>(dev_ctx,
+                          param,
+                          grad,
+                          learning_rate,
+                          moment1,
+                          moment2,
+                          beta1_pow,
+                          beta2_pow,
+                          beta1,
+                          beta2,
+                          epsilon,
+                          lr_ratio,
+                          coeff,
+                          true,
+                          lazy_mode,
+                          use_global_beta_pow,
+                          param_out,
+                          moment1_out,
+                          moment2_out,
+                          beta1_pow_out,
+                          beta2_pow_out);
 }
 
 }  // namespace sr
@@ -14,6 +14,7 @@
 #pragma once
 #include "glog/logging.h"
 
+#include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/selected_rows.h"
@@ -24,6 +25,37 @@
 namespace phi {
 namespace sr {
 
+template <typename Context, typename Functor>
+void SparseLambMomentUpdate(const Context& dev_ctx,
+                            const Functor& functor,
+                            int64_t numel) {
+  phi::funcs::ForRange<Context> for_range(dev_ctx, numel);
+  for_range(functor);
+}
+
+// On CPU the rows of param are split among the threads, and the gradient
+// row of each is searched once instead of once per element.
+template <template <typename> class Functor, typename T>
+void SparseLambMomentUpdate(const phi::CPUContext& dev_ctx UNUSED,
+                            const Functor<T>& functor,
+                            int64_t numel) {
+  if (functor.skip_update_ && *functor.skip_update_) return;
+  int64_t row_numel = functor.row_numel_;
+  int64_t param_row_count = numel / row_numel;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t i = 0; i < param_row_count; ++i) {
+    auto row_idx =
+        phi::funcs::BinarySearch<int64_t>(functor.rows_, functor.row_count_, i);
+    for (int64_t j = 0; j < row_numel; ++j) {
+      T g = row_idx >= 0 ? functor.grad_[row_idx * row_numel + j]
+                         : static_cast<T>(0);
+      functor.update(i * row_numel + j, g);
+    }
+  }
+}
+
 template <typename T, typename MT, typename Context, bool IsMultiPrecision>
 void ComputeRowImpl(const Context& dev_ctx,
                     const DenseTensor& param,
@@ -254,7 +286,7 @@ void ComputeRowImpl(const Context& dev_ctx,
         row_numel,
         grad_merge.rows().size(),
         skip_update_flag);
-    for_range(moment_update_functor);
+    SparseLambMomentUpdate(dev_ctx, moment_update_functor, numel);
     T* beta1_pow_out_data = dev_ctx.template HostAlloc<T>(beta1_pow_out);
     beta1_pow_out_data[0] =
         static_cast<T>(beta1) * beta1_pow.template data<T>()[0];
@@ -285,7 +317,7 @@ void ComputeRowImpl(const Context& dev_ctx,
         row_numel,
         grad_merge.rows().size(),
         skip_update_flag);
-    for_range(moment_update_functor);
+    SparseLambMomentUpdate(dev_ctx, moment_update_functor, numel);
   }
   // Same from here
   // Update parameter
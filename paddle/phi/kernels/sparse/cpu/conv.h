@@ -14,7 +14,9 @@ limitations under the License. */
 
 #pragma once
 
-#include <set>
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
 
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/kernel_registry.h"
@@ -30,7 +32,6 @@ using Dims4D = phi::funcs::sparse::Dims4D;
 
 // such as: kernel(3, 3, 3), kernel_size = 27
 // counter_per_weight: (kernel_size)
-// TODO(zhangkaihuo): optimize performance with multithreading
 template <typename T, typename Context, typename IntT = int>
 void ProductRuleBook(const Context& dev_ctx,
                      const SparseCooTensor& x,
@@ -50,8 +51,6 @@ void ProductRuleBook(const Context& dev_ctx,
                          : kernel_sizes[0] * kernel_sizes[1] * kernel_sizes[2];
   memset(counter_per_kernel, 0, kernel_size * sizeof(int));
 
-  int rulebook_len = 0;
-  // calc the rulebook_len
   const auto& x_dims = x.dims();
 
   int xdim0, xdim1, xdim2, xdim3;
@@ -98,8 +97,10 @@ void ProductRuleBook(const Context& dev_ctx,
   const Dims4D c_strides(sdim0, sdim1, sdim2, sdim3);
   const Dims4D c_dilations(ddim0, ddim1, ddim2, ddim3);
 
-  std::set<IntT> hash_in;
+  // coordinates of input points are looked up by hash in subm conv
+  std::unordered_set<IntT> hash_in;
   if (subm) {
+    hash_in.reserve(non_zero_num);
     for (int i = 0; i < non_zero_num; i++) {
       IntT batch = indices_ptr[i];
       IntT in_z = is2D ? 0 : indices_ptr[i + non_zero_num];
@@ -113,75 +114,83 @@ void ProductRuleBook(const Context& dev_ctx,
     }
   }
 
-  auto f_calc_rulebook = [&](IntT* rulebook_ptr) {
-    int kernel_index = 0, rulebook_index = 0;
-    int zceil = is2D ? 1 : kernel_sizes[0];
-    int yceil = is2D ? kernel_sizes[0] : kernel_sizes[1];
-    int xceil = is2D ? kernel_sizes[1] : kernel_sizes[2];
-    for (int kz = 0; kz < zceil; kz++) {
-      for (int ky = 0; ky < yceil; ky++) {
-        for (int kx = 0; kx < xceil; kx++) {
-          ++kernel_index;
-          for (int64_t i = 0; i < non_zero_num; i++) {
-            IntT batch = indices_ptr[i];
-            IntT in_z = is2D ? 0 : indices_ptr[i + non_zero_num];
-            IntT in_y = is2D ? indices_ptr[i + non_zero_num]
-                             : indices_ptr[i + 2 * non_zero_num];
-            IntT in_x = is2D ? indices_ptr[i + 2 * non_zero_num]
-                             : indices_ptr[i + 3 * non_zero_num];
-
-            IntT out_z =
-                is2D ? 0
-                     : (in_z + paddings[0] - kz * dilations[0]) / strides[0];
-            IntT out_y =
-                (in_y + c_paddings[2] - ky * c_dilations[2]) / c_strides[2];
-            IntT out_x =
-                (in_x + c_paddings[3] - kx * c_dilations[3]) / c_strides[3];
-            if (phi::funcs::sparse::Check(c_x_dims,
-                                          c_kernel_dims,
-                                          c_paddings,
-                                          c_dilations,
-                                          c_strides,
-                                          in_x,
-                                          in_y,
-                                          in_z,
-                                          kx,
-                                          ky,
-                                          kz)) {
-              if (subm) {
-                IntT out_index = phi::funcs::sparse::PointToIndex<Dims4D>(
-                    batch, out_x, out_y, out_z, c_out_dims);
-                if (hash_in.find(out_index) == hash_in.end()) {
-                  continue;
-                }
-              }
-
-              if (rulebook_ptr == nullptr) {
-                counter_per_kernel[kernel_index - 1] += 1;
-                ++rulebook_len;
-              } else {
-                rulebook_ptr[rulebook_index] = kernel_index - 1;
-                rulebook_ptr[rulebook_index + rulebook_len] = i;  // in_i
-                rulebook_ptr[rulebook_index + rulebook_len * 2] =
-                    phi::funcs::sparse::PointToIndex<Dims4D>(
-                        batch, out_x, out_y, out_z, c_out_dims);  // out_index
-                ++rulebook_index;
-              }
-            }
-          }
+  int yceil = is2D ? kernel_sizes[0] : kernel_sizes[1];
+  int xceil = is2D ? kernel_sizes[1] : kernel_sizes[2];
+
+  // Every kernel offset is independent, so both passes run in parallel over
+  // kernel offsets. The first pass counts the rules of each offset, the
+  // second one writes them to the offset's own segment of the rulebook,
+  // which keeps the rulebook in the same order as a serial scan.
+  auto f_calc_rulebook = [&](int kernel_index, IntT* rulebook_ptr, int len) {
+    int kz = kernel_index / (yceil * xceil);
+    int ky = kernel_index / xceil % yceil;
+    int kx = kernel_index % xceil;
+    int rulebook_index = 0;
+    for (int64_t i = 0; i < non_zero_num; i++) {
+      IntT batch = indices_ptr[i];
+      IntT in_z = is2D ? 0 : indices_ptr[i + non_zero_num];
+      IntT in_y = is2D ? indices_ptr[i + non_zero_num]
+                       : indices_ptr[i + 2 * non_zero_num];
+      IntT in_x = is2D ? indices_ptr[i + 2 * non_zero_num]
+                       : indices_ptr[i + 3 * non_zero_num];
+
+      IntT out_z =
+          is2D ? 0 : (in_z + paddings[0] - kz * dilations[0]) / strides[0];
+      IntT out_y = (in_y + c_paddings[2] - ky * c_dilations[2]) / c_strides[2];
+      IntT out_x = (in_x + c_paddings[3] - kx * c_dilations[3]) / c_strides[3];
+      if (phi::funcs::sparse::Check(c_x_dims,
+                                    c_kernel_dims,
+                                    c_paddings,
+                                    c_dilations,
+                                    c_strides,
+                                    in_x,
+                                    in_y,
+                                    in_z,
+                                    kx,
+                                    ky,
+                                    kz)) {
+        IntT out_index = phi::funcs::sparse::PointToIndex<Dims4D>(
+            batch, out_x, out_y, out_z, c_out_dims);
+        if (subm && hash_in.find(out_index) == hash_in.end()) {
+          continue;
         }
+        if (rulebook_ptr != nullptr) {
+          rulebook_ptr[rulebook_index] = kernel_index;
+          rulebook_ptr[rulebook_index + len] = i;  // in_i
+          rulebook_ptr[rulebook_index + len * 2] = out_index;
+        }
+        ++rulebook_index;
       }
     }
+    return rulebook_index;
   };
 
-  f_calc_rulebook(nullptr);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int k = 0; k < kernel_size; ++k) {
+    counter_per_kernel[k] = f_calc_rulebook(k, nullptr, 0);
+  }
+  std::vector<int> offsets(kernel_size + 1, 0);
+  for (int k = 0; k < kernel_size; ++k) {
+    offsets[k + 1] = offsets[k] + counter_per_kernel[k];
+  }
+  int rulebook_len = offsets[kernel_size];
+
   // alloc the rulebook
   *rulebook = phi::Empty(dev_ctx,
                          DenseTensorMeta(phi::CppTypeToDataType<IntT>::Type(),
                                          {3, rulebook_len},
                                          DataLayout::NCHW));
   IntT* rulebook_ptr = rulebook->data<IntT>();
-  f_calc_rulebook(rulebook_ptr);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int k = 0; k < kernel_size; ++k) {
+    if (counter_per_kernel[k] > 0) {
+      f_calc_rulebook(k, rulebook_ptr + offsets[k], rulebook_len);
+    }
+  }
 }
 
 template <typename T, typename Context, typename IntT = int>
@@ -194,12 +203,13 @@ void UpdateRulebookAndOutIndex(const Context& dev_ctx,
                                SparseCooTensor* out) {
   const bool is2D = out_dims.size() == 4 ? true : false;
 
-  std::set<IntT> out_indexs;
+  // the out indexs are kept sorted, the same order as the out points
   int n = rulebook->dims()[1];
   IntT* rulebook_ptr = rulebook->data<IntT>();
-  for (int i = 0; i < n; i++) {
-    out_indexs.insert(rulebook_ptr[i + n * 2]);
-  }
+  std::vector<IntT> out_indexs(rulebook_ptr + n * 2, rulebook_ptr + n * 3);
+  std::sort(out_indexs.begin(), out_indexs.end());
+  out_indexs.erase(std::unique(out_indexs.begin(), out_indexs.end()),
+                   out_indexs.end());
 
   int out_non_zero_num = out_indexs.size();
   const int64_t sparse_dim = is2D ? 3 : 4;
@@ -220,8 +230,11 @@ void UpdateRulebookAndOutIndex(const Context& dev_ctx,
   odim3 = is2D ? 1 : out_dims[1];
   const Dims4D c_out_dims(odim0, odim1, odim2, odim3);
 
-  for (auto it = out_indexs.begin(); it != out_indexs.end(); it++, i++) {
-    const IntT index = *it;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (i = 0; i < out_non_zero_num; i++) {
+    const IntT index = out_indexs[i];
     IntT batch, x, y, z;
     phi::funcs::sparse::IndexToPoint<Dims4D>(
         index, c_out_dims, &batch, &x, &y, &z);
@@ -235,18 +248,29 @@ void UpdateRulebookAndOutIndex(const Context& dev_ctx,
       out_indices_ptr[i + out_non_zero_num * 3] = x;
     }
   }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
   for (i = 0; i < n; i++) {
     IntT out_index = rulebook_ptr[i + n * 2];
-    rulebook_ptr[i + n * 2] =
-        std::distance(out_indexs.begin(), out_indexs.find(out_index));
+    rulebook_ptr[i + n * 2] = std::distance(
+        out_indexs.begin(),
+        std::lower_bound(out_indexs.begin(), out_indexs.end(), out_index));
   }
 
   out->SetMember(out_indices, out_values, out_dims, true);
 }
 
+// rows moved by Gather/Scatter below which the serial loop is faster than
+// the parallel one
+constexpr int kParallelGatherScatterRows = 4096;
+
 template <typename T, typename IntT = int>
 void Gather(
     const T* x, const IntT* indexs, const int n, const int channels, T* out) {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (n > kParallelGatherScatterRows)
+#endif
   for (int i = 0; i < n; i++) {
     IntT real_i = indexs[i];
     memcpy(out + i * channels, x + real_i * channels, channels * sizeof(T));
@@ -256,10 +280,46 @@ void Gather(
 template <typename T, typename IntT = int>
 void Scatter(
     const T* x, const IntT* indexs, const int n, const int channels, T* out) {
+  if (n <= kParallelGatherScatterRows) {
+    for (int i = 0; i < n; i++) {
+      IntT real_i = indexs[i];
+      for (int j = 0; j < channels; j++) {
+        out[real_i * channels + j] += x[i * channels + j];
+      }
+    }
+    return;
+  }
+
+  // Several rules may add to the same out row, so the rules are grouped by
+  // out row with a stable counting sort, and each out row is accumulated by
+  // one thread in the rulebook order.
+  IntT out_rows = *std::max_element(indexs, indexs + n) + 1;
+  std::vector<int> row_offsets(out_rows + 1, 0);
   for (int i = 0; i < n; i++) {
-    IntT real_i = indexs[i];
-    for (int j = 0; j < channels; j++) {
-      out[real_i * channels + j] += x[i * channels + j];
+    ++row_offsets[indexs[i] + 1];
+  }
+  for (IntT r = 0; r < out_rows; r++) {
+    row_offsets[r + 1] += row_offsets[r];
+  }
+  std::vector<int> row_rules(n);
+  std::vector<int> row_pos(row_offsets.begin(), row_offsets.end() - 1);
+  for (int i = 0; i < n; i++) {
+    row_rules[row_pos[indexs[i]]++] = i;
+  }
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (IntT r = 0; r < out_rows; r++) {
+    T* out_row = out + static_cast<int64_t>(r) * channels;
+    for (int k = row_offsets[r]; k < row_offsets[r + 1]; k++) {
+      const T* x_row = x + static_cast<int64_t>(row_rules[k]) * channels;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp simd
+#endif
+      for (int j = 0; j < channels; j++) {
+        out_row[j] += x_row[j];
+      }
     }
   }
 }
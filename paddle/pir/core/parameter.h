@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "paddle/pir/core/type.h"
 
 namespace pir {
@@ -29,6 +31,14 @@ class IR_API Parameter {
     type_ = type;
   }
 
+  ///
+  /// \brief Refers to size bytes at data without copying them. The memory is
+  /// kept alive by holder, e.g. a mapped parameter file shared by all the
+  /// parameters in it.
+  ///
+  Parameter(std::shared_ptr<void> holder, void* data, size_t size, Type type)
+      : data_(data), size_(size), type_(type), holder_(std::move(holder)) {}
+
   Parameter(const Parameter& param) {
     data_ = malloc(param.size_);
     memcpy(data_, param.data_, param.size_);
@@ -41,15 +51,20 @@ class IR_API Parameter {
     memcpy(data_, param.data_, param.size_);
     size_ = param.size_;
     type_ = param.type_;
+    holder_.reset();
     return *this;
   }
 
-  ~Parameter() { free(data_); }
+  ~Parameter() {
+    if (!holder_) free(data_);
+  }
 
   Type type() const { return type_; }
 
   void* data() const { return data_; }
 
+  size_t size() const { return size_; }
+
   bool is_mutable() const { return is_mutable_; }
 
   void set_mutable() { is_mutable_ = true; }
@@ -65,6 +80,11 @@ class IR_API Parameter {
   Type type_;
 
   bool is_mutable_ = false;
+
+  ///
+  /// \brief Owner of data_ if data_ is borrowed, nullptr if data_ is malloced.
+  ///
+  std::shared_ptr<void> holder_;
 };
 
 }  // namespace pir
@@ -66,6 +66,7 @@ class IR_API Program {
                     std::shared_ptr<Parameter> parameter);
 
   ParameterMap& parameters() { return parameters_; }
+  const ParameterMap& parameters() const { return parameters_; }
   void set_parameters(const ParameterMap& parameters) {
     parameters_ = parameters;
   }
@@ -0,0 +1,875 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/pir/core/serialize/program_serializer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "paddle/common/enforce.h"
+#include "paddle/pir/core/block.h"
+#include "paddle/pir/core/builtin_attribute.h"
+#include "paddle/pir/core/builtin_type.h"
+#include "paddle/pir/core/operation.h"
+#include "paddle/pir/core/parameter.h"
+#include "paddle/pir/core/region.h"
+
+namespace pir {
+
+namespace {
+
+constexpr char kProgramMagic[4] = {'P', 'I', 'R', 'B'};
+constexpr char kParamsMagic[4] = {'P', 'I', 'R', 'D'};
+constexpr uint32_t kNullIndex = std::numeric_limits<uint32_t>::max();
+// Both the header of the parameter blob and the data of every parameter in
+// it are aligned to kParamsAlignment, so that a mapped blob can be used by
+// vectorized kernels directly.
+constexpr size_t kParamsAlignment = 64;
+
+enum class TypeKind : uint8_t {
+  kText = 0,
+  kBFloat16,
+  kFloat16,
+  kFloat32,
+  kFloat64,
+  kInt8,
+  kUInt8,
+  kInt16,
+  kInt32,
+  kInt64,
+  kIndex,
+  kBool,
+  kComplex64,
+  kComplex128,
+  kVector,
+  kDenseTensor,
+};
+
+enum class AttributeKind : uint8_t {
+  kText = 0,
+  kBool,
+  kFloat,
+  kDouble,
+  kInt32,
+  kIndex,
+  kInt64,
+  kStr,
+  kArray,
+  kType,
+  kTensorName,
+  kComplex64,
+  kComplex128,
+};
+
+class BufferWriter {
+ public:
+  template <typename T>
+  void Write(const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values can be written.");
+    buffer_.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  void WriteString(const std::string &str) {
+    Write<uint32_t>(static_cast<uint32_t>(str.size()));
+    buffer_.append(str);
+  }
+
+  const std::string &buffer() const { return buffer_; }
+
+ private:
+  std::string buffer_;
+};
+
+class BufferReader {
+ public:
+  BufferReader(const char *data, size_t size) : data_(data), size_(size) {}
+
+  template <typename T>
+  T Read() {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values can be read.");
+    IR_ENFORCE(size_ - pos_ >= sizeof(T),
+               "The binary program is truncated at byte %d.",
+               pos_);
+    T value;
+    std::memcpy(&value, data_ + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return value;
+  }
+
+  std::string ReadString() {
+    uint32_t size = Read<uint32_t>();
+    IR_ENFORCE(size_ - pos_ >= size,
+               "The binary program is truncated at byte %d.",
+               pos_);
+    std::string str(data_ + pos_, size);
+    pos_ += size;
+    return str;
+  }
+
+  void ReadBytes(char *dst, size_t size) {
+    IR_ENFORCE(size_ - pos_ >= size,
+               "The binary program is truncated at byte %d.",
+               pos_);
+    std::memcpy(dst, data_ + pos_, size);
+    pos_ += size;
+  }
+
+ private:
+  const char *data_;
+  size_t size_;
+  size_t pos_{0};
+};
+
+// Writes the kind of the builtin types without parameters, returns false if
+// type is not one of them.
+bool WriteBuiltinTypeKind(Type type, BufferWriter *writer) {
+#define SERIALIZE_BUILTIN_TYPE(__name)  \
+  if (type.isa<__name##Type>()) {       \
+    writer->Write(TypeKind::k##__name); \
+    return true;                        \
+  }
+  SERIALIZE_BUILTIN_TYPE(BFloat16)
+  SERIALIZE_BUILTIN_TYPE(Float16)
+  SERIALIZE_BUILTIN_TYPE(Float32)
+  SERIALIZE_BUILTIN_TYPE(Float64)
+  SERIALIZE_BUILTIN_TYPE(Int8)
+  SERIALIZE_BUILTIN_TYPE(UInt8)
+  SERIALIZE_BUILTIN_TYPE(Int16)
+  SERIALIZE_BUILTIN_TYPE(Int32)
+  SERIALIZE_BUILTIN_TYPE(Int64)
+  SERIALIZE_BUILTIN_TYPE(Index)
+  SERIALIZE_BUILTIN_TYPE(Bool)
+  SERIALIZE_BUILTIN_TYPE(Complex64)
+  SERIALIZE_BUILTIN_TYPE(Complex128)
+#undef SERIALIZE_BUILTIN_TYPE
+  return false;
+}
+
+class ProgramWriter {
+ public:
+  void Write(const Program &program, std::ostream &os, std::ostream *params_os);
+
+ private:
+  uint32_t GetStringId(const std::string &str);
+  uint32_t GetTypeId(Type type);
+  uint32_t GetAttributeId(Attribute attr);
+
+  void DefineValue(Value value);
+  uint32_t GetValueId(Value value) const;
+
+  void WriteOperation(const Operation &op);
+  void WriteRegion(const Region &region);
+  void WriteBlock(const Block &block);
+  void WriteParameters(const Program &program, std::ostream *params_os);
+
+  BufferWriter strings_;
+  uint32_t num_strings_{0};
+  std::unordered_map<std::string, uint32_t> string_ids_;
+
+  BufferWriter types_;
+  uint32_t num_types_{0};
+  std::unordered_map<Type, uint32_t> type_ids_;
+
+  BufferWriter attributes_;
+  uint32_t num_attributes_{0};
+  std::unordered_map<Attribute, uint32_t> attribute_ids_;
+
+  std::unordered_map<Value, uint32_t> value_ids_;
+
+  BufferWriter body_;
+  BufferWriter parameters_;
+};
+
+uint32_t ProgramWriter::GetStringId(const std::string &str) {
+  auto iter = string_ids_.find(str);
+  if (iter != string_ids_.end()) {
+    return iter->second;
+  }
+  strings_.WriteString(str);
+  string_ids_.emplace(str, num_strings_);
+  return num_strings_++;
+}
+
+uint32_t ProgramWriter::GetTypeId(Type type) {
+  if (!type) {
+    return kNullIndex;
+  }
+  auto iter = type_ids_.find(type);
+  if (iter != type_ids_.end()) {
+    return iter->second;
+  }
+  // The types a type is built from are added to the table first, so that
+  // every entry only refers to the entries before it.
+  if (type.isa<VectorType>()) {
+    std::vector<uint32_t> element_ids;
+    for (auto element : type.dyn_cast<VectorType>().data()) {
+      element_ids.push_back(GetTypeId(element));
+    }
+    types_.Write(TypeKind::kVector);
+    types_.Write<uint32_t>(static_cast<uint32_t>(element_ids.size()));
+    for (auto id : element_ids) {
+      types_.Write<uint32_t>(id);
+    }
+  } else if (type.isa<DenseTensorType>()) {
+    auto tensor_type = type.dyn_cast<DenseTensorType>();
+    uint32_t dtype_id = GetTypeId(tensor_type.dtype());
+    types_.Write(TypeKind::kDenseTensor);
+    types_.Write<uint32_t>(dtype_id);
+    const auto &dims = tensor_type.dims();
+    types_.Write<int32_t>(dims.size());
+    for (int i = 0; i < dims.size(); ++i) {
+      types_.Write<int64_t>(dims[i]);
+    }
+    types_.Write<int32_t>(static_cast<int32_t>(tensor_type.data_layout()));
+    const auto &lod = tensor_type.lod();
+    types_.Write<uint32_t>(static_cast<uint32_t>(lod.size()));
+    for (const auto &level : lod) {
+      types_.Write<uint32_t>(static_cast<uint32_t>(level.size()));
+      for (auto offset : level) {
+        types_.Write<uint64_t>(offset);
+      }
+    }
+    types_.Write<uint64_t>(tensor_type.offset());
+  } else if (!WriteBuiltinTypeKind(type, &types_)) {
+    // Types of other dialects are stored in the text form of their dialect
+    // and parsed back on load.
+    std::ostringstream text;
+    type.Print(text);
+    uint32_t text_id = GetStringId(text.str());
+    types_.Write(TypeKind::kText);
+    types_.Write<uint32_t>(text_id);
+  }
+  type_ids_.emplace(type, num_types_);
+  return num_types_++;
+}
+
+uint32_t ProgramWriter::GetAttributeId(Attribute attr) {
+  if (!attr) {
+    return kNullIndex;
+  }
+  auto iter = attribute_ids_.find(attr);
+  if (iter != attribute_ids_.end()) {
+    return iter->second;
+  }
+  IR_ENFORCE(!attr.isa<PointerAttribute>(),
+             "PointerAttribute can not be serialized.");
+  if (attr.isa<BoolAttribute>()) {
+    attributes_.Write(AttributeKind::kBool);
+    attributes_.Write<uint8_t>(attr.dyn_cast<BoolAttribute>().data());
+  } else if (attr.isa<FloatAttribute>()) {
+    attributes_.Write(AttributeKind::kFloat);
+    attributes_.Write<float>(attr.dyn_cast<FloatAttribute>().data());
+  } else if (attr.isa<DoubleAttribute>()) {
+    attributes_.Write(AttributeKind::kDouble);
+    attributes_.Write<double>(attr.dyn_cast<DoubleAttribute>().data());
+  } else if (attr.isa<Int32Attribute>()) {
+    attributes_.Write(AttributeKind::kInt32);
+    attributes_.Write<int32_t>(attr.dyn_cast<Int32Attribute>().data());
+  } else if (attr.isa<IndexAttribute>()) {
+    attributes_.Write(AttributeKind::kIndex);
+    attributes_.Write<int64_t>(attr.dyn_cast<IndexAttribute>().data());
+  } else if (attr.isa<Int64Attribute>()) {
+    attributes_.Write(AttributeKind::kInt64);
+    attributes_.Write<int64_t>(attr.dyn_cast<Int64Attribute>().data());
+  } else if (attr.isa<StrAttribute>()) {
+    uint32_t str_id = GetStringId(attr.dyn_cast<StrAttribute>().AsString());
+    attributes_.Write(AttributeKind::kStr);
+    attributes_.Write<uint32_t>(str_id);
+  } else if (attr.isa<TensorNameAttribute>()) {
+    uint32_t str_id = GetStringId(attr.dyn_cast<TensorNameAttribute>().data());
+    attributes_.Write(AttributeKind::kTensorName);
+    attributes_.Write<uint32_t>(str_id);
+  } else if (attr.isa<TypeAttribute>()) {
+    uint32_t type_id = GetTypeId(attr.dyn_cast<TypeAttribute>().data());
+    attributes_.Write(AttributeKind::kType);
+    attributes_.Write<uint32_t>(type_id);
+  } else if (attr.isa<ArrayAttribute>()) {
+    std::vector<uint32_t> element_ids;
+    for (auto element : attr.dyn_cast<ArrayAttribute>().AsVector()) {
+      element_ids.push_back(GetAttributeId(element));
+    }
+    attributes_.Write(AttributeKind::kArray);
+    attributes_.Write<uint32_t>(static_cast<uint32_t>(element_ids.size()));
+    for (auto id : element_ids) {
+      attributes_.Write<uint32_t>(id);
+    }
+  } else if (attr.isa<Complex64Attribute>()) {
+    auto data = attr.dyn_cast<Complex64Attribute>().data();
+    attributes_.Write(AttributeKind::kComplex64);
+    attributes_.Write<float>(data.real);
+    attributes_.Write<float>(data.imag);
+  } else if (attr.isa<Complex128Attribute>()) {
+    auto data = attr.dyn_cast<Complex128Attribute>().data();
+    attributes_.Write(AttributeKind::kComplex128);
+    attributes_.Write<double>(data.real);
+    attributes_.Write<double>(data.imag);
+  } else {
+    std::ostringstream text;
+    attr.Print(text);
+    uint32_t text_id = GetStringId(text.str());
+    attributes_.Write(AttributeKind::kText);
+    attributes_.Write<uint32_t>(text_id);
+  }
+  attribute_ids_.emplace(attr, num_attributes_);
+  return num_attributes_++;
+}
+
+void ProgramWriter::DefineValue(Value value) {
+  uint32_t id = static_cast<uint32_t>(value_ids_.size());
+  value_ids_.emplace(value, id);
+}
+
+uint32_t ProgramWriter::GetValueId(Value value) const {
+  if (!value) {
+    return kNullIndex;
+  }
+  auto iter = value_ids_.find(value);
+  IR_ENFORCE(iter != value_ids_.end(),
+             "A value is used before it is defined, the program can not be "
+             "serialized.");
+  return iter->second;
+}
+
+void ProgramWriter::WriteOperation(const Operation &op) {
+  IR_ENFORCE(op.num_successors() == 0,
+             "Op %s has successors, which can not be serialized.",
+             op.name());
+  body_.Write<uint32_t>(GetStringId(op.name()));
+
+  body_.Write<uint32_t>(op.num_operands());
+  for (uint32_t i = 0; i < op.num_operands(); ++i) {
+    body_.Write<uint32_t>(GetValueId(op.operand_source(i)));
+  }
+
+  // AttributeMap is unordered, sort the names to make the output stable.
+  std::vector<std::pair<std::string, Attribute>> attrs(
+      op.attributes().begin(), op.attributes().end());
+  std::sort(attrs.begin(), attrs.end(), [](const auto &lhs, const auto &rhs) {
+    return lhs.first < rhs.first;
+  });
+  body_.Write<uint32_t>(static_cast<uint32_t>(attrs.size()));
+  for (const auto &attr : attrs) {
+    body_.Write<uint32_t>(GetStringId(attr.first));
+    body_.Write<uint32_t>(GetAttributeId(attr.second));
+  }
+
+  body_.Write<uint32_t>(op.num_results());
+  for (uint32_t i = 0; i < op.num_results(); ++i) {
+    body_.Write<uint32_t>(GetTypeId(op.result(i).type()));
+    DefineValue(op.result(i));
+  }
+
+  body_.Write<uint32_t>(op.num_regions());
+  for (uint32_t i = 0; i < op.num_regions(); ++i) {
+    WriteRegion(op.region(i));
+  }
+}
+
+void ProgramWriter::WriteRegion(const Region &region) {
+  body_.Write<uint32_t>(static_cast<uint32_t>(region.size()));
+  for (auto &block : region) {
+    WriteBlock(block);
+  }
+}
+
+void ProgramWriter::WriteBlock(const Block &block) {
+  body_.Write<uint32_t>(block.args_size());
+  for (auto arg : block.args()) {
+    body_.Write<uint32_t>(GetTypeId(arg.type()));
+    DefineValue(arg);
+  }
+
+  std::vector<std::pair<std::string, Value>> kwargs(block.kwargs_begin(),
+                                                    block.kwargs_end());
+  std::sort(kwargs.begin(), kwargs.end(), [](const auto &lhs, const auto &rhs) {
+    return lhs.first < rhs.first;
+  });
+  body_.Write<uint32_t>(static_cast<uint32_t>(kwargs.size()));
+  for (const auto &kwarg : kwargs) {
+    body_.Write<uint32_t>(GetStringId(kwarg.first));
+    body_.Write<uint32_t>(GetTypeId(kwarg.second.type()));
+    DefineValue(kwarg.second);
+  }
+
+  body_.Write<uint32_t>(static_cast<uint32_t>(block.size()));
+  for (auto &op : block) {
+    WriteOperation(op);
+  }
+}
+
+void ProgramWriter::WriteParameters(const Program &program,
+                                    std::ostream *params_os) {
+  if (params_os == nullptr) {
+    parameters_.Write<uint32_t>(0);
+    return;
+  }
+  std::vector<std::pair<std::string, Parameter *>> params;
+  for (const auto &param : program.parameters()) {
+    params.emplace_back(param.first, param.second.get());
+  }
+  std::sort(
+      params.begin(), params.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first < rhs.first;
+      });
+
+  const std::string padding(kParamsAlignment, '\0');
+  params_os->write(kParamsMagic, sizeof(kParamsMagic));
+  params_os->write(reinterpret_cast<const char *>(&kBinaryProgramVersion),
+                   sizeof(kBinaryProgramVersion));
+  uint64_t offset = sizeof(kParamsMagic) + sizeof(kBinaryProgramVersion);
+
+  parameters_.Write<uint32_t>(static_cast<uint32_t>(params.size()));
+  for (const auto &param : params) {
+    size_t pad = (kParamsAlignment - offset % kParamsAlignment) %
+                 kParamsAlignment;
+    params_os->write(padding.data(), static_cast<std::streamsize>(pad));
+    offset += pad;
+
+    uint64_t size = param.second->size();
+    parameters_.Write<uint32_t>(GetStringId(param.first));
+    parameters_.Write<uint32_t>(GetTypeId(param.second->type()));
+    parameters_.Write<uint64_t>(offset);
+    parameters_.Write<uint64_t>(size);
+    parameters_.Write<uint8_t>(param.second->is_mutable());
+
+    params_os->write(static_cast<const char *>(param.second->data()),
+                     static_cast<std::streamsize>(size));
+    offset += size;
+  }
+  IR_ENFORCE(params_os->good(), "Failed to write the parameter blob.");
+}
+
+void ProgramWriter::Write(const Program &program,
+                          std::ostream &os,
+                          std::ostream *params_os) {
+  WriteBlock(*program.block());
+  WriteParameters(program, params_os);
+
+  BufferWriter header;
+  header.Write(kProgramMagic);
+  header.Write<uint32_t>(kBinaryProgramVersion);
+  header.Write<uint32_t>(num_strings_);
+  header.Write<uint32_t>(num_types_);
+  header.Write<uint32_t>(num_attributes_);
+  for (const BufferWriter *section :
+       {&header, &strings_, &types_, &attributes_, &body_, &parameters_}) {
+    os.write(section->buffer().data(),
+             static_cast<std::streamsize>(section->buffer().size()));
+  }
+  IR_ENFORCE(os.good(), "Failed to write the binary program.");
+}
+
+class ProgramReader {
+ public:
+  ProgramReader(const std::string &data, IrContext *ctx)
+      : reader_(data.data(), data.size()), ctx_(ctx) {}
+
+  std::unique_ptr<Program> Read(const std::string &params_path);
+
+ private:
+  void ReadStrings(uint32_t num);
+  void ReadTypes(uint32_t num);
+  void ReadAttributes(uint32_t num);
+
+  const std::string &GetString(uint32_t id) const;
+  Type GetType(uint32_t id) const;
+  Attribute GetAttribute(uint32_t id) const;
+  Value GetValue(uint32_t id) const;
+
+  Operation *ReadOperation();
+  void ReadBlock(Block *block);
+  void ReadParameters(Program *program, const std::string &params_path);
+
+  BufferReader reader_;
+  IrContext *ctx_;
+  std::vector<std::string> strings_;
+  std::vector<Type> types_;
+  std::vector<Attribute> attributes_;
+  std::vector<Value> values_;
+};
+
+const std::string &ProgramReader::GetString(uint32_t id) const {
+  IR_ENFORCE(id < strings_.size(), "String id %d is out of range.", id);
+  return strings_[id];
+}
+
+Type ProgramReader::GetType(uint32_t id) const {
+  if (id == kNullIndex) {
+    return Type();
+  }
+  IR_ENFORCE(id < types_.size(), "Type id %d is out of range.", id);
+  return types_[id];
+}
+
+Attribute ProgramReader::GetAttribute(uint32_t id) const {
+  if (id == kNullIndex) {
+    return Attribute();
+  }
+  IR_ENFORCE(id < attributes_.size(), "Attribute id %d is out of range.", id);
+  return attributes_[id];
+}
+
+Value ProgramReader::GetValue(uint32_t id) const {
+  if (id == kNullIndex) {
+    return Value();
+  }
+  IR_ENFORCE(id < values_.size(), "Value id %d is out of range.", id);
+  return values_[id];
+}
+
+void ProgramReader::ReadStrings(uint32_t num) {
+  strings_.reserve(num);
+  for (uint32_t i = 0; i < num; ++i) {
+    strings_.push_back(reader_.ReadString());
+  }
+}
+
+void ProgramReader::ReadTypes(uint32_t num) {
+  types_.reserve(num);
+  for (uint32_t i = 0; i < num; ++i) {
+    auto kind = reader_.Read<TypeKind>();
+    switch (kind) {
+      case TypeKind::kText: {
+        std::istringstream text(GetString(reader_.Read<uint32_t>()));
+        types_.push_back(Type::Parse(text, ctx_));
+        break;
+      }
+      case TypeKind::kVector: {
+        uint32_t size = reader_.Read<uint32_t>();
+        std::vector<Type> elements;
+        elements.reserve(size);
+        for (uint32_t j = 0; j < size; ++j) {
+          elements.push_back(GetType(reader_.Read<uint32_t>()));
+        }
+        types_.push_back(VectorType::get(ctx_, elements));
+        break;
+      }
+      case TypeKind::kDenseTensor: {
+        Type dtype = GetType(reader_.Read<uint32_t>());
+        int32_t rank = reader_.Read<int32_t>();
+        DenseTensorType::Dim dims;
+        if (rank >= 0) {
+          std::vector<int64_t> dim_vec(rank);
+          for (int32_t j = 0; j < rank; ++j) {
+            dim_vec[j] = reader_.Read<int64_t>();
+          }
+          dims = common::make_ddim(dim_vec);
+        }
+        auto layout = static_cast<DataLayout>(reader_.Read<int32_t>());
+        DenseTensorType::LoD lod(reader_.Read<uint32_t>());
+        for (auto &level : lod) {
+          level.resize(reader_.Read<uint32_t>());
+          for (auto &offset : level) {
+            offset = reader_.Read<uint64_t>();
+          }
+        }
+        size_t offset = reader_.Read<uint64_t>();
+        types_.push_back(
+            DenseTensorType::get(ctx_, dtype, dims, layout, lod, offset));
+        break;
+      }
+#define DESERIALIZE_BUILTIN_TYPE(__name)       \
+  case TypeKind::k##__name:                    \
+    types_.push_back(__name##Type::get(ctx_)); \
+    break;
+        DESERIALIZE_BUILTIN_TYPE(BFloat16)
+        DESERIALIZE_BUILTIN_TYPE(Float16)
+        DESERIALIZE_BUILTIN_TYPE(Float32)
+        DESERIALIZE_BUILTIN_TYPE(Float64)
+        DESERIALIZE_BUILTIN_TYPE(Int8)
+        DESERIALIZE_BUILTIN_TYPE(UInt8)
+        DESERIALIZE_BUILTIN_TYPE(Int16)
+        DESERIALIZE_BUILTIN_TYPE(Int32)
+        DESERIALIZE_BUILTIN_TYPE(Int64)
+        DESERIALIZE_BUILTIN_TYPE(Index)
+        DESERIALIZE_BUILTIN_TYPE(Bool)
+        DESERIALIZE_BUILTIN_TYPE(Complex64)
+        DESERIALIZE_BUILTIN_TYPE(Complex128)
+#undef DESERIALIZE_BUILTIN_TYPE
+      default:
+        IR_THROW("Unknown type kind %d in the binary program.",
+                 static_cast<int>(kind));
+    }
+  }
+}
+
+void ProgramReader::ReadAttributes(uint32_t num) {
+  attributes_.reserve(num);
+  for (uint32_t i = 0; i < num; ++i) {
+    auto kind = reader_.Read<AttributeKind>();
+    switch (kind) {
+      case AttributeKind::kText: {
+        std::istringstream text(GetString(reader_.Read<uint32_t>()));
+        attributes_.push_back(Attribute::Parse(text, ctx_));
+        break;
+      }
+      case AttributeKind::kBool:
+        attributes_.push_back(
+            BoolAttribute::get(ctx_, reader_.Read<uint8_t>() != 0));
+        break;
+      case AttributeKind::kFloat:
+        attributes_.push_back(
+            FloatAttribute::get(ctx_, reader_.Read<float>()));
+        break;
+      case AttributeKind::kDouble:
+        attributes_.push_back(
+            DoubleAttribute::get(ctx_, reader_.Read<double>()));
+        break;
+      case AttributeKind::kInt32:
+        attributes_.push_back(
+            Int32Attribute::get(ctx_, reader_.Read<int32_t>()));
+        break;
+      case AttributeKind::kIndex:
+        attributes_.push_back(
+            IndexAttribute::get(ctx_, reader_.Read<int64_t>()));
+        break;
+      case AttributeKind::kInt64:
+        attributes_.push_back(
+            Int64Attribute::get(ctx_, reader_.Read<int64_t>()));
+        break;
+      case AttributeKind::kStr:
+        attributes_.push_back(
+            StrAttribute::get(ctx_, GetString(reader_.Read<uint32_t>())));
+        break;
+      case AttributeKind::kTensorName:
+        attributes_.push_back(TensorNameAttribute::get(
+            ctx_, GetString(reader_.Read<uint32_t>())));
+        break;
+      case AttributeKind::kType:
+        attributes_.push_back(
+            TypeAttribute::get(ctx_, GetType(reader_.Read<uint32_t>())));
+        break;
+      case AttributeKind::kArray: {
+        uint32_t size = reader_.Read<uint32_t>();
+        std::vector<Attribute> elements;
+        elements.reserve(size);
+        for (uint32_t j = 0; j < size; ++j) {
+          elements.push_back(GetAttribute(reader_.Read<uint32_t>()));
+        }
+        attributes_.push_back(ArrayAttribute::get(ctx_, elements));
+        break;
+      }
+      case AttributeKind::kComplex64: {
+        float real = reader_.Read<float>();
+        float imag = reader_.Read<float>();
+        attributes_.push_back(Complex64Attribute::get(
+            ctx_, phi::dtype::complex<float>(real, imag)));
+        break;
+      }
+      case AttributeKind::kComplex128: {
+        double real = reader_.Read<double>();
+        double imag = reader_.Read<double>();
+        attributes_.push_back(Complex128Attribute::get(
+            ctx_, phi::dtype::complex<double>(real, imag)));
+        break;
+      }
+      default:
+        IR_THROW("Unknown attribute kind %d in the binary program.",
+                 static_cast<int>(kind));
+    }
+  }
+}
+
+Operation *ProgramReader::ReadOperation() {
+  const std::string &name = GetString(reader_.Read<uint32_t>());
+  OpInfo op_info = ctx_->GetRegisteredOpInfo(name);
+  IR_ENFORCE(op_info,
+             "Op %s is not registered, load its dialect before loading the "
+             "program.",
+             name);
+
+  std::vector<Value> inputs(reader_.Read<uint32_t>());
+  for (auto &input : inputs) {
+    input = GetValue(reader_.Read<uint32_t>());
+  }
+
+  AttributeMap attrs;
+  uint32_t num_attrs = reader_.Read<uint32_t>();
+  for (uint32_t i = 0; i < num_attrs; ++i) {
+    const std::string &attr_name = GetString(reader_.Read<uint32_t>());
+    attrs.emplace(attr_name, GetAttribute(reader_.Read<uint32_t>()));
+  }
+
+  std::vector<Type> output_types(reader_.Read<uint32_t>());
+  for (auto &type : output_types) {
+    type = GetType(reader_.Read<uint32_t>());
+  }
+
+  uint32_t num_regions = reader_.Read<uint32_t>();
+  Operation *op =
+      Operation::Create(inputs, attrs, output_types, op_info, num_regions);
+  for (uint32_t i = 0; i < op->num_results(); ++i) {
+    values_.push_back(op->result(i));
+  }
+  for (uint32_t i = 0; i < num_regions; ++i) {
+    Region &region = op->region(i);
+    uint32_t num_blocks = reader_.Read<uint32_t>();
+    for (uint32_t j = 0; j < num_blocks; ++j) {
+      ReadBlock(&region.emplace_back());
+    }
+  }
+  return op;
+}
+
+void ProgramReader::ReadBlock(Block *block) {
+  uint32_t num_args = reader_.Read<uint32_t>();
+  for (uint32_t i = 0; i < num_args; ++i) {
+    values_.push_back(block->AddArg(GetType(reader_.Read<uint32_t>())));
+  }
+  uint32_t num_kwargs = reader_.Read<uint32_t>();
+  for (uint32_t i = 0; i < num_kwargs; ++i) {
+    const std::string &keyword = GetString(reader_.Read<uint32_t>());
+    values_.push_back(
+        block->AddKwarg(keyword, GetType(reader_.Read<uint32_t>())));
+  }
+  uint32_t num_ops = reader_.Read<uint32_t>();
+  for (uint32_t i = 0; i < num_ops; ++i) {
+    block->push_back(ReadOperation());
+  }
+}
+
+// Maps the whole parameter blob at path into memory. The mapping is private
+// and writable, so mutable parameters can be updated in place without
+// touching the file, and it is unmapped when the last parameter referring
+// to it is destroyed.
+std::shared_ptr<void> MapParamsFile(const std::string &path, size_t *size) {
+#ifdef _WIN32
+  std::ifstream fin(path, std::ios::binary);
+  IR_ENFORCE(fin.good(), "Failed to open the parameter blob %s.", path);
+  std::string content((std::istreambuf_iterator<char>(fin)),
+                      std::istreambuf_iterator<char>());
+  *size = content.size();
+  void *data = malloc(content.size());
+  std::memcpy(data, content.data(), content.size());
+  return std::shared_ptr<void>(data, free);
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  IR_ENFORCE(fd >= 0, "Failed to open the parameter blob %s.", path);
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    IR_THROW("Failed to stat the parameter blob %s.", path);
+  }
+  size_t file_size = static_cast<size_t>(file_stat.st_size);
+  IR_ENFORCE(file_size > 0, "The parameter blob %s is empty.", path);
+  void *data =
+      mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  IR_ENFORCE(data != MAP_FAILED, "Failed to map the parameter blob %s.", path);
+  *size = file_size;
+  return std::shared_ptr<void>(
+      data, [file_size](void *ptr) { munmap(ptr, file_size); });
+#endif
+}
+
+void ProgramReader::ReadParameters(Program *program,
+                                   const std::string &params_path) {
+  uint32_t num_params = reader_.Read<uint32_t>();
+  if (num_params == 0 || params_path.empty()) {
+    return;
+  }
+  size_t file_size = 0;
+  std::shared_ptr<void> holder = MapParamsFile(params_path, &file_size);
+  char *base = static_cast<char *>(holder.get());
+  IR_ENFORCE(file_size >= sizeof(kParamsMagic) + sizeof(uint32_t) &&
+                 std::memcmp(base, kParamsMagic, sizeof(kParamsMagic)) == 0,
+             "%s is not a parameter blob.",
+             params_path);
+  uint32_t version = 0;
+  std::memcpy(&version, base + sizeof(kParamsMagic), sizeof(version));
+  IR_ENFORCE(version == kBinaryProgramVersion,
+             "The parameter blob %s has version %d, but %d is expected.",
+             params_path,
+             version,
+             kBinaryProgramVersion);
+
+  for (uint32_t i = 0; i < num_params; ++i) {
+    const std::string &name = GetString(reader_.Read<uint32_t>());
+    Type type = GetType(reader_.Read<uint32_t>());
+    uint64_t offset = reader_.Read<uint64_t>();
+    uint64_t size = reader_.Read<uint64_t>();
+    bool is_mutable = reader_.Read<uint8_t>() != 0;
+    IR_ENFORCE(offset <= file_size && size <= file_size - offset,
+               "The data of parameter %s is out of the parameter blob %s.",
+               name,
+               params_path);
+    auto param =
+        std::make_shared<Parameter>(holder, base + offset, size, type);
+    if (is_mutable) {
+      param->set_mutable();
+    }
+    program->SetParameter(name, param);
+  }
+}
+
+std::unique_ptr<Program> ProgramReader::Read(const std::string &params_path) {
+  char magic[sizeof(kProgramMagic)];
+  reader_.ReadBytes(magic, sizeof(magic));
+  IR_ENFORCE(std::memcmp(magic, kProgramMagic, sizeof(magic)) == 0,
+             "The input is not a binary program.");
+  uint32_t version = reader_.Read<uint32_t>();
+  IR_ENFORCE(version == kBinaryProgramVersion,
+             "The binary program has version %d, but %d is expected.",
+             version,
+             kBinaryProgramVersion);
+  uint32_t num_strings = reader_.Read<uint32_t>();
+  uint32_t num_types = reader_.Read<uint32_t>();
+  uint32_t num_attributes = reader_.Read<uint32_t>();
+  ReadStrings(num_strings);
+  ReadTypes(num_types);
+  ReadAttributes(num_attributes);
+
+  auto program = std::make_unique<Program>(ctx_);
+  ReadBlock(program->block());
+  ReadParameters(program.get(), params_path);
+  return program;
+}
+
+}  // namespace
+
+void SerializeProgram(const Program &program,
+                      std::ostream &os,
+                      std::ostream *params_os) {
+  ProgramWriter writer;
+  writer.Write(program, os, params_os);
+}
+
+std::unique_ptr<Program> DeserializeProgram(std::istream &is,
+                                            IrContext *ctx,
+                                            const std::string &params_path) {
+  std::string data((std::istreambuf_iterator<char>(is)),
+                   std::istreambuf_iterator<char>());
+  ProgramReader reader(data, ctx);
+  return reader.Read(params_path);
+}
+
+}  // namespace pir
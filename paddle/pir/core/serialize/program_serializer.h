@@ -0,0 +1,70 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "paddle/pir/core/dll_decl.h"
+#include "paddle/pir/core/ir_context.h"
+#include "paddle/pir/core/program.h"
+
+namespace pir {
+
+///
+/// \brief Binary format of a Program, which loads without any text parsing.
+///
+/// The file starts with a header (magic "PIRB" and format version), followed
+/// by four tables and the program body:
+///   strings:    op names, attribute names, parameter names and the text of
+///               types and attributes of dialects other than builtin.
+///   types:      every distinct type once. Builtin types are encoded field by
+///               field, other types by their text.
+///   attributes: every distinct attribute once, encoded like types.
+///   body:       the ops of the module block in order. Ops refer to names,
+///               types and attributes by their index in the tables, and to
+///               values by the index of the op result or block argument that
+///               defines them. Nested regions are stored in place.
+///   parameters: name, type, and the offset and size of the data of each
+///               parameter in the parameter blob.
+/// Types and attributes are uniqued by the storage managers of IrContext, so
+/// each table entry is built once on load however many ops use it.
+///
+/// The parameter blob holds the raw data of the parameters at 64 bytes
+/// aligned offsets after a small header. On load it is mapped into memory
+/// and the parameters refer to the mapping instead of copying it.
+///
+constexpr uint32_t kBinaryProgramVersion = 1;
+
+///
+/// \brief Writes program to os in the binary format. If params_os is not
+/// nullptr, the data of the parameters of program is written to it as the
+/// parameter blob.
+///
+IR_API void SerializeProgram(const Program &program,
+                             std::ostream &os,
+                             std::ostream *params_os = nullptr);
+
+///
+/// \brief Reads a program written by SerializeProgram. If params_path is not
+/// empty, the parameters of the program are mapped from the parameter blob
+/// at params_path.
+///
+IR_API std::unique_ptr<Program> DeserializeProgram(
+    std::istream &is, IrContext *ctx, const std::string &params_path = "");
+
+}  // namespace pir
@@ -767,6 +767,8 @@ class SparseTable(Table):
             table_proto.enable_revert = usr_table_proto.enable_revert
         if usr_table_proto.HasField("shard_merge_rate"):
             table_proto.shard_merge_rate = usr_table_proto.shard_merge_rate
+        if usr_table_proto.HasField("save_format"):
+            table_proto.save_format = usr_table_proto.save_format
 
         if usr_table_proto.accessor.ByteSize() == 0:
             warnings.warn(
@@ -228,6 +228,65 @@ class TestProcessGroupFp32(unittest.TestCase):
         test_gather(pg.size() - 1)
         print("test gather api ok\n")
 
+        # test all_gather_into_tensor
+        xs = [
+            np.random.random(self.shape).astype(self.dtype)
+            for _ in range(pg.size())
+        ]
+        out_shape = list(self.shape)
+        out_shape[0] *= pg.size()
+        tensor_out = paddle.zeros(out_shape, self.dtype)
+        task = pg.all_gather_into_tensor(
+            tensor_out, paddle.to_tensor(xs[pg.rank()]), True
+        )
+        task.wait()
+        np.testing.assert_array_equal(tensor_out, np.concatenate(xs))
+        print("test all_gather_into_tensor api ok\n")
+
+        # test reduce_scatter
+        xs = [
+            np.random.random(out_shape).astype(self.dtype)
+            for _ in range(pg.size())
+        ]
+        tensor_out = paddle.zeros(self.shape, self.dtype)
+        task = pg.reduce_scatter_tensor(
+            tensor_out, paddle.to_tensor(xs[pg.rank()]), core.ReduceOp.SUM, True
+        )
+        task.wait()
+        sum_result = np.sum(xs, axis=0)
+        chunk = self.shape[0]
+        np.testing.assert_allclose(
+            tensor_out,
+            sum_result[pg.rank() * chunk : (pg.rank() + 1) * chunk],
+            rtol=1e-05,
+        )
+        print("test reduce_scatter api ok\n")
+
+        # test all_to_all_single with uneven split sizes, rank i sends
+        # i + j + 1 rows to rank j
+        row_shape = list(self.shape[1:])
+        in_sizes = [pg.rank() + j + 1 for j in range(pg.size())]
+        out_sizes = [i + pg.rank() + 1 for i in range(pg.size())]
+        xs = []
+        for i in range(pg.size()):
+            rows = sum(i + j + 1 for j in range(pg.size()))
+            xs.append(np.random.random([rows] + row_shape).astype(self.dtype))
+        tensor_out = paddle.zeros([sum(out_sizes)] + row_shape, self.dtype)
+        task = pg.all_to_all_single(
+            tensor_out,
+            paddle.to_tensor(xs[pg.rank()]),
+            out_sizes,
+            in_sizes,
+            True,
+        )
+        task.wait()
+        expected = []
+        for i in range(pg.size()):
+            begin = sum(i + j + 1 for j in range(pg.rank()))
+            expected.append(xs[i][begin : begin + out_sizes[i]])
+        np.testing.assert_array_equal(tensor_out, np.concatenate(expected))
+        print("test all_to_all_single api ok\n")
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -245,3 +245,48 @@ TEST(Benchmark, EagerIntermediateMLPCPU) {
     }
   }
 }
+
+TEST(Benchmark, EagerSmallOpsCPU) {
+  // Prepare Device Contexts
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+
+  for (const std::string mode : {"Accuracy", "Performance"}) {
+    paddle::framework::DDim ddim = common::make_ddim({1});
+    paddle::Tensor X =
+        eager_test::CreateTensorWithValue(ddim,
+                                          paddle::platform::CPUPlace(),
+                                          phi::DataType::FLOAT32,
+                                          phi::DataLayout::NCHW,
+                                          1.0,
+                                          false);
+    paddle::Tensor Y =
+        eager_test::CreateTensorWithValue(ddim,
+                                          paddle::platform::CPUPlace(),
+                                          phi::DataType::FLOAT32,
+                                          phi::DataLayout::NCHW,
+                                          2.0,
+                                          false);
+
+    if (mode == "Accuracy") {
+      benchmark_eager_small_ops(X, Y, true /* accuracy_check */);
+
+    } else if (mode == "Performance") {
+      auto t_start = std::chrono::high_resolution_clock::now();
+#ifdef WITH_GPERFTOOLS
+      ProfilerStart("eager_small_ops_cpu.out");
+#endif
+      benchmark_eager_small_ops(X, Y);
+
+#ifdef WITH_GPERFTOOLS
+      ProfilerStop();
+#endif
+      auto t_end = std::chrono::high_resolution_clock::now();
+      double elapsed_time_ms =
+          std::chrono::duration<double, std::milli>(t_end - t_start).count();
+      std::cout << "Duration: " << elapsed_time_ms << " ms" << std::endl;
+
+    } else {
+      PADDLE_THROW(paddle::platform::errors::Fatal("Unknown benchmark mode"));
+    }
+  }
+}
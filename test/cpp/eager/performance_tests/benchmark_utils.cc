@@ -152,6 +152,29 @@ void benchmark_eager_intermediate_mlp(const paddle::Tensor& X,
   }
 }
 
+/* ------------------------- */
+/* ---- Eager Small Ops ---- */
+/* ------------------------- */
+void benchmark_eager_small_ops(const paddle::Tensor& X,
+                               const paddle::Tensor& Y,
+                               bool accuracy_check) {
+  // X and Y hold one element and do not require grad, so the run time is
+  // dominated by the per-op overhead of dygraph: kernel selection, infer
+  // meta and output allocation.
+  paddle::Tensor out = X;
+
+  size_t max_num_runs = accuracy_check ? 10 : max_num_benchmark_runs * 25;
+  for (size_t i = 0; i < max_num_runs; i++) {
+    out = add_ad_func(out, Y);
+    out = multiply_ad_func(out, X);
+  }
+
+  if (accuracy_check) {
+    // Examine Forward Output (w.r.t max_num_runs = 10, X = 1.0, Y = 2.0)
+    eager_test::CompareTensorWithValue<float>(out, 21.0);
+  }
+}
+
 }  // namespace egr
 
 namespace paddle {
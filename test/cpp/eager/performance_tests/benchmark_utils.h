@@ -65,6 +65,11 @@ void benchmark_eager_intermediate_mlp(const paddle::Tensor& X,
                                       const std::vector<paddle::Tensor>& Bs,
                                       bool accuracy_check = false);
 
+/* ---- Eager Small Ops ---- */
+void benchmark_eager_small_ops(const paddle::Tensor& X,
+                               const paddle::Tensor& Y,
+                               bool accuracy_check = false);
+
 }  // namespace egr
 
 namespace paddle {
@@ -18,6 +18,7 @@
 
 #include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/eager/accumulation/accumulation_node.h"
 #include "paddle/fluid/eager/api/all.h"
 #include "paddle/fluid/eager/api/generated/eager_generated/backwards/scale_node.h"
@@ -31,6 +32,9 @@
 PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
 
+COMMON_DECLARE_int32(eager_backward_num_threads);
+COMMON_DECLARE_bool(eager_backward_deterministic);
+
 namespace egr {
 
 TEST(Backward, SingleNodeEmptyGrad) {
@@ -342,4 +346,88 @@ TEST(Backward, WithAccumulation) {
   eager_test::CompareGradTensorWithValue<float>(leaf_tensor, 2500.0);
 }
 
+/*
+          AccumulationNode
+                 |
+              NodeSum
+      /     /    ...    \
+  Node0  Node1   ...  Node7
+    |      |             |
+  inp0   inp1   ...    inp7
+*/
+
+void RunParallelBranches(bool deterministic) {
+  const int kBranchNum = 8;
+  FLAGS_eager_backward_num_threads = 4;
+  FLAGS_eager_backward_deterministic = deterministic;
+
+  paddle::framework::DDim ddim = common::make_ddim({4, 16, 32});
+  std::vector<paddle::Tensor> target_tensors;
+  for (int i = 0; i < kBranchNum; i++) {
+    target_tensors.emplace_back(
+        eager_test::CreateTensorWithValue(ddim,
+                                          paddle::platform::CPUPlace(),
+                                          phi::DataType::FLOAT32,
+                                          phi::DataLayout::NCHW,
+                                          1.0 /*value*/,
+                                          false /*is_leaf*/));
+  }
+
+  paddle::Tensor leaf_tensor;
+  {
+    // Create NodeSum
+    auto sum_node_ptr = std::make_shared<GradNodeScale>(1, 1);
+    sum_node_ptr->SetAttributes_scale(2.0 /*scale*/);
+    sum_node_ptr->SetDefaultGradInOutMeta();
+
+    // Connect NodeI -> NodeSum via Edge
+    for (int i = 0; i < kBranchNum; i++) {
+      auto node_ptr = std::make_shared<GradNodeScale>(1, 1);
+      node_ptr->SetAttributes_scale(i + 1.0 /*scale*/);
+      node_ptr->SetDefaultGradInOutMeta();
+
+      AutogradMeta* auto_grad_meta =
+          EagerUtils::autograd_meta(&(target_tensors[i]));
+      auto_grad_meta->SetGradNode(
+          std::dynamic_pointer_cast<GradNodeBase>(node_ptr));
+      auto_grad_meta->SetSingleOutRankWithSlot(0, 0);
+      auto_grad_meta->SetStopGradient(false);
+
+      auto tmp_tensor = paddle::Tensor();
+      auto* meta = EagerUtils::autograd_meta(&tmp_tensor);
+      meta->SetStopGradient(false);
+      meta->SetSingleOutRankWithSlot(0, 0);
+      meta->SetGradNode(sum_node_ptr);
+      node_ptr->SetGradOutMeta(tmp_tensor, 0);
+    }
+
+    AutogradMeta* auto_grad_meta = EagerUtils::autograd_meta(&leaf_tensor);
+    // Connect Tensor and AccumulationNode via AutoGradMeta
+    auto acc_node_ptr =
+        std::make_shared<egr::GradNodeAccumulation>(auto_grad_meta);
+    auto_grad_meta->SetGradNode(
+        std::dynamic_pointer_cast<GradNodeBase>(acc_node_ptr));
+    auto_grad_meta->SetSingleOutRankWithSlot(0, 0);
+    auto_grad_meta->SetStopGradient(false);
+    sum_node_ptr->SetGradOutMeta(leaf_tensor, 0);
+  }
+
+  // Use Empty Grad Tensor
+  Backward(target_tensors, {});
+
+  FLAGS_eager_backward_num_threads = 0;
+  FLAGS_eager_backward_deterministic = true;
+
+  // 2 * (1 + 2 + ... + 8)
+  eager_test::CompareGradTensorWithValue<float>(leaf_tensor, 72.0);
+}
+
+TEST(Backward, ParallelBranches) {
+  // Prepare Device Contexts
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+
+  RunParallelBranches(true /*deterministic*/);
+  RunParallelBranches(false /*deterministic*/);
+}
+
 }  // namespace egr
@@ -0,0 +1,152 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/channel.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+// Writes 1..producer_num * num in blocks from producer_num threads while
+// consumer_num threads read blocks, returns the seconds it takes.
+static double ProduceAndConsume(Channel<int64_t> chan,
+                                int producer_num,
+                                int consumer_num,
+                                int64_t num,
+                                int64_t* sum,
+                                int64_t* count) {
+  std::atomic<int64_t> total_sum{0};
+  std::atomic<int64_t> total_count{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < consumer_num; ++i) {
+    consumers.emplace_back([&]() {
+      std::vector<int64_t> block;
+      int64_t local_sum = 0;
+      int64_t local_count = 0;
+      while (chan->Read(block) != 0) {
+        for (int64_t x : block) {
+          local_sum += x;
+        }
+        local_count += block.size();
+      }
+      total_sum += local_sum;
+      total_count += local_count;
+    });
+  }
+  std::vector<std::thread> producers;
+  for (int i = 0; i < producer_num; ++i) {
+    producers.emplace_back([&, i]() {
+      std::vector<int64_t> block;
+      for (int64_t x = i * num + 1; x <= (i + 1) * num; ++x) {
+        block.push_back(x);
+        if (block.size() == 64) {
+          chan->Write(std::move(block));
+          block.clear();
+        }
+      }
+      if (!block.empty()) {
+        chan->Write(std::move(block));
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  chan->Close();
+  for (auto& t : consumers) {
+    t.join();
+  }
+  *sum = total_sum;
+  *count = total_count;
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+TEST(Channel, ShardedProduceAndConsume) {
+  for (size_t capacity : std::vector<size_t>{100, 1 << 20}) {
+    auto chan = MakeChannel<int64_t>(capacity);
+    chan->SetShardNum(4);
+    chan->SetBlockSize(32);
+    EXPECT_EQ(chan->ShardNum(), 4UL);
+    int64_t sum = 0;
+    int64_t count = 0;
+    int64_t n = 8 * 10000;
+    ProduceAndConsume(chan, 8, 8, 10000, &sum, &count);
+    EXPECT_EQ(count, n);
+    EXPECT_EQ(sum, n * (n + 1) / 2);
+    EXPECT_TRUE(chan->Empty());
+  }
+}
+
+TEST(Channel, ShardedCloseAndCapacity) {
+  auto chan = MakeChannel<int>(2);
+  chan->SetShardNum(2);
+  std::vector<int> data = {1, 2, 3};
+
+  // the writer blocks at the capacity until the data is read
+  std::thread writer([&]() { EXPECT_EQ(chan->Write(data), 3UL); });
+  std::vector<int> out;
+  size_t read = 0;
+  while (read < 3) {
+    read += chan->ReadOnce(out, 3);
+    EXPECT_LE(chan->Size(), 2UL);
+  }
+  writer.join();
+
+  chan->Put(4);
+  chan->Put(5);
+  chan->Close();
+  EXPECT_FALSE(chan->Put(6));
+  EXPECT_EQ(chan->GetData().size(), 2UL);
+  EXPECT_EQ(chan->ReadAll(out), 2UL);
+  EXPECT_EQ(out[0] + out[1], 9);
+  int x = 0;
+  EXPECT_FALSE(chan->Get(x));
+
+  chan->Open();
+  EXPECT_TRUE(chan->Put(7));
+  EXPECT_EQ(chan->Size(), 1UL);
+  chan->Clear();
+  EXPECT_TRUE(chan->Empty());
+}
+
+TEST(Channel, ContentionBenchmark) {
+  int thread_num = std::max(4U, std::thread::hardware_concurrency());
+  int64_t num = 200000;
+  for (int shard_num : {1, thread_num}) {
+    auto chan = MakeChannel<int64_t>();
+    chan->SetShardNum(shard_num);
+    chan->SetBlockSize(64);
+    int64_t sum = 0;
+    int64_t count = 0;
+    double seconds =
+        ProduceAndConsume(chan, thread_num, thread_num, num, &sum, &count);
+    EXPECT_EQ(count, thread_num * num);
+    LOG(INFO) << "shard_num=" << shard_num << ", threads=" << thread_num
+              << "x" << thread_num << ": " << count / seconds / 1e6
+              << " M items/s";
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,192 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/slot_line_parser.h"
+
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(SlotLineParser, ParseSlots) {
+  std::string line =
+      "2 1024 18446744073709551615 1 0.5 3 7 8 9 1 -1.25 2 3e2 0x10";
+  SlotLineParser parser(line.c_str(), line.size());
+
+  EXPECT_EQ(parser.NextCount(), 2);
+  EXPECT_EQ(parser.NextUint64(), 1024UL);
+  EXPECT_EQ(parser.NextUint64(), 18446744073709551615UL);
+  EXPECT_EQ(parser.NextCount(), 1);
+  EXPECT_EQ(parser.NextFloat(), 0.5f);
+  // An unused slot.
+  EXPECT_EQ(parser.NextCount(), 3);
+  parser.SkipTokens(3);
+  EXPECT_EQ(parser.NextCount(), 1);
+  EXPECT_EQ(parser.NextFloat(), -1.25f);
+  // Numbers the fast path leaves to strtof/strtoull.
+  EXPECT_EQ(parser.NextCount(), 2);
+  EXPECT_EQ(parser.NextFloat(), 300.0f);
+  EXPECT_EQ(parser.NextUint64(), 0UL);
+  EXPECT_EQ(parser.pos(), line.c_str() + line.size() - 3);
+}
+
+TEST(SlotLineParser, NextToken) {
+  std::string line = "1 ins_0 1 logkey_0 1 5";
+  SlotLineParser parser(line.c_str(), line.size());
+  const char* token = nullptr;
+  size_t len = 0;
+
+  EXPECT_EQ(parser.NextCount(), 1);
+  parser.NextToken(&token, &len);
+  EXPECT_EQ(std::string(token, len), "ins_0");
+  EXPECT_EQ(parser.NextCount(), 1);
+  parser.NextToken(&token, &len);
+  EXPECT_EQ(std::string(token, len), "logkey_0");
+  EXPECT_EQ(parser.NextCount(), 1);
+  EXPECT_EQ(parser.NextUint64(), 5UL);
+  EXPECT_EQ(parser.offset(), line.size());
+}
+
+TEST(SlotLineParser, SameAsStrto) {
+  std::mt19937_64 rng(0);
+  std::vector<std::string> tokens = {"0",
+                                     "007",
+                                     "99999999",
+                                     "9999999999999999999",
+                                     "10000000000000000000",
+                                     "18446744073709551615",
+                                     "18446744073709551616",
+                                     "99999999999999999999",
+                                     "123456789012345678901"};
+  for (int i = 0; i < 10000; ++i) {
+    tokens.push_back(std::to_string(rng() >> (rng() % 64)));
+  }
+  std::string line;
+  for (auto& token : tokens) {
+    line += token + " ";
+  }
+  SlotLineParser parser(line.c_str(), line.size());
+  char* endptr = const_cast<char*>(line.c_str());
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    uint64_t expected = strtoull(endptr, &endptr, 10);
+    EXPECT_EQ(parser.NextUint64(), expected) << tokens[i];
+    EXPECT_EQ(parser.pos(), endptr);
+  }
+
+  std::vector<std::string> floats = {"0",
+                                     "-0",
+                                     "1.",
+                                     ".5",
+                                     "0.1",
+                                     "16777216",
+                                     "16777217",
+                                     "0.0000000001",
+                                     "0.00000000001",
+                                     "1e-7",
+                                     "inf",
+                                     "3.4028235e38"};
+  std::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+  for (int i = 0; i < 10000; ++i) {
+    std::ostringstream os;
+    os.precision(1 + i % 9);
+    os << dist(rng);
+    floats.push_back(os.str());
+  }
+  line.clear();
+  for (auto& token : floats) {
+    line += token + " ";
+  }
+  parser = SlotLineParser(line.c_str(), line.size());
+  endptr = const_cast<char*>(line.c_str());
+  for (size_t i = 0; i < floats.size(); ++i) {
+    float expected = strtof(endptr, &endptr);
+    EXPECT_EQ(parser.NextFloat(), expected) << floats[i];
+    EXPECT_EQ(parser.pos(), endptr);
+  }
+}
+
+TEST(SlotLineParser, Benchmark) {
+  // A CTR line: a label, a dense float slot and sparse slots of hashed ids.
+  std::mt19937_64 rng(0);
+  std::ostringstream os;
+  os << "1 1 13";
+  for (int i = 0; i < 13; ++i) {
+    os << " " << static_cast<float>(rng() % 1000) / 1000;
+  }
+  for (int i = 0; i < 100; ++i) {
+    os << " 3";
+    for (int j = 0; j < 3; ++j) {
+      os << " " << rng();
+    }
+  }
+  std::string line = os.str();
+  const int repeat = 2000;
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t checksum = 0;
+  for (int r = 0; r < repeat; ++r) {
+    char* endptr = const_cast<char*>(line.c_str());
+    strtol(endptr, &endptr, 10);
+    checksum += strtoull(endptr, &endptr, 10);
+    strtol(endptr, &endptr, 10);
+    for (int i = 0; i < 13; ++i) {
+      checksum += static_cast<uint64_t>(strtof(endptr, &endptr));
+    }
+    for (int i = 0; i < 100; ++i) {
+      strtol(endptr, &endptr, 10);
+      for (int j = 0; j < 3; ++j) {
+        checksum += strtoull(endptr, &endptr, 10);
+      }
+    }
+  }
+  double strto_sec = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+  start = std::chrono::steady_clock::now();
+  uint64_t parser_checksum = 0;
+  for (int r = 0; r < repeat; ++r) {
+    SlotLineParser parser(line.c_str(), line.size());
+    parser.NextCount();
+    parser_checksum += parser.NextUint64();
+    parser.NextCount();
+    for (int i = 0; i < 13; ++i) {
+      parser_checksum += static_cast<uint64_t>(parser.NextFloat());
+    }
+    for (int i = 0; i < 100; ++i) {
+      parser.NextCount();
+      for (int j = 0; j < 3; ++j) {
+        parser_checksum += parser.NextUint64();
+      }
+    }
+  }
+  double parser_sec = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+
+  EXPECT_EQ(checksum, parser_checksum);
+  double mb = static_cast<double>(line.size()) * repeat / (1 << 20);
+  LOG(INFO) << "strto*: " << mb / strto_sec
+            << " MB/s, SlotLineParser: " << mb / parser_sec << " MB/s";
+}
+
+}  // namespace framework
+}  // namespace paddle
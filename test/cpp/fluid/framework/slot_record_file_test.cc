@@ -0,0 +1,184 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/slot_record_file.h"
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+static SlotRecordFileSchema MakeSchema() {
+  SlotRecordFileSchema schema;
+  schema.slot_names = {"click", "dense", "user", "item"};
+  schema.slot_types = {'u', 'f', 'u', 'u'};
+  return schema;
+}
+
+static std::vector<SlotRecord> MakeRecords(size_t num) {
+  std::vector<SlotRecord> records;
+  for (size_t i = 0; i < num; ++i) {
+    SlotRecord rec = make_slotrecord();
+    rec->search_id = i * 7;
+    rec->rank = static_cast<uint32_t>(i % 5);
+    rec->cmatch = 222;
+    rec->ins_id_ = "ins_" + std::to_string(i);
+    std::vector<uint64_t> click = {i % 2};
+    std::vector<uint64_t> user(i % 4, i);
+    std::vector<uint64_t> item = {i * 1000003ULL, i * 1000033ULL};
+    rec->slot_uint64_feasigns_.add_values(click.data(), click.size());
+    rec->slot_uint64_feasigns_.add_values(user.data(), user.size());
+    rec->slot_uint64_feasigns_.add_values(item.data(), item.size());
+    std::vector<float> dense = {0.5f * i, 1.0f};
+    rec->slot_float_feasigns_.add_values(dense.data(), dense.size());
+    records.push_back(rec);
+  }
+  return records;
+}
+
+static void ExpectRecordEq(const SlotRecord& a, const SlotRecord& b) {
+  EXPECT_EQ(a->search_id, b->search_id);
+  EXPECT_EQ(a->rank, b->rank);
+  EXPECT_EQ(a->cmatch, b->cmatch);
+  EXPECT_EQ(a->ins_id_, b->ins_id_);
+  EXPECT_EQ(a->slot_uint64_feasigns_.slot_offsets,
+            b->slot_uint64_feasigns_.slot_offsets);
+  EXPECT_EQ(a->slot_uint64_feasigns_.slot_values,
+            b->slot_uint64_feasigns_.slot_values);
+  EXPECT_EQ(a->slot_float_feasigns_.slot_offsets,
+            b->slot_float_feasigns_.slot_offsets);
+  EXPECT_EQ(a->slot_float_feasigns_.slot_values,
+            b->slot_float_feasigns_.slot_values);
+}
+
+static void RoundTrip(bool compress) {
+  std::string path = "slot_record_file_test";
+  path += compress ? "_compressed" : "_raw";
+  path += kSlotRecordFileSuffix;
+  EXPECT_TRUE(IsSlotRecordFile(path));
+
+  std::vector<SlotRecord> records = MakeRecords(1000);
+  {
+    // small blocks, so that the records span many of them
+    SlotRecordFileWriter writer(path, MakeSchema(), compress, 4096);
+    writer.Write(records.data(), records.size());
+  }
+
+  SlotRecordFileReader reader(path);
+  EXPECT_TRUE(reader.schema() == MakeSchema());
+  size_t num = 0;
+  int blocks = 0;
+  while (reader.NextBlock()) {
+    std::vector<SlotRecord> block;
+    for (size_t i = 0; i < reader.record_num(); ++i) {
+      block.push_back(make_slotrecord());
+    }
+    reader.ReadBlock(block.data());
+    for (auto& rec : block) {
+      ASSERT_LT(num, records.size());
+      ExpectRecordEq(rec, records[num++]);
+      free_slotrecord(rec);
+    }
+    ++blocks;
+  }
+  EXPECT_EQ(num, records.size());
+  EXPECT_GT(blocks, 1);
+
+  for (auto& rec : records) {
+    free_slotrecord(rec);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(SlotRecordFile, RoundTrip) { RoundTrip(false); }
+
+TEST(SlotRecordFile, CompressedRoundTrip) { RoundTrip(true); }
+
+TEST(SlotRecordFile, RejectTextFile) {
+  std::string path = "slot_record_file_test_text" +
+                     std::string(kSlotRecordFileSuffix);
+  FILE* fp = fopen(path.c_str(), "w");
+  ASSERT_NE(fp, nullptr);
+  fputs("1 1 2 0.5 0.5\n", fp);
+  fclose(fp);
+  EXPECT_THROW(SlotRecordFileReader{path}, platform::EnforceNotMet);
+  std::remove(path.c_str());
+}
+
+// Writes a valid file of a few records, then appends tail to it.
+static std::string WriteFileWithTail(const std::string& name,
+                                     const std::string& tail) {
+  std::string path = "slot_record_file_test_" + name + kSlotRecordFileSuffix;
+  std::vector<SlotRecord> records = MakeRecords(10);
+  {
+    SlotRecordFileWriter writer(path, MakeSchema(), false);
+    writer.Write(records.data(), records.size());
+  }
+  for (auto& rec : records) {
+    free_slotrecord(rec);
+  }
+  FILE* fp = fopen(path.c_str(), "ab");
+  EXPECT_NE(fp, nullptr);
+  fwrite(tail.data(), 1, tail.size(), fp);
+  fclose(fp);
+  return path;
+}
+
+// Reads the blocks of path until NextBlock returns false.
+static void ReadAllBlocks(const std::string& path) {
+  SlotRecordFileReader reader(path);
+  while (reader.NextBlock()) {
+    std::vector<SlotRecord> block;
+    for (size_t i = 0; i < reader.record_num(); ++i) {
+      block.push_back(make_slotrecord());
+    }
+    reader.ReadBlock(block.data());
+    for (auto& rec : block) {
+      free_slotrecord(rec);
+    }
+  }
+}
+
+TEST(SlotRecordFile, RejectTruncatedBlockHeader) {
+  std::string path = WriteFileWithTail("truncated", std::string(5, '\0'));
+  EXPECT_THROW(ReadAllBlocks(path), platform::EnforceNotMet);
+  std::remove(path.c_str());
+}
+
+TEST(SlotRecordFile, RejectRawSizeMismatch) {
+  std::string payload(4, '\1');
+  SlotRecordBlockHeader header;
+  memset(&header, 0, sizeof(header));
+  header.record_num = 1;
+  header.compressed = 0;
+  header.raw_size = 1024;
+  header.stored_size = payload.size();
+  header.checksum = crc32(
+      0L, reinterpret_cast<const Bytef*>(payload.data()), payload.size());
+  std::string tail(reinterpret_cast<const char*>(&header), sizeof(header));
+  std::string path = WriteFileWithTail("raw_size", tail + payload);
+  EXPECT_THROW(ReadAllBlocks(path), platform::EnforceNotMet);
+  std::remove(path.c_str());
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -14,6 +14,11 @@ limitations under the License. */
 
 #include "paddle/phi/kernels/funcs/selected_rows_functor.h"
 
+#include <chrono>
+#include <map>
+#include <random>
+
+#include "glog/logging.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
@@ -431,6 +436,65 @@ TEST(selected_rows_functor, cpu_merge_add_multi_noduplicated) {
   }
 }
 
+TEST(selected_rows_functor, cpu_merge_add_duplicate_ratios) {
+  paddle::platform::CPUPlace cpu_place;
+  phi::CPUContext ctx(cpu_place);
+  ctx.SetAllocator(paddle::memory::allocation::AllocatorFacade::Instance()
+                       .GetAllocator(cpu_place)
+                       .get());
+
+  int64_t row_numel = 16;
+  size_t row_num = 1 << 16;
+  std::mt19937 rng(0);
+  // from no duplicated rows to about 100 duplicates of a row
+  for (int64_t height : {1 << 30, 1 << 16, 1 << 12, 1 << 9}) {
+    std::vector<std::unique_ptr<phi::SelectedRows>> selected_rows;
+    std::vector<const phi::SelectedRows*> inputs;
+    std::map<int64_t, std::vector<float>> expected;
+    for (int k = 0; k < 2; ++k) {
+      std::vector<int64_t> rows(row_num / 2);
+      for (auto& row : rows) {
+        row = static_cast<int64_t>(rng() % height);
+      }
+      selected_rows.emplace_back(new phi::SelectedRows(rows, height));
+      auto* in_value = selected_rows.back()->mutable_value();
+      auto* in_data = in_value->mutable_data<float>(
+          common::make_ddim({static_cast<int64_t>(rows.size()), row_numel}),
+          cpu_place);
+      for (size_t i = 0; i < rows.size(); ++i) {
+        auto& sum = expected[rows[i]];
+        sum.resize(row_numel, 0);
+        for (int64_t j = 0; j < row_numel; ++j) {
+          in_data[i * row_numel + j] = static_cast<float>(rng() % 8);
+          sum[j] += in_data[i * row_numel + j];
+        }
+      }
+      inputs.push_back(selected_rows.back().get());
+    }
+
+    std::unique_ptr<phi::SelectedRows> output{new phi::SelectedRows()};
+    phi::funcs::scatter::MergeAdd<phi::CPUContext, float> merge_add_functor;
+    auto start = std::chrono::steady_clock::now();
+    merge_add_functor(ctx, inputs, output.get(), true);
+    auto end = std::chrono::steady_clock::now();
+    VLOG(3) << "MergeAdd of " << row_num << " rows into "
+            << output->rows().size() << " rows takes "
+            << std::chrono::duration<double, std::micro>(end - start).count()
+            << " us";
+
+    ASSERT_EQ(output->rows().size(), expected.size());
+    auto* out_data = output->value().data<float>();
+    size_t i = 0;
+    for (auto& item : expected) {
+      ASSERT_EQ(output->rows()[i], item.first);
+      for (int64_t j = 0; j < row_numel; ++j) {
+        ASSERT_EQ(out_data[i * row_numel + j], item.second[j]);
+      }
+      ++i;
+    }
+  }
+}
+
 TEST(selected_rows_functor, cpu_sum_to) {
   paddle::platform::CPUPlace cpu_place;
   phi::CPUContext ctx(cpu_place);
@@ -0,0 +1,142 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_cached_cpu_allocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+class CountedAllocator : public Allocator {
+ public:
+  bool IsAllocThreadSafe() const override { return true; }
+
+  size_t AllocatedSize() const { return allocated_size_; }
+  size_t AllocTimes() const { return alloc_times_; }
+
+ protected:
+  phi::Allocation *AllocateImpl(size_t size) override {
+    allocated_size_ += size;
+    ++alloc_times_;
+    return new Allocation(malloc(size), size, platform::CPUPlace());  // NOLINT
+  }
+
+  void FreeImpl(phi::Allocation *allocation) override {
+    allocated_size_ -= allocation->size();
+    free(allocation->ptr());  // NOLINT
+    delete allocation;
+  }
+
+ private:
+  std::atomic<size_t> allocated_size_{0};
+  std::atomic<size_t> alloc_times_{0};
+};
+
+TEST(ThreadCachedCPUAllocator, size_class) {
+  auto counted_allocator = std::make_shared<CountedAllocator>();
+  ThreadCachedCPUAllocator allocator(counted_allocator, 1 << 20, 1 << 24, 0);
+  ASSERT_EQ(allocator.SizeClassOf(1), 256UL);
+  ASSERT_EQ(allocator.SizeClassOf(256), 256UL);
+  ASSERT_EQ(allocator.SizeClassOf(257), 320UL);
+  ASSERT_EQ(allocator.SizeClassOf(1000), 1024UL);
+  ASSERT_EQ(allocator.SizeClassOf(1 << 20), 1UL << 20);
+  ASSERT_EQ(allocator.SizeClassOf((1 << 20) + 1), 0UL);
+}
+
+TEST(ThreadCachedCPUAllocator, reuse_and_release) {
+  auto counted_allocator = std::make_shared<CountedAllocator>();
+  auto allocator = std::make_shared<ThreadCachedCPUAllocator>(
+      counted_allocator, 1 << 20, 1 << 24, 1 << 24);
+
+  for (size_t i = 0; i < 10; ++i) {
+    auto allocation = allocator->Allocate(1000);
+    ASSERT_EQ(allocation->size(), 1000UL);
+    ASSERT_NE(allocation->ptr(), nullptr);
+  }
+  // the freed block is reused by the same thread
+  ASSERT_EQ(counted_allocator->AllocTimes(), 1UL);
+  ASSERT_EQ(counted_allocator->AllocatedSize(), 1024UL);
+
+  // large blocks bypass the cache
+  {
+    auto allocation = allocator->Allocate((1 << 20) + 1);
+    ASSERT_EQ(counted_allocator->AllocatedSize(), 1024UL + (1 << 20) + 1);
+  }
+  ASSERT_EQ(counted_allocator->AllocatedSize(), 1024UL);
+
+  ASSERT_EQ(allocator->Release(platform::CPUPlace()), 1024UL);
+  ASSERT_EQ(counted_allocator->AllocatedSize(), 0UL);
+}
+
+TEST(ThreadCachedCPUAllocator, cross_thread_free) {
+  auto counted_allocator = std::make_shared<CountedAllocator>();
+  auto allocator = std::make_shared<ThreadCachedCPUAllocator>(
+      counted_allocator, 1 << 20, 1 << 24, 1 << 24);
+
+  const size_t kNum = 64;
+  std::vector<AllocationPtr> allocations;
+  std::thread producer([&] {
+    for (size_t i = 0; i < kNum; ++i) {
+      allocations.emplace_back(allocator->Allocate(4096));
+    }
+  });
+  producer.join();
+  ASSERT_EQ(counted_allocator->AllocTimes(), kNum);
+
+  // freed on another thread, and flushed to the central list when that
+  // thread exits
+  std::thread consumer([&] { allocations.clear(); });
+  consumer.join();
+  ASSERT_EQ(counted_allocator->AllocatedSize(), kNum * 4096);
+
+  std::thread reuser([&] {
+    for (size_t i = 0; i < kNum; ++i) {
+      allocations.emplace_back(allocator->Allocate(4000));
+    }
+    allocations.clear();
+  });
+  reuser.join();
+  ASSERT_EQ(counted_allocator->AllocTimes(), kNum);
+
+  allocator->Release(platform::CPUPlace());
+  ASSERT_EQ(counted_allocator->AllocatedSize(), 0UL);
+}
+
+TEST(ThreadCachedCPUAllocator, bounded_thread_cache) {
+  auto counted_allocator = std::make_shared<CountedAllocator>();
+  // neither the thread cache nor the central list can hold all blocks
+  auto allocator = std::make_shared<ThreadCachedCPUAllocator>(
+      counted_allocator, 1 << 20, 64 << 10, 64 << 10);
+
+  std::vector<AllocationPtr> allocations;
+  for (size_t i = 0; i < 100; ++i) {
+    allocations.emplace_back(allocator->Allocate(4096));
+  }
+  allocations.clear();
+  ASSERT_LE(counted_allocator->AllocatedSize(), 128UL << 10);
+
+  allocator->Release(platform::CPUPlace());
+  ASSERT_EQ(counted_allocator->AllocatedSize(), 0UL);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
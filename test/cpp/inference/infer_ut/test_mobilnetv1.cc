@@ -77,6 +77,90 @@ TEST(tensorrt_tester_mobilenetv1, tuned_dynamic_trt_fp32_bz2) {
   VLOG(1) << "finish test";
 }
 
+TEST(cpu_tester_mobilenetv1, dynamic_batcher_thread16_bz1) {
+  int thread_num = 16;
+  int repeat_times = 20;
+  size_t pool_size = 2;
+
+  // init input data
+  std::map<std::string, paddle::test::Record> my_input_data_map;
+  my_input_data_map["x"] = PrepareInput(1);
+  // init output data
+  std::map<std::string, paddle::test::Record> truth_output_data;
+  // prepare inference config
+  paddle_infer::Config config;
+  config.SetModel(FLAGS_modeldir + "/inference.pdmodel",
+                  FLAGS_modeldir + "/inference.pdiparams");
+  config.DisableGpu();
+  config.SetCpuMathLibraryNumThreads(1);
+  services::PredictorPool pred_pool(config, pool_size);
+  SingleThreadPrediction(
+      pred_pool.Retrieve(0), &my_input_data_map, &truth_output_data, 1);
+
+  // baseline: each predictor of the pool runs batch 1 in its own thread
+  int request_num = thread_num * repeat_times;
+  std::vector<std::future<double>> profiles;
+  for (size_t i = 0; i < pool_size; ++i) {
+    profiles.push_back(std::async(std::launch::async,
+                                  paddle::test::SingleThreadProfile,
+                                  pred_pool.Retrieve(i),
+                                  &my_input_data_map,
+                                  request_num / pool_size));
+  }
+  double baseline_ms = 0;
+  for (auto& profile : profiles) {
+    baseline_ms = std::max(baseline_ms, profile.get());
+  }
+
+  // load generator: every thread sends requests of batch 1
+  auto& input_record = my_input_data_map["x"];
+  paddle::PaddleTensor input;
+  input.name = "x";
+  input.shape = input_record.shape;
+  input.dtype = paddle::PaddleDType::FLOAT32;
+  input.data.Reset(input_record.data.data(),
+                   input_record.data.size() * sizeof(float));
+
+  services::DynamicBatcherOptions options;
+  options.max_batch_size = 8;
+  options.max_queue_delay_us = 2000;
+  services::DynamicBatcher batcher(&pred_pool, options);
+  std::vector<std::map<std::string, paddle::test::Record>> infer_output_data(
+      thread_num);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_num; ++i) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < repeat_times; ++j) {
+        std::vector<paddle::PaddleTensor> outputs;
+        ASSERT_TRUE(batcher.Run({input}, &outputs));
+        for (auto& output : outputs) {
+          ASSERT_EQ(output.dtype, paddle::PaddleDType::FLOAT32);
+          auto* data = static_cast<float*>(output.data.data());
+          auto& record = infer_output_data[i][output.name];
+          record.data.assign(data,
+                             data + output.data.length() / sizeof(float));
+          record.shape = output.shape;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < thread_num; ++i) {
+    threads[i].join();
+    // batched kernels may accumulate in another order
+    CompareRecord(&truth_output_data, &infer_output_data[i], 1e-4);
+  }
+
+  auto stats = batcher.GetStats();
+  EXPECT_EQ(stats.request_num, static_cast<uint64_t>(request_num));
+  LOG(INFO) << "dynamic batcher: " << stats.batch_num << " batches, "
+            << stats.avg_batch_requests << " requests per batch, latency avg "
+            << stats.avg_latency_us << " us, p50 " << stats.p50_latency_us
+            << " us, p99 " << stats.p99_latency_us << " us, throughput "
+            << stats.throughput << " requests/s";
+  LOG(INFO) << "unbatched throughput " << request_num * 1000.0 / baseline_ms
+            << " requests/s";
+}
+
 }  // namespace paddle_infer
 
 int main(int argc, char** argv) {
@@ -39,6 +39,9 @@
 
 DECLARE_FILE_SYMBOLS(kernel_dialect);
 
+COMMON_DECLARE_bool(enable_pir_in_executor_trace_run);
+COMMON_DECLARE_bool(pir_interpreter_static_memory_plan);
+
 PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(full_int_array, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(uniform, CPU, ALL_LAYOUT);
@@ -219,6 +222,86 @@ TEST(StandaloneExecutor, run_inplace_sqrt) {
   EXPECT_EQ(res3, true);
 }
 
+TEST(StandaloneExecutor, run_with_static_memory_plan) {
+  FLAGS_enable_pir_in_executor_trace_run = true;
+  FLAGS_pir_interpreter_static_memory_plan = true;
+
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  pir::Program program((ctx));
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  // large enough that the arena alignment does not dominate the sizes
+  const std::vector<int64_t> shape{64, 64};
+  const size_t tensor_bytes = 64 * 64 * sizeof(float);
+  paddle::dialect::FullOp x = builder.Build<paddle::dialect::FullOp>(
+      shape, 4.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  paddle::dialect::FullOp y = builder.Build<paddle::dialect::FullOp>(
+      shape, 5.0, phi::DataType::FLOAT32, phi::CPUPlace());
+  auto add1 = builder.Build<paddle::dialect::AddOp>(x->result(0), y->result(0));
+  auto sqrt = builder.Build<paddle::dialect::SqrtOp>(add1->result(0));
+  auto add2 =
+      builder.Build<paddle::dialect::AddOp>(sqrt->result(0), x->result(0));
+
+  std::string out_name = "add_out";
+  builder.Build<pir::ShadowOutputOp>(add2->result(0), out_name);
+
+  auto kernel_program = paddle::dialect::PdOpLowerToKernelPass(&program);
+
+  auto place = platform::CPUPlace();
+  Scope scope;
+  InterpreterCore test_core(place, {}, kernel_program->block(), &scope);
+
+  test_core.SetSkipGcVars({out_name});
+
+  // the first run profiles, the others run with the planned arena
+  for (int i = 0; i < 3; ++i) {
+    test_core.Run({});
+
+    auto out_tensor =
+        test_core.local_scope() == nullptr
+            ? scope.FindVar(out_name)->Get<phi::DenseTensor>()
+            : test_core.local_scope()
+                  ->FindVar(out_name)
+                  ->Get<phi::DenseTensor>();
+    for (int64_t j = 0; j < out_tensor.numel(); ++j) {
+      EXPECT_TRUE(simple_cmp(out_tensor.data<float>()[j], 7.0));
+    }
+  }
+  FLAGS_enable_pir_in_executor_trace_run = false;
+  FLAGS_pir_interpreter_static_memory_plan = false;
+
+  // y is dead when sqrt writes its output, so they share the arena
+  auto* impl = dynamic_cast<const PirInterpreter*>(test_core.Impl());
+  ASSERT_NE(impl, nullptr);
+  const auto* planner = impl->MemoryPlanner();
+  ASSERT_NE(planner, nullptr);
+  EXPECT_FALSE(planner->IsProfiling());
+  EXPECT_GT(planner->PlannedVarNum(), 0u);
+  EXPECT_LT(planner->ArenaSize(), planner->PlannedVarNum() * tensor_bytes);
+}
+
+TEST(StaticMemoryPlanner, AssignMemoryOffsets) {
+  // a: [0, 2], b: [1, 3], c: [3, 4], d: [4, 5]
+  std::vector<interpreter::MemoryBlock> blocks = {
+      {0, 2, 100}, {1, 3, 300}, {3, 4, 200}, {4, 5, 400}};
+  size_t arena_size = interpreter::AssignMemoryOffsets(&blocks, 64);
+
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    EXPECT_EQ(blocks[i].offset % 64, 0u);
+    EXPECT_LE(blocks[i].offset + blocks[i].size, arena_size);
+    for (size_t j = i + 1; j < blocks.size(); ++j) {
+      bool live_together = blocks[i].first_step <= blocks[j].last_step &&
+                           blocks[j].first_step <= blocks[i].last_step;
+      bool overlap = blocks[i].offset < blocks[j].offset + blocks[j].size &&
+                     blocks[j].offset < blocks[i].offset + blocks[i].size;
+      EXPECT_FALSE(live_together && overlap) << i << " " << j;
+    }
+  }
+  // as large as c and d, which are alive at step 4, the largest peak
+  EXPECT_EQ(arena_size, 704u);
+}
+
 TEST(StandaloneExecutor, if_op) {
   pir::IrContext* ctx = pir::IrContext::Instance();
   ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
@@ -48,6 +48,33 @@ TEST(KernelFactory, SelectedKernelMap) {
   }
 }
 
+TEST(KernelFactory, SelectKernelByInternedName) {
+  auto& factory = phi::KernelFactory::Instance();
+  phi::KernelNameId scale_id = phi::KernelFactory::InternKernelName("scale");
+  EXPECT_EQ(phi::KernelFactory::InternKernelName("scale"), scale_id);
+  EXPECT_EQ(phi::KernelFactory::GetKernelName(scale_id), "scale");
+
+  phi::KernelKey kernel_key(
+      phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT32);
+  auto by_name = factory.SelectKernelOrThrowError("scale", kernel_key);
+  auto by_id = factory.SelectKernelOrThrowError(scale_id, kernel_key);
+  auto cached = factory.SelectKernelOrThrowError(scale_id, kernel_key);
+  EXPECT_EQ(&by_id.kernel, &by_name.kernel);
+  EXPECT_EQ(&cached.kernel, &by_name.kernel);
+  EXPECT_EQ(cached.has_fallback_cpu, by_name.has_fallback_cpu);
+
+  // Registering a kernel invalidates the cached selections.
+  phi::KernelNameId test_id =
+      phi::KernelFactory::InternKernelName("interned_name_test");
+  EXPECT_ANY_THROW(factory.SelectKernelOrThrowError(test_id, kernel_key));
+  factory.kernels()["interned_name_test"][kernel_key] = by_name.kernel;
+  auto registered = factory.SelectKernelOrThrowError(test_id, kernel_key);
+  EXPECT_EQ(&registered.kernel,
+            &factory.kernels()["interned_name_test"][kernel_key]);
+  factory.kernels().erase("interned_name_test");
+  EXPECT_ANY_THROW(factory.SelectKernelOrThrowError(test_id, kernel_key));
+}
+
 template <typename T, typename Context>
 void TestKernel(const Context& dev_ctx,
                 const DenseTensor& x,
@@ -0,0 +1,314 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/selected_rows.h"
+#include "paddle/phi/kernels/adagrad_kernel.h"
+#include "paddle/phi/kernels/selected_rows/adamw_kernel.h"
+#include "paddle/phi/kernels/selected_rows/lamb_kernel.h"
+
+namespace phi {
+namespace tests {
+
+constexpr int64_t kHeight = 10;
+constexpr int64_t kWidth = 5;
+constexpr float kTolerance = 1e-5f;
+
+const phi::CPUContext& GetCPUContext() {
+  return *phi::DeviceContextPool::Instance().GetByPlace(phi::CPUPlace());
+}
+
+void FillTensor(const std::vector<int64_t>& dims,
+                const std::vector<float>& values,
+                DenseTensor* tensor) {
+  tensor->Resize(common::make_ddim(dims));
+  float* data = GetCPUContext().template Alloc<float>(tensor);
+  for (size_t i = 0; i < values.size(); ++i) {
+    data[i] = values[i];
+  }
+}
+
+std::vector<float> ToVector(const DenseTensor& tensor) {
+  const float* data = tensor.data<float>();
+  return std::vector<float>(data, data + tensor.numel());
+}
+
+std::vector<float> MakeValues(int64_t numel, float scale, float bias) {
+  std::vector<float> values(numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    values[i] = scale * static_cast<float>(i % 7) + bias;
+  }
+  return values;
+}
+
+// A gradient with duplicated and unsorted rows, and the rows of param that
+// it touches after merging.
+void MakeGrad(SelectedRows* grad,
+              std::map<int64_t, std::vector<float>>* rows) {
+  std::vector<int64_t> grad_rows{3, 1, 3, 7};
+  grad->set_rows(grad_rows);
+  grad->set_height(kHeight);
+  int64_t numel = static_cast<int64_t>(grad_rows.size()) * kWidth;
+  std::vector<float> values(numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    values[i] = 0.05f * static_cast<float>(i % 9) - 0.2f;
+  }
+  FillTensor({static_cast<int64_t>(grad_rows.size()), kWidth},
+             values,
+             grad->mutable_value());
+  for (size_t i = 0; i < grad_rows.size(); ++i) {
+    auto& row = (*rows)[grad_rows[i]];
+    row.resize(kWidth, 0.0f);
+    for (int64_t j = 0; j < kWidth; ++j) {
+      row[j] += values[i * kWidth + j];
+    }
+  }
+}
+
+void ExpectNear(const std::vector<float>& expected,
+                const std::vector<float>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(expected[i], actual[i], kTolerance) << "at " << i;
+  }
+}
+
+void TestAdamW(bool lazy_mode) {
+  const auto& dev_ctx = GetCPUContext();
+  const int64_t numel = kHeight * kWidth;
+  const float lr = 0.01f, beta1 = 0.9f, beta2 = 0.999f, epsilon = 1e-8f;
+  const float b1p = 0.81f, b2p = 0.998f, lr_ratio = 1.0f, coeff = 0.1f;
+
+  auto param_v = MakeValues(numel, 0.1f, -0.3f);
+  auto mom1_v = MakeValues(numel, 0.01f, 0.0f);
+  auto mom2_v = MakeValues(numel, 0.02f, 0.01f);
+
+  DenseTensor param, mom1, mom2, lr_t, b1p_t, b2p_t;
+  FillTensor({kHeight, kWidth}, param_v, &param);
+  FillTensor({kHeight, kWidth}, mom1_v, &mom1);
+  FillTensor({kHeight, kWidth}, mom2_v, &mom2);
+  FillTensor({1}, {lr}, &lr_t);
+  FillTensor({1}, {b1p}, &b1p_t);
+  FillTensor({1}, {b2p}, &b2p_t);
+
+  SelectedRows grad;
+  std::map<int64_t, std::vector<float>> merged;
+  MakeGrad(&grad, &merged);
+
+  // The untouched rows of the outputs keep their values, as if the kernel
+  // ran in place.
+  DenseTensor param_out, mom1_out, mom2_out, b1p_out, b2p_out;
+  FillTensor({kHeight, kWidth}, param_v, &param_out);
+  FillTensor({kHeight, kWidth}, mom1_v, &mom1_out);
+  FillTensor({kHeight, kWidth}, mom2_v, &mom2_out);
+  FillTensor({1}, {b1p}, &b1p_out);
+  FillTensor({1}, {b2p}, &b2p_out);
+
+  phi::sr::AdamwDenseParamSparseGradKernel<float, phi::CPUContext>(
+      dev_ctx,
+      param,
+      grad,
+      lr_t,
+      mom1,
+      mom2,
+      b1p_t,
+      b2p_t,
+      paddle::none,
+      paddle::none,
+      beta1,
+      beta2,
+      epsilon,
+      lr_ratio,
+      coeff,
+      true,
+      lazy_mode,
+      1000,
+      false,
+      false,
+      &param_out,
+      &mom1_out,
+      &mom2_out,
+      &b1p_out,
+      &b2p_out,
+      nullptr);
+
+  // In lazy_mode the rows without gradient are neither updated nor decayed,
+  // otherwise they are decayed and updated with a zero gradient.
+  std::vector<float> expected_param = param_v;
+  std::vector<float> expected_mom1 = mom1_v;
+  std::vector<float> expected_mom2 = mom2_v;
+  const float lr_t_value = lr * std::sqrt(1 - b2p) / (1 - b1p);
+  const float eps_t = epsilon * std::sqrt(1 - b2p);
+  for (int64_t row = 0; row < kHeight; ++row) {
+    auto it = merged.find(row);
+    if (lazy_mode && it == merged.end()) continue;
+    for (int64_t j = 0; j < kWidth; ++j) {
+      int64_t i = row * kWidth + j;
+      float g = it == merged.end() ? 0.0f : it->second[j];
+      float p = param_v[i] - lr * lr_ratio * coeff * param_v[i];
+      float m1 = beta1 * mom1_v[i] + (1 - beta1) * g;
+      float m2 = beta2 * mom2_v[i] + (1 - beta2) * g * g;
+      expected_mom1[i] = m1;
+      expected_mom2[i] = m2;
+      expected_param[i] = p - lr_t_value * m1 / (std::sqrt(m2) + eps_t);
+    }
+  }
+
+  ExpectNear(expected_param, ToVector(param_out));
+  ExpectNear(expected_mom1, ToVector(mom1_out));
+  ExpectNear(expected_mom2, ToVector(mom2_out));
+  EXPECT_NEAR(b1p * beta1, b1p_out.data<float>()[0], kTolerance);
+  EXPECT_NEAR(b2p * beta2, b2p_out.data<float>()[0], kTolerance);
+}
+
+TEST(SelectedRowsOptimizer, AdamWLazyMode) { TestAdamW(true); }
+
+TEST(SelectedRowsOptimizer, AdamW) { TestAdamW(false); }
+
+TEST(SelectedRowsOptimizer, Adagrad) {
+  const auto& dev_ctx = GetCPUContext();
+  const int64_t numel = kHeight * kWidth;
+  const float lr = 0.01f, epsilon = 1e-6f;
+
+  auto param_v = MakeValues(numel, 0.1f, -0.3f);
+  auto moment_v = MakeValues(numel, 0.02f, 0.01f);
+
+  DenseTensor param, moment, lr_t;
+  FillTensor({kHeight, kWidth}, param_v, &param);
+  FillTensor({kHeight, kWidth}, moment_v, &moment);
+  FillTensor({1}, {lr}, &lr_t);
+
+  SelectedRows grad;
+  std::map<int64_t, std::vector<float>> merged;
+  MakeGrad(&grad, &merged);
+
+  // The sparse kernel only runs in place.
+  phi::AdagradSparseKernel<float, phi::CPUContext>(dev_ctx,
+                                                   param,
+                                                   grad,
+                                                   moment,
+                                                   lr_t,
+                                                   paddle::none,
+                                                   epsilon,
+                                                   false,
+                                                   &param,
+                                                   &moment,
+                                                   nullptr);
+
+  std::vector<float> expected_param = param_v;
+  std::vector<float> expected_moment = moment_v;
+  for (const auto& item : merged) {
+    for (int64_t j = 0; j < kWidth; ++j) {
+      int64_t i = item.first * kWidth + j;
+      float g = item.second[j];
+      expected_moment[i] += g * g;
+      expected_param[i] -= lr * g / (std::sqrt(expected_moment[i]) + epsilon);
+    }
+  }
+
+  ExpectNear(expected_param, ToVector(param));
+  ExpectNear(expected_moment, ToVector(moment));
+}
+
+TEST(SelectedRowsOptimizer, Lamb) {
+  const auto& dev_ctx = GetCPUContext();
+  const int64_t numel = kHeight * kWidth;
+  const float lr = 0.01f, beta1 = 0.9f, beta2 = 0.999f, epsilon = 1e-6f;
+  const float b1p = 0.81f, b2p = 0.998f, weight_decay = 0.01f;
+
+  auto param_v = MakeValues(numel, 0.1f, -0.3f);
+  auto mom1_v = MakeValues(numel, 0.01f, 0.0f);
+  auto mom2_v = MakeValues(numel, 0.02f, 0.01f);
+
+  DenseTensor param, mom1, mom2, lr_t, b1p_t, b2p_t;
+  FillTensor({kHeight, kWidth}, param_v, &param);
+  FillTensor({kHeight, kWidth}, mom1_v, &mom1);
+  FillTensor({kHeight, kWidth}, mom2_v, &mom2);
+  FillTensor({1}, {lr}, &lr_t);
+  FillTensor({1}, {b1p}, &b1p_t);
+  FillTensor({1}, {b2p}, &b2p_t);
+
+  SelectedRows grad;
+  std::map<int64_t, std::vector<float>> merged;
+  MakeGrad(&grad, &merged);
+
+  DenseTensor param_out, mom1_out, mom2_out, b1p_out, b2p_out;
+  param_out.Resize(param.dims());
+  mom1_out.Resize(mom1.dims());
+  mom2_out.Resize(mom2.dims());
+  b1p_out.Resize(b1p_t.dims());
+  b2p_out.Resize(b2p_t.dims());
+
+  phi::sr::LambKernel<float, phi::CPUContext>(dev_ctx,
+                                              param,
+                                              grad,
+                                              lr_t,
+                                              mom1,
+                                              mom2,
+                                              b1p_t,
+                                              b2p_t,
+                                              paddle::none,
+                                              paddle::none,
+                                              weight_decay,
+                                              beta1,
+                                              beta2,
+                                              epsilon,
+                                              false,
+                                              false,
+                                              &param_out,
+                                              &mom1_out,
+                                              &mom2_out,
+                                              &b1p_out,
+                                              &b2p_out,
+                                              nullptr);
+
+  // Every row is updated, the rows without gradient with a zero gradient.
+  std::vector<float> expected_mom1(numel), expected_mom2(numel);
+  std::vector<float> trust_ratio_div(numel);
+  double p_norm = 0, t_norm = 0;
+  for (int64_t i = 0; i < numel; ++i) {
+    auto it = merged.find(i / kWidth);
+    float g = it == merged.end() ? 0.0f : it->second[i % kWidth];
+    float m1 = beta1 * mom1_v[i] + (1 - beta1) * g;
+    float m2 = beta2 * mom2_v[i] + (1 - beta2) * g * g;
+    expected_mom1[i] = m1;
+    expected_mom2[i] = m2;
+    trust_ratio_div[i] =
+        (m1 / (1 - b1p)) / (std::sqrt(m2 / (1 - b2p)) + epsilon) +
+        weight_decay * param_v[i];
+    p_norm += param_v[i] * param_v[i];
+    t_norm += trust_ratio_div[i] * trust_ratio_div[i];
+  }
+  float ratio = static_cast<float>(std::sqrt(p_norm) / std::sqrt(t_norm));
+  std::vector<float> expected_param(numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    expected_param[i] = param_v[i] - lr * ratio * trust_ratio_div[i];
+  }
+
+  ExpectNear(expected_param, ToVector(param_out));
+  ExpectNear(expected_mom1, ToVector(mom1_out));
+  ExpectNear(expected_mom2, ToVector(mom2_out));
+  EXPECT_NEAR(b1p * beta1, b1p_out.data<float>()[0], kTolerance);
+  EXPECT_NEAR(b2p * beta2, b2p_out.data<float>()[0], kTolerance);
+}
+
+}  // namespace tests
+}  // namespace phi
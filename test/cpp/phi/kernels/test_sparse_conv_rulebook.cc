@@ -0,0 +1,237 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/backends/dynload/port.h"
+#include "paddle/phi/kernels/sparse/cpu/conv.h"
+
+namespace phi {
+namespace tests {
+
+inline double GetCurrentUS() {
+  struct timeval time;
+  gettimeofday(&time, nullptr);
+  return 1e+6 * time.tv_sec + time.tv_usec;  // NOLINT
+}
+
+// The serial rulebook construction with ordered sets, used as reference.
+void RefRuleBook(const std::vector<int>& indices,
+                 int nnz,
+                 const sparse::Dims4D& x_dims,
+                 const sparse::Dims4D& out_dims,
+                 const std::vector<int>& kernel_sizes,
+                 const std::vector<int>& paddings,
+                 const std::vector<int>& strides,
+                 bool subm,
+                 std::vector<int>* rules,
+                 std::vector<int>* out_points) {
+  const sparse::Dims4D kernel_dims(
+      1, kernel_sizes[2], kernel_sizes[1], kernel_sizes[0]);
+  const sparse::Dims4D pads(1, paddings[2], paddings[1], paddings[0]);
+  const sparse::Dims4D dilations(1, 1, 1, 1);
+  const sparse::Dims4D stride_dims(1, strides[2], strides[1], strides[0]);
+  std::set<int> hash_in;
+  for (int i = 0; i < nnz; i++) {
+    hash_in.insert(phi::funcs::sparse::PointToIndex<sparse::Dims4D>(
+        indices[i],
+        indices[i + 3 * nnz],
+        indices[i + 2 * nnz],
+        indices[i + nnz],
+        x_dims));
+  }
+  std::vector<int> kernel_row, in_row, out_row;
+  int kernel_index = 0;
+  for (int kz = 0; kz < kernel_sizes[0]; kz++) {
+    for (int ky = 0; ky < kernel_sizes[1]; ky++) {
+      for (int kx = 0; kx < kernel_sizes[2]; kx++, kernel_index++) {
+        for (int i = 0; i < nnz; i++) {
+          int z = indices[i + nnz], y = indices[i + 2 * nnz],
+              x = indices[i + 3 * nnz];
+          if (!phi::funcs::sparse::Check(x_dims,
+                                         kernel_dims,
+                                         pads,
+                                         dilations,
+                                         stride_dims,
+                                         x,
+                                         y,
+                                         z,
+                                         kx,
+                                         ky,
+                                         kz)) {
+            continue;
+          }
+          int out_index = phi::funcs::sparse::PointToIndex<sparse::Dims4D>(
+              indices[i],
+              (x + pads[3] - kx) / stride_dims[3],
+              (y + pads[2] - ky) / stride_dims[2],
+              (z + paddings[0] - kz) / strides[0],
+              out_dims);
+          if (subm && hash_in.find(out_index) == hash_in.end()) {
+            continue;
+          }
+          kernel_row.push_back(kernel_index);
+          in_row.push_back(i);
+          out_row.push_back(out_index);
+        }
+      }
+    }
+  }
+  std::set<int> out_indexs(out_row.begin(), out_row.end());
+  for (auto& out_index : out_row) {
+    out_index = std::distance(out_indexs.begin(), out_indexs.find(out_index));
+  }
+  rules->clear();
+  rules->insert(rules->end(), kernel_row.begin(), kernel_row.end());
+  rules->insert(rules->end(), in_row.begin(), in_row.end());
+  rules->insert(rules->end(), out_row.begin(), out_row.end());
+  out_points->assign(out_indexs.begin(), out_indexs.end());
+}
+
+// A voxelized lidar like scene: points clustered on a few surfaces of a
+// (41, 400, 352) grid.
+SparseCooTensor RandomVoxels(const CPUContext& dev_ctx,
+                             int nnz,
+                             const DDim& dims) {
+  std::mt19937 rng(100);
+  std::set<std::vector<int>> points;
+  while (static_cast<int>(points.size()) < nnz) {
+    int cluster_z = rng() % dims[1];
+    int cluster_y = rng() % dims[2];
+    int cluster_x = rng() % dims[3];
+    for (int j = 0; j < 64 && static_cast<int>(points.size()) < nnz; j++) {
+      int z = std::min<int>(dims[1] - 1, cluster_z + rng() % 3);
+      int y = std::min<int>(dims[2] - 1, cluster_y + rng() % 8);
+      int x = std::min<int>(dims[3] - 1, cluster_x + rng() % 8);
+      points.insert({0, z, y, x});
+    }
+  }
+  DenseTensor indices = phi::Empty(
+      dev_ctx, DenseTensorMeta(DataType::INT32, {4, nnz}, DataLayout::NCHW));
+  DenseTensor values = phi::Empty(
+      dev_ctx, DenseTensorMeta(DataType::FLOAT32, {nnz, 1}, DataLayout::NCHW));
+  int* indices_ptr = indices.data<int>();
+  int i = 0;
+  for (auto& point : points) {
+    for (int d = 0; d < 4; d++) {
+      indices_ptr[i + d * nnz] = point[d];
+    }
+    ++i;
+  }
+  return SparseCooTensor(indices, values, dims);
+}
+
+void TestRuleBook(bool subm) {
+  auto& pool = phi::DeviceContextPool::Instance();
+  auto* dev_ctx = static_cast<CPUContext*>(pool.Get(phi::CPUPlace()));
+  const int nnz = 20000;
+  DDim x_dims = common::make_ddim({1, 41, 400, 352, 1});
+  SparseCooTensor x = RandomVoxels(*dev_ctx, nnz, x_dims);
+
+  std::vector<int> kernel_sizes = {3, 3, 3, 1, 16};
+  std::vector<int> paddings = {1, 1, 1};
+  std::vector<int> dilations = {1, 1, 1};
+  std::vector<int> strides = {1, 1, 1};
+  if (!subm) {
+    strides = {2, 2, 2};
+  }
+  DDim out_dims = common::make_ddim({1, 1, 1, 1, 1});
+  phi::funcs::sparse::GetOutShape(
+      x_dims, kernel_sizes, paddings, dilations, strides, &out_dims);
+
+  const int kernel_size = 27;
+  std::vector<int> counter(kernel_size);
+  DenseTensor rulebook;
+  SparseCooTensor out;
+  auto start = GetCurrentUS();
+  sparse::ProductRuleBook<float, CPUContext, int>(*dev_ctx,
+                                                  x,
+                                                  kernel_sizes,
+                                                  paddings,
+                                                  dilations,
+                                                  strides,
+                                                  out_dims,
+                                                  subm,
+                                                  &rulebook,
+                                                  counter.data());
+  sparse::UpdateRulebookAndOutIndex<float, CPUContext, int>(
+      *dev_ctx, x, kernel_size, 16, out_dims, &rulebook, &out);
+  auto rulebook_time = GetCurrentUS() - start;
+
+  std::vector<int> indices(x.indices().data<int>(),
+                           x.indices().data<int>() + 4 * nnz);
+  std::vector<int> ref_rules, ref_out_points;
+  start = GetCurrentUS();
+  const sparse::Dims4D c_x_dims(x_dims[0], x_dims[3], x_dims[2], x_dims[1]);
+  const sparse::Dims4D c_out_dims(
+      out_dims[0], out_dims[3], out_dims[2], out_dims[1]);
+  RefRuleBook(indices,
+              nnz,
+              c_x_dims,
+              c_out_dims,
+              kernel_sizes,
+              paddings,
+              strides,
+              subm,
+              &ref_rules,
+              &ref_out_points);
+  auto ref_time = GetCurrentUS() - start;
+  VLOG(3) << "subm: " << subm << " rules: " << rulebook.dims()[1]
+          << " rulebook: " << rulebook_time << " us, ref: " << ref_time
+          << " us";
+
+  ASSERT_EQ(rulebook.numel(), static_cast<int64_t>(ref_rules.size()));
+  const int* rulebook_ptr = rulebook.data<int>();
+  for (size_t i = 0; i < ref_rules.size(); i++) {
+    ASSERT_EQ(rulebook_ptr[i], ref_rules[i]);
+  }
+  ASSERT_EQ(out.nnz(), static_cast<int64_t>(ref_out_points.size()));
+}
+
+TEST(SparseConvRuleBook, subm) { TestRuleBook(true); }
+
+TEST(SparseConvRuleBook, strided) { TestRuleBook(false); }
+
+TEST(SparseConvRuleBook, scatter) {
+  const int n = 50000, channels = 16, out_rows = 3000;
+  std::mt19937 rng(100);
+  std::vector<int> indexs(n);
+  std::vector<float> x(n * channels);
+  for (int i = 0; i < n; i++) {
+    indexs[i] = rng() % out_rows;
+  }
+  for (auto& v : x) {
+    v = static_cast<float>(rng() % 100) / 10.f;
+  }
+  std::vector<float> out(out_rows * channels, 0.f);
+  std::vector<float> ref(out_rows * channels, 0.f);
+  sparse::Scatter<float, int>(x.data(), indexs.data(), n, channels, out.data());
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < channels; j++) {
+      ref[indexs[i] * channels + j] += x[i * channels + j];
+    }
+  }
+  // accumulated in the same order, so results are bitwise equal
+  for (size_t i = 0; i < ref.size(); i++) {
+    ASSERT_EQ(out[i], ref[i]);
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,203 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <sys/time.h>
+
+#include <sstream>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/kernels/funcs/strided_copy_utils.h"
+
+namespace phi {
+namespace tests {
+
+inline double GetCurrentUS() {
+  struct timeval time;
+  gettimeofday(&time, nullptr);
+  return 1e+6 * time.tv_sec + time.tv_usec;  // NOLINT
+}
+
+std::vector<int64_t> ContiguousStrides(const std::vector<int64_t>& dims) {
+  std::vector<int64_t> strides(dims.size(), 1);
+  for (int i = static_cast<int>(dims.size()) - 2; i >= 0; --i) {
+    strides[i] = strides[i + 1] * dims[i + 1];
+  }
+  return strides;
+}
+
+// The per element div/mod copy, used as reference.
+template <typename T>
+void RefStridedCopy(const T* in,
+                    const std::vector<int64_t>& in_strides,
+                    T* out,
+                    const std::vector<int64_t>& out_strides,
+                    const std::vector<int64_t>& dims) {
+  int64_t numel = 1;
+  for (auto d : dims) {
+    numel *= d;
+  }
+  int rank = static_cast<int>(dims.size());
+  for (int64_t i = 0; i < numel; i++) {
+    int64_t in_offset = 0, out_offset = 0;
+    int64_t index_tmp = i;
+    for (int dim = rank - 1; dim >= 0; --dim) {
+      in_offset += (index_tmp % dims[dim]) * in_strides[dim];
+      out_offset += (index_tmp % dims[dim]) * out_strides[dim];
+      index_tmp = index_tmp / dims[dim];
+    }
+    out[out_offset] = in[in_offset];
+  }
+}
+
+// Copies the view of a contiguous tensor of src_dims, permuted by perm, to
+// a contiguous tensor, as contiguous() does after transpose.
+template <typename T>
+void TestPermute(const std::vector<int64_t>& src_dims,
+                 const std::vector<int>& perm) {
+  std::vector<int64_t> src_strides = ContiguousStrides(src_dims);
+  std::vector<int64_t> dims, in_strides;
+  int64_t numel = 1;
+  for (auto p : perm) {
+    dims.push_back(src_dims[p]);
+    in_strides.push_back(src_strides[p]);
+    numel *= src_dims[p];
+  }
+  std::vector<int64_t> out_strides = ContiguousStrides(dims);
+
+  std::vector<T> in(numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    in[i] = static_cast<T>(i % 251);
+  }
+  std::vector<T> out(numel), ref(numel);
+
+  funcs::StridedCopyPlan plan(static_cast<int>(dims.size()),
+                              dims.data(),
+                              in_strides.data(),
+                              out_strides.data());
+  auto start = GetCurrentUS();
+  plan.Run(in.data(), out.data());
+  auto copy_time = GetCurrentUS() - start;
+  start = GetCurrentUS();
+  RefStridedCopy(in.data(), in_strides, ref.data(), out_strides, dims);
+  auto ref_time = GetCurrentUS() - start;
+
+  std::stringstream ss;
+  for (auto p : perm) {
+    ss << p << " ";
+  }
+  VLOG(3) << "perm: " << ss.str() << "numel: " << numel
+          << " rank: " << plan.rank() << " tiled: " << plan.tiled()
+          << " copy: " << copy_time << " us, ref: " << ref_time << " us";
+  ASSERT_EQ(out, ref);
+}
+
+TEST(StridedCopy, identity) {
+  TestPermute<float>({64, 128, 256}, {0, 1, 2});
+  TestPermute<float>({1 << 20}, {0});
+}
+
+TEST(StridedCopy, transpose2d) {
+  TestPermute<float>({1024, 1024}, {1, 0});
+  TestPermute<double>({1000, 33}, {1, 0});
+  TestPermute<int8_t>({257, 129}, {1, 0});
+}
+
+TEST(StridedCopy, permute) {
+  // NCHW <-> NHWC
+  TestPermute<float>({8, 64, 56, 56}, {0, 2, 3, 1});
+  TestPermute<float>({8, 56, 56, 64}, {0, 3, 1, 2});
+  // swap the heads and the sequence of attention
+  TestPermute<float>({4, 512, 16, 64}, {0, 2, 1, 3});
+  TestPermute<int64_t>({3, 5, 7, 11, 13}, {4, 2, 0, 3, 1});
+  TestPermute<float>({2, 1, 300, 1, 40}, {4, 1, 0, 3, 2});
+}
+
+TEST(StridedCopy, slice) {
+  // the [:, 16:80, :] view of a [32, 128, 100] tensor
+  std::vector<int64_t> dims = {32, 64, 100};
+  std::vector<int64_t> in_strides = {128 * 100, 100, 1};
+  std::vector<int64_t> out_strides = ContiguousStrides(dims);
+  std::vector<float> in(32 * 128 * 100);
+  for (size_t i = 0; i < in.size(); ++i) {
+    in[i] = static_cast<float>(i);
+  }
+  const float* in_data = in.data() + 16 * 100;
+  std::vector<float> out(32 * 64 * 100), ref(32 * 64 * 100);
+  funcs::StridedCopyPlan plan(
+      3, dims.data(), in_strides.data(), out_strides.data());
+  ASSERT_EQ(plan.rank(), 2);
+  plan.Run(in_data, out.data());
+  RefStridedCopy(in_data, in_strides, ref.data(), out_strides, dims);
+  ASSERT_EQ(out, ref);
+
+  // every other column
+  in_strides = {128 * 100, 100, 2};
+  dims = {32, 128, 50};
+  out_strides = ContiguousStrides(dims);
+  out.assign(32 * 128 * 50, 0);
+  ref.assign(32 * 128 * 50, 0);
+  funcs::StridedCopyPlan plan2(
+      3, dims.data(), in_strides.data(), out_strides.data());
+  plan2.Run(in.data(), out.data());
+  RefStridedCopy(in.data(), in_strides, ref.data(), out_strides, dims);
+  ASSERT_EQ(out, ref);
+}
+
+TEST(StridedCopy, strided_out) {
+  // write a contiguous tensor into the transposed view of another one
+  std::vector<int64_t> dims = {96, 200};
+  std::vector<int64_t> in_strides = ContiguousStrides(dims);
+  std::vector<int64_t> out_strides = {1, 96};
+  std::vector<float> in(96 * 200);
+  for (size_t i = 0; i < in.size(); ++i) {
+    in[i] = static_cast<float>(i);
+  }
+  std::vector<float> out(96 * 200), ref(96 * 200);
+  funcs::StridedCopyPlan plan(
+      2, dims.data(), in_strides.data(), out_strides.data());
+  plan.Run(in.data(), out.data());
+  RefStridedCopy(in.data(), in_strides, ref.data(), out_strides, dims);
+  ASSERT_EQ(out, ref);
+
+  // broadcast output keeps the last written element
+  dims = {4, 8};
+  out_strides = {0, 1};
+  in_strides = ContiguousStrides(dims);
+  out.assign(8, 0);
+  ref.assign(8, 0);
+  funcs::StridedCopyPlan plan2(
+      2, dims.data(), in_strides.data(), out_strides.data());
+  plan2.Run(in.data(), out.data());
+  RefStridedCopy(in.data(), in_strides, ref.data(), out_strides, dims);
+  ASSERT_EQ(out, ref);
+}
+
+TEST(StridedCopy, scalar_and_empty) {
+  float in = 3.f, out = 0.f;
+  funcs::StridedCopyPlan plan(0, nullptr, nullptr, nullptr);
+  plan.Run(&in, &out);
+  ASSERT_EQ(out, 3.f);
+
+  std::vector<int64_t> dims = {4, 0, 3};
+  std::vector<int64_t> strides = ContiguousStrides(dims);
+  funcs::StridedCopyPlan empty_plan(
+      3, dims.data(), strides.data(), strides.data());
+  ASSERT_EQ(empty_plan.numel(), 0);
+  empty_plan.Run(&in, &out);
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,103 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "paddle/pir/core/builder.h"
+#include "paddle/pir/core/builtin_attribute.h"
+#include "paddle/pir/core/builtin_dialect.h"
+#include "paddle/pir/core/builtin_op.h"
+#include "paddle/pir/core/builtin_type.h"
+#include "paddle/pir/core/ir_context.h"
+#include "paddle/pir/core/parameter.h"
+#include "paddle/pir/core/program.h"
+#include "paddle/pir/core/serialize/program_serializer.h"
+
+TEST(program_serializer_test, round_trip) {
+  // (1) Init environment.
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+
+  // (2) Build a program with a parameter, constants of several attribute
+  // kinds and a combine op using them.
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  pir::Type param_type = pir::Float32Type::get(ctx);
+  std::vector<float> weight = {1.0f, 2.0f, 3.0f, 4.0f};
+  auto param = std::make_shared<pir::Parameter>(
+      weight.data(), weight.size() * sizeof(float), param_type);
+  param->set_mutable();
+  program.SetParameter("w", param);
+
+  pir::Value w = builder.Build<pir::ParameterOp>("w", param_type)->result(0);
+  pir::Value a = builder
+                     .Build<pir::ConstantOp>(builder.float_attr(2.0f),
+                                             builder.float32_type())
+                     ->result(0);
+  pir::Value b =
+      builder
+          .Build<pir::ConstantOp>(
+              builder.array_attr({builder.int64_attr(1),
+                                  builder.str_attr("x"),
+                                  builder.bool_attr(true)}),
+              builder.int32_type())
+          ->result(0);
+  builder.Build<pir::CombineOp>(std::vector<pir::Value>{w, a, b});
+
+  // (3) Serialize the program and its parameters.
+  std::string params_path = "program_serializer_test.params";
+  std::stringstream program_stream;
+  {
+    std::ofstream params_stream(params_path, std::ios::binary);
+    pir::SerializeProgram(program, program_stream, &params_stream);
+  }
+
+  // (4) Deserialize and compare.
+  std::unique_ptr<pir::Program> loaded =
+      pir::DeserializeProgram(program_stream, ctx, params_path);
+  std::stringstream expected, actual;
+  program.Print(expected);
+  loaded->Print(actual);
+  EXPECT_EQ(expected.str(), actual.str());
+  EXPECT_EQ(loaded->block()->size(), program.block()->size());
+
+  pir::Parameter *loaded_param = loaded->GetParameter("w");
+  ASSERT_NE(loaded_param, nullptr);
+  EXPECT_EQ(loaded_param->type(), param_type);
+  EXPECT_TRUE(loaded_param->is_mutable());
+  ASSERT_EQ(loaded_param->size(), weight.size() * sizeof(float));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(loaded_param->data()) % 64, 0u);
+  const float *data = static_cast<const float *>(loaded_param->data());
+  for (size_t i = 0; i < weight.size(); ++i) {
+    EXPECT_EQ(data[i], weight[i]);
+  }
+
+  // (5) Unmap the parameter blob before removing it.
+  loaded.reset();
+  std::remove(params_path.c_str());
+}
+
+TEST(program_serializer_test, reject_bad_magic) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  std::stringstream bad_stream("not a binary program");
+  EXPECT_THROW(pir::DeserializeProgram(bad_stream, ctx),
+               pir::IrNotMetException);
+}